@@ -91,7 +91,8 @@ void S3D_MASTER::ObjectCoordsTo3DUnits( std::vector< S3D_VERTEX >& aVertices )
 }
 
 
-void TransfertToGLlist( std::vector< S3D_VERTEX >& aVertices, double aBiuTo3DUnits )
+void TransfertToGLlist( CVERTEXBUFFER& aBuffer, std::vector< S3D_VERTEX >& aVertices,
+                        double aBiuTo3DUnits )
 {
     unsigned ii;
     GLfloat ax, ay, az, bx, by, bz, nx, ny, nz, r;
@@ -120,34 +121,34 @@ void TransfertToGLlist( std::vector< S3D_VERTEX >& aVertices, double aBiuTo3DUni
         nx /= r;
         ny /= r;
         nz /= r;
-        glNormal3f( nx, ny, nz );
+        aBuffer.Normal( nx, ny, nz );
     }
 
-    /* glBegin/glEnd */
+    /* Begin/End */
     switch( aVertices.size() )
     {
     case 3:
-        glBegin( GL_TRIANGLES );
+        aBuffer.Begin( GL_TRIANGLES );
         break;
 
     case 4:
-        glBegin( GL_QUADS );
+        aBuffer.Begin( GL_QUADS );
         break;
 
     default:
-        glBegin( GL_POLYGON );
+        aBuffer.Begin( GL_POLYGON );
         break;
     }
 
     /* draw polygon/triangle/quad */
     for( ii = 0; ii < aVertices.size(); ii++ )
     {
-        glVertex3d( aVertices[ii].x * aBiuTo3DUnits,
-                    aVertices[ii].y * aBiuTo3DUnits,
-                    aVertices[ii].z * aBiuTo3DUnits );
+        aBuffer.Vertex( aVertices[ii].x * aBiuTo3DUnits,
+                        aVertices[ii].y * aBiuTo3DUnits,
+                        aVertices[ii].z * aBiuTo3DUnits );
     }
 
-    glEnd();
+    aBuffer.End();
 }
 
 S3DPOINT_VALUE_CTRL::S3DPOINT_VALUE_CTRL( wxWindow* aParent, wxBoxSizer* aBoxSizer )
@@ -39,9 +39,7 @@
 
 #include <gestfich.h>
 
-#ifdef __WINDOWS__
 #include <GL/glew.h>        // must be included before gl.h
-#endif
 
 #include <3d_viewer.h>
 #include <3d_canvas.h>
@@ -76,13 +74,12 @@ END_EVENT_TABLE()
 // Define an invalid value for some unsigned int indexes
 #define INVALID_INDEX GL_INVALID_VALUE
 
-EDA_3D_CANVAS::EDA_3D_CANVAS( EDA_3D_FRAME* parent, int* attribList ) :
-    wxGLCanvas( parent, wxID_ANY, attribList, wxDefaultPosition, wxDefaultSize,
-                wxFULL_REPAINT_ON_RESIZE )
+EDA_3D_SCENE::EDA_3D_SCENE()
 {
     m_init   = false;
-    m_reportWarnings = true;
     m_shadow_init = false;
+    m_shadowKey = 0;
+    m_shapesBuilt = false;
     // set an invalide value to not yet initialized indexes managing
     // textures created to enhance 3D rendering
     m_text_pcb = m_text_silk = INVALID_INDEX;
@@ -99,7 +96,23 @@ EDA_3D_CANVAS::EDA_3D_CANVAS( EDA_3D_FRAME* parent, int* attribList ) :
 
     // Clear all gl list identifiers:
     for( int ii = GL_ID_BEGIN; ii < GL_ID_END; ii++ )
+    {
         m_glLists[ii] = 0;
+        m_glBuffers[ii] = NULL;
+    }
+}
+
+
+EDA_3D_SCENE::~EDA_3D_SCENE()
+{
+}
+
+
+EDA_3D_CANVAS::EDA_3D_CANVAS( EDA_3D_FRAME* parent, int* attribList ) :
+    wxGLCanvas( parent, wxID_ANY, attribList, wxDefaultPosition, wxDefaultSize,
+                wxFULL_REPAINT_ON_RESIZE )
+{
+    m_reportWarnings = true;
 
     // Explicitly create a new rendering context instance for this canvas.
     m_glRC = new wxGLContext( this );
@@ -113,16 +126,21 @@ EDA_3D_CANVAS::~EDA_3D_CANVAS()
     ClearLists();
     m_init = false;
     delete m_glRC;
+}
 
-    // Free the list of parsers list
-    for( unsigned int i = 0; i < m_model_parsers_list.size(); i++ )
-        if( m_model_parsers_list[i] )
-            delete m_model_parsers_list[i];
 
+void EDA_3D_CANVAS::ClearLists( int aGlList )
+{
+    // The lists and buffers belong to the context of this canvas.  If it cannot be
+    // made current, they are freed with the context.
+    if( m_init && IsShownOnScreen() )
+        SetCurrent( *m_glRC );
+
+    EDA_3D_SCENE::ClearLists( aGlList );
 }
 
 
-void EDA_3D_CANVAS::ClearLists( int aGlList )
+void EDA_3D_SCENE::ClearLists( int aGlList )
 {
     if( aGlList )
     {
@@ -131,6 +149,9 @@ void EDA_3D_CANVAS::ClearLists( int aGlList )
 
         m_glLists[aGlList] = 0;
 
+        delete m_glBuffers[aGlList];
+        m_glBuffers[aGlList] = NULL;
+
         return;
     }
 
@@ -140,8 +161,14 @@ void EDA_3D_CANVAS::ClearLists( int aGlList )
             glDeleteLists( m_glLists[ii], 1 );
 
         m_glLists[ii] = 0;
+
+        delete m_glBuffers[ii];
+        m_glBuffers[ii] = NULL;
     }
 
+    m_meshBuffers.clear();
+    m_shapesBuilt = false;
+
     // When m_text_fake_shadow_??? is set to INVALID_INDEX, textures are no yet
     // created.
     if( m_text_fake_shadow_front != INVALID_INDEX )
@@ -546,12 +573,14 @@ GLuint load_and_generate_texture( tsImage *image )
 }
 
 /* Initialize broad parameters for OpenGL */
-void EDA_3D_CANVAS::InitGL()
+void EDA_3D_SCENE::InitGL()
 {
     if( !m_init )
     {
         m_init = true;
 
+        // Vertex buffers are used if available, vertex arrays otherwise.
+        glewInit();
 
         m_text_pcb = load_and_generate_texture( (tsImage *)&text_pcb  );
         m_text_silk = load_and_generate_texture( (tsImage *)&text_silk );
@@ -583,7 +612,7 @@ void EDA_3D_CANVAS::InitGL()
 
 
 /* Initialize OpenGL light sources. */
-void EDA_3D_CANVAS::SetLights()
+void EDA_3D_SCENE::SetLights()
 {
     // activate light. the source is above the xy plane, at source_pos
     GLfloat source_pos[4]    = { m_lightPos.x, m_lightPos.y, m_lightPos.z, 0.0f };
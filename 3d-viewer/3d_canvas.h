@@ -32,84 +32,15 @@
 
 #include <wx/glcanvas.h>
 
-#ifdef __WXMAC__
-#  ifdef __DARWIN__
-#    include <OpenGL/glu.h>
-#  else
-#    include <glu.h>
-#  endif
-#else
-#  include <GL/glu.h>
-#endif
+#include <3d_scene.h>
 
-#include <3d_struct.h>
-#include <modelparsers.h>
-#include <class_module.h>
-#include <CBBox.h>
-
-class BOARD_DESIGN_SETTINGS;
 class EDA_3D_FRAME;
-class CPOLYGONS_LIST;
-
-class VIA;
-class D_PAD;
-
-// We are using GL lists to store layers and other items
-// to draw or not
-// GL_LIST_ID are the GL lists indexes in m_glLists
-enum GL_LIST_ID
-{
-    GL_ID_BEGIN = 0,
-    GL_ID_AXIS = GL_ID_BEGIN,   // list id for 3D axis
-    GL_ID_GRID,                 // list id for 3D grid
-    GL_ID_BOARD,                // List id for copper layers
-    GL_ID_TECH_LAYERS,          // List id for non copper layers (masks...)
-    GL_ID_AUX_LAYERS,           // List id for user layers (draw, eco, comment)
-    GL_ID_3DSHAPES_SOLID_FRONT, // List id for 3D shapes, non transparent entities
-    GL_ID_3DSHAPES_TRANSP_FRONT,// List id for 3D shapes, transparent entities
-    GL_ID_3DSHAPES_SOLID_BACK,  // List id for 3D shapes, non transparent entities
-    GL_ID_3DSHAPES_TRANSP_BACK, // List id for 3D shapes, transparent entities
-    GL_ID_SHADOW_FRONT,
-    GL_ID_SHADOW_BACK,
-    GL_ID_SHADOW_BOARD,
-    GL_ID_BODY,                 // Body only list
-    GL_ID_END
-};
 
-class EDA_3D_CANVAS : public wxGLCanvas
+class EDA_3D_CANVAS : public wxGLCanvas, public EDA_3D_SCENE
 {
 private:
-    bool            m_init;
     bool            m_reportWarnings;       ///< true to report all wranings when build the 3D scene false to report errors only
-    GLuint          m_glLists[GL_ID_END];   ///< GL lists
     wxGLContext*    m_glRC;
-    wxRealPoint     m_draw3dOffset;         ///< offset to draw the 3D mesh.
-    double          m_ZBottom;              ///< position of the back layer
-    double          m_ZTop;                 ///< position of the front layer
-
-    GLuint          m_text_pcb;             ///< an index to the texture generated for pcb texts
-    GLuint          m_text_silk;            ///< an index to the texture generated for silk layers
-
-    // Index to the textures generated for shadows
-    bool            m_shadow_init;
-    GLuint          m_text_fake_shadow_front;
-    GLuint          m_text_fake_shadow_back;
-    GLuint          m_text_fake_shadow_board;
-
-    CBBOX           m_boardAABBox;          ///< Axis Align Bounding Box of the board
-    CBBOX           m_fastAABBox;           ///< Axis Align Bounding Box that contain the other bounding boxes
-    CBBOX           m_fastAABBox_Shadow;    ///< A bit scalled version of the m_fastAABBox
-
-    S3D_VERTEX      m_lightPos;
-
-    /// Stores the list of parsers for each new file name (dont repeat files already loaded)
-    std::vector<S3D_MODEL_PARSER *> m_model_parsers_list;
-    std::vector<wxString> m_model_filename_list;
-
-    void create_and_render_shadow_buffer( GLuint *aDst_gl_texture,
-            GLuint aTexture_size, bool aDraw_body, int aBlurPasses );
-
-    void calcBBox();
 
 public:
     EDA_3D_CANVAS( EDA_3D_FRAME* parent, int* attribList = 0 );
@@ -121,12 +52,20 @@ public:
 
     /**
      * Function ClearLists
-     * Clear the display list.
+     * Clear the display list or the vertex buffer, after making the context of this
+     * canvas current.
      * @param aGlList = the list to clear.
-     * if 0 (default) all lists are cleared
+     * if 0 (default) all lists and buffers are cleared, including the 3D shapes
      */
     void   ClearLists( int aGlList = 0 );
 
+    /**
+     * Function CreateDrawGL_List
+     * creates the missing OpenGL draw list items, with a busy cursor.
+     * @see EDA_3D_SCENE::CreateDrawGL_List()
+     */
+    void   CreateDrawGL_List( wxString* aErrorMessages, bool aShowWarnings );
+
     // Event functions:
     void   OnPaint( wxPaintEvent& event );
     void   OnEraseBackground( wxEraseEvent& event );
@@ -144,200 +83,9 @@ public:
     void   Redraw();
     void   Render();
 
-    /**
-     * Function CreateDrawGL_List
-     * Prepares the parameters of the OpenGL draw list
-     * creates the OpenGL draw list items (board, grid ...)
-     * @param aErrorMessages = a wxString which will filled with error messages,
-     * if any
-     * @param aShowWarnings = true to show all messages, false to show errors only
-     */
-    void   CreateDrawGL_List( wxString* aErrorMessages, bool aShowWarnings );
-    void   InitGL();
-
     void ReportWarnings( bool aReport ) { m_reportWarnings = aReport; }
 
-    void   SetLights();
-
-    void   SetOffset(double aPosX, double aPosY)
-    {
-        m_draw3dOffset.x = aPosX;
-        m_draw3dOffset.y = aPosY;
-    }
-
-    /** @return the INFO3D_VISU which contains the current parameters
-     * to draw the 3D view og the board
-     */
-    INFO3D_VISU& GetPrm3DVisu() const;
-
-
-private:
-
-    /**
-     * return true if we are in realistic mode render
-     */
-    bool isRealisticMode() const;
-
-    /**
-     * @return true if aItem should be displayed
-     * @param aItem = an item of DISPLAY3D_FLG enum
-     */
-    bool isEnabled( DISPLAY3D_FLG aItem ) const;
-
-    /** Helper function
-     * @return true if aLayer should be displayed, false otherwise
-     */
-    bool is3DLayerEnabled( LAYER_ID aLayer ) const;
-
-    /**
-     * @return the size of the board in pcb units
-     */
-    wxSize getBoardSize() const;
-
-    /**
-     * @return the position of the board center in pcb units
-     */
-    wxPoint getBoardCenter() const;
-
-    /**
-     * Helper function setGLTechLayersColor
-     * Initialize the color to draw the non copper layers
-     * in realistic mode and normal mode.
-     */
-    void setGLTechLayersColor( LAYER_NUM aLayer );
-
-    /**
-     * Helper function setGLCopperColor
-     * Initialize the copper color to draw the board
-     * in realistic mode (a golden yellow color )
-     */
-    void setGLCopperColor();
-
-    /**
-     * Helper function setGLEpoxyColor
-     * Initialize the color to draw the epoxy body board in realistic mode.
-     */
-    void setGLEpoxyColor( float aTransparency = 1.0 );
-
-    /**
-     * Helper function setGLSolderMaskColor
-     * Initialize the color to draw the solder mask layers in realistic mode.
-     */
-    void setGLSolderMaskColor( float aTransparency = 1.0 );
-
-    /**
-     * Function buildBoard3DView
-     * Called by CreateDrawGL_List()
-     * Populates the OpenGL GL_ID_BOARD draw list with board items only on copper layers.
-     * 3D footprint shapes, tech layers and aux layers are not on this list
-     * Fills aErrorMessages with error messages created by some calculation function
-     * @param aBoardList =
-     * @param aBodyOnlyList =
-     * @param aErrorMessages = a wxString to add error and warning messages
-     * created by the build process (can be NULL)
-     * @param aShowWarnings = true to show all messages, false to show errors only
-     */
-    void   buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
-                             wxString* aErrorMessages, bool aShowWarnings );
-
-    /**
-     * Function buildTechLayers3DView
-     * Called by CreateDrawGL_List()
-     * Populates the OpenGL GL_ID_TECH_LAYERS draw list with items on tech layers
-     * @param aErrorMessages = a wxString to add error and warning messages
-     * created by the build process (can be NULL)
-     * @param aShowWarnings = true to show all messages, false to show errors only
-     */
-    void   buildTechLayers3DView( wxString* aErrorMessages, bool aShowWarnings );
-
-    /**
-     * Function buildShadowList
-     * Called by CreateDrawGL_List()
-     */
-     void buildShadowList( GLuint aFrontList, GLuint aBacklist, GLuint aBoardList );
-
-    /**
-     * Function buildFootprintShape3DList
-     * Called by CreateDrawGL_List()
-     * Fills the OpenGL GL_ID_3DSHAPES_SOLID and GL_ID_3DSHAPES_TRANSP
-     * draw lists with 3D footprint shapes
-     * @param aOpaqueList is the gl list for non transparent items
-     * @param aTransparentList is the gl list for non transparent items,
-     * which need to be drawn after all other items
-     */
-    void   buildFootprintShape3DList( GLuint aOpaqueList,
-                                      GLuint aTransparentList );
-    /**
-     * Function buildBoard3DAuxLayers
-     * Called by CreateDrawGL_List()
-     * Fills the OpenGL GL_ID_AUX_LAYERS draw list
-     * with items on aux layers only
-     */
-    void   buildBoard3DAuxLayers();
-
-    void   draw3DGrid( double aGriSizeMM );
-    void   draw3DAxis();
-
-    /**
-     * Helper function BuildPadShapeThickOutlineAsPolygon:
-     * Build a pad outline as non filled polygon, to draw pads on silkscreen layer
-     * with a line thickness = aWidth
-     * Used only to draw pads outlines on silkscreen layers.
-     */
-    void buildPadShapeThickOutlineAsPolygon( const D_PAD*          aPad,
-                                             CPOLYGONS_LIST& aCornerBuffer,
-                                             int             aWidth,
-                                             int             aCircleToSegmentsCount,
-                                             double          aCorrectionFactor );
-
-
-    /**
-     * Helper function draw3DViaHole:
-     * Draw the via hole:
-     * Build a vertical hole (a cylinder) between the first and the last via layers
-     */
-    void   draw3DViaHole( const VIA * aVia );
-
-    /**
-     * Helper function draw3DPadHole:
-     * Draw the pad hole:
-     * Build a vertical hole (round or oblong) between the front and back layers
-     */
-    void   draw3DPadHole( const D_PAD * aPad );
-
-    /**
-     * function render3DComponentShape
-     * insert mesh in gl list
-     * @param module
-     * @param  aIsRenderingJustNonTransparentObjects = true to load non transparent objects
-     * @param  aIsRenderingJustTransparentObjects = true to load non transparent objects
-     * in openGL, transparent objects should be drawn *after* non transparent objects
-     */
-    void render3DComponentShape( MODULE* module,
-                                 bool aIsRenderingJustNonTransparentObjects,
-                                 bool aIsRenderingJustTransparentObjects );
-
-    /**
-     * function read3DComponentShape
-     * read the 3D component shape(s) of the footprint (physical shape).
-     * @param module
-     * @return true if load was succeeded, false otherwise
-     */
-    bool read3DComponentShape( MODULE* module );
-
-    /**
-     * function generateFakeShadowsTextures
-     * creates shadows of the board an footprints
-     * for aesthetical purpose
-     * @param aErrorMessages = a wxString to add error and warning messages
-     * created by the build process (can be NULL)
-     * @param aShowWarnings = true to show all messages, false to show errors only
-     */
-    void   generateFakeShadowsTextures( wxString* aErrorMessages, bool aShowWarnings );
-
     DECLARE_EVENT_TABLE()
 };
 
-void CheckGLError(const char *aFileName, int aLineNumber);
-
 #endif  /*  _3D_CANVAS_H_ */
@@ -57,7 +57,6 @@ S3D_MASTER::S3D_MASTER( EDA_ITEM* aParent ) :
     
     m_3D_Drawings = NULL;
     m_Materials   = NULL;
-    m_parser      = NULL;
     m_ShapeType   = FILE3D_NONE;
 
     m_use_modelfile_diffuseColor = true;
@@ -69,7 +69,146 @@
 static GLfloat  Get3DLayer_Z_Orientation( LAYER_NUM aLayer );
 
 
-void EDA_3D_CANVAS::create_and_render_shadow_buffer( GLuint *aDst_gl_texture,
+/// Size of the shadow textures, in pixels
+#define SHADOW_TEXTURE_SIZE 512
+
+
+/**
+ * Class SHADOW_KEY
+ * computes a 64 bits FNV-1a hash of the parameters of the shadows, to know if
+ * the shadow images must be rendered again.
+ */
+class SHADOW_KEY
+{
+public:
+    SHADOW_KEY() :
+        m_hash( 14695981039346656037ULL )
+    {
+    }
+
+    void Add( const void* aData, size_t aSize )
+    {
+        const unsigned char* data = (const unsigned char*) aData;
+
+        for( size_t ii = 0; ii < aSize; ++ii )
+            m_hash = ( m_hash ^ data[ii] ) * 1099511628211ULL;
+    }
+
+    void Add( double aValue )   { Add( &aValue, sizeof( aValue ) ); }
+    void Add( int aValue )      { Add( &aValue, sizeof( aValue ) ); }
+
+    void Add( const S3D_VERTEX& aVertex )
+    {
+        Add( (double) aVertex.x );
+        Add( (double) aVertex.y );
+        Add( (double) aVertex.z );
+    }
+
+    void Add( const S3DPOINT& aPoint )
+    {
+        Add( aPoint.x );
+        Add( aPoint.y );
+        Add( aPoint.z );
+    }
+
+    void Add( const wxString& aText )
+    {
+        std::string text = TO_UTF8( aText );
+
+        Add( (int) text.size() );
+        Add( text.data(), text.size() );
+    }
+
+    uint64_t Get() const    { return m_hash; }
+
+private:
+    uint64_t    m_hash;
+};
+
+
+uint64_t EDA_3D_SCENE::shadowKey()
+{
+    BOARD*      pcb = GetBoard();
+    SHADOW_KEY  key;
+
+    // The view of the shadows
+    key.Add( GetPrm3DVisu().m_BiuTo3Dunits );
+    key.Add( GetPrm3DVisu().m_BoardPos.x );
+    key.Add( GetPrm3DVisu().m_BoardPos.y );
+    key.Add( GetPrm3DVisu().m_BoardSize.x );
+    key.Add( GetPrm3DVisu().m_BoardSize.y );
+    key.Add( GetPrm3DVisu().GetLayerZcoordBIU( F_Paste ) );
+    key.Add( GetPrm3DVisu().GetLayerZcoordBIU( B_Paste ) );
+    key.Add( m_fastAABBox_Shadow.Min() );
+    key.Add( m_fastAABBox_Shadow.Max() );
+    key.Add( m_lightPos );
+
+    // What is drawn
+    key.Add( (int) isEnabled( FL_RENDER_MATERIAL ) );
+    key.Add( (int) m_shapesBuilt );
+    key.Add( (int) ( m_glBuffers[GL_ID_BOARD] != NULL ) );
+
+    // The board outline
+    CPOLYGONS_LIST  outlines;
+    CPOLYGONS_LIST  holes;
+    wxString        msg;
+
+    pcb->GetBoardPolygonOutlines( outlines, holes, &msg );
+
+    key.Add( (int) outlines.GetCornersCount() );
+
+    for( unsigned ii = 0; ii < outlines.GetCornersCount(); ii++ )
+    {
+        key.Add( outlines.GetX( ii ) );
+        key.Add( outlines.GetY( ii ) );
+        key.Add( (int) outlines.IsEndContour( ii ) );
+    }
+
+    // The footprints and their shapes
+    for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
+    {
+        key.Add( module->GetPosition().x );
+        key.Add( module->GetPosition().y );
+        key.Add( module->GetOrientation() );
+        key.Add( (int) module->IsFlipped() );
+
+        for( S3D_MASTER* shape3D = module->Models(); shape3D; shape3D = shape3D->Next() )
+        {
+            if( !shape3D->Is3DType( S3D_MASTER::FILE3D_VRML ) )
+                continue;
+
+            wxString        filename = shape3D->GetShape3DFullFilename();
+            wxStructStat    st;
+
+            key.Add( filename );
+
+            // An edited model file gives other shadows under the same name.
+            // The separators are fixed as in S3D_MASTER::ReadData().
+#ifdef __WINDOWS__
+            filename.Replace( wxT( "/" ), wxT( "\\" ) );
+#else
+            filename.Replace( wxT( "\\" ), wxT( "/" ) );
+#endif
+
+            if( wxStat( filename, &st ) == 0 )
+            {
+                key.Add( (double) st.st_mtime );
+                key.Add( (double) st.st_size );
+            }
+            else
+                key.Add( -1 );
+
+            key.Add( shape3D->m_MatScale );
+            key.Add( shape3D->m_MatRotation );
+            key.Add( shape3D->m_MatPosition );
+        }
+    }
+
+    return key.Get();
+}
+
+
+void EDA_3D_SCENE::create_and_render_shadow_buffer( std::vector<unsigned char>& aShadowImage,
         GLuint aTexture_size, bool aDraw_body, int aBlurPasses )
 {
     glDisable( GL_TEXTURE_2D );
@@ -81,57 +220,61 @@ void EDA_3D_CANVAS::create_and_render_shadow_buffer( GLuint *aDst_gl_texture,
 
     // Render body and shapes
 
-    if( aDraw_body && m_glLists[GL_ID_BODY] )
-            glCallList( m_glLists[GL_ID_BODY] );
+    if( aDraw_body && m_glBuffers[GL_ID_BOARD] )
+        m_glBuffers[GL_ID_BOARD]->DrawRange( RANGE_ID_BODY );
 
-    if( m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] )
-        glCallList( m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] );
+    if( m_shapesBuilt )
+        drawFootprintShapes( isEnabled( FL_RENDER_MATERIAL ), false );
 
     // Create and Initialize the float depth buffer
 
-    float *depthbufferFloat = (float*) malloc( aTexture_size * aTexture_size * sizeof(float) );
-
-    for( unsigned int i = 0; i < (aTexture_size * aTexture_size); i++ )
-        depthbufferFloat[i] = 1.0f;
+    std::vector<float> depthbufferFloat( aTexture_size * aTexture_size, 1.0f );
 
+    // The depth is read from the current frame buffer, the one of the canvas
+    // or the offscreen one
     glPixelStorei( GL_PACK_ALIGNMENT, 4 );
     glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
-    glReadBuffer( GL_BACK_LEFT );
     glReadPixels( 0, 0,
                   aTexture_size, aTexture_size,
-                  GL_DEPTH_COMPONENT, GL_FLOAT, depthbufferFloat );
+                  GL_DEPTH_COMPONENT, GL_FLOAT, &depthbufferFloat[0] );
 
     CheckGLError( __FILE__, __LINE__ );
 
-    glEnable( GL_TEXTURE_2D );
-    glGenTextures( 1, aDst_gl_texture );
-    glBindTexture( GL_TEXTURE_2D, *aDst_gl_texture );
-
     CIMAGE imgDepthBuffer( aTexture_size, aTexture_size );
     CIMAGE imgDepthBufferAux( aTexture_size, aTexture_size );
 
-    imgDepthBuffer.SetPixelsFromNormalizedFloat( depthbufferFloat );
-
-    free( depthbufferFloat );
+    imgDepthBuffer.SetPixelsFromNormalizedFloat( &depthbufferFloat[0] );
 
     // Debug texture image
     //wxString filename;
-    //filename.Printf( "imgDepthBuffer_%04d", *aDst_gl_texture );
+    //filename.Printf( "imgDepthBuffer_%p", &aShadowImage );
     //imgDepthBuffer.SaveAsPNG( filename );
 
     while( aBlurPasses > 0 )
     {
         aBlurPasses--;
-        imgDepthBufferAux.EfxFilter( &imgDepthBuffer, FILTER_GAUSSIAN_BLUR );
-        imgDepthBuffer.EfxFilter( &imgDepthBufferAux, FILTER_GAUSSIAN_BLUR );
+        imgDepthBufferAux.EfxBlur( &imgDepthBuffer );
+        imgDepthBuffer.EfxBlur( &imgDepthBufferAux );
     }
 
     // Debug texture image
-    //filename.Printf( "imgDepthBuffer_blur%04d", *aDst_gl_texture );
+    //filename.Printf( "imgDepthBuffer_blur%p", &aShadowImage );
     //imgDepthBuffer.SaveAsPNG( filename );
 
-    unsigned char *depthbufferRGBA = (unsigned char*) malloc( aTexture_size * aTexture_size * 4 );
-    unsigned char *pPixels = imgDepthBuffer.GetBuffer();
+    const unsigned char* pPixels = imgDepthBuffer.GetBuffer();
+
+    aShadowImage.assign( pPixels, pPixels + aTexture_size * aTexture_size );
+}
+
+
+void EDA_3D_SCENE::createShadowTexture( GLuint *aDst_gl_texture,
+        const std::vector<unsigned char>& aShadowImage, GLuint aTexture_size )
+{
+    glEnable( GL_TEXTURE_2D );
+    glGenTextures( 1, aDst_gl_texture );
+    glBindTexture( GL_TEXTURE_2D, *aDst_gl_texture );
+
+    std::vector<unsigned char> depthbufferRGBA( aTexture_size * aTexture_size * 4 );
 
     // Convert it to a RGBA buffer
     for( unsigned int i = 0; i < (aTexture_size * aTexture_size); i++ )
@@ -139,7 +282,7 @@ void EDA_3D_CANVAS::create_and_render_shadow_buffer( GLuint *aDst_gl_texture,
         depthbufferRGBA[i * 4 + 0] = 0;
         depthbufferRGBA[i * 4 + 1] = 0;
         depthbufferRGBA[i * 4 + 2] = 0;
-        depthbufferRGBA[i * 4 + 3] = 255 - pPixels[i];                  // Store in alpha channel the inversion of the image
+        depthbufferRGBA[i * 4 + 3] = 255 - aShadowImage[i];    // Store in alpha channel the inversion of the image
     }
 
     glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
@@ -147,9 +290,7 @@ void EDA_3D_CANVAS::create_and_render_shadow_buffer( GLuint *aDst_gl_texture,
     glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
     glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
 
-    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, aTexture_size, aTexture_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, depthbufferRGBA );
-
-    free( depthbufferRGBA );
+    glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, aTexture_size, aTexture_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, &depthbufferRGBA[0] );
 
     CheckGLError( __FILE__, __LINE__ );
 }
@@ -157,7 +298,7 @@ void EDA_3D_CANVAS::create_and_render_shadow_buffer( GLuint *aDst_gl_texture,
 /// Scale factor to make a bigger BBox in order to blur the texture and dont have artifacts in the edges
 #define SHADOW_BOUNDING_BOX_SCALE 1.25f
 
-void EDA_3D_CANVAS::generateFakeShadowsTextures( wxString* aErrorMessages, bool aShowWarnings )
+void EDA_3D_SCENE::generateFakeShadowsTextures( wxString* aErrorMessages, bool aShowWarnings )
 {
     if( m_shadow_init == true )
     {
@@ -171,6 +312,29 @@ void EDA_3D_CANVAS::generateFakeShadowsTextures( wxString* aErrorMessages, bool
 
     m_shadow_init = true;
 
+    // The shadow images are kept when the lists are rebuilt: render them again
+    // only if the board outline or the footprints were changed.
+    uint64_t key = shadowKey();
+
+    if( key != m_shadowKey || m_shadowImages[SHADOW_BOARD].empty() )
+    {
+        renderFakeShadows();
+        m_shadowKey = key;
+    }
+
+    createShadowTexture( &m_text_fake_shadow_front, m_shadowImages[SHADOW_FRONT],
+                         SHADOW_TEXTURE_SIZE );
+    createShadowTexture( &m_text_fake_shadow_back, m_shadowImages[SHADOW_BACK],
+                         SHADOW_TEXTURE_SIZE );
+    createShadowTexture( &m_text_fake_shadow_board, m_shadowImages[SHADOW_BOARD],
+                         SHADOW_TEXTURE_SIZE );
+
+    DBG( printf( "  generateFakeShadowsTextures total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
+}
+
+
+void EDA_3D_SCENE::renderFakeShadows()
+{
     glClearColor( 0, 0, 0, 1 );
 
     glMatrixMode( GL_PROJECTION );
@@ -197,7 +361,7 @@ void EDA_3D_CANVAS::generateFakeShadowsTextures( wxString* aErrorMessages, bool
                   -GetPrm3DVisu().m_BoardPos.y * GetPrm3DVisu().m_BiuTo3Dunits,
                   0.0f );
 
-    create_and_render_shadow_buffer( &m_text_fake_shadow_front, 512, false, 1 );
+    create_and_render_shadow_buffer( m_shadowImages[SHADOW_FRONT], SHADOW_TEXTURE_SIZE, false, 1 );
 
     zpos = GetPrm3DVisu().GetLayerZcoordBIU( B_Paste ) * GetPrm3DVisu().m_BiuTo3Dunits;
 
@@ -212,7 +376,7 @@ void EDA_3D_CANVAS::generateFakeShadowsTextures( wxString* aErrorMessages, bool
                   -GetPrm3DVisu().m_BoardPos.y * GetPrm3DVisu().m_BiuTo3Dunits,
                   0.0f );
 
-    create_and_render_shadow_buffer( &m_text_fake_shadow_back, 512, false, 1 );
+    create_and_render_shadow_buffer( m_shadowImages[SHADOW_BACK], SHADOW_TEXTURE_SIZE, false, 1 );
 
 
     // Render ALL BOARD shadow
@@ -247,9 +411,7 @@ void EDA_3D_CANVAS::generateFakeShadowsTextures( wxString* aErrorMessages, bool
     // move the bouding box in order to draw it with its center at 0,0 3D coordinates
     glTranslatef( -(m_fastAABBox_Shadow.Min().x + v.x / 2.0f), -(m_fastAABBox_Shadow.Min().y + v.y / 2.0f), 0.0f );
 
-    create_and_render_shadow_buffer( &m_text_fake_shadow_board, 512, true, 10 );
-
-    DBG( printf( "  generateFakeShadowsTextures total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
+    create_and_render_shadow_buffer( m_shadowImages[SHADOW_BOARD], SHADOW_TEXTURE_SIZE, true, 10 );
 }
 
 
@@ -260,7 +422,6 @@ void EDA_3D_CANVAS::Redraw()
         return;
 
     wxString errorMessages;
-    bool showWarnings = m_reportWarnings;
 
     SetCurrent( *m_glRC );
 
@@ -272,15 +433,38 @@ void EDA_3D_CANVAS::Redraw()
     // is wrong when next another canvas is repainted.
     wxSize size = GetClientSize();
 
+    RenderScene( size, Parent()->ModeIsOrtho(), &errorMessages, m_reportWarnings );
+
+    SwapBuffers();
+
+    if( !errorMessages.IsEmpty() )
+        wxLogMessage( errorMessages );
+
+    ReportWarnings( false );
+}
+
+
+void EDA_3D_CANVAS::CreateDrawGL_List( wxString* aErrorMessages, bool aShowWarnings )
+{
+    wxBusyCursor    dummy;
+
+    EDA_3D_SCENE::CreateDrawGL_List( aErrorMessages, aShowWarnings );
+}
+
+
+void EDA_3D_SCENE::RenderScene( const wxSize& aSize, bool aOrtho,
+                                wxString* aErrorMessages, bool aShowWarnings )
+{
+    const wxSize& size = aSize;
+
     InitGL();
 
     if( isEnabled( FL_MODULE ) && isRealisticMode() &&
         isEnabled( FL_RENDER_SHADOWS ) )
     {
-        generateFakeShadowsTextures( &errorMessages, showWarnings );
+        generateFakeShadowsTextures( aErrorMessages, aShowWarnings );
     }
 
-    // *MUST* be called *after*  SetCurrent( ):
     glViewport( 0, 0, size.x, size.y );
 
     // clear color and depth buffers
@@ -328,7 +512,7 @@ void EDA_3D_CANVAS::Redraw()
     if( GetPrm3DVisu().m_Zoom > MAX_VIEW_ANGLE )
         GetPrm3DVisu().m_Zoom = MAX_VIEW_ANGLE;
 
-     if( Parent()->ModeIsOrtho() )
+     if( aOrtho )
      {
          // OrthoReductionFactor is chosen to provide roughly the same size as
          // Perspective View
@@ -374,8 +558,8 @@ void EDA_3D_CANVAS::Redraw()
     glRotatef( GetPrm3DVisu().m_Rot[2], 0.0, 0.0, 1.0 );
 
 
-    if( ! m_glLists[GL_ID_BOARD] || ! m_glLists[GL_ID_TECH_LAYERS] )
-        CreateDrawGL_List( &errorMessages, showWarnings );
+    if( ! m_glBuffers[GL_ID_BOARD] || ! m_glBuffers[GL_ID_TECH_LAYERS] )
+        CreateDrawGL_List( aErrorMessages, aShowWarnings );
 
     if( isEnabled( FL_AXIS ) && m_glLists[GL_ID_AXIS] )
         glCallList( m_glLists[GL_ID_AXIS] );
@@ -385,11 +569,8 @@ void EDA_3D_CANVAS::Redraw()
                   -GetPrm3DVisu().m_BoardPos.y * GetPrm3DVisu().m_BiuTo3Dunits,
                   0.0f );
 
-    if( isEnabled( FL_MODULE ) )
-    {
-        if( ! m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] )
-            CreateDrawGL_List( &errorMessages, showWarnings );
-    }
+    if( isEnabled( FL_MODULE ) && ! m_shapesBuilt )
+        CreateDrawGL_List( aErrorMessages, aShowWarnings );
 
     glEnable( GL_LIGHTING );
 
@@ -412,9 +593,9 @@ void EDA_3D_CANVAS::Redraw()
 
     if( isEnabled( FL_SHOW_BOARD_BODY ) )
     {
-        if( m_glLists[GL_ID_BODY] )
+        if( m_glBuffers[GL_ID_BOARD] )
         {
-            glCallList( m_glLists[GL_ID_BODY] );
+            m_glBuffers[GL_ID_BOARD]->DrawRange( RANGE_ID_BODY );
         }
     }
 
@@ -429,9 +610,13 @@ void EDA_3D_CANVAS::Redraw()
                         GetPrm3DVisu().m_CopperColor.m_Blue  * 0.20f, 1.0f );
     glMaterialfv( GL_FRONT_AND_BACK, GL_SPECULAR, &specular.x );
 
-    if( m_glLists[GL_ID_BOARD] )
+    if( m_glBuffers[GL_ID_BOARD] )
     {
-        glCallList( m_glLists[GL_ID_BOARD] );
+        drawBufferLayers( *m_glBuffers[GL_ID_BOARD] );
+
+        // The holes are hidden by the body, unless the copper is thick
+        if( !isEnabled( FL_SHOW_BOARD_BODY ) || isEnabled( FL_USE_COPPER_THICKNESS ) )
+            m_glBuffers[GL_ID_BOARD]->DrawRange( RANGE_ID_HOLES );
     }
 
 
@@ -443,17 +628,17 @@ void EDA_3D_CANVAS::Redraw()
     glm::vec4 specularTech( 0.0f, 0.0f, 0.0f, 1.0f );
     glMaterialfv( GL_FRONT_AND_BACK, GL_SPECULAR, &specularTech.x );
 
-    if( m_glLists[GL_ID_TECH_LAYERS] )
+    if( m_glBuffers[GL_ID_TECH_LAYERS] )
     {
-        glCallList( m_glLists[GL_ID_TECH_LAYERS] );
+        drawBufferLayers( *m_glBuffers[GL_ID_TECH_LAYERS] );
     }
 
-    if( isEnabled( FL_COMMENTS ) || isEnabled( FL_COMMENTS )  )
+    if( isEnabled( FL_COMMENTS ) || isEnabled( FL_ECO )  )
     {
-        if( ! m_glLists[GL_ID_AUX_LAYERS] )
-            CreateDrawGL_List( &errorMessages, showWarnings );
+        if( ! m_glBuffers[GL_ID_AUX_LAYERS] )
+            CreateDrawGL_List( aErrorMessages, aShowWarnings );
 
-        glCallList( m_glLists[GL_ID_AUX_LAYERS] );
+        drawBufferLayers( *m_glBuffers[GL_ID_AUX_LAYERS] );
     }
 
 
@@ -502,10 +687,11 @@ void EDA_3D_CANVAS::Redraw()
 
     if( isEnabled( FL_MODULE ) )
     {
-        if( ! m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] )
-            CreateDrawGL_List( &errorMessages, showWarnings );
+        if( ! m_shapesBuilt )
+            CreateDrawGL_List( aErrorMessages, aShowWarnings );
 
-        glCallList( m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] );
+        // Without materials, all the shapes are drawn as non transparent objects
+        drawFootprintShapes( isEnabled( FL_RENDER_MATERIAL ), false );
     }
 
     glEnable( GL_BLEND );
@@ -537,14 +723,14 @@ void EDA_3D_CANVAS::Redraw()
         }
     }
 
-    // This list must be drawn last, because it contains the
+    // These shapes must be drawn last, because they are the
     // transparent gl objects, which should be drawn after all
     // non transparent objects
-    if(  isEnabled( FL_MODULE ) && m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] )
+    if(  isEnabled( FL_MODULE ) && isEnabled( FL_RENDER_MATERIAL ) )
     {
         glEnable( GL_BLEND );
         glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-        glCallList( m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] );
+        drawFootprintShapes( false, true );
     }
 
     // Debug bounding boxes
@@ -558,17 +744,10 @@ void EDA_3D_CANVAS::Redraw()
     glColor4f( 0.0f, 1.0f, 1.0f, 1.0f );
     m_boardAABBox.GLdebug();
     */
-
-    SwapBuffers();
-
-    if( !errorMessages.IsEmpty() )
-        wxLogMessage( errorMessages );
-
-    ReportWarnings( false );
 }
 
 
-void EDA_3D_CANVAS::buildShadowList( GLuint aFrontList, GLuint aBacklist, GLuint aBoardList )
+void EDA_3D_SCENE::buildShadowList( GLuint aFrontList, GLuint aBacklist, GLuint aBoardList )
 {
     // Board shadows are based on board dimension.
 
@@ -632,8 +811,8 @@ void EDA_3D_CANVAS::buildShadowList( GLuint aFrontList, GLuint aBacklist, GLuint
 }
 
 
-void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
-                                      wxString* aErrorMessages, bool aShowWarnings  )
+void EDA_3D_SCENE::buildBoard3DView( CVERTEXBUFFER& aBuffer,
+                                     wxString* aErrorMessages, bool aShowWarnings  )
 {
     BOARD* pcb = GetBoard();
 
@@ -691,8 +870,6 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
     LAYER_ID        cu_seq[MAX_CU_LAYERS];          // preferred sequence, could have called CuStack()
                                                     // but I assume that's backwards
 
-    glNewList( aBoardList, GL_COMPILE );
-
     for( unsigned i=0; i < DIM( cu_seq ); ++i )
         cu_seq[i] = ToLAYER_ID( B_Cu - i );
 
@@ -856,21 +1033,23 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
         int thickness = GetPrm3DVisu().GetLayerObjectThicknessBIU( layer );
         int zpos = GetPrm3DVisu().GetLayerZcoordBIU( layer );
 
+        aBuffer.BeginRange( layer );
+
         if( realistic_mode )
         {
-            setGLCopperColor();
+            setGLCopperColor( aBuffer );
         }
         else
         {
             EDA_COLOR_T color = g_ColorsSettings.GetLayerColor( layer );
-            SetGLColor( color );
+            SetGLColor( aBuffer, color );
         }
 
-        glNormal3f( 0.0, 0.0, Get3DLayer_Z_Orientation( layer ) );
+        aBuffer.Normal( 0.0, 0.0, Get3DLayer_Z_Orientation( layer ) );
 
         bufferPolys.RemoveAllContours();
         bufferPolys.ImportFrom( currLayerPolyset );
-        Draw3D_SolidHorizontalPolyPolygons( bufferPolys, zpos,
+        Draw3D_SolidHorizontalPolyPolygons( aBuffer, bufferPolys, zpos,
                                             thickness,
                                             GetPrm3DVisu().m_BiuTo3Dunits, useTextures );
 
@@ -879,51 +1058,48 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
             thickness -= ( 0.04 * IU_PER_MM );
         }
 
-        glNormal3f( 0.0, 0.0, Get3DLayer_Z_Orientation( layer ) );
+        aBuffer.Normal( 0.0, 0.0, Get3DLayer_Z_Orientation( layer ) );
 
         if( bufferZonesPolys.GetCornersCount() )
-            Draw3D_SolidHorizontalPolyPolygons( bufferZonesPolys, zpos,
+            Draw3D_SolidHorizontalPolyPolygons( aBuffer, bufferZonesPolys, zpos,
                                                 thickness,
                                                 GetPrm3DVisu().m_BiuTo3Dunits, useTextures );
         throughHolesListBuilt = true;
     }
 
-    if ( !isEnabled( FL_SHOW_BOARD_BODY ) ||
-          isEnabled( FL_USE_COPPER_THICKNESS ) )
-    {
-        setGLCopperColor();
-
-        // Draw vias holes (vertical cylinders)
-        for( const TRACK* track = pcb->m_Track;  track;  track = track->Next() )
-        {
-            const VIA *via = dynamic_cast<const VIA*>(track);
+    // The holes are always built: Redraw() shows them only if they are not
+    // hidden by the board body
+    aBuffer.BeginRange( RANGE_ID_HOLES );
+    setGLCopperColor( aBuffer );
 
-            if( via )
-                draw3DViaHole( via );
-        }
+    // Draw vias holes (vertical cylinders)
+    for( const TRACK* track = pcb->m_Track;  track;  track = track->Next() )
+    {
+        const VIA *via = dynamic_cast<const VIA*>(track);
 
-        // Draw pads holes (vertical cylinders)
-        for( const MODULE* module = pcb->m_Modules;  module;  module = module->Next() )
-        {
-            for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
-                if( pad->GetAttribute () != PAD_HOLE_NOT_PLATED )
-                    draw3DPadHole( pad );
-        }
+        if( via )
+            draw3DViaHole( aBuffer, via );
     }
 
-    glEndList();
+    // Draw pads holes (vertical cylinders)
+    for( const MODULE* module = pcb->m_Modules;  module;  module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            if( pad->GetAttribute () != PAD_HOLE_NOT_PLATED )
+                draw3DPadHole( aBuffer, pad );
+    }
 
     // Build the body board:
-    glNewList( aBodyOnlyList, GL_COMPILE );
+    aBuffer.BeginRange( RANGE_ID_BODY );
 
     if( isRealisticMode() )
     {
-        setGLEpoxyColor( 1.00 );
+        setGLEpoxyColor( aBuffer, 1.00 );
     }
     else
     {
         EDA_COLOR_T color = g_ColorsSettings.GetLayerColor( Edge_Cuts );
-        SetGLColor( color, 0.7 );
+        SetGLColor( aBuffer, color, 0.7 );
     }
 
     float copper_thickness = GetPrm3DVisu().GetCopperThicknessBIU();
@@ -942,7 +1118,7 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
     zpos += (copper_thickness + epsilon) / 2.0f;
     board_thickness -= copper_thickness + epsilon;
 
-    glNormal3f( 0.0f, 0.0f, Get3DLayer_Z_Orientation( F_Cu ) );
+    aBuffer.Normal( 0.0f, 0.0f, Get3DLayer_Z_Orientation( F_Cu ) );
     KI_POLYGON_SET  currLayerPolyset;
     KI_POLYGON_SET  polysetHoles;
 
@@ -960,15 +1136,15 @@ void EDA_3D_CANVAS::buildBoard3DView( GLuint aBoardList, GLuint aBodyOnlyList,
 
     if( bufferPcbOutlines.GetCornersCount() )
     {
-        Draw3D_SolidHorizontalPolyPolygons( bufferPcbOutlines, zpos + board_thickness / 2.0,
-                                            board_thickness, GetPrm3DVisu().m_BiuTo3Dunits, useTextures );
+        Draw3D_SolidHorizontalPolyPolygons( aBuffer, bufferPcbOutlines,
+                                            zpos + board_thickness / 2.0, board_thickness,
+                                            GetPrm3DVisu().m_BiuTo3Dunits, useTextures );
     }
-
-    glEndList();
 }
 
 
-void EDA_3D_CANVAS::buildTechLayers3DView( wxString* aErrorMessages, bool aShowWarnings )
+void EDA_3D_SCENE::buildTechLayers3DView( CVERTEXBUFFER& aBuffer,
+                                          wxString* aErrorMessages, bool aShowWarnings )
 {
     BOARD* pcb = GetBoard();
     bool useTextures = isRealisticMode() && isEnabled( FL_RENDER_TEXTURES );
@@ -1046,14 +1222,12 @@ void EDA_3D_CANVAS::buildTechLayers3DView( wxString* aErrorMessages, bool aShowW
         F_Mask,
     };
 
-    // User layers are not drawn here, only technical layers
+    // User layers are not drawn here, only technical layers.
+    // All of them are built, the hidden ones are just not drawn by Redraw()
     for( LSEQ seq = LSET::AllTechMask().Seq( teckLayerList, DIM( teckLayerList ) );  seq;  ++seq )
     {
         LAYER_ID layer = *seq;
 
-        if( !is3DLayerEnabled( layer ) )
-            continue;
-
         if( layer == Edge_Cuts && isEnabled( FL_SHOW_BOARD_BODY )  )
             continue;
 
@@ -1178,9 +1352,10 @@ void EDA_3D_CANVAS::buildTechLayers3DView( wxString* aErrorMessages, bool aShowW
         bufferPolys.RemoveAllContours();
         bufferPolys.ImportFrom( currLayerPolyset );
 
-        setGLTechLayersColor( layer );
-        glNormal3f( 0.0, 0.0, Get3DLayer_Z_Orientation( layer ) );
-        Draw3D_SolidHorizontalPolyPolygons( bufferPolys, zpos,
+        aBuffer.BeginRange( layer );
+        setGLTechLayersColor( aBuffer, layer );
+        aBuffer.Normal( 0.0, 0.0, Get3DLayer_Z_Orientation( layer ) );
+        Draw3D_SolidHorizontalPolyPolygons( aBuffer, bufferPolys, zpos,
                 thickness, GetPrm3DVisu().m_BiuTo3Dunits, useTextures );
     }
 }
@@ -1189,11 +1364,15 @@ void EDA_3D_CANVAS::buildTechLayers3DView( wxString* aErrorMessages, bool aShowW
 /**
  * Function buildBoard3DAuxLayers
  * Called by CreateDrawGL_List()
- * Fills the OpenGL GL_ID_BOARD draw list with items
+ * Fills the GL_ID_AUX_LAYERS vertex buffer with items
  * on aux layers only
  */
-void EDA_3D_CANVAS::buildBoard3DAuxLayers()
+void EDA_3D_SCENE::buildBoard3DAuxLayers( CVERTEXBUFFER& aBuffer )
 {
+    // The aux layers are never shown in realistic mode
+    if( isRealisticMode() )
+        return;
+
     const int   segcountforcircle   = 18;
     double      correctionFactor    = 1.0 / cos( M_PI / (segcountforcircle * 2) );
     BOARD*      pcb = GetBoard();
@@ -1211,13 +1390,11 @@ void EDA_3D_CANVAS::buildBoard3DAuxLayers()
         Margin
     };
 
+    // All the layers are built, the hidden ones are just not drawn by Redraw()
     for( LSEQ aux( sequence, sequence+DIM(sequence) );  aux;  ++aux )
     {
         LAYER_ID layer = *aux;
 
-        if( !is3DLayerEnabled( layer ) )
-            continue;
-
         bufferPolys.RemoveAllContours();
 
         for( BOARD_ITEM* item = pcb->m_Drawings; item; item = item->Next() )
@@ -1280,18 +1457,30 @@ void EDA_3D_CANVAS::buildBoard3DAuxLayers()
         bufferPolys.RemoveAllContours();
         bufferPolys.ImportFrom( currLayerPolyset );
 
-        setGLTechLayersColor( layer );
-        glNormal3f( 0.0, 0.0, Get3DLayer_Z_Orientation( layer ) );
-        Draw3D_SolidHorizontalPolyPolygons( bufferPolys, zpos,
+        aBuffer.BeginRange( layer );
+        setGLTechLayersColor( aBuffer, layer );
+        aBuffer.Normal( 0.0, 0.0, Get3DLayer_Z_Orientation( layer ) );
+        Draw3D_SolidHorizontalPolyPolygons( aBuffer, bufferPolys, zpos,
                                             thickness, GetPrm3DVisu().m_BiuTo3Dunits, false );
     }
 }
 
-void EDA_3D_CANVAS::CreateDrawGL_List( wxString* aErrorMessages, bool aShowWarnings )
+
+void EDA_3D_SCENE::drawBufferLayers( const CVERTEXBUFFER& aBuffer )
 {
-    BOARD* pcb = GetBoard();
+    // The layer ids are in the drawing order of the transparent layers
+    for( int ii = 0; ii < LAYER_ID_COUNT; ii++ )
+    {
+        LAYER_ID layer = ToLAYER_ID( ii );
 
-    wxBusyCursor    dummy;
+        if( aBuffer.HasRange( layer ) && is3DLayerEnabled( layer ) )
+            aBuffer.DrawRange( layer );
+    }
+}
+
+void EDA_3D_SCENE::CreateDrawGL_List( wxString* aErrorMessages, bool aShowWarnings )
+{
+    BOARD* pcb = GetBoard();
 
     // Build 3D board parameters:
     GetPrm3DVisu().InitSettings( pcb );
@@ -1301,67 +1490,51 @@ void EDA_3D_CANVAS::CreateDrawGL_List( wxString* aErrorMessages, bool aShowWarni
     // Create axis gl list (if it is not shown, the list will be not called
     draw3DAxis();
 
-    // Create Board full gl lists:
+    // Create Board full vertex buffers:
 
-    if( ! m_glLists[GL_ID_BOARD] )
+    if( ! m_glBuffers[GL_ID_BOARD] )
     {
         DBG( unsigned strtime = GetRunningMicroSecs() );
 
-        m_glLists[GL_ID_BOARD] = glGenLists( 1 );
-        m_glLists[GL_ID_BODY] = glGenLists( 1 );
-        buildBoard3DView(m_glLists[GL_ID_BOARD], m_glLists[GL_ID_BODY], aErrorMessages, aShowWarnings );
+        m_glBuffers[GL_ID_BOARD] = new CVERTEXBUFFER;
+        buildBoard3DView( *m_glBuffers[GL_ID_BOARD], aErrorMessages, aShowWarnings );
+        m_glBuffers[GL_ID_BOARD]->Upload();
         CheckGLError( __FILE__, __LINE__ );
 
         DBG( printf( "  buildBoard3DView total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
     }
 
-    if( ! m_glLists[GL_ID_TECH_LAYERS] )
+    if( ! m_glBuffers[GL_ID_TECH_LAYERS] )
     {
         DBG( unsigned strtime = GetRunningMicroSecs() );
 
-        m_glLists[GL_ID_TECH_LAYERS] = glGenLists( 1 );
-        glNewList( m_glLists[GL_ID_TECH_LAYERS], GL_COMPILE );
+        m_glBuffers[GL_ID_TECH_LAYERS] = new CVERTEXBUFFER;
         // when calling BuildTechLayers3DView,
         // do not show warnings, which are the same as buildBoard3DView
-        buildTechLayers3DView( aErrorMessages, false );
-        glEndList();
+        buildTechLayers3DView( *m_glBuffers[GL_ID_TECH_LAYERS], aErrorMessages, false );
+        m_glBuffers[GL_ID_TECH_LAYERS]->Upload();
         CheckGLError( __FILE__, __LINE__ );
 
         DBG( printf( "  buildTechLayers3DView total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
     }
 
-    if( ! m_glLists[GL_ID_AUX_LAYERS] )
+    if( ! m_glBuffers[GL_ID_AUX_LAYERS] )
     {
         DBG( unsigned strtime = GetRunningMicroSecs() );
 
-        m_glLists[GL_ID_AUX_LAYERS] = glGenLists( 1 );
-        glNewList( m_glLists[GL_ID_AUX_LAYERS], GL_COMPILE );
-        buildBoard3DAuxLayers();
-        glEndList();
+        m_glBuffers[GL_ID_AUX_LAYERS] = new CVERTEXBUFFER;
+        buildBoard3DAuxLayers( *m_glBuffers[GL_ID_AUX_LAYERS] );
+        m_glBuffers[GL_ID_AUX_LAYERS]->Upload();
         CheckGLError( __FILE__, __LINE__ );
 
         DBG( printf( "  buildBoard3DAuxLayers total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
     }
 
-    // draw modules 3D shapes
-    if( ! m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] && isEnabled( FL_MODULE ) )
+    // build the buffers of the modules 3D shapes
+    if( ! m_shapesBuilt && isEnabled( FL_MODULE ) )
     {
-        m_glLists[GL_ID_3DSHAPES_SOLID_FRONT] = glGenLists( 1 );
-
-        // GL_ID_3DSHAPES_TRANSP_FRONT is an auxiliary list for 3D shapes;
-        // Ensure it is cleared before rebuilding it
-        if( m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] )
-            glDeleteLists( m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT], 1 );
-
-        bool useMaterial = g_Parm_3D_Visu.GetFlag( FL_RENDER_MATERIAL );
-
-        if( useMaterial )
-            m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] = glGenLists( 1 );
-        else
-            m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] = 0;
-
-        buildFootprintShape3DList( m_glLists[GL_ID_3DSHAPES_SOLID_FRONT],
-                                   m_glLists[GL_ID_3DSHAPES_TRANSP_FRONT] );
+        buildFootprintShape3DList();
+        m_shapesBuilt = true;
 
         CheckGLError( __FILE__, __LINE__ );
     }
@@ -1396,7 +1569,7 @@ void EDA_3D_CANVAS::CreateDrawGL_List( wxString* aErrorMessages, bool aShowWarni
 }
 
 
-void EDA_3D_CANVAS::calcBBox()
+void EDA_3D_SCENE::calcBBox()
 {
     BOARD* pcb = GetBoard();
 
@@ -1467,15 +1640,10 @@ void EDA_3D_CANVAS::calcBBox()
 }
 
 
-void EDA_3D_CANVAS::buildFootprintShape3DList( GLuint aOpaqueList,
-                                               GLuint aTransparentList )
+void EDA_3D_SCENE::buildFootprintShape3DList()
 {
     DBG( unsigned strtime = GetRunningMicroSecs() );
 
-    // clean the parser list if it have any already loaded files
-    m_model_parsers_list.clear();
-    m_model_filename_list.clear();
-
     BOARD* pcb = GetBoard();
 
     for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
@@ -1485,94 +1653,46 @@ void EDA_3D_CANVAS::buildFootprintShape3DList( GLuint aOpaqueList,
 
     DBG( strtime = GetRunningMicroSecs() );
 
-    bool useMaterial = g_Parm_3D_Visu.GetFlag( FL_RENDER_MATERIAL );
-
-    if( useMaterial )
+    // Build the buffers of each file only once, even if it is used by many footprints
+    for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
     {
-        // aOpaqueList is the gl list for non transparent items
-        // aTransparentList is the gl list for non transparent items,
-        // which need to be drawn after all other items
-
-        glNewList( aOpaqueList, GL_COMPILE );
-        bool loadOpaqueObjects = true;
-
-        for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
-            render3DComponentShape( module,  loadOpaqueObjects,
-                                             !loadOpaqueObjects );
-
-        glEndList();
-
-
-        glNewList( aTransparentList, GL_COMPILE );
-        bool loadTransparentObjects = true;
+        for( S3D_MASTER* shape3D = module->Models(); shape3D; shape3D = shape3D->Next() )
+        {
+            if( !shape3D->Is3DType( S3D_MASTER::FILE3D_VRML ) || !shape3D->m_parser )
+                continue;
 
-        for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
-            render3DComponentShape( module, !loadTransparentObjects,
-                                            loadTransparentObjects );
+            S3D_MODEL_PARSER* key = shape3D->m_parser.get();
 
-        glEndList();
+            if( m_meshBuffers.find( key ) == m_meshBuffers.end() )
+                m_meshBuffers.insert( key, new S3D_MESH_BUFFER( shape3D->m_parser ) );
+        }
     }
-    else
-    {
-        // Just create one list
-        glNewList( aOpaqueList, GL_COMPILE );
 
-        for( MODULE* module = pcb->m_Modules; module; module = module->Next() )
-            render3DComponentShape( module, false, false );
-        glEndList();
-    }
+    DBG( printf( "  build mesh buffers total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
+}
+
 
-    DBG( printf( "  render3DComponentShape total time %f ms\n", (double) (GetRunningMicroSecs() - strtime) / 1000.0 ) );
+void EDA_3D_SCENE::drawFootprintShapes( bool aIsRenderingJustNonTransparentObjects,
+                                        bool aIsRenderingJustTransparentObjects )
+{
+    for( MODULE* module = GetBoard()->m_Modules; module; module = module->Next() )
+        render3DComponentShape( module, aIsRenderingJustNonTransparentObjects,
+                                aIsRenderingJustTransparentObjects );
 }
 
 
-bool EDA_3D_CANVAS::read3DComponentShape( MODULE* module )
+bool EDA_3D_SCENE::read3DComponentShape( MODULE* module )
 {
     if( module )
     {
         S3D_MASTER* shape3D = module->Models();
 
+        // The files already loaded, by this canvas or an other one, are shared
+        // by ReadData(), and read again only if they were modified.
         for( ; shape3D; shape3D = shape3D->Next() )
         {
             if( shape3D->Is3DType( S3D_MASTER::FILE3D_VRML ) )
-            {
-                bool found = false;
-
-                unsigned int i;
-                wxString shape_filename = shape3D->GetShape3DFullFilename();
-
-                // Search for already loaded files
-                for( i = 0; i < m_model_filename_list.size(); i++ )
-                {
-                    if( shape_filename.Cmp(m_model_filename_list[i]) == 0 )
-                    {
-                        found = true;
-                        break;
-                    }
-                }
-
-                if( found == false )
-                {
-                    // Create a new parser
-                    S3D_MODEL_PARSER *newParser = S3D_MODEL_PARSER::Create( shape3D, shape3D->GetShape3DExtension() );
-
-                    if( newParser )
-                    {
-                        // Read file
-                        if( shape3D->ReadData( newParser ) == 0 )
-                        {
-                            // Store this couple filename / parsed file
-                            m_model_filename_list.push_back( shape_filename );
-                            m_model_parsers_list.push_back( newParser );
-                        }
-                    }
-                }
-                else
-                {
-                    // Reusing file
-                    shape3D->m_parser = m_model_parsers_list[i];
-                }
-            }
+                shape3D->ReadData();
         }
     }
 
@@ -1580,9 +1700,9 @@ bool EDA_3D_CANVAS::read3DComponentShape( MODULE* module )
 }
 
 
-void EDA_3D_CANVAS::render3DComponentShape( MODULE* module,
-                                            bool aIsRenderingJustNonTransparentObjects,
-                                            bool aIsRenderingJustTransparentObjects )
+void EDA_3D_SCENE::render3DComponentShape( MODULE* module,
+                                           bool aIsRenderingJustNonTransparentObjects,
+                                           bool aIsRenderingJustTransparentObjects )
 {
     double zpos = GetPrm3DVisu().GetModulesZcoord3DIU( module->IsFlipped() );
 
@@ -1609,9 +1729,15 @@ void EDA_3D_CANVAS::render3DComponentShape( MODULE* module,
     {
         if( shape3D->Is3DType( S3D_MASTER::FILE3D_VRML ) )
         {
+            MESH_BUFFERS::const_iterator meshes = m_meshBuffers.find( shape3D->m_parser.get() );
+
+            if( meshes == m_meshBuffers.end() )
+                continue;
+
             glPushMatrix();
 
-            shape3D->Render( aIsRenderingJustNonTransparentObjects,
+            shape3D->Render( *meshes->second,
+                             aIsRenderingJustNonTransparentObjects,
                              aIsRenderingJustTransparentObjects );
 
             if( isEnabled( FL_RENDER_SHOW_MODEL_BBOX ) )
@@ -1638,7 +1764,7 @@ void EDA_3D_CANVAS::render3DComponentShape( MODULE* module,
 }
 
 
-bool EDA_3D_CANVAS::is3DLayerEnabled( LAYER_ID aLayer ) const
+bool EDA_3D_SCENE::is3DLayerEnabled( LAYER_ID aLayer ) const
 {
     DISPLAY3D_FLG flg;
 
@@ -43,6 +43,7 @@
 #endif
 
 // Variables used to pass a value to call back openGL functions
+static CVERTEXBUFFER* s_buffer;
 static float s_textureScale;
 static double s_currentZpos;
 static double s_biuTo3Dunits;
@@ -55,17 +56,18 @@ static void CALLBACK    tessErrorCB( GLenum errorCode );
 static void CALLBACK    tessCPolyPt2Vertex( const GLvoid* data );
 
 // 2 helper functions to set the current normal vector for gle items
-static inline void SetNormalZpos()
+static inline void SetNormalZpos( CVERTEXBUFFER& aBuffer )
 {
-    glNormal3f( 0.0, 0.0, 1.0 );
+    aBuffer.Normal( 0.0, 0.0, 1.0 );
 }
 
-static inline void SetNormalZneg()
+static inline void SetNormalZneg( CVERTEXBUFFER& aBuffer )
 {
-    glNormal3f( 0.0, 0.0, -1.0 );
+    aBuffer.Normal( 0.0, 0.0, -1.0 );
 }
 
-void TransfertToGLlist( std::vector< S3D_VERTEX >& aVertices, double aBiuTo3DUnits );
+void TransfertToGLlist( CVERTEXBUFFER& aBuffer, std::vector< S3D_VERTEX >& aVertices,
+                        double aBiuTo3DUnits );
 
 /* Draw3D_VerticalPolygonalCylinder is a helper function.
  *
@@ -73,7 +75,8 @@ void TransfertToGLlist( std::vector< S3D_VERTEX >& aVertices, double aBiuTo3DUni
  * from Z position = aZpos to aZpos + aHeight
  * Used to create the vertical sides of 3D horizontal shapes with thickness.
  */
-static void Draw3D_VerticalPolygonalCylinder( const CPOLYGONS_LIST& aPolysList,
+static void Draw3D_VerticalPolygonalCylinder( CVERTEXBUFFER& aBuffer,
+                                              const CPOLYGONS_LIST& aPolysList,
                                               int aHeight, int aZpos,
                                               bool aInside, double aBiuTo3DUnits )
 {
@@ -120,7 +123,7 @@ static void Draw3D_VerticalPolygonalCylinder( const CPOLYGONS_LIST& aPolysList,
         coords[3].y = coords[2].y;              // only z change
 
         // Creates the GL_QUAD
-        TransfertToGLlist( coords, aBiuTo3DUnits );
+        TransfertToGLlist( aBuffer, coords, aBiuTo3DUnits );
     }
 }
 
@@ -142,10 +145,26 @@ void SetGLColor( S3D_COLOR& aColor, float aTransparency )
 }
 
 
-void SetGLTexture( GLuint text_id, float scale )
+void SetGLColor( CVERTEXBUFFER& aBuffer, EDA_COLOR_T color, double alpha )
 {
-    glEnable( GL_TEXTURE_2D );
-    glBindTexture( GL_TEXTURE_2D, text_id );
+    const StructColors &colordata = g_ColorRefs[ColorGetBase( color )];
+
+    float red     = colordata.m_Red / 255.0;
+    float blue    = colordata.m_Blue / 255.0;
+    float green   = colordata.m_Green / 255.0;
+    aBuffer.Color( red, green, blue, (float)alpha );
+}
+
+
+void SetGLColor( CVERTEXBUFFER& aBuffer, S3D_COLOR& aColor, float aTransparency )
+{
+    aBuffer.Color( aColor.m_Red, aColor.m_Green, aColor.m_Blue, aTransparency );
+}
+
+
+void SetGLTexture( CVERTEXBUFFER& aBuffer, GLuint text_id, float scale )
+{
+    aBuffer.SetTexture( text_id );
     s_textureScale = scale;     // for Tess callback functions
 }
 
@@ -158,11 +177,13 @@ void SetGLTexture( GLuint text_id, float scale )
  *  The top side is located at aZpos + aThickness / 2
  *  The bottom side is located at aZpos - aThickness / 2
  */
-void Draw3D_SolidHorizontalPolyPolygons( const CPOLYGONS_LIST& aPolysList,
+void Draw3D_SolidHorizontalPolyPolygons( CVERTEXBUFFER& aBuffer,
+                                         const CPOLYGONS_LIST& aPolysList,
                                          int aZpos, int aThickness, double aBiuTo3DUnits,
                                          bool aUseTextures )
 {
     // for Tess callback functions:
+    s_buffer = &aBuffer;
     s_biuTo3Dunits = aBiuTo3DUnits;
     s_useTextures = aUseTextures;
 
@@ -180,7 +201,7 @@ void Draw3D_SolidHorizontalPolyPolygons( const CPOLYGONS_LIST& aPolysList,
 
     // Set normal toward positive Z axis, for a solid object on the top side
     if( aThickness )
-        SetNormalZpos();
+        SetNormalZpos( aBuffer );
 
     // gluTessProperty(tess, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_ODD);
 
@@ -233,7 +254,7 @@ void Draw3D_SolidHorizontalPolyPolygons( const CPOLYGONS_LIST& aPolysList,
         v_data[2] = zpos;
         // Set normal toward negative Z axis, for a solid object on bottom side
         if( aThickness )
-            SetNormalZneg();
+            SetNormalZneg( aBuffer );
     }
 
     if( startContour == 0 )
@@ -250,7 +271,8 @@ void Draw3D_SolidHorizontalPolyPolygons( const CPOLYGONS_LIST& aPolysList,
     }
 
     // Build the 3D data : vertical side
-    Draw3D_VerticalPolygonalCylinder( polylist, aThickness, aZpos - (aThickness / 2.0), true, aBiuTo3DUnits );
+    Draw3D_VerticalPolygonalCylinder( aBuffer, polylist, aThickness, aZpos - (aThickness / 2.0),
+                                      true, aBiuTo3DUnits );
 }
 
 
@@ -258,14 +280,16 @@ void Draw3D_SolidHorizontalPolyPolygons( const CPOLYGONS_LIST& aPolysList,
  * The first polygon is the main polygon, others are holes
  * See Draw3D_SolidHorizontalPolyPolygons for more info
  */
-void Draw3D_SolidHorizontalPolygonWithHoles( const CPOLYGONS_LIST& aPolysList,
+void Draw3D_SolidHorizontalPolygonWithHoles( CVERTEXBUFFER& aBuffer,
+                                             const CPOLYGONS_LIST& aPolysList,
                                              int aZpos, int aThickness,
                                              double aBiuTo3DUnits, bool aUseTextures )
 {
     CPOLYGONS_LIST polygon;
 
     ConvertPolysListWithHolesToOnePolygon( aPolysList, polygon );
-    Draw3D_SolidHorizontalPolyPolygons( polygon, aZpos, aThickness, aBiuTo3DUnits, aUseTextures );
+    Draw3D_SolidHorizontalPolyPolygons( aBuffer, polygon, aZpos, aThickness, aBiuTo3DUnits,
+                                        aUseTextures );
 }
 
 
@@ -274,7 +298,7 @@ void Draw3D_SolidHorizontalPolygonWithHoles( const CPOLYGONS_LIST& aPolysList,
  * If aHeight = height of the cylinder is 0, only one ring will be drawn
  * If aThickness = 0, only one cylinder will be drawn
  */
-void Draw3D_ZaxisCylinder( wxPoint aCenterPos, int aRadius,
+void Draw3D_ZaxisCylinder( CVERTEXBUFFER& aBuffer, wxPoint aCenterPos, int aRadius,
                            int aHeight, int aThickness,
                            int aZpos, double aBiuTo3DUnits )
 {
@@ -296,35 +320,36 @@ void Draw3D_ZaxisCylinder( wxPoint aCenterPos, int aRadius,
     {
         
         // Draw the vertical outer side
-        Draw3D_VerticalPolygonalCylinder( outer_cornerBuffer,
+        Draw3D_VerticalPolygonalCylinder( aBuffer, outer_cornerBuffer,
                                       aHeight, aZpos, false, aBiuTo3DUnits );
 
         if( aThickness )
             // Draws the vertical inner side (hole)
-            Draw3D_VerticalPolygonalCylinder( inner_cornerBuffer,
+            Draw3D_VerticalPolygonalCylinder( aBuffer, inner_cornerBuffer,
                                           aHeight, aZpos, true, aBiuTo3DUnits );
     }
 
     if( aThickness )
     {
         // draw top (front) and bottom (back) horizontal sides (rings)
-        SetNormalZpos();
+        SetNormalZpos( aBuffer );
         outer_cornerBuffer.Append( inner_cornerBuffer );
         CPOLYGONS_LIST polygon;
 
         ConvertPolysListWithHolesToOnePolygon( outer_cornerBuffer, polygon );
         // draw top (front) horizontal ring
-        Draw3D_SolidHorizontalPolyPolygons( polygon, aZpos + aHeight, 0, aBiuTo3DUnits, false );
+        Draw3D_SolidHorizontalPolyPolygons( aBuffer, polygon, aZpos + aHeight, 0,
+                                            aBiuTo3DUnits, false );
 
         if( aHeight )
         {
             // draw bottom (back) horizontal ring
-            SetNormalZneg();
-            Draw3D_SolidHorizontalPolyPolygons( polygon, aZpos, 0, aBiuTo3DUnits, false );
+            SetNormalZneg( aBuffer );
+            Draw3D_SolidHorizontalPolyPolygons( aBuffer, polygon, aZpos, 0, aBiuTo3DUnits, false );
         }
     }
 
-    SetNormalZpos();
+    SetNormalZpos( aBuffer );
 }
 
 
@@ -335,7 +360,7 @@ void Draw3D_ZaxisCylinder( wxPoint aCenterPos, int aRadius,
  * If aHeight = height of the cylinder is 0, only one ring will be drawn
  * If aThickness = 0, only one cylinder will be drawn
  */
-void Draw3D_ZaxisOblongCylinder( wxPoint aAxis1Pos, wxPoint aAxis2Pos,
+void Draw3D_ZaxisOblongCylinder( CVERTEXBUFFER& aBuffer, wxPoint aAxis1Pos, wxPoint aAxis2Pos,
                                  int aRadius, int aHeight, int aThickness,
                                  int aZpos, double aBiuTo3DUnits  )
 {
@@ -350,7 +375,7 @@ void Draw3D_ZaxisOblongCylinder( wxPoint aAxis1Pos, wxPoint aAxis2Pos,
 
     // Draw the oblong outer cylinder
     if( aHeight )
-        Draw3D_VerticalPolygonalCylinder( outer_cornerBuffer, aHeight, aZpos,
+        Draw3D_VerticalPolygonalCylinder( aBuffer, outer_cornerBuffer, aHeight, aZpos,
                                           false, aBiuTo3DUnits );
 
     if( aThickness )
@@ -362,7 +387,7 @@ void Draw3D_ZaxisOblongCylinder( wxPoint aAxis1Pos, wxPoint aAxis2Pos,
 
         // Draw the oblong inner cylinder
         if( aHeight )
-            Draw3D_VerticalPolygonalCylinder( inner_cornerBuffer, aHeight,
+            Draw3D_VerticalPolygonalCylinder( aBuffer, inner_cornerBuffer, aHeight,
                                               aZpos, true, aBiuTo3DUnits );
 
         // Build the horizontal full polygon shape
@@ -373,18 +398,19 @@ void Draw3D_ZaxisOblongCylinder( wxPoint aAxis1Pos, wxPoint aAxis2Pos,
         ConvertPolysListWithHolesToOnePolygon( outer_cornerBuffer, polygon );
 
         // draw top (front) horizontal side (ring)
-        SetNormalZpos();
-        Draw3D_SolidHorizontalPolyPolygons( polygon, aZpos + aHeight, 0, aBiuTo3DUnits, false );
+        SetNormalZpos( aBuffer );
+        Draw3D_SolidHorizontalPolyPolygons( aBuffer, polygon, aZpos + aHeight, 0,
+                                            aBiuTo3DUnits, false );
 
         if( aHeight )
         {
             // draw bottom (back) horizontal side (ring)
-            SetNormalZneg();
-            Draw3D_SolidHorizontalPolyPolygons( polygon, aZpos, 0, aBiuTo3DUnits, false );
+            SetNormalZneg( aBuffer );
+            Draw3D_SolidHorizontalPolyPolygons( aBuffer, polygon, aZpos, 0, aBiuTo3DUnits, false );
         }
     }
 
-    SetNormalZpos();
+    SetNormalZpos( aBuffer );
 }
 
 
@@ -394,7 +420,7 @@ void Draw3D_ZaxisOblongCylinder( wxPoint aAxis1Pos, wxPoint aAxis2Pos,
  * aThickness = thickness of segment in board units
  * aZpos = z position of segment in board units
  */
-void Draw3D_SolidSegment( const wxPoint& aStart, const wxPoint& aEnd,
+void Draw3D_SolidSegment( CVERTEXBUFFER& aBuffer, const wxPoint& aStart, const wxPoint& aEnd,
                           int aWidth, int aThickness, int aZpos, double aBiuTo3DUnits )
 {
     CPOLYGONS_LIST   cornerBuffer;
@@ -402,11 +428,12 @@ void Draw3D_SolidSegment( const wxPoint& aStart, const wxPoint& aEnd,
 
     TransformRoundedEndsSegmentToPolygon( cornerBuffer, aStart, aEnd, slice, aWidth );
 
-    Draw3D_SolidHorizontalPolyPolygons( cornerBuffer, aZpos, aThickness, aBiuTo3DUnits, false );
+    Draw3D_SolidHorizontalPolyPolygons( aBuffer, cornerBuffer, aZpos, aThickness,
+                                        aBiuTo3DUnits, false );
 }
 
 
-void Draw3D_ArcSegment( const wxPoint&  aCenterPos, const wxPoint& aStartPoint,
+void Draw3D_ArcSegment( CVERTEXBUFFER& aBuffer, const wxPoint&  aCenterPos, const wxPoint& aStartPoint,
                         double aArcAngle, int aWidth, int aThickness,
                         int aZpos, double aBiuTo3DUnits )
 {
@@ -416,7 +443,8 @@ void Draw3D_ArcSegment( const wxPoint&  aCenterPos, const wxPoint& aStartPoint,
     TransformArcToPolygon( cornerBuffer, aCenterPos, aStartPoint, aArcAngle,
                            slice, aWidth );
 
-    Draw3D_SolidHorizontalPolyPolygons( cornerBuffer, aZpos, aThickness, aBiuTo3DUnits, false );
+    Draw3D_SolidHorizontalPolyPolygons( aBuffer, cornerBuffer, aZpos, aThickness,
+                                        aBiuTo3DUnits, false );
 }
 
 
@@ -426,13 +454,13 @@ void Draw3D_ArcSegment( const wxPoint&  aCenterPos, const wxPoint& aStartPoint,
 
 void CALLBACK tessBeginCB( GLenum which )
 {
-    glBegin( which );
+    s_buffer->Begin( which );
 }
 
 
 void CALLBACK tessEndCB()
 {
-    glEnd();
+    s_buffer->End();
 }
 
 
@@ -443,11 +471,11 @@ void CALLBACK tessCPolyPt2Vertex( const GLvoid* data )
 
     if( s_useTextures )
     {
-        glTexCoord2f( ptr->x * s_biuTo3Dunits * s_textureScale,
-                      -ptr->y * s_biuTo3Dunits * s_textureScale);
+        s_buffer->TexCoord( ptr->x * s_biuTo3Dunits * s_textureScale,
+                            -ptr->y * s_biuTo3Dunits * s_textureScale );
     }
 
-    glVertex3d( ptr->x * s_biuTo3Dunits, -ptr->y * s_biuTo3Dunits, s_currentZpos );
+    s_buffer->Vertex( ptr->x * s_biuTo3Dunits, -ptr->y * s_biuTo3Dunits, s_currentZpos );
 }
 
 
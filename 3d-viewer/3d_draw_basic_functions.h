@@ -28,10 +28,13 @@
 #ifndef _3D_DRAW_BASIC_FUNCTIONS_H_
 #define _3D_DRAW_BASIC_FUNCTIONS_H_
 
+#include <CVertexBuffer.h>
+
 // angle increment to draw a circle, approximated by segments
 #define ANGLE_INC( x ) ( 3600 / (x) )
 
 /** draw all solid polygons found in aPolysList
+ * @param aBuffer = the vertex buffer which stores the triangles
  * @param aPolysList = the poligon list to draw
  * @param aZpos = z position in board internal units
  * @param aThickness = thickness in board internal units
@@ -42,12 +45,14 @@
  *  The top side is located at aZpos + aThickness / 2
  *  The bottom side is located at aZpos - aThickness / 2
  */
-void    Draw3D_SolidHorizontalPolyPolygons( const CPOLYGONS_LIST& aPolysList,
+void    Draw3D_SolidHorizontalPolyPolygons( CVERTEXBUFFER& aBuffer,
+                                            const CPOLYGONS_LIST& aPolysList,
                                             int aZpos, int aThickness, double aBiuTo3DUnits,
                                             bool aUseTextures );
 
 /** draw the solid polygon found in aPolysList
  * The first polygonj is the main polygon, others are holes
+ * @param aBuffer = the vertex buffer which stores the triangles
  * @param aPolysList = the polygon with holes to draw
  * @param aZpos = z position in board internal units
  * @param aThickness = thickness in board internal units
@@ -58,11 +63,13 @@ void    Draw3D_SolidHorizontalPolyPolygons( const CPOLYGONS_LIST& aPolysList,
  *  The top side is located at aZpos + aThickness / 2
  *  The bottom side is located at aZpos - aThickness / 2
  */
-void    Draw3D_SolidHorizontalPolygonWithHoles( const CPOLYGONS_LIST& aPolysList,
+void    Draw3D_SolidHorizontalPolygonWithHoles( CVERTEXBUFFER& aBuffer,
+                                                const CPOLYGONS_LIST& aPolysList,
                                                 int aZpos, int aThickness, double aBiuTo3DUnits,
                                                 bool aUseTextures );
 
 /** draw a thick segment using 3D primitives, in a XY plane
+ * @param aBuffer = the vertex buffer which stores the triangles
  * @param aStart = YX position of start point in board units
  * @param aEnd = YX position of end point in board units
  * @param aWidth = width of segment in board units
@@ -74,11 +81,12 @@ void    Draw3D_SolidHorizontalPolygonWithHoles( const CPOLYGONS_LIST& aPolysList
  *  The top side is located at aZpos + aThickness / 2
  *  The bottom side is located at aZpos - aThickness / 2
  */
-void    Draw3D_SolidSegment( const wxPoint& aStart, const wxPoint& aEnd,
+void    Draw3D_SolidSegment( CVERTEXBUFFER& aBuffer, const wxPoint& aStart, const wxPoint& aEnd,
                              int aWidth, int aThickness, int aZpos,
                              double aBiuTo3DUnits );
 
 /** draw an arc using 3D primitives, in a XY plane
+ * @param aBuffer = the vertex buffer which stores the triangles
  * @param aCenterPos = XY position of the center in board units
  * @param aStartPoint = start point coordinate of arc in board units
  * @param aWidth = width of the circle in board units
@@ -88,13 +96,14 @@ void    Draw3D_SolidSegment( const wxPoint& aStart, const wxPoint& aEnd,
  * @param aZpos = z position of segment in board units
  * @param aBiuTo3DUnits = board internal units to 3D units scaling value
  */
-void Draw3D_ArcSegment( const wxPoint&  aCenterPos, const wxPoint& aStartPoint,
+void Draw3D_ArcSegment( CVERTEXBUFFER& aBuffer, const wxPoint&  aCenterPos, const wxPoint& aStartPoint,
                         double aArcAngle, int aWidth, int aThickness,
                         int aZpos, double aBiuTo3DUnits );
 
 
 /** draw a thick cylinder (a tube) using 3D primitives.
  * the cylinder axis is parallel to the Z axis
+ * @param aBuffer = the vertex buffer which stores the triangles
  * @param aCenterPos = XY position of the axis cylinder ( board internal units)
  * @param aRadius = radius of the cylinder ( board internal units)
  * @param aHeight = height of the cylinder ( boardinternal units)
@@ -105,12 +114,13 @@ void Draw3D_ArcSegment( const wxPoint&  aCenterPos, const wxPoint& aStartPoint,
  * If aHeight = height of the cylinder is 0, only one ring will be drawn
  * If aThickness = 0, only one cylinder (not a tube) will be drawn
  */
-void    Draw3D_ZaxisCylinder( wxPoint aCenterPos, int aRadius,
+void    Draw3D_ZaxisCylinder( CVERTEXBUFFER& aBuffer, wxPoint aCenterPos, int aRadius,
                               int aHeight, int aThickness,
                               int aZpos, double aBiuTo3DUnits );
 
 /** draw an oblong cylinder (oblong tube) using 3D primitives.
  * the cylinder axis are parallel to the Z axis
+ * @param aBuffer = the vertex buffer which stores the triangles
  * @param aAxis1Pos = position of the first axis cylinder
  * @param aAxis2Pos = position of the second axis cylinder
  * @param aRadius = radius of the cylinder ( board internal units )
@@ -119,7 +129,7 @@ void    Draw3D_ZaxisCylinder( wxPoint aCenterPos, int aRadius,
  * @param aZpos = Z position of the bottom side of the cylinder ( board internal units )
  * @param aBiuTo3DUnits = board internal units to 3D units scaling value
  */
-void    Draw3D_ZaxisOblongCylinder( wxPoint aAxis1Pos, wxPoint aAxis2Pos,
+void    Draw3D_ZaxisOblongCylinder( CVERTEXBUFFER& aBuffer, wxPoint aAxis1Pos, wxPoint aAxis2Pos,
                                     int aRadius, int aHeight, int aThickness,
                                     int aZpos, double aBiuTo3DUnits  );
 /**
@@ -136,13 +146,30 @@ void SetGLColor( EDA_COLOR_T aColor, double aTransparency = 1.0 );
  */
 void SetGLColor( S3D_COLOR& aColor, float aTransparency );
 
+/**
+ * Set the color of the next vertices of aBuffer from a Kicad color
+ * @param aBuffer = the vertex buffer which stores the triangles
+ * @param aColor = a EDA_COLOR_T kicad color index
+ * @param aTransparency = the color transparency (default = 1.0 = no transparency)
+ */
+void SetGLColor( CVERTEXBUFFER& aBuffer, EDA_COLOR_T aColor, double aTransparency = 1.0 );
+
+/**
+ * Set the color of the next vertices of aBuffer from a S3D_COLOR color
+ * @param aBuffer = the vertex buffer which stores the triangles
+ * @param aColor = a S3D_COLOR RGB color index
+ * @param aTransparency = the color transparency (default = 1.0 = no transparency)
+ */
+void SetGLColor( CVERTEXBUFFER& aBuffer, S3D_COLOR& aColor, float aTransparency );
+
 
 /**
- * Set a texture id and a scale to apply when rendering the polygons
+ * Set a texture id and a scale to apply when rendering the next polygons of aBuffer
+ * @param aBuffer = the vertex buffer which stores the triangles
  * @param text_id = texture ID created by glGenTextures
  * @param scale = scale to apply to texture coords
  */
-void SetGLTexture( GLuint text_id, float scale );
+void SetGLTexture( CVERTEXBUFFER& aBuffer, GLuint text_id, float scale );
 
 
 #endif      // _3D_DRAW_BASIC_FUNCTIONS_H_
@@ -72,32 +72,32 @@ void CheckGLError(const char *aFileName, int aLineNumber)
 }
 
 
-INFO3D_VISU& EDA_3D_CANVAS::GetPrm3DVisu() const
+INFO3D_VISU& EDA_3D_SCENE::GetPrm3DVisu() const
 {
-    return Parent()->GetPrm3DVisu();
+    return g_Parm_3D_Visu;
 }
 
-wxSize EDA_3D_CANVAS::getBoardSize() const
+wxSize EDA_3D_SCENE::getBoardSize() const
 {
     // return the size of the board in pcb units
     return GetPrm3DVisu().m_BoardSize;
 }
 
 
-wxPoint EDA_3D_CANVAS::getBoardCenter() const
+wxPoint EDA_3D_SCENE::getBoardCenter() const
 {
     // return the position of the board center in pcb units
     return GetPrm3DVisu().m_BoardPos;
 }
 
 // return true if we are in realistic mode render
-bool EDA_3D_CANVAS::isRealisticMode() const
+bool EDA_3D_SCENE::isRealisticMode() const
 {
     return GetPrm3DVisu().IsRealisticMode();
 }
 
 // return true if aItem should be displayed
-bool EDA_3D_CANVAS::isEnabled( DISPLAY3D_FLG aItem ) const
+bool EDA_3D_SCENE::isEnabled( DISPLAY3D_FLG aItem ) const
 {
     return GetPrm3DVisu().GetFlag( aItem );
 }
@@ -105,41 +105,41 @@ bool EDA_3D_CANVAS::isEnabled( DISPLAY3D_FLG aItem ) const
 
 // Helper function: initialize the copper color to draw the board
 // in realistic mode.
-void EDA_3D_CANVAS::setGLCopperColor()
+void EDA_3D_SCENE::setGLCopperColor( CVERTEXBUFFER& aBuffer )
 {
-    glDisable( GL_TEXTURE_2D );
-    SetGLColor( GetPrm3DVisu().m_CopperColor, 1.0 );
+    aBuffer.SetTexture( 0 );
+    SetGLColor( aBuffer, GetPrm3DVisu().m_CopperColor, 1.0 );
 }
 
 // Helper function: initialize the color to draw the epoxy
 // body board in realistic mode.
-void EDA_3D_CANVAS::setGLEpoxyColor( float aTransparency )
+void EDA_3D_SCENE::setGLEpoxyColor( CVERTEXBUFFER& aBuffer, float aTransparency )
 {
     // Generates an epoxy color, near board color
-    SetGLColor( GetPrm3DVisu().m_BoardBodyColor, aTransparency );
+    SetGLColor( aBuffer, GetPrm3DVisu().m_BoardBodyColor, aTransparency );
 
     if( isEnabled( FL_RENDER_TEXTURES ) )
     {
-        SetGLTexture( m_text_pcb, TEXTURE_PCB_SCALE );
+        SetGLTexture( aBuffer, m_text_pcb, TEXTURE_PCB_SCALE );
     }
 }
 
 // Helper function: initialize the color to draw the
 // solder mask layers in realistic mode.
-void EDA_3D_CANVAS::setGLSolderMaskColor( float aTransparency )
+void EDA_3D_SCENE::setGLSolderMaskColor( CVERTEXBUFFER& aBuffer, float aTransparency )
 {
     // Generates a solder mask color
-    SetGLColor( GetPrm3DVisu().m_SolderMaskColor, aTransparency );
+    SetGLColor( aBuffer, GetPrm3DVisu().m_SolderMaskColor, aTransparency );
 
     if( isEnabled( FL_RENDER_TEXTURES ) )
     {
-        SetGLTexture( m_text_pcb, TEXTURE_PCB_SCALE );
+        SetGLTexture( aBuffer, m_text_pcb, TEXTURE_PCB_SCALE );
     }
 }
 
 // Helper function: initialize the color to draw the non copper layers
 // in realistic mode and normal mode.
-void EDA_3D_CANVAS::setGLTechLayersColor( LAYER_NUM aLayer )
+void EDA_3D_SCENE::setGLTechLayersColor( CVERTEXBUFFER& aBuffer, LAYER_NUM aLayer )
 {
     EDA_COLOR_T color;
 
@@ -149,39 +149,39 @@ void EDA_3D_CANVAS::setGLTechLayersColor( LAYER_NUM aLayer )
         {
         case B_Paste:
         case F_Paste:
-            SetGLColor( DARKGRAY, 0.7 );
+            SetGLColor( aBuffer, DARKGRAY, 0.7 );
             break;
 
         case B_SilkS:
         case F_SilkS:
-            SetGLColor( GetPrm3DVisu().m_SilkScreenColor, 0.96 );
+            SetGLColor( aBuffer, GetPrm3DVisu().m_SilkScreenColor, 0.96 );
 
             if( isEnabled( FL_RENDER_TEXTURES ) )
             {
-                SetGLTexture( m_text_silk, 10.0f );
+                SetGLTexture( aBuffer, m_text_silk, 10.0f );
             }
 
             break;
 
         case B_Mask:
         case F_Mask:
-            setGLSolderMaskColor( 0.90 );
+            setGLSolderMaskColor( aBuffer, 0.90 );
             break;
 
         default:
             color = g_ColorsSettings.GetLayerColor( aLayer );
-            SetGLColor( color, 0.7 );
+            SetGLColor( aBuffer, color, 0.7 );
             break;
         }
     }
     else
     {
         color = g_ColorsSettings.GetLayerColor( aLayer );
-        SetGLColor( color, 0.7 );
+        SetGLColor( aBuffer, color, 0.7 );
     }
 }
 
-void EDA_3D_CANVAS::draw3DAxis()
+void EDA_3D_SCENE::draw3DAxis()
 {
     if( ! m_glLists[GL_ID_AXIS] )
     {
@@ -207,7 +207,7 @@ void EDA_3D_CANVAS::draw3DAxis()
 
 // draw a 3D grid: an horizontal grid (XY plane and Z = 0,
 // and a vertical grid (XZ plane and Y = 0)
-void EDA_3D_CANVAS::draw3DGrid( double aGriSizeMM )
+void EDA_3D_SCENE::draw3DGrid( double aGriSizeMM )
 {
     double      zpos = 0.0;
     EDA_COLOR_T gridcolor = DARKGRAY;           // Color of grid lines
@@ -343,7 +343,7 @@ void EDA_3D_CANVAS::draw3DGrid( double aGriSizeMM )
 
 
 // Draw 3D pads.
-void EDA_3D_CANVAS::draw3DPadHole( const D_PAD* aPad )
+void EDA_3D_SCENE::draw3DPadHole( CVERTEXBUFFER& aBuffer, const D_PAD* aPad )
 {
     // Draw the pad hole
     wxSize  drillsize   = aPad->GetDrillSize();
@@ -359,16 +359,16 @@ void EDA_3D_CANVAS::draw3DPadHole( const D_PAD* aPad )
                                   GetPrm3DVisu().GetLayerZcoordBIU( B_Cu );
 
     if( isRealisticMode() )
-        setGLCopperColor();
+        setGLCopperColor( aBuffer );
     else
-        SetGLColor( DARKGRAY );
+        SetGLColor( aBuffer, DARKGRAY );
 
     int holeZpoz    = GetPrm3DVisu().GetLayerZcoordBIU( B_Cu ) - thickness / 2;
     int holeHeight  = height + thickness;
 
     if( drillsize.x == drillsize.y )    // usual round hole
     {
-        Draw3D_ZaxisCylinder( aPad->GetPosition(),
+        Draw3D_ZaxisCylinder( aBuffer, aPad->GetPosition(),
                               (drillsize.x + thickness / 2) / 2, holeHeight,
                               thickness, holeZpoz, GetPrm3DVisu().m_BiuTo3Dunits );
     }
@@ -395,13 +395,13 @@ void EDA_3D_CANVAS::draw3DPadHole( const D_PAD* aPad )
         int     hole_radius = ( width + thickness ) / 2;
 
         // Draw the hole
-        Draw3D_ZaxisOblongCylinder( start, end, hole_radius, holeHeight,
+        Draw3D_ZaxisOblongCylinder( aBuffer, start, end, hole_radius, holeHeight,
                                     thickness, holeZpoz, GetPrm3DVisu().m_BiuTo3Dunits );
     }
 }
 
 
-void EDA_3D_CANVAS::draw3DViaHole( const VIA* aVia )
+void EDA_3D_SCENE::draw3DViaHole( CVERTEXBUFFER& aBuffer, const VIA* aVia )
 {
     LAYER_ID    top_layer, bottom_layer;
     int         thickness       = GetPrm3DVisu().GetCopperThicknessBIU();
@@ -411,25 +411,25 @@ void EDA_3D_CANVAS::draw3DViaHole( const VIA* aVia )
 
     // Drawing via hole:
     if( isRealisticMode() )
-        setGLCopperColor();
+        setGLCopperColor( aBuffer );
     else
     {
         EDA_COLOR_T color = g_ColorsSettings.GetItemColor( VIAS_VISIBLE + aVia->GetViaType() );
-        SetGLColor( color );
+        SetGLColor( aBuffer, color );
     }
 
     int height = GetPrm3DVisu().GetLayerZcoordBIU( top_layer ) -
                  GetPrm3DVisu().GetLayerZcoordBIU( bottom_layer ) + thickness;
     int   zpos = GetPrm3DVisu().GetLayerZcoordBIU( bottom_layer ) - thickness / 2;
 
-    Draw3D_ZaxisCylinder( aVia->GetStart(), inner_radius, height,
+    Draw3D_ZaxisCylinder( aBuffer, aVia->GetStart(), inner_radius, height,
                           thickness, zpos, GetPrm3DVisu().m_BiuTo3Dunits );
 }
 
 /* Build a pad outline as non filled polygon, to draw pads on silkscreen layer
  * Used only to draw pads outlines on silkscreen layers.
  */
-void EDA_3D_CANVAS::buildPadShapeThickOutlineAsPolygon( const D_PAD*  aPad,
+void EDA_3D_SCENE::buildPadShapeThickOutlineAsPolygon( const D_PAD*  aPad,
                                                 CPOLYGONS_LIST& aCornerBuffer,
                                                 int             aWidth,
                                                 int             aCircleToSegmentsCount,
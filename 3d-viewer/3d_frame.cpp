@@ -485,7 +485,7 @@ void EDA_3D_FRAME::Process_Special_Functions( wxCommandEvent& event )
 
     case ID_MENU3D_FL_RENDER_SHADOWS:
         GetPrm3DVisu().SetFlag( FL_RENDER_SHADOWS, isChecked );
-        NewDisplay();
+        m_canvas->Refresh();
         return;
 
     case ID_MENU3D_FL_RENDER_SHOW_HOLES_IN_ZONES:
@@ -516,12 +516,12 @@ void EDA_3D_FRAME::Process_Special_Functions( wxCommandEvent& event )
 
     case ID_MENU3D_FL_RENDER_SHOW_MODEL_BBOX:
         GetPrm3DVisu().SetFlag( FL_RENDER_SHOW_MODEL_BBOX, isChecked );
-        NewDisplay();
+        m_canvas->Refresh();
         return;
 
     case ID_MENU3D_SHOW_BOARD_BODY:
         GetPrm3DVisu().SetFlag( FL_SHOW_BOARD_BODY, isChecked );
-        NewDisplay();
+        m_canvas->Refresh();
         return;
 
     case ID_MENU3D_AXIS_ONOFF:
@@ -547,32 +547,32 @@ void EDA_3D_FRAME::Process_Special_Functions( wxCommandEvent& event )
 
     case ID_MENU3D_ADHESIVE_ONOFF:
         GetPrm3DVisu().SetFlag( FL_ADHESIVE, isChecked );
-        NewDisplay( GL_ID_TECH_LAYERS );
+        m_canvas->Refresh();
         return;
 
     case ID_MENU3D_SILKSCREEN_ONOFF:
         GetPrm3DVisu().SetFlag( FL_SILKSCREEN, isChecked );
-        NewDisplay( GL_ID_TECH_LAYERS );
+        m_canvas->Refresh();
         return;
 
     case ID_MENU3D_SOLDER_MASK_ONOFF:
         GetPrm3DVisu().SetFlag( FL_SOLDERMASK, isChecked );
-        NewDisplay( GL_ID_TECH_LAYERS );
+        m_canvas->Refresh();
         return;
 
     case ID_MENU3D_SOLDER_PASTE_ONOFF:
         GetPrm3DVisu().SetFlag( FL_SOLDERPASTE, isChecked );
-        NewDisplay();
+        m_canvas->Refresh();
         return;
 
     case ID_MENU3D_COMMENTS_ONOFF:
         GetPrm3DVisu().SetFlag( FL_COMMENTS, isChecked );
-        NewDisplay( GL_ID_AUX_LAYERS );
+        m_canvas->Refresh();
         return;
 
     case ID_MENU3D_ECO_ONOFF:
         GetPrm3DVisu().SetFlag( FL_ECO, isChecked );
-        NewDisplay( GL_ID_AUX_LAYERS );
+        m_canvas->Refresh();
         return;
 
     default:
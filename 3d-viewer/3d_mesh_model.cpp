@@ -28,10 +28,13 @@
  */
 
 #include <fctsys.h>
+#include <algorithm>
 #include <3d_mesh_model.h>
+#include <modelparsers.h>
 #include <boost/geometry/algorithms/area.hpp>
 #define GLM_FORCE_RADIANS
 #include <gal/opengl/glm/gtc/matrix_transform.hpp>
+#include <gal/opengl/glm/gtc/matrix_inverse.hpp>
 #include <gal/opengl/glm/glm.hpp>
 
 #ifdef __WXMAC__
@@ -155,238 +158,193 @@ void S3D_MESH::calcBBox( )
 }
 
 
-void S3D_MESH::openGL_RenderAllChilds(  bool aIsRenderingJustNonTransparentObjects,
-                                        bool aIsRenderingJustTransparentObjects )
+/**
+ * Function isInvisible
+ * @return true if the faces using the material aIndex of aMaterial are fully transparent,
+ * and should not be drawn.
+ */
+static bool isInvisible( const S3D_MATERIAL* aMaterial, unsigned aIndex, bool aUseMaterial )
 {
-    glEnable( GL_COLOR_MATERIAL ) ;
-    SetOpenGlDefaultMaterial();
-
-    glPushMatrix();
-    glTranslatef( m_translation.x, m_translation.y, m_translation.z );
-    glRotatef( m_rotation[3], m_rotation[0], m_rotation[1], m_rotation[2] );
-    glScalef( m_scale.x, m_scale.y, m_scale.z );
+    return aUseMaterial && aMaterial->m_Transparency.size() > aIndex
+           && aMaterial->m_Transparency[aIndex] >= 1.0f;
+}
 
-    // Render your self
-    openGL_Render( aIsRenderingJustNonTransparentObjects,
-                   aIsRenderingJustTransparentObjects );
 
-    // Render childs recursively
-    for( unsigned int idx = 0; idx < childs.size(); idx++ )
-    {
-        childs[idx]->openGL_RenderAllChilds( aIsRenderingJustNonTransparentObjects,
-                                             aIsRenderingJustTransparentObjects );
-    }
+S3D_MESH_BUFFER::S3D_MESH_BUFFER( const boost::shared_ptr<S3D_MODEL_PARSER>& aModel ) :
+    m_model( aModel )
+{
+    m_useMaterial  = g_Parm_3D_Visu.GetFlag( FL_RENDER_MATERIAL );
+    m_smoothShapes = g_Parm_3D_Visu.IsRealisticMode()
+                     && g_Parm_3D_Visu.GetFlag( FL_RENDER_SMOOTH_NORMALS );
 
-    SetOpenGlDefaultMaterial();
+    for( unsigned int idx = 0; idx < m_model->childs.size(); idx++ )
+        addMesh( m_model->childs[idx], glm::mat4() );
 
-    glPopMatrix();
+    m_buffer.Upload();
 }
 
 
-void S3D_MESH::openGL_Render( bool aIsRenderingJustNonTransparentObjects,
-                              bool aIsRenderingJustTransparentObjects )
+int S3D_MESH_BUFFER::getBatch( S3D_MATERIAL* aMaterial, unsigned aIndex )
 {
-    if( (aIsRenderingJustNonTransparentObjects == true) &&
-        (aIsRenderingJustTransparentObjects == true) )
+    for( unsigned ii = 0; ii < m_batches.size(); ii++ )
     {
-        return;
+        if( m_batches[ii].material == aMaterial && m_batches[ii].index == aIndex )
+            return ii;
     }
 
-    //DBG( printf( "openGL_Render" ) );
-    bool useMaterial = g_Parm_3D_Visu.GetFlag( FL_RENDER_MATERIAL );
-    bool smoothShapes = g_Parm_3D_Visu.IsRealisticMode()
-                        && g_Parm_3D_Visu.GetFlag( FL_RENDER_SMOOTH_NORMALS );
+    BATCH batch;
 
-    if( m_CoordIndex.size() == 0 )
-    {
-        return;
-    }
+    batch.material    = aMaterial;
+    batch.index       = aIndex;
+    batch.transparent = m_useMaterial && aMaterial
+                        && aMaterial->m_Transparency.size() > aIndex
+                        && aMaterial->m_Transparency[aIndex] != 0.0f;
 
-    if( m_Materials && ( m_MaterialIndex.size() == 0 ) )
-    {
-        bool isTransparent = m_Materials->SetOpenGLMaterial( 0, useMaterial );
+    m_batches.push_back( batch );
 
-        if( isTransparent && aIsRenderingJustNonTransparentObjects )
-            return;
+    return m_batches.size() - 1;
+}
 
-        if( !isTransparent && aIsRenderingJustTransparentObjects )
-            return;
 
-        if( useMaterial )
-            if( m_Materials->m_Transparency.size() > 0 )
-                if( m_Materials->m_Transparency[0] >= 1.0f )
-                    return;
-    }
+void S3D_MESH_BUFFER::addMesh( S3D_MESH* aMesh, const glm::mat4& aTransform )
+{
+    // The transform of the mesh applies to its own faces and to its childs
+    glm::mat4 transform = glm::translate( aTransform, aMesh->m_translation );
 
-    glPushMatrix();
-    glTranslatef( m_translation.x, m_translation.y, m_translation.z );
-    glRotatef( m_rotation[3], m_rotation[0], m_rotation[1], m_rotation[2] );
-    glScalef( m_scale.x, m_scale.y, m_scale.z );
+    if( aMesh->m_rotation[3] != 0.0f )
+        transform = glm::rotate( transform, glm::radians( aMesh->m_rotation[3] ),
+                                 S3D_VERTEX( aMesh->m_rotation[0], aMesh->m_rotation[1],
+                                             aMesh->m_rotation[2] ) );
 
-    calcPointNormalized();
-    calcPerFaceNormals();
+    transform = glm::scale( transform, aMesh->m_scale );
 
-    if( smoothShapes )
-    {
-        if( (m_PerVertexNormalsNormalized.size() > 0) &&
-            g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
-            perVertexNormalsVerify_and_Repair();
-        else
-            calcPerPointNormals();
+    // Normals are transformed by the inverse transpose matrix,
+    // to stay perpendicular to the faces when the scale is not uniform
+    glm::mat3 normalTransform = glm::inverseTranspose( glm::mat3( transform ) );
 
-    }
+    S3D_MATERIAL* materials = aMesh->m_Materials;
+    bool perFaceMaterial = materials && ( aMesh->m_MaterialIndex.size() != 0 );
 
-    for( unsigned int idx = 0; idx < m_CoordIndex.size(); idx++ )
-    {
-        if( m_Materials && ( m_MaterialIndex.size() != 0 ) )
-        {
-            if ( m_MaterialIndex.size() > idx )
-            {
-                bool isTransparent = m_Materials->SetOpenGLMaterial( m_MaterialIndex[idx], useMaterial );
-                
-                if( isTransparent && aIsRenderingJustNonTransparentObjects )
-                    continue;
+    // Do not add complete transparent meshes
+    bool visible = !( materials && !perFaceMaterial && isInvisible( materials, 0, m_useMaterial ) );
 
-                if( !isTransparent && aIsRenderingJustTransparentObjects )
-                    continue;
+    if( aMesh->m_CoordIndex.size() && visible )
+    {
+        aMesh->calcPointNormalized();
+        aMesh->calcPerFaceNormals();
 
-                if( useMaterial )
-                    if( (int)m_Materials->m_Transparency.size() > m_MaterialIndex[idx] )
-                        if( m_Materials->m_Transparency[m_MaterialIndex[idx]] >= 1.0f )
-                            continue;
-            }
-            else
-            {
-                // This is only need on debug, because above we are marking the bad elements
-                DBG( m_Materials->SetOpenGLMaterial( 0, useMaterial ) );
-            }
-        }
+        bool useModelNormals = false;
 
-/*
-#if defined(DEBUG)
-        // Debug Normals
-        glColor4f( 1.0, 0.0, 1.0, 1.0 );
-        for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+        if( m_smoothShapes )
         {
-            // Flat
-            if( m_PerFaceNormalsNormalized.size() > 0 )
-            {
-                S3D_VERTEX normal = m_PerFaceNormalsNormalized[idx];
-                glNormal3fv( &normal.x );
+            useModelNormals = ( aMesh->m_PerVertexNormalsNormalized.size() > 0 ) &&
+                              g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS );
 
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                {
-                    glBegin( GL_LINES );
-                    glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                    glVertex3fv( &point.x );
-                    point += normal;
-                    glVertex3fv( &point.x );
-                    glEnd();
-                }
-            }
-        }
-#endif
-*/
-
-        switch( m_CoordIndex[idx].size() )
-        {
-        case 3:
-            glBegin( GL_TRIANGLES );
-            break;
-        case 4:
-            glBegin( GL_QUADS );
-            break;
-        default:
-            glBegin( GL_POLYGON );
-            break;
+            if( useModelNormals )
+                aMesh->perVertexNormalsVerify_and_Repair();
+            else
+                aMesh->calcPerPointNormals();
         }
 
+        int             batch = -1;
+        S3D_MATERIAL*   batchMaterial = NULL;
+        unsigned        batchIndex = 0;
 
-        if( smoothShapes )
+        for( unsigned int idx = 0; idx < aMesh->m_CoordIndex.size(); idx++ )
         {
-            if( (m_PerVertexNormalsNormalized.size() > 0) &&
-                g_Parm_3D_Visu.GetFlag( FL_RENDER_USE_MODEL_NORMALS ) )
+            S3D_MATERIAL*   material = NULL;
+            unsigned        index = 0;
+
+            if( perFaceMaterial )
             {
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                // Faces without material index are drawn without material
+                if( aMesh->m_MaterialIndex.size() > idx )
                 {
-                    glm::vec3 normal = m_PerVertexNormalsNormalized[m_NormalIndex[idx][ii]];
-                    glNormal3fv( &normal.x );
-/*
-#if defined(DEBUG)
-                    // Flag error vertices
-                    if ((normal.x == 0.0) && (normal.y == 0.0) && (normal.z == 0.0))
-                    {
-                        glColor4f( 1.0, 0.0, 1.0, 1.0 );
-                    }
-#endif
-*/
-                    glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                    glVertex3fv( &point.x );
+                    material = materials;
+                    index    = aMesh->m_MaterialIndex[idx];
                 }
             }
             else
+                material = materials;
+
+            if( material && isInvisible( material, index, m_useMaterial ) )
+                continue;
+
+            // Consecutive faces usually have the same material
+            if( batch < 0 || material != batchMaterial || index != batchIndex )
             {
-                std::vector< glm::vec3 > normals_list;
-                normals_list = m_PerFaceVertexNormals[idx];
+                batch         = getBatch( material, index );
+                batchMaterial = material;
+                batchIndex    = index;
+                m_buffer.BeginRange( batch );
+            }
 
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                {
-                    glm::vec3 normal = normals_list[ii];
-                    glNormal3fv( &normal.x );
+            const std::vector<int>& face = aMesh->m_CoordIndex[idx];
 
-/*
-#if defined(DEBUG)
-                    // Flag error vertices
-                    if ((normal.x == 0.0) && (normal.y == 0.0) && (normal.z == 0.0))
-                    {
-                        glColor4f( 1.0, 0.0, 1.0, 1.0 );
-                    }
-#endif
-*/
+            // A fan, which is also right for the triangles and the quads
+            m_buffer.Begin( GL_POLYGON );
 
-                    glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                    glVertex3fv( &point.x );
-                }
-            }
-        }
-        else
-        {
-            // Flat
-            if( m_PerFaceNormalsNormalized.size() > 0 )
+            for( unsigned int ii = 0; ii < face.size(); ii++ )
             {
-                S3D_VERTEX normal = m_PerFaceNormalsNormalized[idx];
-/*
-#if defined(DEBUG)
-                // Flag error vertices
-                if( (normal.x == 0.0) && (normal.y == 0.0) && (normal.z == 0.0) )
-                {
-                    DBG( printf("%u\n", idx) );
-                    glColor4f( 1.0, 0.0, 1.0, 1.0 );
-                }
-#endif
-*/
-                glNormal3fv( &normal.x );
+                bool        hasNormal = true;
+                glm::vec3   normal;
+
+                if( m_smoothShapes && useModelNormals )
+                    normal = aMesh->m_PerVertexNormalsNormalized[aMesh->m_NormalIndex[idx][ii]];
+                else if( m_smoothShapes )
+                    normal = aMesh->m_PerFaceVertexNormals[idx][ii];
+                else if( aMesh->m_PerFaceNormalsNormalized.size() > 0 )
+                    normal = aMesh->m_PerFaceNormalsNormalized[idx];
+                else
+                    hasNormal = false;
 
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
+                if( hasNormal )
                 {
-                    glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                    glVertex3fv( &point.x );
-                }
-            }
-            else
-            {
-                for( unsigned int ii = 0; ii < m_CoordIndex[idx].size(); ii++ )
-                {
-                    glm::vec3 point = m_Point[m_CoordIndex[idx][ii]];
-                    glVertex3fv( &point.x );
+                    normal = normalTransform * normal;
+                    m_buffer.Normal( normal.x, normal.y, normal.z );
                 }
+
+                glm::vec4 point = transform * glm::vec4( aMesh->m_Point[face[ii]], 1.0f );
+
+                m_buffer.Vertex( point.x, point.y, point.z );
             }
+
+            m_buffer.End();
         }
+    }
+
+    for( unsigned int idx = 0; idx < aMesh->childs.size(); idx++ )
+        addMesh( aMesh->childs[idx], transform );
+}
+
+
+void S3D_MESH_BUFFER::Draw( bool aIsRenderingJustNonTransparentObjects,
+                            bool aIsRenderingJustTransparentObjects ) const
+{
+    if( aIsRenderingJustNonTransparentObjects && aIsRenderingJustTransparentObjects )
+        return;
+
+    glEnable( GL_COLOR_MATERIAL );
+
+    for( unsigned ii = 0; ii < m_batches.size(); ii++ )
+    {
+        const BATCH& batch = m_batches[ii];
+
+        if( batch.transparent && aIsRenderingJustNonTransparentObjects )
+            continue;
+
+        if( !batch.transparent && aIsRenderingJustTransparentObjects )
+            continue;
+
+        SetOpenGlDefaultMaterial();
+
+        if( batch.material )
+            batch.material->SetOpenGLMaterial( batch.index, m_useMaterial );
 
-        glEnd();
+        m_buffer.DrawRange( ii );
     }
 
-    glPopMatrix();
+    SetOpenGlDefaultMaterial();
 }
 
 
@@ -547,7 +505,14 @@ void S3D_MESH::calcPerFaceNormals()
         return;
     }
 
-    for( unsigned int idx = 0; idx < m_CoordIndex.size(); idx++ )
+    int faceCount = (int) m_CoordIndex.size();
+
+    // Each face writes only its own normals: the faces are computed in parallel.
+    #ifdef USE_OPENMP
+    #pragma omp parallel for if( faceCount >= 1024 ) schedule( dynamic, 256 )
+    #endif /* USE_OPENMP */
+
+    for( int idx = 0; idx < faceCount; idx++ )
     {
         glm::vec3 cross_prod;
 
@@ -698,92 +663,125 @@ void S3D_MESH::calcPerPointNormals()
 
     isPerPointNormalsComputed = true;
 
+    int faceCount = (int) m_CoordIndex.size();
+
     m_PerFaceVertexNormals.clear();
 
     // Pre-allocate space for the entire vector of vertex normals so we can do parallel writes
-    m_PerFaceVertexNormals.resize( m_CoordIndex.size() );
+    m_PerFaceVertexNormals.resize( faceCount );
 
-    for( unsigned int each_face_A_idx = 0; each_face_A_idx < m_CoordIndex.size(); each_face_A_idx++ )
+    for( int each_face_A_idx = 0; each_face_A_idx < faceCount; each_face_A_idx++ )
     {
         m_PerFaceVertexNormals[each_face_A_idx].resize( m_CoordIndex[each_face_A_idx].size() );
     }
 
+    // Build the list of the faces using each point, so the faces sharing a vertex are
+    // found without searching all the faces of the mesh for each vertex.
+    // The faces of the point p are pointFaces[pointFirstFace[p]] to
+    // pointFaces[pointFirstFace[p + 1] - 1], in increasing order, each face once.
+    int pointCount = 0;
 
-    // Initialize each vertex normal
-    for( unsigned int each_face_A_idx = 0; each_face_A_idx < m_CoordIndex.size(); each_face_A_idx++ )
+    for( int each_face_A_idx = 0; each_face_A_idx < faceCount; each_face_A_idx++ )
     {
-        glm::vec3 initVertexFaceNormal = m_PerFaceNormalsRaw_X_PerFaceSquaredArea[each_face_A_idx];
-        
-        std::vector< glm::vec3 >& face_A_normals = m_PerFaceVertexNormals[each_face_A_idx];
+        const std::vector<int>& face = m_CoordIndex[each_face_A_idx];
 
-        for( unsigned int each_vert_A_idx = 0; each_vert_A_idx < m_CoordIndex[each_face_A_idx].size(); each_vert_A_idx++ )
-        {
-            face_A_normals[each_vert_A_idx] = initVertexFaceNormal;
-        }
+        for( unsigned int ii = 0; ii < face.size(); ii++ )
+            pointCount = std::max( pointCount, face[ii] + 1 );
     }
 
-    
-    #ifdef USE_OPENMP
-    #pragma omp parallel for
-    #endif /* USE_OPENMP */
+    std::vector<int> pointFirstFace( pointCount + 1, 0 );
+    std::vector<int> lastFace( pointCount, -1 );
 
-    // for each face A in mesh
-    for( unsigned int each_face_A_idx = 0; each_face_A_idx < m_CoordIndex.size(); each_face_A_idx++ )
+    for( int each_face_A_idx = 0; each_face_A_idx < faceCount; each_face_A_idx++ )
     {
-        // n = face A facet normal
-        std::vector< glm::vec3 >& face_A_normals = m_PerFaceVertexNormals[each_face_A_idx];
- 
-        // loop through all vertices
-        // for each vert in face A
-        for( unsigned int each_vert_A_idx = 0; each_vert_A_idx < m_CoordIndex[each_face_A_idx].size(); each_vert_A_idx++ )
+        const std::vector<int>& face = m_CoordIndex[each_face_A_idx];
+
+        for( unsigned int ii = 0; ii < face.size(); ii++ )
         {
-            int vertexIndexFromFaceA = (int)(m_CoordIndex[each_face_A_idx][each_vert_A_idx]);
-            glm::vec3 vector_face_A = m_PerFaceNormalsNormalized[each_face_A_idx];
+            int point = face[ii];
 
-            // for each face B in mesh
-            for( unsigned int each_face_B_idx = 0; each_face_B_idx < m_CoordIndex.size(); each_face_B_idx++ )
+            if( point >= 0 && lastFace[point] != each_face_A_idx )
             {
-                //if A != B { // ignore self
-                if( each_face_A_idx != each_face_B_idx )
-                {
-                    for( unsigned int ii = 0; ii < m_CoordIndex[each_face_B_idx].size(); ii++ )
-                    {
-                        // Check if there is any vertice in the face B that touch the vertice in face A
-                        if( m_CoordIndex[each_face_B_idx][ii] == vertexIndexFromFaceA )
-                        {
-                            glm::vec3 vector_face_B = m_PerFaceNormalsNormalized[each_face_B_idx];
+                lastFace[point] = each_face_A_idx;
+                pointFirstFace[point + 1]++;
+            }
+        }
+    }
 
-                            float dot_prod = glm::dot( vector_face_A, vector_face_B );
+    for( int point = 0; point < pointCount; point++ )
+        pointFirstFace[point + 1] += pointFirstFace[point];
 
-                            if( dot_prod > 0.05f )
-                                face_A_normals[each_vert_A_idx] += m_PerFaceNormalsRaw_X_PerFaceSquaredArea[each_face_B_idx] * dot_prod;
+    std::vector<int> pointFaces( pointFirstFace[pointCount] );
+    std::vector<int> pointFill( pointFirstFace.begin(), pointFirstFace.end() - 1 );
 
-                            // For each face, only one vertice can touch / share
-                            // another vertice from the other face, so we exit here
-                            break;
-                        }
-                    }
-                }
+    lastFace.assign( pointCount, -1 );
+
+    for( int each_face_A_idx = 0; each_face_A_idx < faceCount; each_face_A_idx++ )
+    {
+        const std::vector<int>& face = m_CoordIndex[each_face_A_idx];
+
+        for( unsigned int ii = 0; ii < face.size(); ii++ )
+        {
+            int point = face[ii];
+
+            if( point >= 0 && lastFace[point] != each_face_A_idx )
+            {
+                lastFace[point] = each_face_A_idx;
+                pointFaces[ pointFill[point]++ ] = each_face_A_idx;
             }
         }
     }
 
-
+    // Each face writes only its own vertex normals: the faces are computed in parallel.
+    // Small meshes are not worth starting the threads.
     #ifdef USE_OPENMP
-    #pragma omp parallel for
+    #pragma omp parallel for if( faceCount >= 1024 ) schedule( dynamic, 256 )
     #endif /* USE_OPENMP */
 
-    // Normalize
-    for( unsigned int each_face_A_idx = 0; each_face_A_idx < m_CoordIndex.size(); each_face_A_idx++ )
+    // for each face A in mesh
+    for( int each_face_A_idx = 0; each_face_A_idx < faceCount; each_face_A_idx++ )
     {
+        // n = face A facet normal
         std::vector< glm::vec3 >& face_A_normals = m_PerFaceVertexNormals[each_face_A_idx];
+        glm::vec3 vector_face_A = m_PerFaceNormalsNormalized[each_face_A_idx];
 
-        for( unsigned int each_vert_A_idx = 0; each_vert_A_idx < m_CoordIndex[each_face_A_idx].size(); each_vert_A_idx++ )
+        // for each vert in face A
+        for( unsigned int each_vert_A_idx = 0; each_vert_A_idx < face_A_normals.size(); each_vert_A_idx++ )
         {
-            float l = glm::length( face_A_normals[each_vert_A_idx] );
+            glm::vec3 normal = m_PerFaceNormalsRaw_X_PerFaceSquaredArea[each_face_A_idx];
+            int       point  = m_CoordIndex[each_face_A_idx][each_vert_A_idx];
+            int       first  = 0;
+            int       last   = 0;
+
+            if( point >= 0 )
+            {
+                first = pointFirstFace[point];
+                last  = pointFirstFace[point + 1];
+            }
+
+            // for each face B that touch the vertex of face A, ignoring face A itself
+            for( int ii = first; ii < last; ii++ )
+            {
+                int each_face_B_idx = pointFaces[ii];
+
+                if( each_face_B_idx == each_face_A_idx )
+                    continue;
+
+                glm::vec3 vector_face_B = m_PerFaceNormalsNormalized[each_face_B_idx];
+
+                float dot_prod = glm::dot( vector_face_A, vector_face_B );
+
+                if( dot_prod > 0.05f )
+                    normal += m_PerFaceNormalsRaw_X_PerFaceSquaredArea[each_face_B_idx] * dot_prod;
+            }
+
+            // Normalize
+            float l = glm::length( normal );
 
             if( l > FLT_EPSILON ) // avoid division by zero
-                face_A_normals[each_vert_A_idx] /= l;
+                normal /= l;
+
+            face_A_normals[each_vert_A_idx] = normal;
         }
     }
 }
@@ -31,11 +31,14 @@
 #define __3D_MESH_MODEL_H__
 
 #include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 #define GLM_FORCE_RADIANS
 #include <gal/opengl/glm/glm.hpp>
 #include "3d_struct.h"
 #include "3d_material.h"
 #include "CBBox.h"
+#include "CVertexBuffer.h"
 
 
 class S3D_MESH;
@@ -47,9 +50,6 @@ public:
     S3D_MESH();
     ~S3D_MESH();
 
-    void openGL_RenderAllChilds( bool aIsRenderingJustNonTransparentObjects,
-                                 bool aIsRenderingJustTransparentObjects );
-
     S3D_MATERIAL                    *m_Materials;
 
     // Point and index list
@@ -69,6 +69,8 @@ public:
     CBBOX &getBBox();
 
 private:
+    friend class S3D_MESH_BUFFER;
+
     std::vector< S3D_VERTEX >                 m_PerFaceNormalsRaw_X_PerFaceSquaredArea;
     std::vector< std::vector< S3D_VERTEX > >  m_PerFaceVertexNormals;
     std::vector< S3D_VERTEX >                 m_PointNormalized;
@@ -91,9 +93,64 @@ private:
     void calcBBoxAllChilds();
 
     CBBOX   m_BBox;
+};
 
-    void openGL_Render( bool aIsRenderingJustNonTransparentObjects,
-                        bool aIsRenderingJustTransparentObjects );
+
+/**
+ * Class S3D_MESH_BUFFER
+ * holds the faces of all the meshes of a model file in a vertex buffer, with the
+ * transforms of the meshes applied, so the model is drawn with a few calls whatever
+ * its number of faces.  The faces are grouped by material: a model used by several
+ * footprints is stored once, and drawn at the place of each footprint.
+ *
+ * The faces depend on the FL_RENDER_MATERIAL, FL_RENDER_SMOOTH_NORMALS and
+ * FL_RENDER_USE_MODEL_NORMALS flags when the buffer is built.
+ */
+class S3D_MESH_BUFFER : public boost::noncopyable
+{
+public:
+    /**
+     * Constructor
+     * builds the buffer of the meshes of aModel.  The OpenGL context which will
+     * draw the buffer must be current.
+     * @param aModel = the loaded model file, kept alive as long as the buffer
+     */
+    S3D_MESH_BUFFER( const boost::shared_ptr<S3D_MODEL_PARSER>& aModel );
+
+    /**
+     * Function Draw
+     * draws the faces, with their materials, in the current model view matrix.
+     * @param aIsRenderingJustNonTransparentObjects = true to draw only the opaque faces
+     * @param aIsRenderingJustTransparentObjects = true to draw only the transparent faces
+     */
+    void Draw( bool aIsRenderingJustNonTransparentObjects,
+               bool aIsRenderingJustTransparentObjects ) const;
+
+private:
+    /// Faces drawn with the same material, stored in the range of the same index.
+    struct BATCH
+    {
+        S3D_MATERIAL*   material;       ///< NULL for the faces without material
+        unsigned        index;          ///< index of the material in material
+        bool            transparent;
+    };
+
+    /**
+     * Function addMesh
+     * adds the faces of aMesh and of its childs to the buffer.
+     * @param aMesh = the mesh to add
+     * @param aTransform = the transform of the parent mesh
+     */
+    void addMesh( S3D_MESH* aMesh, const glm::mat4& aTransform );
+
+    /// @return the index of the batch of the faces using aMaterial, created if needed.
+    int getBatch( S3D_MATERIAL* aMaterial, unsigned aIndex );
+
+    boost::shared_ptr<S3D_MODEL_PARSER> m_model;
+    std::vector<BATCH>                  m_batches;
+    CVERTEXBUFFER                       m_buffer;
+    bool                                m_useMaterial;
+    bool                                m_smoothShapes;
 };
 
 #endif
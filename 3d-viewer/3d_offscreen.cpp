@@ -0,0 +1,299 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_offscreen.cpp
+ * @brief the 3D view of a board rendered in an offscreen buffer, without user interface
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <wx/image.h>
+#include <wx/log.h>
+
+#include <GL/glew.h>        // must be included before gl.h
+
+#include <3d_offscreen.h>
+#include <trackball.h>
+
+// EGL is included last, because its platform header may include the X11 headers
+// and their macros.  No native window is used here.
+#define MESA_EGL_NO_X11_HEADERS
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA   0x31DD
+#endif
+
+typedef EGLDisplay (*GET_PLATFORM_DISPLAY_FUNC)( EGLenum aPlatform, void* aNativeDisplay,
+                                                 const EGLint* aAttribList );
+
+// The shadows textures are rendered in the current frame buffer,
+// which must be at least as large as them
+#define MIN_FRAME_BUFFER_SIZE 512
+
+
+EDA_3D_OFFSCREEN::EDA_3D_OFFSCREEN( BOARD* aBoard )
+{
+    m_board       = aBoard;
+    m_display     = EGL_NO_DISPLAY;
+    m_context     = EGL_NO_CONTEXT;
+    m_frameBuffer = 0;
+    m_colorBuffer = 0;
+    m_depthBuffer = 0;
+
+    // Without 3D frame, the settings are not read: use the default background
+    // of the 3D frame instead of a black one
+    INFO3D_VISU& prms = GetPrm3DVisu();
+
+    if( prms.m_BgColor.m_Red == 0.0 && prms.m_BgColor.m_Green == 0.0 &&
+        prms.m_BgColor.m_Blue == 0.0 && prms.m_BgColor_Top.m_Red == 0.0 &&
+        prms.m_BgColor_Top.m_Green == 0.0 && prms.m_BgColor_Top.m_Blue == 0.0 )
+    {
+        prms.m_BgColor.m_Red       = 0.4;
+        prms.m_BgColor.m_Green     = 0.4;
+        prms.m_BgColor.m_Blue      = 0.5;
+        prms.m_BgColor_Top.m_Red   = 0.8;
+        prms.m_BgColor_Top.m_Green = 0.8;
+        prms.m_BgColor_Top.m_Blue  = 0.9;
+    }
+}
+
+
+EDA_3D_OFFSCREEN::~EDA_3D_OFFSCREEN()
+{
+    release();
+}
+
+
+void EDA_3D_OFFSCREEN::release()
+{
+    if( m_context != EGL_NO_CONTEXT )
+    {
+        // The lists, buffers and textures of the scene belong to the context
+        eglMakeCurrent( m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context );
+
+        ClearLists();
+
+        if( m_frameBuffer )
+        {
+            glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, 0 );
+            glDeleteFramebuffersEXT( 1, &m_frameBuffer );
+            glDeleteRenderbuffersEXT( 1, &m_colorBuffer );
+            glDeleteRenderbuffersEXT( 1, &m_depthBuffer );
+            m_frameBuffer = m_colorBuffer = m_depthBuffer = 0;
+        }
+
+        eglMakeCurrent( m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+        eglDestroyContext( m_display, m_context );
+        m_context = EGL_NO_CONTEXT;
+    }
+
+    if( m_display != EGL_NO_DISPLAY )
+    {
+        eglTerminate( m_display );
+        m_display = EGL_NO_DISPLAY;
+    }
+}
+
+
+bool EDA_3D_OFFSCREEN::Init( const wxSize& aSize )
+{
+    release();
+
+    m_size = aSize;
+
+    // Prefer the surfaceless platform, which needs no display server
+    GET_PLATFORM_DISPLAY_FUNC getPlatformDisplay =
+        (GET_PLATFORM_DISPLAY_FUNC) eglGetProcAddress( "eglGetPlatformDisplayEXT" );
+
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLint major, minor;
+
+    if( getPlatformDisplay )
+        display = getPlatformDisplay( EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL );
+
+    if( display == EGL_NO_DISPLAY || !eglInitialize( display, &major, &minor ) )
+    {
+        display = eglGetDisplay( EGL_DEFAULT_DISPLAY );
+
+        if( display == EGL_NO_DISPLAY || !eglInitialize( display, &major, &minor ) )
+        {
+            wxLogError( wxT( "EDA_3D_OFFSCREEN: cannot initialize EGL" ) );
+            return false;
+        }
+    }
+
+    m_display = display;
+
+    if( !eglBindAPI( EGL_OPENGL_API ) )
+    {
+        wxLogError( wxT( "EDA_3D_OFFSCREEN: OpenGL is not supported by EGL" ) );
+        release();
+        return false;
+    }
+
+    // No surface is used, so a config is needed only by the EGL implementations
+    // without EGL_KHR_no_config_context
+    static const EGLint configAttribs[] =
+    {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+        EGL_NONE
+    };
+
+    EGLConfig config = NULL;
+    EGLint    configCount = 0;
+
+    if( !eglChooseConfig( display, configAttribs, &config, 1, &configCount ) || !configCount )
+        config = NULL;
+
+    EGLContext context = eglCreateContext( display, config, EGL_NO_CONTEXT, NULL );
+
+    if( context == EGL_NO_CONTEXT )
+    {
+        wxLogError( wxT( "EDA_3D_OFFSCREEN: cannot create the OpenGL context" ) );
+        release();
+        return false;
+    }
+
+    m_context = context;
+
+    if( !eglMakeCurrent( display, EGL_NO_SURFACE, EGL_NO_SURFACE, context ) )
+    {
+        wxLogError( wxT( "EDA_3D_OFFSCREEN: surfaceless OpenGL contexts are not supported" ) );
+        release();
+        return false;
+    }
+
+    // Only the OpenGL functions are needed, glewInit() can fail on the GLX ones
+    // when there is no X display, so the result is not used.
+    glewInit();
+
+    if( !GLEW_EXT_framebuffer_object )
+    {
+        wxLogError( wxT( "EDA_3D_OFFSCREEN: frame buffer objects are not supported" ) );
+        release();
+        return false;
+    }
+
+    wxSize bufferSize( std::max( m_size.x, MIN_FRAME_BUFFER_SIZE ),
+                       std::max( m_size.y, MIN_FRAME_BUFFER_SIZE ) );
+
+    glGenFramebuffersEXT( 1, &m_frameBuffer );
+    glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, m_frameBuffer );
+
+    glGenRenderbuffersEXT( 1, &m_colorBuffer );
+    glBindRenderbufferEXT( GL_RENDERBUFFER_EXT, m_colorBuffer );
+    glRenderbufferStorageEXT( GL_RENDERBUFFER_EXT, GL_RGBA8, bufferSize.x, bufferSize.y );
+    glFramebufferRenderbufferEXT( GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT,
+                                  GL_RENDERBUFFER_EXT, m_colorBuffer );
+
+    glGenRenderbuffersEXT( 1, &m_depthBuffer );
+    glBindRenderbufferEXT( GL_RENDERBUFFER_EXT, m_depthBuffer );
+    glRenderbufferStorageEXT( GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24,
+                              bufferSize.x, bufferSize.y );
+    glFramebufferRenderbufferEXT( GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT,
+                                  GL_RENDERBUFFER_EXT, m_depthBuffer );
+
+    glBindRenderbufferEXT( GL_RENDERBUFFER_EXT, 0 );
+
+    glDrawBuffer( GL_COLOR_ATTACHMENT0_EXT );
+    glReadBuffer( GL_COLOR_ATTACHMENT0_EXT );
+
+    if( glCheckFramebufferStatusEXT( GL_FRAMEBUFFER_EXT ) != GL_FRAMEBUFFER_COMPLETE_EXT )
+    {
+        wxLogError( wxT( "EDA_3D_OFFSCREEN: cannot create a %dx%d frame buffer" ),
+                    bufferSize.x, bufferSize.y );
+        release();
+        return false;
+    }
+
+    return true;
+}
+
+
+void EDA_3D_OFFSCREEN::setView( VIEW3D aView )
+{
+    INFO3D_VISU& prms = GetPrm3DVisu();
+
+    for( int ii = 0; ii < 4; ii++ )
+        prms.m_Rot[ii] = 0.0;
+
+    trackball( prms.m_Quat, 0.0, 0.0, 0.0, 0.0 );
+    prms.m_Zoom = 1.0;
+    SetOffset( 0.0, 0.0 );
+
+    switch( aView )
+    {
+    case VIEW3D_TOP:
+        break;
+
+    case VIEW3D_BOTTOM:
+        prms.m_ROTX = -180;
+        break;
+
+    case VIEW3D_ISO:
+        prms.m_ROTX = -55;
+        prms.m_ROTZ = -45;
+        break;
+    }
+}
+
+
+bool EDA_3D_OFFSCREEN::RenderView( VIEW3D aView, const wxString& aFileName,
+                                   wxString* aErrorMessages )
+{
+    if( m_context == EGL_NO_CONTEXT )
+        return false;
+
+    eglMakeCurrent( m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context );
+    glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, m_frameBuffer );
+
+    // InitGL() resets the zoom the first time, so it is called before setting the view
+    InitGL();
+    setView( aView );
+
+    RenderScene( m_size, false, aErrorMessages, false );
+
+    glFinish();
+
+    unsigned char* pixelbuffer = (unsigned char*) malloc( m_size.x * m_size.y * 3 );
+
+    glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+    glReadBuffer( GL_COLOR_ATTACHMENT0_EXT );
+    glReadPixels( 0, 0, m_size.x, m_size.y, GL_RGB, GL_UNSIGNED_BYTE, pixelbuffer );
+
+    // The image takes the ownership of the buffer.
+    // OpenGL stores the rows from the bottom, the images from the top.
+    wxImage image( m_size.x, m_size.y, pixelbuffer );
+    image = image.Mirror( false );
+
+    if( !wxImage::FindHandler( wxBITMAP_TYPE_PNG ) )
+        wxImage::AddHandler( new wxPNGHandler );
+
+    return image.SaveFile( aFileName, wxBITMAP_TYPE_PNG );
+}
@@ -0,0 +1,99 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ /**
+ * @file 3d_offscreen.h
+ * @brief the 3D view of a board rendered in an offscreen buffer, without user interface
+ */
+
+#ifndef _3D_OFFSCREEN_H_
+#define _3D_OFFSCREEN_H_
+
+#include <3d_scene.h>
+
+/**
+ * Class EDA_3D_OFFSCREEN
+ * renders the 3D view of a board in an offscreen frame buffer, and saves it in image
+ * files, without window nor display server.
+ *
+ * The OpenGL context is created with EGL, on the surfaceless platform of Mesa if
+ * available (which also works without graphic card, with the software rasterizer),
+ * or on the default display.  The scene is built once, at the first rendering, and
+ * the next views only draw it again.
+ */
+class EDA_3D_OFFSCREEN : public EDA_3D_SCENE
+{
+public:
+    /// The predefined views, the same as the ones of the 3D frame toolbar
+    enum VIEW3D
+    {
+        VIEW3D_TOP,
+        VIEW3D_BOTTOM,
+        VIEW3D_ISO          ///< seen from the front left corner, above the board
+    };
+
+    EDA_3D_OFFSCREEN( BOARD* aBoard );
+    ~EDA_3D_OFFSCREEN();
+
+    BOARD* GetBoard() { return m_board; }
+
+    /**
+     * Function Init
+     * creates the OpenGL context and the frame buffer.
+     * @param aSize = the size of the rendered images, in pixels
+     * @return true if success, false if no OpenGL context can be created.
+     * The errors are reported with wxLogError.
+     */
+    bool Init( const wxSize& aSize );
+
+    /**
+     * Function RenderView
+     * renders the board seen from a predefined view, and saves it in a png file.
+     * @param aView = the view
+     * @param aFileName = the full file name of the png file
+     * @param aErrorMessages = a wxString which will filled with the error messages
+     * of the scene build, if any (can be NULL)
+     * @return true if the file is written.
+     */
+    bool RenderView( VIEW3D aView, const wxString& aFileName, wxString* aErrorMessages );
+
+private:
+    /// Sets the rotation of the view parameters, like EDA_3D_CANVAS::SetView3D().
+    void setView( VIEW3D aView );
+
+    /// Destroys the frame buffer and the context
+    void release();
+
+    BOARD*      m_board;
+    wxSize      m_size;
+
+    void*       m_display;          ///< the EGLDisplay, EGL is not included here
+    void*       m_context;          ///< the EGLContext
+
+    GLuint      m_frameBuffer;
+    GLuint      m_colorBuffer;
+    GLuint      m_depthBuffer;
+};
+
+#endif  /*  _3D_OFFSCREEN_H_ */
@@ -28,11 +28,15 @@
  * @file 3d_read_mesh.cpp
  */
 
+#include <map>
+#include <boost/weak_ptr.hpp>
 #include <fctsys.h>
 #include <common.h>
 #include <macros.h>
 #include <kicad_string.h>
 #include <pgm_base.h>
+#include <ki_mutex.h>
+#include <wx/filefn.h>
 #define GLM_FORCE_RADIANS
 #include <gal/opengl/glm/gtc/matrix_transform.hpp>
 #include <3d_viewer.h>
@@ -53,8 +57,37 @@ S3D_MODEL_PARSER *S3D_MODEL_PARSER::Create( S3D_MASTER* aMaster,
  }
 
 
-int S3D_MASTER::ReadData( S3D_MODEL_PARSER* aParser )
-{    
+/**
+ * Function deleteModel
+ * deletes a parser of the model cache, then the master owning the materials of its meshes.
+ */
+static void deleteModel( S3D_MODEL_PARSER* aParser )
+{
+    S3D_MASTER* owner = aParser->GetMaster();
+
+    delete aParser;
+    delete owner;
+}
+
+
+struct CACHED_MODEL
+{
+    long                                mtime;
+    long                                size;
+    boost::weak_ptr<S3D_MODEL_PARSER>   parser;     ///< never modified once loaded
+};
+
+typedef std::map<wxString, CACHED_MODEL>    CACHED_MODELS;
+
+/// The models loaded by all the 3D frames of the process, by full file name.
+/// A model is shared by the S3D_MASTERs using it, and is deleted with the last one:
+/// the cache does not keep it alive.
+static CACHED_MODELS    s_cachedModels;
+static MUTEX            s_cachedModelsLock;
+
+
+int S3D_MASTER::ReadData()
+{
     if( m_Shape3DName.IsEmpty() )
     {
         //DBG( printf("m_Shape3DName.IsEmpty") );
@@ -67,9 +100,6 @@ int S3D_MASTER::ReadData( S3D_MODEL_PARSER* aParser )
         return -1;
     }
 
-    if( aParser == NULL )
-        return -1;
-
     wxString filename = m_Shape3DFullFilename;
 
 #ifdef __WINDOWS__
@@ -78,22 +108,84 @@ int S3D_MASTER::ReadData( S3D_MODEL_PARSER* aParser )
     filename.Replace( wxT( "\\" ), wxT( "/" ) );
 #endif
 
-    if( wxFileName::FileExists( filename ) )
+    wxStructStat    st;
+
+    if( wxStat( filename, &st ) == 0 )
     {
-        wxFileName fn( filename );
+        long    mtime = (long) st.st_mtime;
+        long    size  = (long) st.st_size;
+
+        boost::shared_ptr<S3D_MODEL_PARSER> parser;
+
+        {
+            MUTLOCK lock( s_cachedModelsLock );
+
+            CACHED_MODELS::const_iterator it = s_cachedModels.find( filename );
+
+            if( it != s_cachedModels.end() && it->second.mtime == mtime
+                && it->second.size == size )
+                parser = it->second.parser.lock();
+        }
 
-        if( aParser->Load( filename ) )
+        if( !parser )
+        {
+            // The materials of the meshes belong to the master given to the parser, so
+            // give it one of its own, which lives as long as the meshes, rather than
+            // this one, which may be deleted with its footprint while the meshes are
+            // still used by other footprints.
+            S3D_MASTER* owner = new S3D_MASTER( NULL );
+
+            owner->SetShape3DName( m_Shape3DName );
+
+            S3D_MODEL_PARSER* newParser = S3D_MODEL_PARSER::Create( owner, GetShape3DExtension() );
+
+            if( newParser == NULL )
+            {
+                delete owner;
+                m_parser.reset();
+                return -1;
+            }
+
+            parser.reset( newParser, deleteModel );
+
+            if( !parser->Load( filename ) )
+                parser.reset();
+            else
+            {
+                MUTLOCK lock( s_cachedModelsLock );
+
+                // Forget the models released since the last load
+                for( CACHED_MODELS::iterator it = s_cachedModels.begin();
+                     it != s_cachedModels.end(); )
+                {
+                    if( it->second.parser.expired() )
+                        s_cachedModels.erase( it++ );
+                    else
+                        ++it;
+                }
+
+                CACHED_MODEL& cached = s_cachedModels[ filename ];
+
+                cached.mtime  = mtime;
+                cached.size   = size;
+                cached.parser = parser;
+            }
+        }
+
+        if( parser )
         {
             // Invalidate bounding boxes
             m_fastAABBox.Reset();
             m_BBox.Reset();
 
-            m_parser = aParser;
+            m_parser = parser;
 
             return 0;
         }
     }
 
+    m_parser.reset();
+
     wxLogDebug( wxT( "3D shape '%s' not found, even tried '%s' after env var substitution." ),
         GetChars( m_Shape3DName ),
         GetChars( filename ) );
@@ -102,12 +194,10 @@ int S3D_MASTER::ReadData( S3D_MODEL_PARSER* aParser )
 }
 
 
-void S3D_MASTER::Render( bool aIsRenderingJustNonTransparentObjects,
+void S3D_MASTER::Render( const S3D_MESH_BUFFER& aMeshes,
+                         bool aIsRenderingJustNonTransparentObjects,
                          bool aIsRenderingJustTransparentObjects )
 {
-    if( m_parser == NULL )
-        return;
-    
     double aVrmlunits_to_3Dunits = g_Parm_3D_Visu.m_BiuTo3Dunits * UNITS3D_TO_UNITSPCB;
 
     glScalef( aVrmlunits_to_3Dunits, aVrmlunits_to_3Dunits, aVrmlunits_to_3Dunits );
@@ -122,9 +212,7 @@ void S3D_MASTER::Render( bool aIsRenderingJustNonTransparentObjects,
 
     glScalef( m_MatScale.x, m_MatScale.y, m_MatScale.z );
 
-    for( unsigned int idx = 0; idx < m_parser->childs.size(); idx++ )
-        m_parser->childs[idx]->openGL_RenderAllChilds( aIsRenderingJustNonTransparentObjects,
-                                                       aIsRenderingJustTransparentObjects );
+    aMeshes.Draw( aIsRenderingJustNonTransparentObjects, aIsRenderingJustTransparentObjects );
 }
 
 
@@ -148,7 +236,7 @@ CBBOX &S3D_MASTER::getFastAABBox( )
 
 void S3D_MASTER::calcBBox()
 {
-    if( m_parser == NULL )
+    if( !m_parser )
         return;
 
     bool firstBBox = true;
@@ -0,0 +1,420 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_scene.h
+ * @brief the 3D view of a board, drawn in the current OpenGL context
+ */
+
+#ifndef _3D_SCENE_H_
+#define _3D_SCENE_H_
+
+#include <wx/glcanvas.h>     // used only to define the GL types
+
+#ifdef __WXMAC__
+#  ifdef __DARWIN__
+#    include <OpenGL/glu.h>
+#  else
+#    include <glu.h>
+#  endif
+#else
+#  include <GL/glu.h>
+#endif
+
+#include <vector>
+#include <stdint.h>
+#include <boost/ptr_container/ptr_map.hpp>
+
+#include <3d_struct.h>
+#include <modelparsers.h>
+#include <class_module.h>
+#include <CBBox.h>
+#include <CVertexBuffer.h>
+#include <info3d_visu.h>
+
+class BOARD;
+class CPOLYGONS_LIST;
+
+class VIA;
+class D_PAD;
+
+// We are using GL lists and vertex buffers to store layers and other items
+// to draw or not
+// GL_LIST_ID are the GL lists indexes in m_glLists, and the vertex buffers
+// indexes in m_glBuffers
+enum GL_LIST_ID
+{
+    GL_ID_BEGIN = 0,
+    GL_ID_AXIS = GL_ID_BEGIN,   // list id for 3D axis
+    GL_ID_GRID,                 // list id for 3D grid
+    GL_ID_BOARD,                // buffer id for copper layers, holes and body
+    GL_ID_TECH_LAYERS,          // buffer id for non copper layers (masks...)
+    GL_ID_AUX_LAYERS,           // buffer id for user layers (draw, eco, comment)
+    GL_ID_SHADOW_FRONT,
+    GL_ID_SHADOW_BACK,
+    GL_ID_SHADOW_BOARD,
+    GL_ID_END
+};
+
+// The ranges of the GL_ID_BOARD buffer are the copper layers, then the holes and the body.
+// The ranges of the other buffers are their layers.
+enum BOARD_RANGE_ID
+{
+    RANGE_ID_HOLES = LAYER_ID_COUNT,    // vias and plated pads holes
+    RANGE_ID_BODY                       // board body only
+};
+
+/// The meshes buffers of the 3D shapes, by model file
+typedef boost::ptr_map<S3D_MODEL_PARSER*, S3D_MESH_BUFFER> MESH_BUFFERS;
+
+/**
+ * Class EDA_3D_SCENE
+ * builds the 3D view of a board (GL lists, vertex buffers and textures), and draws it
+ * in the current OpenGL context.
+ *
+ * The scene does not depend on a window: EDA_3D_CANVAS draws it on screen, and
+ * EDA_3D_OFFSCREEN draws it in an offscreen buffer, without user interface.
+ * The lists, buffers and textures belong to the OpenGL context which was current
+ * when they were built, which must be current when calling any function of the scene.
+ */
+class EDA_3D_SCENE
+{
+protected:
+    bool            m_init;
+    GLuint          m_glLists[GL_ID_END];   ///< GL lists
+    CVERTEXBUFFER*  m_glBuffers[GL_ID_END]; ///< vertex buffers of the layers, by range
+
+    /// The meshes of the footprint shapes, one buffer per model file,
+    /// drawn for each footprint using it.
+    MESH_BUFFERS    m_meshBuffers;
+    bool            m_shapesBuilt;          ///< true when the 3D shapes are read and buffered
+    wxRealPoint     m_draw3dOffset;         ///< offset to draw the 3D mesh.
+    double          m_ZBottom;              ///< position of the back layer
+    double          m_ZTop;                 ///< position of the front layer
+
+    GLuint          m_text_pcb;             ///< an index to the texture generated for pcb texts
+    GLuint          m_text_silk;            ///< an index to the texture generated for silk layers
+
+    // Index to the textures generated for shadows
+    bool            m_shadow_init;
+    GLuint          m_text_fake_shadow_front;
+    GLuint          m_text_fake_shadow_back;
+    GLuint          m_text_fake_shadow_board;
+
+    /// The indexes of the shadow images in m_shadowImages
+    enum SHADOW_IMAGE_ID
+    {
+        SHADOW_FRONT,
+        SHADOW_BACK,
+        SHADOW_BOARD,
+        SHADOW_COUNT
+    };
+
+    /// The blurred shadow images, kept when the lists are cleared: they are rendered
+    /// again only when the board outline or the footprints change.
+    std::vector<unsigned char>  m_shadowImages[SHADOW_COUNT];
+    uint64_t                    m_shadowKey;    ///< the shadowKey() of m_shadowImages
+
+    CBBOX           m_boardAABBox;          ///< Axis Align Bounding Box of the board
+    CBBOX           m_fastAABBox;           ///< Axis Align Bounding Box that contain the other bounding boxes
+    CBBOX           m_fastAABBox_Shadow;    ///< A bit scalled version of the m_fastAABBox
+
+    S3D_VERTEX      m_lightPos;
+
+    /**
+     * Function create_and_render_shadow_buffer
+     * renders the depth of the footprint shapes, and of the board body if aDraw_body
+     * is true, with the current matrices, and blurs it.
+     * @param aShadowImage = the blurred depth image, aTexture_size * aTexture_size pixels
+     * @param aTexture_size = the size of the image
+     * @param aDraw_body = true to render the board body
+     * @param aBlurPasses = the number of blur passes
+     */
+    void create_and_render_shadow_buffer( std::vector<unsigned char>& aShadowImage,
+            GLuint aTexture_size, bool aDraw_body, int aBlurPasses );
+
+    /**
+     * Function createShadowTexture
+     * creates a shadow texture, with the inverted shadow image as alpha channel.
+     * @param aDst_gl_texture = the created texture
+     * @param aShadowImage = the image made by create_and_render_shadow_buffer()
+     * @param aTexture_size = the size of the image
+     */
+    void createShadowTexture( GLuint *aDst_gl_texture,
+            const std::vector<unsigned char>& aShadowImage, GLuint aTexture_size );
+
+    void calcBBox();
+
+public:
+    EDA_3D_SCENE();
+    virtual ~EDA_3D_SCENE();
+
+    /// @return the board to draw
+    virtual BOARD* GetBoard() = 0;
+
+    /**
+     * Function ClearLists
+     * Clear the display list or the vertex buffer.
+     * @param aGlList = the list to clear.
+     * if 0 (default) all lists and buffers are cleared, including the 3D shapes
+     */
+    virtual void ClearLists( int aGlList = 0 );
+
+    /**
+     * Function CreateDrawGL_List
+     * Prepares the parameters of the OpenGL draw list
+     * creates the OpenGL draw list items (board, grid ...)
+     * @param aErrorMessages = a wxString which will filled with error messages,
+     * if any
+     * @param aShowWarnings = true to show all messages, false to show errors only
+     */
+    virtual void CreateDrawGL_List( wxString* aErrorMessages, bool aShowWarnings );
+
+    /**
+     * Function RenderScene
+     * draws the board in the current OpenGL context, with the view parameters of
+     * GetPrm3DVisu(), and builds first the missing lists and buffers.
+     * @param aSize = the size of the viewport, in pixels
+     * @param aOrtho = true for an orthographic projection, false for a perspective one
+     * @param aErrorMessages = a wxString which will filled with error messages,
+     * if any
+     * @param aShowWarnings = true to show all messages, false to show errors only
+     */
+    void   RenderScene( const wxSize& aSize, bool aOrtho,
+                        wxString* aErrorMessages, bool aShowWarnings );
+
+    void   InitGL();
+
+    void   SetLights();
+
+    void   SetOffset(double aPosX, double aPosY)
+    {
+        m_draw3dOffset.x = aPosX;
+        m_draw3dOffset.y = aPosY;
+    }
+
+    /** @return the INFO3D_VISU which contains the current parameters
+     * to draw the 3D view og the board
+     */
+    INFO3D_VISU& GetPrm3DVisu() const;
+
+private:
+
+    /**
+     * return true if we are in realistic mode render
+     */
+    bool isRealisticMode() const;
+
+    /**
+     * @return true if aItem should be displayed
+     * @param aItem = an item of DISPLAY3D_FLG enum
+     */
+    bool isEnabled( DISPLAY3D_FLG aItem ) const;
+
+    /** Helper function
+     * @return true if aLayer should be displayed, false otherwise
+     */
+    bool is3DLayerEnabled( LAYER_ID aLayer ) const;
+
+    /**
+     * @return the size of the board in pcb units
+     */
+    wxSize getBoardSize() const;
+
+    /**
+     * @return the position of the board center in pcb units
+     */
+    wxPoint getBoardCenter() const;
+
+    /**
+     * Helper function setGLTechLayersColor
+     * Initialize the color to draw the non copper layers
+     * in realistic mode and normal mode.
+     */
+    void setGLTechLayersColor( CVERTEXBUFFER& aBuffer, LAYER_NUM aLayer );
+
+    /**
+     * Helper function setGLCopperColor
+     * Initialize the copper color to draw the board
+     * in realistic mode (a golden yellow color )
+     */
+    void setGLCopperColor( CVERTEXBUFFER& aBuffer );
+
+    /**
+     * Helper function setGLEpoxyColor
+     * Initialize the color to draw the epoxy body board in realistic mode.
+     */
+    void setGLEpoxyColor( CVERTEXBUFFER& aBuffer, float aTransparency = 1.0 );
+
+    /**
+     * Helper function setGLSolderMaskColor
+     * Initialize the color to draw the solder mask layers in realistic mode.
+     */
+    void setGLSolderMaskColor( CVERTEXBUFFER& aBuffer, float aTransparency = 1.0 );
+
+    /**
+     * Function buildBoard3DView
+     * Called by CreateDrawGL_List()
+     * Populates the GL_ID_BOARD vertex buffer with board items only on copper layers,
+     * one range per layer, then the holes and the body in their own ranges.
+     * 3D footprint shapes, tech layers and aux layers are not on this buffer
+     * Fills aErrorMessages with error messages created by some calculation function
+     * @param aBuffer = the buffer to fill
+     * @param aErrorMessages = a wxString to add error and warning messages
+     * created by the build process (can be NULL)
+     * @param aShowWarnings = true to show all messages, false to show errors only
+     */
+    void   buildBoard3DView( CVERTEXBUFFER& aBuffer,
+                             wxString* aErrorMessages, bool aShowWarnings );
+
+    /**
+     * Function buildTechLayers3DView
+     * Called by CreateDrawGL_List()
+     * Populates the GL_ID_TECH_LAYERS vertex buffer with items on tech layers,
+     * one range per layer, including the hidden layers
+     * @param aBuffer = the buffer to fill
+     * @param aErrorMessages = a wxString to add error and warning messages
+     * created by the build process (can be NULL)
+     * @param aShowWarnings = true to show all messages, false to show errors only
+     */
+    void   buildTechLayers3DView( CVERTEXBUFFER& aBuffer,
+                                  wxString* aErrorMessages, bool aShowWarnings );
+
+    /**
+     * Function drawBufferLayers
+     * draws the ranges of the visible layers of a vertex buffer.
+     * @param aBuffer = the buffer to draw
+     */
+    void   drawBufferLayers( const CVERTEXBUFFER& aBuffer );
+
+    /**
+     * Function buildShadowList
+     * Called by CreateDrawGL_List()
+     */
+     void buildShadowList( GLuint aFrontList, GLuint aBacklist, GLuint aBoardList );
+
+    /**
+     * Function buildFootprintShape3DList
+     * Called by CreateDrawGL_List()
+     * Reads the 3D footprint shapes, and builds the vertex buffers of their files
+     * which are not yet built
+     */
+    void   buildFootprintShape3DList();
+
+    /**
+     * Function drawFootprintShapes
+     * draws the 3D shapes of all the footprints.
+     * @param  aIsRenderingJustNonTransparentObjects = true to draw non transparent objects
+     * @param  aIsRenderingJustTransparentObjects = true to draw transparent objects
+     * in openGL, transparent objects should be drawn *after* non transparent objects
+     */
+    void   drawFootprintShapes( bool aIsRenderingJustNonTransparentObjects,
+                                bool aIsRenderingJustTransparentObjects );
+
+    /**
+     * Function buildBoard3DAuxLayers
+     * Called by CreateDrawGL_List()
+     * Fills the GL_ID_AUX_LAYERS vertex buffer
+     * with items on aux layers only, one range per layer
+     * @param aBuffer = the buffer to fill
+     */
+    void   buildBoard3DAuxLayers( CVERTEXBUFFER& aBuffer );
+
+    void   draw3DGrid( double aGriSizeMM );
+    void   draw3DAxis();
+
+    /**
+     * Helper function BuildPadShapeThickOutlineAsPolygon:
+     * Build a pad outline as non filled polygon, to draw pads on silkscreen layer
+     * with a line thickness = aWidth
+     * Used only to draw pads outlines on silkscreen layers.
+     */
+    void buildPadShapeThickOutlineAsPolygon( const D_PAD*          aPad,
+                                             CPOLYGONS_LIST& aCornerBuffer,
+                                             int             aWidth,
+                                             int             aCircleToSegmentsCount,
+                                             double          aCorrectionFactor );
+
+
+    /**
+     * Helper function draw3DViaHole:
+     * Draw the via hole:
+     * Build a vertical hole (a cylinder) between the first and the last via layers
+     */
+    void   draw3DViaHole( CVERTEXBUFFER& aBuffer, const VIA * aVia );
+
+    /**
+     * Helper function draw3DPadHole:
+     * Draw the pad hole:
+     * Build a vertical hole (round or oblong) between the front and back layers
+     */
+    void   draw3DPadHole( CVERTEXBUFFER& aBuffer, const D_PAD * aPad );
+
+    /**
+     * function render3DComponentShape
+     * draws the meshes of the footprint shapes, at the footprint position
+     * @param module
+     * @param  aIsRenderingJustNonTransparentObjects = true to load non transparent objects
+     * @param  aIsRenderingJustTransparentObjects = true to load non transparent objects
+     * in openGL, transparent objects should be drawn *after* non transparent objects
+     */
+    void render3DComponentShape( MODULE* module,
+                                 bool aIsRenderingJustNonTransparentObjects,
+                                 bool aIsRenderingJustTransparentObjects );
+
+    /**
+     * function read3DComponentShape
+     * read the 3D component shape(s) of the footprint (physical shape).
+     * @param module
+     * @return true if load was succeeded, false otherwise
+     */
+    bool read3DComponentShape( MODULE* module );
+
+    /**
+     * function generateFakeShadowsTextures
+     * creates shadows of the board an footprints
+     * for aesthetical purpose
+     * @param aErrorMessages = a wxString to add error and warning messages
+     * created by the build process (can be NULL)
+     * @param aShowWarnings = true to show all messages, false to show errors only
+     */
+    void   generateFakeShadowsTextures( wxString* aErrorMessages, bool aShowWarnings );
+
+    /**
+     * function renderFakeShadows
+     * renders the front, back and board shadow images in m_shadowImages
+     */
+    void   renderFakeShadows();
+
+    /**
+     * function shadowKey
+     * @return a hash of what changes the shadows: the board outline, the footprint
+     * positions and shapes, and the view parameters of the shadows
+     */
+    uint64_t shadowKey();
+
+};
+
+void CheckGLError(const char *aFileName, int aLineNumber);
+
+#endif  /*  _3D_SCENE_H_ */
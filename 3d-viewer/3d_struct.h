@@ -33,6 +33,7 @@
 
 #include <common.h>
 #include <base_struct.h>
+#include <boost/shared_ptr.hpp>
 #include <3d_material.h>
 #include <3d_types.h>
 #include <CBBox.h>
@@ -41,6 +42,7 @@
 class S3D_MASTER;
 class STRUCT_3D_SHAPE;
 class S3D_MODEL_PARSER;
+class S3D_MESH_BUFFER;
 
 // Master structure for a 3D footprint shape description
 class S3D_MASTER : public EDA_ITEM
@@ -51,7 +53,8 @@ public:
     S3DPOINT            m_MatPosition;  ///< an offset for the entire 3D footprint shape
     STRUCT_3D_SHAPE*    m_3D_Drawings;  ///< the list of basic shapes
     S3D_MATERIAL*       m_Materials;    ///< the list of materiels used by the shapes
-    S3D_MODEL_PARSER*   m_parser;       ///< it store the loaded file to be rendered later
+    /// The loaded file to be rendered later, shared by all the shapes using this file.
+    boost::shared_ptr<S3D_MODEL_PARSER> m_parser;
 
     enum FILE3D_TYPE
     {
@@ -90,12 +93,24 @@ public:
     /**
      * Function ReadData
      * Select the parser to read the 3D data file (vrml, x3d ...)
-     * and build the description objects list
-     * @param aParser the parser that should be used to read model data and stored in
+     * and build the description objects list.
+     * The files are parsed once per process: the meshes of a file are shared by all
+     * the shapes using it, until the file is modified.  The meshes are never modified
+     * once parsed, the transform of each shape being applied when rendering.
+     * @return 0 if the file was read, -1 otherwise.
      */
-    int  ReadData( S3D_MODEL_PARSER* aParser );
+    int  ReadData();
 
-    void Render( bool aIsRenderingJustNonTransparentObjects,
+    /**
+     * Function Render
+     * draws the meshes of the loaded file, with the scale, rotation and offset
+     * of this shape applied to the current model view matrix.
+     * @param aMeshes = the buffer built from m_parser, shared by the shapes using the file
+     * @param aIsRenderingJustNonTransparentObjects = true to draw only the opaque faces
+     * @param aIsRenderingJustTransparentObjects = true to draw only the transparent faces
+     */
+    void Render( const S3D_MESH_BUFFER& aMeshes,
+                 bool aIsRenderingJustNonTransparentObjects,
                  bool aIsRenderingJustTransparentObjects );
 
     /**
@@ -30,6 +30,7 @@
 #include "CImage.h"
 #include <wx/image.h>                                                           // Used for save an image to disk
 #include <string.h>                                                             // For memcpy
+#include <vector>
 
 #ifndef CLAMP
 #define CLAMP(n, min, max) {if (n < min) n=min; else if (n > max) n = max;}
@@ -364,10 +365,8 @@ static const S_FILTER FILTERS[] =   {
 };// Filters
 
 
-//!TODO: This functions can be optimized slipting it between the edges and
-//       do it without use the getpixel function.
-//       Optimization can be done to m_pixels[ix + iy * m_width]
-//       but keep in mind the parallel process of the algorithm
+// The pixels at less than 2 pixels from the edges are read with Getpixel(), to clamp
+// their coordinates.  The other ones are read directly.
 void CIMAGE::EfxFilter( CIMAGE *aInImg, E_FILTER aFilterType )
 {
     S_FILTER filter = FILTERS[aFilterType];
@@ -378,23 +377,38 @@ void CIMAGE::EfxFilter( CIMAGE *aInImg, E_FILTER aFilterType )
     #ifdef USE_OPENMP
     #pragma omp parallel for
     #endif /* USE_OPENMP */
-    
+
     for( int iy = 0; iy < (int)m_height; iy++)
     {
+        bool edgeRow = ( iy < 2 ) || ( iy >= (int)m_height - 2 );
+
         for( int ix = 0; ix < (int)m_width; ix++ )
         {
             int v = 0;
 
-            for( int sy = 0; sy < 5; sy++ )
+            if( edgeRow || ( ix < 2 ) || ( ix >= (int)m_width - 2 ) )
+            {
+                for( int sy = 0; sy < 5; sy++ )
+                {
+                    for( int sx = 0; sx < 5; sx++ )
+                    {
+                        int factor = filter.kernel[sx][sy];
+                        unsigned char pixelv = aInImg->Getpixel( ix + sx - 2, iy + sy - 2 );
+                        v += pixelv * factor;
+                    }
+                }
+            }
+            else
             {
-                for( int sx = 0; sx < 5; sx++ )
+                for( int sy = 0; sy < 5; sy++ )
                 {
-                    int factor = filter.kernel[sx][sy];
-                    unsigned char pixelv = aInImg->Getpixel( ix + sx - 2, iy + sy - 2 );
-                    v += pixelv * factor;
+                    const unsigned char* row = aInImg->m_pixels + ( iy + sy - 2 ) * m_width + ix - 2;
+
+                    for( int sx = 0; sx < 5; sx++ )
+                        v += row[sx] * filter.kernel[sx][sy];
                 }
             }
-            
+
             v /= filter.div;
 
             v += filter.offset;
@@ -407,6 +421,92 @@ void CIMAGE::EfxFilter( CIMAGE *aInImg, E_FILTER aFilterType )
 }
 
 
+/// The weights of EfxBlur(), the sums of the rows of the FILTER_GAUSSIAN_BLUR kernel
+static const int BLUR_WEIGHTS[5] = { 23, 40, 58, 40, 23 };
+
+/// The sum of the BLUR_WEIGHTS, which is also the sum of the FILTER_GAUSSIAN_BLUR kernel
+#define BLUR_WEIGHTS_SUM    184
+
+/// The divisor of EfxBlur(), to brighten the image as much as FILTER_GAUSSIAN_BLUR
+#define BLUR_DIV            ( BLUR_WEIGHTS_SUM * 182 )
+
+
+void CIMAGE::EfxBlur( const CIMAGE *aInImg )
+{
+    const int width  = m_width;
+    const int height = m_height;
+
+    // The horizontal pass, kept with all its precision for the vertical pass
+    std::vector<unsigned short> rows( m_wxh );
+
+    #ifdef USE_OPENMP
+    #pragma omp parallel for
+    #endif /* USE_OPENMP */
+
+    for( int iy = 0; iy < height; iy++ )
+    {
+        const unsigned char* in  = aInImg->m_pixels + iy * width;
+        unsigned short*      out = &rows[iy * width];
+
+        for( int ix = 0; ix < width; ix++ )
+        {
+            int v = 0;
+
+            if( ( ix < 2 ) || ( ix >= width - 2 ) )
+            {
+                for( int s = 0; s < 5; s++ )
+                {
+                    int x = ix + s - 2;
+
+                    x = ( x < 0 ) ? 0 : ( ( x >= width ) ? width - 1 : x );
+                    v += in[x] * BLUR_WEIGHTS[s];
+                }
+            }
+            else
+            {
+                for( int s = 0; s < 5; s++ )
+                    v += in[ix + s - 2] * BLUR_WEIGHTS[s];
+            }
+
+            out[ix] = v;
+        }
+    }
+
+    // The vertical pass, on whole rows
+    #ifdef USE_OPENMP
+    #pragma omp parallel for
+    #endif /* USE_OPENMP */
+
+    for( int iy = 0; iy < height; iy++ )
+    {
+        const unsigned short* in[5];
+
+        for( int s = 0; s < 5; s++ )
+        {
+            int y = iy + s - 2;
+
+            y = ( y < 0 ) ? 0 : ( ( y >= height ) ? height - 1 : y );
+            in[s] = &rows[y * width];
+        }
+
+        unsigned char* out = m_pixels + iy * width;
+
+        for( int ix = 0; ix < width; ix++ )
+        {
+            int v = in[0][ix] * BLUR_WEIGHTS[0] + in[1][ix] * BLUR_WEIGHTS[1]
+                  + in[2][ix] * BLUR_WEIGHTS[2] + in[3][ix] * BLUR_WEIGHTS[3]
+                  + in[4][ix] * BLUR_WEIGHTS[4];
+
+            v /= BLUR_DIV;
+
+            CLAMP(v, 0, 255);
+
+            out[ix] = v;
+        }
+    }
+}
+
+
 void CIMAGE::SetPixelsFromNormalizedFloat( const float * aNormalizedFloatArray )
 {
     for( unsigned int i = 0; i < m_wxh; i++ )
@@ -145,6 +145,17 @@ public:
      */
     void EfxFilter( CIMAGE *aInImg, E_FILTER aFilterType );
 
+    /**
+     * Function EfxBlur
+     * apply a blur to the input image and stores it in the image class
+     * this <- Blur(aInImg)
+     * The blur is close to FILTER_GAUSSIAN_BLUR, but done in a horizontal and a vertical
+     * pass of 5 pixels each, instead of one pass of 25 pixels, and without Getpixel()
+     * inside the image.  It is much faster, to blur big images many times.
+     * @param aInImg input image, with the same size as this image
+     */
+    void EfxBlur( const CIMAGE *aInImg );
+
     /**
      * Function SaveAsPNG
      * save image buffer to a PNG file into the working folder.
@@ -0,0 +1,350 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+ /**
+ * @file CVertexBuffer.cpp
+ * @brief triangles stored in OpenGL vertex and index buffers, drawn by ranges
+ */
+
+#include <GL/glew.h>        // must be included before gl.h
+#include <stddef.h>         // For offsetof
+#include <algorithm>
+#include <wx/debug.h>
+#include "CVertexBuffer.h"
+
+
+CVERTEXBUFFER::CVERTEXBUFFER()
+{
+    m_currentRange   = 0;
+    m_currentTexture = 0;
+    m_currentKey     = 0;
+    m_keys.push_back( KEY( m_currentRange, m_currentTexture ) );
+
+    m_current.normal[0]   = 0.0f;
+    m_current.normal[1]   = 0.0f;
+    m_current.normal[2]   = 1.0f;
+    m_current.texCoord[0] = 0.0f;
+    m_current.texCoord[1] = 0.0f;
+    m_current.color[0]    = 255;
+    m_current.color[1]    = 255;
+    m_current.color[2]    = 255;
+    m_current.color[3]    = 255;
+
+    m_mode           = GL_TRIANGLES;
+    m_primitiveStart = 0;
+    m_hasColors      = false;
+    m_triangleCount  = 0;
+
+    m_uploaded       = false;
+    m_vertexBuffer   = 0;
+    m_indexBuffer    = 0;
+}
+
+
+CVERTEXBUFFER::~CVERTEXBUFFER()
+{
+    if( m_vertexBuffer )
+    {
+        glDeleteBuffers( 1, &m_vertexBuffer );
+        glDeleteBuffers( 1, &m_indexBuffer );
+    }
+}
+
+
+void CVERTEXBUFFER::BeginRange( int aRange )
+{
+    m_currentRange = aRange;
+    SetTexture( 0 );
+}
+
+
+void CVERTEXBUFFER::SetTexture( GLuint aTexture )
+{
+    m_currentTexture = aTexture;
+
+    KEY key( m_currentRange, m_currentTexture );
+
+    // There are only a few ranges and textures
+    for( m_currentKey = 0; m_currentKey < m_keys.size(); m_currentKey++ )
+    {
+        if( m_keys[m_currentKey] == key )
+            return;
+    }
+
+    m_keys.push_back( key );
+}
+
+
+void CVERTEXBUFFER::Begin( GLenum aMode )
+{
+    m_mode           = aMode;
+    m_primitiveStart = m_vertices.size();
+}
+
+
+void CVERTEXBUFFER::Color( float aRed, float aGreen, float aBlue, float aAlpha )
+{
+    float color[4] = { aRed, aGreen, aBlue, aAlpha };
+
+    for( int ii = 0; ii < 4; ii++ )
+        m_current.color[ii] = (GLubyte) ( std::min( std::max( color[ii], 0.0f ), 1.0f ) * 255.0f
+                                          + 0.5f );
+
+    m_hasColors = true;
+}
+
+
+void CVERTEXBUFFER::Vertex( float aX, float aY, float aZ )
+{
+    wxASSERT( !m_uploaded );
+
+    m_current.position[0] = aX;
+    m_current.position[1] = aY;
+    m_current.position[2] = aZ;
+
+    m_vertices.push_back( m_current );
+}
+
+
+void CVERTEXBUFFER::addTriangle( unsigned aA, unsigned aB, unsigned aC )
+{
+    m_indices.push_back( m_primitiveStart + aA );
+    m_indices.push_back( m_primitiveStart + aB );
+    m_indices.push_back( m_primitiveStart + aC );
+
+    m_triangleKeys.push_back( m_currentKey );
+    m_triangleCount++;
+}
+
+
+void CVERTEXBUFFER::End()
+{
+    unsigned count = m_vertices.size() - m_primitiveStart;
+    unsigned ii;
+
+    switch( m_mode )
+    {
+    case GL_TRIANGLES:
+        for( ii = 2; ii < count; ii += 3 )
+            addTriangle( ii - 2, ii - 1, ii );
+        break;
+
+    case GL_TRIANGLE_STRIP:
+        // Every other triangle is reversed, to keep the orientation of the strip
+        for( ii = 2; ii < count; ii++ )
+        {
+            if( ii % 2 )
+                addTriangle( ii - 1, ii - 2, ii );
+            else
+                addTriangle( ii - 2, ii - 1, ii );
+        }
+        break;
+
+    case GL_TRIANGLE_FAN:
+    case GL_POLYGON:
+        for( ii = 2; ii < count; ii++ )
+            addTriangle( 0, ii - 1, ii );
+        break;
+
+    case GL_QUADS:
+        for( ii = 3; ii < count; ii += 4 )
+        {
+            addTriangle( ii - 3, ii - 2, ii - 1 );
+            addTriangle( ii - 3, ii - 1, ii );
+        }
+        break;
+
+    case GL_QUAD_STRIP:
+        for( ii = 3; ii < count; ii += 2 )
+        {
+            addTriangle( ii - 3, ii - 2, ii );
+            addTriangle( ii - 3, ii, ii - 1 );
+        }
+        break;
+
+    default:
+        wxFAIL_MSG( wxT( "CVERTEXBUFFER::End(): not a primitive made of triangles" ) );
+        m_vertices.resize( m_primitiveStart );
+        break;
+    }
+}
+
+
+void CVERTEXBUFFER::Upload()
+{
+    wxASSERT( !m_uploaded );
+
+    m_uploaded = true;
+
+    // Sort the triangles by range and texture, so each range is drawn with one call
+    // per texture, even if it was recorded in several times.
+    std::vector< std::pair<KEY, unsigned> > sortedKeys;
+
+    for( unsigned ii = 0; ii < m_keys.size(); ii++ )
+        sortedKeys.push_back( std::make_pair( m_keys[ii], ii ) );
+
+    std::sort( sortedKeys.begin(), sortedKeys.end() );
+
+    std::vector<unsigned> keyCounts( m_keys.size(), 0 );
+
+    for( unsigned ii = 0; ii < m_triangleKeys.size(); ii++ )
+        keyCounts[ m_triangleKeys[ii] ]++;
+
+    std::vector<unsigned> keyOffsets( m_keys.size(), 0 );
+    unsigned offset = 0;
+
+    for( unsigned ii = 0; ii < sortedKeys.size(); ii++ )
+    {
+        unsigned key = sortedKeys[ii].second;
+
+        keyOffsets[key] = offset;
+
+        if( keyCounts[key] )
+        {
+            SEGMENT segment;
+
+            segment.first   = offset * 3;
+            segment.count   = keyCounts[key] * 3;
+            segment.texture = m_keys[key].second;
+
+            m_ranges[ m_keys[key].first ].push_back( segment );
+        }
+
+        offset += keyCounts[key];
+    }
+
+    std::vector<GLuint> sortedIndices( m_indices.size() );
+
+    for( unsigned ii = 0; ii < m_triangleKeys.size(); ii++ )
+    {
+        unsigned dest = keyOffsets[ m_triangleKeys[ii] ]++ * 3;
+
+        sortedIndices[dest]     = m_indices[ii * 3];
+        sortedIndices[dest + 1] = m_indices[ii * 3 + 1];
+        sortedIndices[dest + 2] = m_indices[ii * 3 + 2];
+    }
+
+    m_indices.swap( sortedIndices );
+    std::vector<unsigned>().swap( m_triangleKeys );
+
+    if( m_indices.empty() || !GLEW_VERSION_1_5 )
+        return;
+
+    glGenBuffers( 1, &m_vertexBuffer );
+    glBindBuffer( GL_ARRAY_BUFFER, m_vertexBuffer );
+    glBufferData( GL_ARRAY_BUFFER, m_vertices.size() * sizeof( VERTEX ),
+                  &m_vertices[0], GL_STATIC_DRAW );
+
+    glGenBuffers( 1, &m_indexBuffer );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof( GLuint ),
+                  &m_indices[0], GL_STATIC_DRAW );
+
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+
+    // The graphic card has its own copy
+    std::vector<VERTEX>().swap( m_vertices );
+    std::vector<GLuint>().swap( m_indices );
+}
+
+
+bool CVERTEXBUFFER::HasRange( int aRange ) const
+{
+    return m_ranges.find( aRange ) != m_ranges.end();
+}
+
+
+void CVERTEXBUFFER::setPointers() const
+{
+    const char* base = NULL;
+
+    if( m_vertexBuffer )
+    {
+        glBindBuffer( GL_ARRAY_BUFFER, m_vertexBuffer );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer );
+    }
+    else
+        base = (const char*) &m_vertices[0];
+
+    glEnableClientState( GL_VERTEX_ARRAY );
+    glVertexPointer( 3, GL_FLOAT, sizeof( VERTEX ), base + offsetof( VERTEX, position ) );
+
+    glEnableClientState( GL_NORMAL_ARRAY );
+    glNormalPointer( GL_FLOAT, sizeof( VERTEX ), base + offsetof( VERTEX, normal ) );
+
+    glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+    glTexCoordPointer( 2, GL_FLOAT, sizeof( VERTEX ), base + offsetof( VERTEX, texCoord ) );
+
+    if( m_hasColors )
+    {
+        glEnableClientState( GL_COLOR_ARRAY );
+        glColorPointer( 4, GL_UNSIGNED_BYTE, sizeof( VERTEX ), base + offsetof( VERTEX, color ) );
+    }
+}
+
+
+void CVERTEXBUFFER::DrawRange( int aRange ) const
+{
+    wxASSERT( m_uploaded );
+
+    RANGES::const_iterator range = m_ranges.find( aRange );
+
+    if( range == m_ranges.end() )
+        return;
+
+    setPointers();
+
+    const GLuint* indices = m_vertexBuffer ? NULL : &m_indices[0];
+    bool textured = false;
+
+    for( unsigned ii = 0; ii < range->second.size(); ii++ )
+    {
+        const SEGMENT& segment = range->second[ii];
+
+        if( segment.texture )
+        {
+            glEnable( GL_TEXTURE_2D );
+            glBindTexture( GL_TEXTURE_2D, segment.texture );
+            textured = true;
+        }
+        else
+            glDisable( GL_TEXTURE_2D );
+
+        glDrawElements( GL_TRIANGLES, segment.count, GL_UNSIGNED_INT, indices + segment.first );
+    }
+
+    if( textured )
+        glDisable( GL_TEXTURE_2D );
+
+    glDisableClientState( GL_VERTEX_ARRAY );
+    glDisableClientState( GL_NORMAL_ARRAY );
+    glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+    glDisableClientState( GL_COLOR_ARRAY );
+
+    if( m_vertexBuffer )
+    {
+        glBindBuffer( GL_ARRAY_BUFFER, 0 );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+    }
+}
@@ -0,0 +1,171 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+ /**
+ * @file CVertexBuffer.h
+ * @brief triangles stored in OpenGL vertex and index buffers, drawn by ranges
+ */
+
+#ifndef CVertexBuffer_h
+#define CVertexBuffer_h
+
+#include <map>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <wx/glcanvas.h>     // used only to define the GL types
+
+
+/**
+ * Class CVERTEXBUFFER
+ * stores triangles in a vertex buffer and an index buffer, and draws them by ranges.
+ *
+ * The triangles are recorded like in the immediate mode: Begin(), Normal(), Color(),
+ * TexCoord(), Vertex() and End() take the same parameters as the gl functions.
+ * Each triangle belongs to the range given to the last BeginRange(), e.g. a layer, so
+ * the ranges can be hidden by not drawing them, without recording them again.
+ *
+ * Once recorded, Upload() moves the triangles to the graphic card: the buffer is then
+ * drawn without sending the vertices again at each frame.  If the vertex buffer objects
+ * (OpenGL 1.5) are not available, the triangles are drawn from vertex arrays.
+ *
+ * The OpenGL context must be current when uploading, drawing and deleting the buffer.
+ */
+class CVERTEXBUFFER : public boost::noncopyable
+{
+public:
+    CVERTEXBUFFER();
+    ~CVERTEXBUFFER();
+
+    /**
+     * Function BeginRange
+     * starts recording the triangles of a range, without texture.  A range may be
+     * recorded in several times, the triangles are added to the ones already recorded.
+     * @param aRange = the range identifier, e.g. a layer id.
+     */
+    void BeginRange( int aRange );
+
+    /**
+     * Function SetTexture
+     * sets the texture of the next triangles of the current range.
+     * @param aTexture = the texture created by glGenTextures, or 0 for no texture.
+     */
+    void SetTexture( GLuint aTexture );
+
+    /**
+     * Function Begin
+     * starts a primitive, like glBegin.  Only the primitives made of triangles are
+     * supported: GL_TRIANGLES, GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN, GL_QUADS,
+     * GL_QUAD_STRIP and GL_POLYGON.
+     */
+    void Begin( GLenum aMode );
+
+    /// Ends the current primitive, like glEnd.
+    void End();
+
+    void Normal( float aX, float aY, float aZ )
+    {
+        m_current.normal[0] = aX;
+        m_current.normal[1] = aY;
+        m_current.normal[2] = aZ;
+    }
+
+    void TexCoord( float aS, float aT )
+    {
+        m_current.texCoord[0] = aS;
+        m_current.texCoord[1] = aT;
+    }
+
+    /// Sets the current color.  The colors are stored only if this function is used.
+    void Color( float aRed, float aGreen, float aBlue, float aAlpha );
+
+    void Vertex( float aX, float aY, float aZ );
+
+    /**
+     * Function Upload
+     * moves the recorded triangles to the graphic card.  No triangle can be added after.
+     */
+    void Upload();
+
+    /**
+     * Function HasRange
+     * @return true if triangles were recorded in the range aRange.
+     */
+    bool HasRange( int aRange ) const;
+
+    /**
+     * Function DrawRange
+     * draws the triangles of the range aRange, with the texture of each triangle.
+     * GL_TEXTURE_2D is left disabled if the range has textured triangles.
+     */
+    void DrawRange( int aRange ) const;
+
+    /// @return the count of recorded triangles, for statistics.
+    unsigned GetTriangleCount() const { return m_triangleCount; }
+
+private:
+    struct VERTEX
+    {
+        GLfloat     position[3];
+        GLfloat     normal[3];
+        GLfloat     texCoord[2];
+        GLubyte     color[4];
+    };
+
+    /// Consecutive triangles of a range, drawn with the same texture.
+    struct SEGMENT
+    {
+        unsigned    first;          ///< first index
+        unsigned    count;          ///< count of indices
+        GLuint      texture;
+    };
+
+    typedef std::pair<int, GLuint>              KEY;        ///< a range and a texture
+    typedef std::map<int, std::vector<SEGMENT> > RANGES;
+
+    /// Adds the triangle made of the vertices aA, aB and aC of the current primitive.
+    void addTriangle( unsigned aA, unsigned aB, unsigned aC );
+
+    void setPointers() const;
+
+    int                     m_currentRange;
+    GLuint                  m_currentTexture;
+    unsigned                m_currentKey;       ///< index of the current range and texture
+    std::vector<KEY>        m_keys;
+
+    VERTEX                  m_current;          ///< the next vertex, but its position
+    GLenum                  m_mode;             ///< mode of the current primitive
+    unsigned                m_primitiveStart;   ///< first vertex of the current primitive
+    bool                    m_hasColors;
+
+    std::vector<VERTEX>     m_vertices;         ///< cleared once uploaded to buffers
+    std::vector<GLuint>     m_indices;          ///< sorted by range and texture once uploaded
+    std::vector<unsigned>   m_triangleKeys;     ///< the key of each triangle, until uploaded
+    unsigned                m_triangleCount;
+
+    RANGES                  m_ranges;           ///< built when uploaded
+    bool                    m_uploaded;
+    GLuint                  m_vertexBuffer;     ///< 0 if the vertex buffers are not used
+    GLuint                  m_indexBuffer;
+};
+
+#endif  // CVertexBuffer_h
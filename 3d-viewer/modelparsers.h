@@ -36,6 +36,7 @@
 
 class S3D_MASTER;
 class X3D_MODEL_PARSER;
+class VRML_READER;
 
 /**
  * abstract class S3D_MODEL_PARSER
@@ -173,6 +174,9 @@ public:
      */
     wxString VRML2_representation();
 
+    /// @return true if the loaded file includes other files, with Inline nodes.
+    bool HasInline() const { return m_hasInline; }
+
 private:
     int loadFileModel( S3D_MESH *transformationModel );
     int read_Transform();
@@ -212,7 +216,7 @@ private:
     bool                      m_normalPerVertex;
     bool                      colorPerVertex;
     S3D_MESH*                 m_model;                  ///< It stores the current model that the parsing is adding data
-    FILE*                     m_file;
+    VRML_READER*              m_reader;                 ///< The file being loaded
     wxFileName                m_Filename;
     VRML2_COORDINATE_MAP      m_defCoordinateMap;
     VRML2_DEF_GROUP_MAP       m_defGroupMap;            ///< Stores a list of labels for groups and meshs that will be used later by the USE keyword
@@ -224,6 +228,7 @@ private:
     int                       m_counter_USE_GROUP;      ///< Counts the number of USE * used, in the end, if m_counter_DEF_GROUP > 0 and m_counter_USE_GROUP == 0 then it will add the first group with childs
 
     bool                      m_discardLastGeometry;    ///< If true, it should not store the latest loaded geometry (used to discard IndexedLineSet, but load it)
+    bool                      m_hasInline;              ///< True if an Inline node was read
 };
 
 
@@ -267,7 +272,7 @@ private:
     bool                     m_normalPerVertex;
     bool                     colorPerVertex;
     S3D_MESH*                m_model;
-    FILE*                    m_file;
+    VRML_READER*             m_reader;
     wxString                 m_Filename;
     S3D_MODEL_PARSER*        m_ModelParser;
     S3D_MASTER*              m_Master;
@@ -297,6 +302,25 @@ public:
      * to our internal units.
      */
     bool Load( const wxString& aFilename );
+
+private:
+    /**
+     * Function loadCache
+     * reads the meshes and materials of aFilename from its binary cache, if it exists
+     * and matches the file.
+     * @param aFilename = the full filename of the model file
+     * @return bool - true if the cache was loaded, false if the file must be parsed.
+     */
+    bool loadCache( const wxString& aFilename );
+
+    /**
+     * Function saveCache
+     * writes the loaded meshes and materials to the binary cache of aFilename, if this
+     * file is big enough to be slow to parse.  Errors are ignored, the cache is only
+     * an optimization.
+     * @param aFilename = the full filename of the model file
+     */
+    void saveCache( const wxString& aFilename );
 };
 
 
@@ -30,7 +30,100 @@
 #include "vrml_aux.h"
 
 
-bool GetString( FILE* File, char* aDstString, size_t maxDstLen )
+/// The longest number text, used to read a number at the end of the file
+#define MAX_NUMBER_LEN 64
+
+
+VRML_READER::VRML_READER( const wxString& aFileName ) throw( IO_ERROR ) :
+    m_file( aFileName )
+{
+    m_data = m_file.GetData();
+    m_size = m_file.GetSize();
+    m_pos  = 0;
+}
+
+
+void VRML_READER::skipSeparators()
+{
+    while( m_pos < m_size )
+    {
+        char c = m_data[m_pos];
+
+        if( c == '#' )
+        {
+            while( m_pos < m_size && m_data[m_pos] != '\n' && m_data[m_pos] != '\r' )
+                m_pos++;
+        }
+        else if( c == ' ' || c == ',' || c == '\n' || c == '\r' || c == '\t'
+                 || c == '\f' || c == '\v' )
+        {
+            m_pos++;
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+
+bool VRML_READER::ReadFloat( float* aValue )
+{
+    skipSeparators();
+
+    if( m_pos >= m_size )
+        return false;
+
+    const char* text = m_data + m_pos;
+    char        tail[MAX_NUMBER_LEN + 1];
+
+    // The file is not nul terminated: copy a number at its end
+    if( m_size - m_pos < MAX_NUMBER_LEN )
+    {
+        memcpy( tail, text, m_size - m_pos );
+        tail[m_size - m_pos] = 0;
+        text = tail;
+    }
+
+    char*  end;
+    double value = Strtod_C( text, &end );
+
+    if( end == text )
+        return false;
+
+    *aValue = (float) value;
+    m_pos += end - text;
+
+    return true;
+}
+
+
+bool VRML_READER::ReadInt( int* aValue )
+{
+    skipSeparators();
+
+    size_t pos = m_pos;
+    bool   negative = false;
+
+    if( pos < m_size && ( m_data[pos] == '-' || m_data[pos] == '+' ) )
+        negative = m_data[pos++] == '-';
+
+    if( pos >= m_size || !isdigit( (unsigned char) m_data[pos] ) )
+        return false;
+
+    int value = 0;
+
+    while( pos < m_size && isdigit( (unsigned char) m_data[pos] ) )
+        value = value * 10 + ( m_data[pos++] - '0' );
+
+    *aValue = negative ? -value : value;
+    m_pos = pos;
+
+    return true;
+}
+
+
+bool GetString( VRML_READER* aReader, char* aDstString, size_t maxDstLen )
 {
 
     if( (!aDstString) || (maxDstLen == 0) )
@@ -38,7 +131,7 @@ bool GetString( FILE* File, char* aDstString, size_t maxDstLen )
 
     int c;
 
-    while( ( c = fgetc( File ) ) != EOF )
+    while( ( c = aReader->GetChar() ) != EOF )
     {
         if( c == '\"' )
         {
@@ -51,7 +144,10 @@ bool GetString( FILE* File, char* aDstString, size_t maxDstLen )
         return false;
     }
 
-    while( (( c = fgetc( File ) ) != EOF) && (maxDstLen > 0) )
+    // Keep room for the terminating nul
+    maxDstLen--;
+
+    while( (( c = aReader->GetChar() ) != EOF) && (maxDstLen > 0) )
     {
         if( c == '\"' )
         {
@@ -76,15 +172,15 @@ bool GetString( FILE* File, char* aDstString, size_t maxDstLen )
 }
 
 
-static int SkipGetChar ( FILE* File );
+static int SkipGetChar ( VRML_READER* aReader );
 
 
-static int SkipGetChar( FILE* File )
+static int SkipGetChar( VRML_READER* aReader )
 {
     int    c;
     bool    re_parse;
 
-    if( ( c = fgetc( File ) ) == EOF )
+    if( ( c = aReader->GetChar() ) == EOF )
     {
         // DBG( printf( "EOF\n" ) );
         return EOF;
@@ -101,7 +197,7 @@ static int SkipGetChar( FILE* File )
             // DBG( printf( "Skipping space \\t or { or [\n" ) );
             do
             {
-                if( ( c = fgetc( File ) ) == EOF )
+                if( ( c = aReader->GetChar() ) == EOF )
                 {
                     // DBG( printf( "EOF\n" ) );
 
@@ -117,7 +213,7 @@ static int SkipGetChar( FILE* File )
                 // DBG( printf( "Skipping # \\n or \\r or 0, 0x%02X\n", c ) );
                 do
                 {
-                    if( ( c = fgetc( File ) ) == EOF )
+                    if( ( c = aReader->GetChar() ) == EOF )
                     {
                         // DBG( printf( "EOF\n" ) );
                         return EOF;
@@ -126,7 +222,7 @@ static int SkipGetChar( FILE* File )
             }
             else
             {
-                if( ( c = fgetc( File ) ) == EOF )
+                if( ( c = aReader->GetChar() ) == EOF )
                 {
                     // DBG( printf( "EOF\n" ) );
                     return EOF;
@@ -141,9 +237,9 @@ static int SkipGetChar( FILE* File )
 }
 
 
-bool GetNextTag( FILE* File, char* tag, size_t len )
+bool GetNextTag( VRML_READER* aReader, char* tag, size_t len )
 {
-    int c = SkipGetChar( File );
+    int c = SkipGetChar( aReader );
 
     if( c == EOF )
     {
@@ -156,53 +252,51 @@ bool GetNextTag( FILE* File, char* tag, size_t len )
     // DBG( printf( "tag[0] %c\n", tag[0] ) );
     if( (c != '}') && (c != ']') )
     {
-        len--;
+        // Keep room for the first char and the terminating nul
+        len -= 2;
         char* dst = &tag[1];
 
-        while( fscanf( File, "%c", dst ) && len > 0 )
+        while( len > 0 && ( c = aReader->GetChar() ) != EOF )
         {
-            if( (*dst == ' ') || (*dst == '[') || (*dst == '{')
-                || (*dst == '\t') || (*dst == '\n')|| (*dst == '\r') )
+            if( (c == ' ') || (c == '[') || (c == '{')
+                || (c == '\t') || (c == '\n')|| (c == '\r') )
             {
-                *dst = 0;
                 break;
             }
 
-            dst++;
+            *dst++ = c;
             len--;
         }
 
+        *dst = 0;
 
         // DBG( printf( "tag %s\n", tag ) );
-        c = SkipGetChar( File );
+        c = SkipGetChar( aReader );
 
-        if( c != EOF )
-        {
-            // Puts again the read char in the buffer
-            ungetc( c, File );
-        }
+        // Puts again the read char in the buffer
+        aReader->UngetChar( c );
     }
 
     return true;
 }
 
 
-int Read_NotImplemented( FILE* File, char closeChar )
+int Read_NotImplemented( VRML_READER* aReader, char closeChar )
 {
     int c;
 
     // DBG( printf( "look for %c\n", closeChar) );
-    while( ( c = fgetc( File ) ) != EOF )
+    while( ( c = aReader->GetChar() ) != EOF )
     {
         if( c == '{' )
         {
             // DBG( printf( "{\n") );
-            Read_NotImplemented( File, '}' );
+            Read_NotImplemented( aReader, '}' );
         }
         else if( c == '[' )
         {
             // DBG( printf( "[\n") );
-            Read_NotImplemented( File, ']' );
+            Read_NotImplemented( aReader, ']' );
         }
         else if( c == closeChar )
         {
@@ -216,7 +310,7 @@ int Read_NotImplemented( FILE* File, char closeChar )
 }
 
 
-int ParseVertexList( FILE* File, std::vector<glm::vec3>& dst_vector )
+int ParseVertexList( VRML_READER* aReader, std::vector<glm::vec3>& dst_vector )
 {
     // DBG( printf( "      ParseVertexList\n" ) );
 
@@ -224,7 +318,7 @@ int ParseVertexList( FILE* File, std::vector<glm::vec3>& dst_vector )
 
     glm::vec3 vertex;
 
-    while( ParseVertex( File, vertex ) )
+    while( ParseVertex( aReader, vertex ) )
     {
         dst_vector.push_back( vertex );
     }
@@ -233,38 +327,58 @@ int ParseVertexList( FILE* File, std::vector<glm::vec3>& dst_vector )
 }
 
 
-bool ParseVertex( FILE* File, glm::vec3& dst_vertex )
+void ParseFaceIndexList( VRML_READER* aReader, std::vector< std::vector<int> >& aDstFaces )
 {
-    float   a, b, c;
-    int     ret = fscanf( File, "%e %e %e", &a, &b, &c );
+    aDstFaces.clear();
+
+    std::vector<int> face;
+    int              index;
+
+    while( aReader->ReadInt( &index ) )
+    {
+        if( index == -1 )
+        {
+            aDstFaces.push_back( face );
+            face.clear();
+        }
+        else
+        {
+            face.push_back( index );
+        }
+    }
+}
 
-    dst_vertex.x    = a;
-    dst_vertex.y    = b;
-    dst_vertex.z    = c;
 
-    int s = SkipGetChar( File );
+bool ParseVertex( VRML_READER* aReader, glm::vec3& dst_vertex )
+{
+    int ret = 0;
 
-    if( s != EOF )
+    for( ; ret < 3; ret++ )
     {
-        // Puts again the read char in the buffer
-        ungetc( s, File );
+        if( !aReader->ReadFloat( &dst_vertex[ret] ) )
+            break;
     }
 
+    int s = SkipGetChar( aReader );
+
+    // Puts again the read char in the buffer
+    aReader->UngetChar( s );
+
     // DBG( printf( "ret%d(%.9f,%.9f,%.9f)", ret, a,b,c) );
 
     return ret == 3;
 }
 
 
-bool ParseFloat( FILE* aFile, float *aDstFloat, float aDefaultValue )
+bool ParseFloat( VRML_READER* aReader, float *aDstFloat, float aDefaultValue )
 {
     float   value;
-    int     ret = fscanf( aFile, "%e", &value );
+    bool    ret = aReader->ReadFloat( &value );
 
-    if( ret == 1 )
+    if( ret )
         *aDstFloat = value;
     else
         *aDstFloat = aDefaultValue;
 
-    return ret == 1;
+    return ret;
 }
@@ -38,6 +38,7 @@
 #include <gal/opengl/glm/glm.hpp>
 #include <vector>
 #include <kicad_string.h>
+#include <richio.h>
 #include <info3d_visu.h>
 #ifdef __WXMAC__
 #  ifdef __DARWIN__
@@ -51,63 +52,145 @@
 #include <wx/glcanvas.h>
 
 /**
- * Function GetEpoxyThicknessBIU
+ * Class VRML_READER
+ * reads a VRML file loaded in memory by a MMAP_LINE_READER, char by char or by
+ * numbers, instead of calling fgetc() and fscanf() for each char and number.
+ * The numbers are read without the C library, so they do not depend on the locale.
+ */
+class VRML_READER
+{
+public:
+    /**
+     * Constructor
+     * @param aFileName = the file to read
+     * @throw IO_ERROR if the file cannot be read
+     */
+    VRML_READER( const wxString& aFileName ) throw( IO_ERROR );
+
+    /**
+     * Function GetChar
+     * @return int - the next char, or EOF at the end of the file
+     */
+    int GetChar()
+    {
+        if( m_pos >= m_size )
+            return EOF;
+
+        return (unsigned char) m_data[m_pos++];
+    }
+
+    /**
+     * Function UngetChar
+     * puts back the last char read by GetChar(), like ungetc()
+     * @param aChar = the last char read, nothing is done if it is EOF
+     */
+    void UngetChar( int aChar )
+    {
+        if( aChar != EOF && m_pos > 0 )
+            m_pos--;
+    }
+
+    /**
+     * Function ReadFloat
+     * reads the next number, after the white spaces, commas and comments
+     * @param aValue = where to put the number
+     * @return bool - true if a number was read, false if the next item is not a number,
+     * which is not read
+     */
+    bool ReadFloat( float* aValue );
+
+    /**
+     * Function ReadInt
+     * reads the next integer, after the white spaces, commas and comments
+     * @param aValue = where to put the number
+     * @return bool - true if a number was read, false if the next item is not an integer,
+     * which is not read
+     */
+    bool ReadInt( int* aValue );
+
+    /// @return the content of the file, which may be NULL if the file is empty
+    const char* GetData() const     { return m_data; }
+    size_t GetSize() const          { return m_size; }
+
+private:
+    /// Skips the white spaces, the commas and the comments before a number
+    void skipSeparators();
+
+    MMAP_LINE_READER    m_file;
+    const char*         m_data;
+    size_t              m_size;
+    size_t              m_pos;      ///< position of the next char in m_data
+};
+
+
+/**
+ * Function Read_NotImplemented
  * skip a VRML block and eventualy internal blocks until it find the close char
- * @param File file to read from
+ * @param aReader file to read from
  * @param closeChar the expected close char of the block
  * @return int - -1 if failed, 0 if OK
  */
-int Read_NotImplemented( FILE* File, char closeChar);
+int Read_NotImplemented( VRML_READER* aReader, char closeChar );
 
 
 /**
  * Function ParseVertexList
  * parse a vertex list
- * @param File file to read from
+ * @param aReader file to read from
  * @param dst_vector destination vector list
  * @return int - -1 if failed, 0 if OK
  */
-int ParseVertexList( FILE* File, std::vector< glm::vec3 > &dst_vector);
+int ParseVertexList( VRML_READER* aReader, std::vector< glm::vec3 > &dst_vector );
+
+
+/**
+ * Function ParseFaceIndexList
+ * parse a list of indexes where each face ends with -1, e.g. a coordIndex.
+ * The indexes after the last -1 are ignored.
+ * @param aReader file to read from
+ * @param aDstFaces destination list of the indexes of each face
+ */
+void ParseFaceIndexList( VRML_READER* aReader, std::vector< std::vector<int> >& aDstFaces );
 
 
 /**
  * Function ParseVertex
  * parse a vertex
- * @param File file to read from
+ * @param aReader file to read from
  * @param dst_vertex destination vector
  * @return bool - return true if the 3 elements are read
  */
-bool ParseVertex( FILE* File, glm::vec3 &dst_vertex );
+bool ParseVertex( VRML_READER* aReader, glm::vec3 &dst_vertex );
 
 
 /**
  * Function ParseFloat
  * parse a float value
- * @param aFile file to read from
+ * @param aReader file to read from
  * @param aDstFloat destination float
  * @param aDefaultValue = the default value, when the actual value cannot be read
  * @return bool - Return true if the float was read without error
  */
-bool ParseFloat( FILE* aFile, float *aDstFloat, float aDefaultValue );
+bool ParseFloat( VRML_READER* aReader, float *aDstFloat, float aDefaultValue );
 
 /**
  * Function GetNextTag
  * parse the next tag
- * @param File file to read from
+ * @param aReader file to read from
  * @param tag destination pointer
  * @param len max length of storage
  * @return bool - true if succeeded, false if EOF
  */
-bool GetNextTag( FILE* File, char* tag, size_t len );
+bool GetNextTag( VRML_READER* aReader, char* tag, size_t len );
 
 /**
  * Function GetString
  * parse a string, it expects starting by " and end with "
- * @param File file to read from
+ * @param aReader file to read from
  * @param aDstString destination pointer
  * @param maxDstLen max length of storage
  * @return bool - true if successful read the string, false if failed to get a string
  */
-bool GetString( FILE* File, char* aDstString, size_t maxDstLen );
+bool GetString( VRML_READER* aReader, char* aDstString, size_t maxDstLen );
 
 #endif
@@ -0,0 +1,376 @@
+/**
+ * @file vrml_model_cache.cpp
+ * @brief Binary cache of the big VRML model files, used to load them faster.
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * The cache of <name>.wrl is <name>.wrl-cache.  It contains:
+ *  - a header, with the size, modification time and hash of the model file it was
+ *    made from, and the m_use_modelfile_* options of the shape used to parse it,
+ *    so a cache which does not match the model file is not used;
+ *  - the materials;
+ *  - the meshes, as parsed: points, indexes, colors and normals given by the file.
+ *    The normals computed from the faces depend on the render options, and are
+ *    computed when drawing, like for a parsed file.  A mesh used by several parents
+ *    (VRML USE) is stored once, and referenced by its index;
+ *  - the root meshes.
+ * The cache is read and written with CACHE_READER and CACHE_WRITER.
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <macros.h>
+#include <richio.h>
+
+#include "3d_struct.h"
+#include "modelparsers.h"
+
+#include <wx/filename.h>
+#include <stdint.h>
+#include <cstring>
+#include <map>
+
+
+#define MODEL_CACHE_VERSION     2
+
+/// Smaller model files are fast enough to parse, and do not get a cache.
+static const size_t MODEL_CACHE_MIN_SIZE = 2 * 1024 * 1024;
+
+static const char modelCacheMagic[8] = { 'K', 'I', 'C', 'A', 'D', 'W', 'R', 'L' };
+
+
+/// @return the m_use_modelfile_* options of aMaster, which change the parsed materials.
+static uint32_t parserOptions( const S3D_MASTER* aMaster )
+{
+    return ( aMaster->m_use_modelfile_diffuseColor      ? 1 << 0 : 0 )
+         | ( aMaster->m_use_modelfile_emissiveColor     ? 1 << 1 : 0 )
+         | ( aMaster->m_use_modelfile_specularColor     ? 1 << 2 : 0 )
+         | ( aMaster->m_use_modelfile_ambientIntensity  ? 1 << 3 : 0 )
+         | ( aMaster->m_use_modelfile_transparency      ? 1 << 4 : 0 )
+         | ( aMaster->m_use_modelfile_shininess         ? 1 << 5 : 0 );
+}
+
+
+/**
+ * Function putFaces
+ * puts the faces of aList, as their count, then the size of each face and the indexes.
+ */
+static void putFaces( CACHE_WRITER& aWriter, const std::vector< std::vector<int> >& aList )
+{
+    aWriter.Put<uint32_t>( aList.size() );
+
+    for( unsigned ii = 0; ii < aList.size(); ii++ )
+        aWriter.Put<uint32_t>( aList[ii].size() );
+
+    for( unsigned ii = 0; ii < aList.size(); ii++ )
+    {
+        if( !aList[ii].empty() )
+            aWriter.Put( (const char*) &aList[ii][0], aList[ii].size() * sizeof( int ) );
+    }
+}
+
+
+/**
+ * Function getFaces
+ * gets the faces put by putFaces().
+ */
+static void getFaces( CACHE_READER& aReader, std::vector< std::vector<int> >& aList )
+    throw( IO_ERROR )
+{
+    uint32_t        count = aReader.Get<uint32_t>();
+    const char*     sizes = aReader.Skip( (size_t) count * sizeof( uint32_t ) );
+
+    aList.resize( count );
+
+    for( uint32_t ii = 0; ii < count; ii++ )
+    {
+        uint32_t faceSize;
+
+        memcpy( &faceSize, sizes + ii * sizeof( uint32_t ), sizeof( faceSize ) );
+
+        const char* data = aReader.Skip( (size_t) faceSize * sizeof( int ) );
+
+        aList[ii].resize( faceSize );
+
+        if( faceSize )
+            memcpy( &aList[ii][0], data, (size_t) faceSize * sizeof( int ) );
+    }
+}
+
+
+/**
+ * Function collectMeshes
+ * adds aMesh and its childs to aMeshes, in an order where the childs of a mesh are
+ * before the mesh, each mesh being added once.
+ */
+static void collectMeshes( S3D_MESH* aMesh, std::vector<S3D_MESH*>& aMeshes,
+                           std::map<S3D_MESH*, uint32_t>& aIndexes )
+{
+    if( aIndexes.find( aMesh ) != aIndexes.end() )
+        return;
+
+    for( unsigned ii = 0; ii < aMesh->childs.size(); ii++ )
+    {
+        if( aMesh->childs[ii] )
+            collectMeshes( aMesh->childs[ii], aMeshes, aIndexes );
+    }
+
+    aIndexes[aMesh] = aMeshes.size();
+    aMeshes.push_back( aMesh );
+}
+
+
+bool VRML_MODEL_PARSER::loadCache( const wxString& aFileName )
+{
+    wxString cacheName = CacheFileName( aFileName );
+
+    if( !wxFileName::FileExists( cacheName ) )
+        return false;
+
+    std::vector<S3D_MATERIAL*>  materials;
+    std::vector<S3D_MESH*>      meshes;
+    std::vector<S3D_MESH*>      roots;
+
+    try
+    {
+        MMAP_LINE_READER    cache( cacheName );
+        CACHE_READER        in( cache );
+
+        if( !in.CheckHeader( modelCacheMagic, MODEL_CACHE_VERSION, aFileName )
+            || in.Get<uint32_t>() != parserOptions( GetMaster() ) )
+        {
+            return false;
+        }
+
+        // The materials, created without father: they are given to the shape only
+        // once the whole cache is read.
+        uint32_t materialCount = in.Get<uint32_t>();
+
+        for( uint32_t ii = 0; ii < materialCount; ii++ )
+        {
+            uint32_t        nameSize = in.Get<uint32_t>();
+            const char*     name     = in.Skip( nameSize );
+            S3D_MATERIAL*   material = new S3D_MATERIAL( NULL,
+                                                FROM_UTF8( std::string( name, nameSize ).c_str() ) );
+
+            materials.push_back( material );
+
+            in.GetList( material->m_AmbientColor );
+            in.GetList( material->m_DiffuseColor );
+            in.GetList( material->m_EmissiveColor );
+            in.GetList( material->m_SpecularColor );
+            in.GetList( material->m_Shininess );
+            in.GetList( material->m_Transparency );
+        }
+
+        // The meshes, the childs of a mesh being always before it
+        uint32_t meshCount = in.Get<uint32_t>();
+
+        // The childs are linked at the end, so the meshes can be deleted on error
+        std::vector< std::vector<uint32_t> > meshChilds( meshCount );
+
+        for( uint32_t ii = 0; ii < meshCount; ii++ )
+        {
+            S3D_MESH* mesh = new S3D_MESH();
+
+            meshes.push_back( mesh );
+
+            int32_t material = in.Get<int32_t>();
+
+            if( material >= (int32_t) materialCount )
+                THROW_IO_ERROR( _( "invalid material in model cache" ) );
+
+            if( material >= 0 )
+                mesh->m_Materials = materials[material];
+
+            mesh->m_translation = in.Get<S3D_VERTEX>();
+            mesh->m_rotation    = in.Get<glm::vec4>();
+            mesh->m_scale       = in.Get<S3D_VERTEX>();
+
+            in.GetList( mesh->m_Point );
+            getFaces( in, mesh->m_CoordIndex );
+            getFaces( in, mesh->m_NormalIndex );
+            in.GetList( mesh->m_PerFaceColor );
+            in.GetList( mesh->m_PerFaceNormalsNormalized );
+            in.GetList( mesh->m_PerVertexNormalsNormalized );
+            in.GetList( mesh->m_MaterialIndex );
+            in.GetList( meshChilds[ii] );
+
+            for( unsigned jj = 0; jj < meshChilds[ii].size(); jj++ )
+            {
+                if( meshChilds[ii][jj] >= ii )
+                    THROW_IO_ERROR( _( "invalid mesh in model cache" ) );
+            }
+        }
+
+        std::vector<uint32_t> rootIndexes;
+
+        in.GetList( rootIndexes );
+
+        for( unsigned ii = 0; ii < rootIndexes.size(); ii++ )
+        {
+            if( rootIndexes[ii] >= meshCount )
+                THROW_IO_ERROR( _( "invalid mesh in model cache" ) );
+        }
+
+        // The cache is valid
+        for( uint32_t ii = 0; ii < meshCount; ii++ )
+        {
+            for( unsigned jj = 0; jj < meshChilds[ii].size(); jj++ )
+                meshes[ii]->childs.push_back( meshes[ meshChilds[ii][jj] ] );
+        }
+
+        for( unsigned ii = 0; ii < rootIndexes.size(); ii++ )
+            childs.push_back( meshes[ rootIndexes[ii] ] );
+
+        for( unsigned ii = 0; ii < materials.size(); ii++ )
+        {
+            materials[ii]->SetParent( GetMaster() );
+            GetMaster()->Insert( materials[ii] );
+        }
+
+        return true;
+    }
+    catch( const IO_ERROR& )
+    {
+        // The cache is unusable, the caller parses the model file.
+        // The childs are not linked yet, each mesh is deleted alone.
+        for( unsigned ii = 0; ii < meshes.size(); ii++ )
+            delete meshes[ii];
+
+        for( unsigned ii = 0; ii < materials.size(); ii++ )
+            delete materials[ii];
+
+        return false;
+    }
+}
+
+
+void VRML_MODEL_PARSER::saveCache( const wxString& aFileName )
+{
+    wxString cacheName = CacheFileName( aFileName );
+
+    try
+    {
+        MMAP_LINE_READER modelFile( aFileName );
+
+        if( modelFile.GetSize() < MODEL_CACHE_MIN_SIZE )
+            return;
+
+        CACHE_WRITER out;
+
+        out.PutHeader( modelCacheMagic, MODEL_CACHE_VERSION, modelFile );
+        out.Put<uint32_t>( parserOptions( GetMaster() ) );
+
+        std::vector<S3D_MESH*>          meshes;
+        std::map<S3D_MESH*, uint32_t>   meshIndexes;
+
+        for( unsigned ii = 0; ii < childs.size(); ii++ )
+        {
+            if( childs[ii] )
+                collectMeshes( childs[ii], meshes, meshIndexes );
+        }
+
+        // The materials
+        std::vector<S3D_MATERIAL*>          materials;
+        std::map<S3D_MATERIAL*, int32_t>    materialIndexes;
+
+        for( unsigned ii = 0; ii < meshes.size(); ii++ )
+        {
+            S3D_MATERIAL* material = meshes[ii]->m_Materials;
+
+            if( material && materialIndexes.find( material ) == materialIndexes.end() )
+            {
+                materialIndexes[material] = materials.size();
+                materials.push_back( material );
+            }
+        }
+
+        out.Put<uint32_t>( materials.size() );
+
+        for( unsigned ii = 0; ii < materials.size(); ii++ )
+        {
+            S3D_MATERIAL*   material = materials[ii];
+            std::string     name     = TO_UTF8( material->m_Name );
+
+            out.Put<uint32_t>( name.size() );
+            out.Put( name.data(), name.size() );
+            out.PutList( material->m_AmbientColor );
+            out.PutList( material->m_DiffuseColor );
+            out.PutList( material->m_EmissiveColor );
+            out.PutList( material->m_SpecularColor );
+            out.PutList( material->m_Shininess );
+            out.PutList( material->m_Transparency );
+        }
+
+        // The meshes
+        out.Put<uint32_t>( meshes.size() );
+
+        for( unsigned ii = 0; ii < meshes.size(); ii++ )
+        {
+            S3D_MESH* mesh = meshes[ii];
+
+            out.Put<int32_t>( mesh->m_Materials ? materialIndexes[mesh->m_Materials] : -1 );
+            out.Put<S3D_VERTEX>( mesh->m_translation );
+            out.Put<glm::vec4>( mesh->m_rotation );
+            out.Put<S3D_VERTEX>( mesh->m_scale );
+            out.PutList( mesh->m_Point );
+            putFaces( out, mesh->m_CoordIndex );
+            putFaces( out, mesh->m_NormalIndex );
+            out.PutList( mesh->m_PerFaceColor );
+            out.PutList( mesh->m_PerFaceNormalsNormalized );
+            out.PutList( mesh->m_PerVertexNormalsNormalized );
+            out.PutList( mesh->m_MaterialIndex );
+
+            std::vector<uint32_t> childIndexes;
+
+            for( unsigned jj = 0; jj < mesh->childs.size(); jj++ )
+            {
+                if( mesh->childs[jj] )
+                    childIndexes.push_back( meshIndexes[ mesh->childs[jj] ] );
+            }
+
+            out.PutList( childIndexes );
+        }
+
+        // The root meshes
+        std::vector<uint32_t> rootIndexes;
+
+        for( unsigned ii = 0; ii < childs.size(); ii++ )
+        {
+            if( childs[ii] )
+                rootIndexes.push_back( meshIndexes[ childs[ii] ] );
+        }
+
+        out.PutList( rootIndexes );
+
+        out.Write( cacheName );
+    }
+    catch( const IO_ERROR& )
+    {
+        // The cache is only an optimization, the model file itself is fine.
+    }
+}
@@ -52,7 +52,7 @@ VRML1_MODEL_PARSER::VRML1_MODEL_PARSER( S3D_MODEL_PARSER* aModelParser )
     m_ModelParser = aModelParser;
     m_Master = m_ModelParser->GetMaster();
     m_model = NULL;
-    m_file  = NULL;
+    m_reader = NULL;
     m_normalPerVertex = true;
     colorPerVertex = true;
 }
@@ -69,32 +69,37 @@ bool VRML1_MODEL_PARSER::Load( const wxString& aFilename )
 
     wxLogTrace( traceVrmlV1Parser, wxT( "Loading: %s" ), GetChars( aFilename ) );
 
-    m_file = wxFopen( aFilename, wxT( "rt" ) );
-
-    if( m_file == NULL )
-        return false;
+    try
+    {
+        // The numbers are read without the C library, so the locale is not switched
+        VRML_READER reader( aFilename );
 
-    // Switch the locale to standard C (needed to print floating point numbers)
-    LOCALE_IO toggle;
+        m_reader = &reader;
 
-    m_ModelParser->childs.clear();
+        m_ModelParser->childs.clear();
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
-    {
-        if( ( *text == '}' ) || ( *text == ']' ) )
+        while( GetNextTag( m_reader, text, sizeof(text) ) )
         {
-            continue;
+            if( ( *text == '}' ) || ( *text == ']' ) )
+            {
+                continue;
+            }
+
+            if( strcmp( text, "Separator" ) == 0 )
+            {
+                m_model = new S3D_MESH();
+                m_ModelParser->childs.push_back( m_model );
+                read_separator();
+            }
         }
 
-        if( strcmp( text, "Separator" ) == 0 )
-        {
-            m_model = new S3D_MESH();
-            m_ModelParser->childs.push_back( m_model );
-            read_separator();
-        }
+        m_reader = NULL;
+    }
+    catch( const IO_ERROR& )
+    {
+        m_reader = NULL;
+        return false;
     }
-
-    fclose( m_file );
 
     return true;
 }
@@ -106,7 +111,7 @@ int VRML1_MODEL_PARSER::read_separator()
 
     // DBG( printf( "Separator\n" ) );
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( strcmp( text, "Material" ) == 0 )
         {
@@ -138,7 +143,7 @@ int VRML1_MODEL_PARSER::read_separator()
         else if( ( *text != '}' ) )
         {
             // DBG( printf( "read_NotImplemented %s\n", text ) );
-            Read_NotImplemented( m_file, '}' );
+            Read_NotImplemented( m_reader, '}' );
         }
         else
             break;
@@ -163,7 +168,7 @@ int VRML1_MODEL_PARSER::readMaterial()
 
     m_model->m_Materials = material;
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -212,7 +217,7 @@ int VRML1_MODEL_PARSER::readCoordinate3()
 
     // DBG( printf( "  readCoordinate3\n" ) );
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -241,7 +246,7 @@ int VRML1_MODEL_PARSER::readIndexedFaceSet()
 
     // DBG( printf( "  readIndexedFaceSet\n" ) );
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -272,7 +277,7 @@ int VRML1_MODEL_PARSER::readMaterial_ambientColor()
 {
     // DBG( printf( "    readMaterial_ambientColor\n" ) );
 
-    return ParseVertexList( m_file, m_model->m_Materials->m_AmbientColor );
+    return ParseVertexList( m_reader, m_model->m_Materials->m_AmbientColor );
 }
 
 
@@ -280,7 +285,7 @@ int VRML1_MODEL_PARSER::readMaterial_diffuseColor()
 {
     // DBG( printf( "    readMaterial_diffuseColor\n" ) );
 
-    return ParseVertexList( m_file, m_model->m_Materials->m_DiffuseColor );
+    return ParseVertexList( m_reader, m_model->m_Materials->m_DiffuseColor );
 }
 
 
@@ -288,7 +293,7 @@ int VRML1_MODEL_PARSER::readMaterial_emissiveColor()
 {
     // DBG( printf( "    readMaterial_emissiveColor\n" ) );
 
-    int ret = ParseVertexList( m_file, m_model->m_Materials->m_EmissiveColor );
+    int ret = ParseVertexList( m_reader, m_model->m_Materials->m_EmissiveColor );
 
     if( m_Master->m_use_modelfile_emissiveColor == false )
     {
@@ -303,7 +308,7 @@ int VRML1_MODEL_PARSER::readMaterial_specularColor()
 {
     // DBG( printf( "    readMaterial_specularColor\n" ) );
 
-    int ret = ParseVertexList( m_file, m_model->m_Materials->m_SpecularColor );
+    int ret = ParseVertexList( m_reader, m_model->m_Materials->m_SpecularColor );
 
     if( m_Master->m_use_modelfile_specularColor == false )
     {
@@ -322,7 +327,7 @@ int VRML1_MODEL_PARSER::readMaterial_shininess()
 
     float shininess_value;
 
-    while( fscanf( m_file, "%f,", &shininess_value ) )
+    while( m_reader->ReadFloat( &shininess_value ) )
     {
         // VRML value is normalized and openGL expects a value 0 - 128
         shininess_value = shininess_value * 128.0f;
@@ -348,7 +353,7 @@ int VRML1_MODEL_PARSER::readMaterial_transparency()
 
     float tmp;
 
-    while( fscanf( m_file, "%f,", &tmp ) )
+    while( m_reader->ReadFloat( &tmp ) )
     {
         m_model->m_Materials->m_Transparency.push_back( tmp );
     }
@@ -368,7 +373,7 @@ int VRML1_MODEL_PARSER::readCoordinate3_point()
 {
     // DBG( printf( "    readCoordinate3_point\n" ) );
 
-    if( ParseVertexList( m_file, m_model->m_Point ) == 0 )
+    if( ParseVertexList( m_reader, m_model->m_Point ) == 0 )
     {
         return 0;
     }
@@ -388,7 +393,8 @@ int VRML1_MODEL_PARSER::readIndexedFaceSet_coordIndex()
 
     int dummy;    // should be -1
 
-    while( fscanf( m_file, "%d,%d,%d,%d,", &coord[0], &coord[1], &coord[2], &dummy ) )
+    while( m_reader->ReadInt( &coord[0] ) && m_reader->ReadInt( &coord[1] )
+           && m_reader->ReadInt( &coord[2] ) && m_reader->ReadInt( &dummy ) )
     {
         std::vector<int> coord_list;
 
@@ -426,7 +432,7 @@ int VRML1_MODEL_PARSER::readIndexedFaceSet_materialIndex()
 
     int index;
 
-    while( fscanf( m_file, "%d,", &index ) )
+    while( m_reader->ReadInt( &index ) )
     {
         m_model->m_MaterialIndex.push_back( index );
     }
@@ -55,13 +55,14 @@ VRML2_MODEL_PARSER::VRML2_MODEL_PARSER( S3D_MODEL_PARSER* aModelParser )
     m_ModelParser = aModelParser;
     m_Master = m_ModelParser->GetMaster();
     m_model = NULL;
-    m_file = NULL;
+    m_reader = NULL;
     m_normalPerVertex = true;
     colorPerVertex = true;
     m_debugSpacer = "";
     m_counter_DEF_GROUP = 0;
     m_counter_USE_GROUP = 0;
     m_discardLastGeometry = false;
+    m_hasInline = false;
 }
 
 
@@ -81,63 +82,37 @@ void VRML2_MODEL_PARSER::debug_exit()
 
 bool VRML2_MODEL_PARSER::Load( const wxString& aFilename )
 {
-    wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "Loading: %s" ), GetChars( aFilename ) );
-    debug_enter();
-
-    m_file = wxFopen( aFilename, wxT( "rt" ) );
-
-    if( m_file == NULL )
-    {
-        debug_exit();
-        wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "Failed to open file: %s" ), GetChars( aFilename ) );
-        return false;
-    }
-
-    m_Filename = aFilename;
-
-    // Switch the locale to standard C (needed to print floating point numbers)
-    LOCALE_IO toggle;
-
-    loadFileModel( NULL );
-
-    fclose( m_file );
-
-    debug_exit();
-    return true;
+    return Load( aFilename, NULL );
 }
 
 
 bool VRML2_MODEL_PARSER::Load( const wxString& aFilename, S3D_MESH *aTransformationModel )
 {
-    if( aTransformationModel )
-    {
-        wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "Loading: %s" ), GetChars( aFilename ) );
-        debug_enter();
-
-        m_file = wxFopen( aFilename, wxT( "rt" ) );
+    wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "Loading: %s" ), GetChars( aFilename ) );
+    debug_enter();
 
-        if( m_file == NULL )
-        {
-            debug_exit();
-            wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "Failed to open file: %s" ), GetChars( aFilename ) );
-            return false;
-        }
+    try
+    {
+        // The numbers are read without the C library, so the locale is not switched
+        VRML_READER reader( aFilename );
 
+        m_reader   = &reader;
         m_Filename = aFilename;
 
-        // Switch the locale to standard C (needed to print floating point numbers)
-        LOCALE_IO toggle;
-
         loadFileModel( aTransformationModel );
 
-        fclose( m_file );
-
+        m_reader = NULL;
+    }
+    catch( const IO_ERROR& )
+    {
+        m_reader = NULL;
         debug_exit();
-        return true;
+        wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "Failed to open file: %s" ), GetChars( aFilename ) );
+        return false;
     }
 
     debug_exit();
-    return false;
+    return true;
 }
 
 
@@ -147,7 +122,7 @@ int VRML2_MODEL_PARSER::loadFileModel( S3D_MESH *aTransformationModel )
 
     debug_enter();
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( ( *text == '}' ) || ( *text == ']' ) )
         {
@@ -310,7 +285,7 @@ int VRML2_MODEL_PARSER::read_Transform()
 
     char text[BUFLINE_SIZE];
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -357,7 +332,7 @@ int VRML2_MODEL_PARSER::read_Transform()
         }
         else if( strcmp( text, "translation" ) == 0 )
         {
-            ParseVertex( m_file, m_model->m_translation );
+            ParseVertex( m_reader, m_model->m_translation );
 
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "translation (%f,%f,%f)" ),
                                           m_model->m_translation.x,
@@ -366,10 +341,10 @@ int VRML2_MODEL_PARSER::read_Transform()
         }
         else if( strcmp( text, "rotation" ) == 0 )
         {
-            if( fscanf( m_file, "%f %f %f %f", &m_model->m_rotation[0],
-                        &m_model->m_rotation[1],
-                        &m_model->m_rotation[2],
-                        &m_model->m_rotation[3] ) != 4 )
+            if( !m_reader->ReadFloat( &m_model->m_rotation[0] )
+                || !m_reader->ReadFloat( &m_model->m_rotation[1] )
+                || !m_reader->ReadFloat( &m_model->m_rotation[2] )
+                || !m_reader->ReadFloat( &m_model->m_rotation[3] ) )
             {
                 m_model->m_rotation[0]  = 0.0f;
                 m_model->m_rotation[1]  = 0.0f;
@@ -391,7 +366,7 @@ int VRML2_MODEL_PARSER::read_Transform()
         }
         else if( strcmp( text, "scale" ) == 0 )
         {
-            ParseVertex( m_file, m_model->m_scale );
+            ParseVertex( m_reader, m_model->m_scale );
 
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "scale (%f,%f,%f)" ), m_model->m_scale.x, m_model->m_scale.y, m_model->m_scale.z );
         }
@@ -400,10 +375,10 @@ int VRML2_MODEL_PARSER::read_Transform()
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "scaleOrientation is not implemented, but it will be parsed" ) );
 
             glm::vec4 vecDummy;
-            if( fscanf( m_file, "%f %f %f %f", &vecDummy[0],
-                        &vecDummy[1],
-                        &vecDummy[2],
-                        &vecDummy[3] ) != 4 )
+            if( !m_reader->ReadFloat( &vecDummy[0] )
+                || !m_reader->ReadFloat( &vecDummy[1] )
+                || !m_reader->ReadFloat( &vecDummy[2] )
+                || !m_reader->ReadFloat( &vecDummy[3] ) )
             {
                 vecDummy[0]  = 0.0f;
                 vecDummy[1]  = 0.0f;
@@ -423,7 +398,7 @@ int VRML2_MODEL_PARSER::read_Transform()
         {
             // this is not used
             glm::vec3 vecDummy;
-            ParseVertex( m_file, vecDummy );
+            ParseVertex( m_reader, vecDummy );
 
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "center is not implemented (%f,%f,%f)" ), vecDummy.x, vecDummy.y, vecDummy.z );
         }
@@ -439,7 +414,7 @@ int VRML2_MODEL_PARSER::read_Transform()
         {
             int dummy;
 
-            if( fscanf( m_file, "%d", &dummy ) != 1 )
+            if( !m_reader->ReadInt( &dummy ) )
             {
                 // !TODO: log errors
             }
@@ -516,7 +491,7 @@ int VRML2_MODEL_PARSER::read_Transform()
         {
             char useLabel[BUFLINE_SIZE];
 
-            if( GetNextTag( m_file, useLabel, sizeof(useLabel) ) )
+            if( GetNextTag( m_reader, useLabel, sizeof(useLabel) ) )
             {
                 // Check if a ',' is at the end and remove it
                 if( useLabel[strlen(useLabel) - 1] == ',' )
@@ -573,7 +548,7 @@ int VRML2_MODEL_PARSER::read_Transform()
         else
         {
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_Transform: %s NotImplemented" ), text );
-            Read_NotImplemented( m_file, '}' );
+            Read_NotImplemented( m_reader, '}' );
         }
     }
 
@@ -588,9 +563,11 @@ int VRML2_MODEL_PARSER::read_Inline()
     wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_Inline" ) );
     debug_enter();
 
+    m_hasInline = true;
+
     char text[BUFLINE_SIZE];
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
             continue;
@@ -604,7 +581,7 @@ int VRML2_MODEL_PARSER::read_Inline()
 
         if( strcmp( text, "url" ) == 0 )
         {
-            if( GetString( m_file, text, sizeof(text) ) )
+            if( GetString( m_reader, text, sizeof(text) ) )
             {
                 wxString filename;
                 filename = filename.FromUTF8( text );
@@ -678,7 +655,7 @@ int VRML2_MODEL_PARSER::read_DEF_Coordinate()
     char text[BUFLINE_SIZE];
 
     // Get the name of the definition.
-    if( !GetNextTag( m_file, text, sizeof(text) ) )
+    if( !GetNextTag( m_reader, text, sizeof(text) ) )
     {
         debug_exit();
         wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_DEF_Coordinate failed to get next tag" ) );
@@ -687,7 +664,7 @@ int VRML2_MODEL_PARSER::read_DEF_Coordinate()
 
     std::string coordinateName = text;
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
             continue;
@@ -728,14 +705,14 @@ int VRML2_MODEL_PARSER::read_DEF()
     char text[BUFLINE_SIZE];
     char tagName[BUFLINE_SIZE];
 
-    if( !GetNextTag( m_file, tagName, sizeof(tagName) ) )
+    if( !GetNextTag( m_reader, tagName, sizeof(tagName) ) )
     {
         debug_exit();
         wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "DEF failed GetNextTag first" ) );
         return -1;
     }
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -862,7 +839,7 @@ int VRML2_MODEL_PARSER::read_DEF()
         {
             debug_exit();
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_DEF %s %s NotImplemented, skipping." ), tagName, text );
-            Read_NotImplemented( m_file, '}' );
+            Read_NotImplemented( m_reader, '}' );
             return 0;
         }
     }
@@ -881,7 +858,7 @@ int VRML2_MODEL_PARSER::read_IndexedFaceSet_USE()
     char text[BUFLINE_SIZE];
 
     // Get the name of the definition.
-    if( !GetNextTag( m_file, text, sizeof(text) ) )
+    if( !GetNextTag( m_reader, text, sizeof(text) ) )
     {
         debug_exit();
         wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_IndexedFaceSet_USE failed to get next tag" ) );
@@ -918,7 +895,7 @@ int VRML2_MODEL_PARSER::read_Shape()
 
     char text[BUFLINE_SIZE];
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -953,7 +930,7 @@ int VRML2_MODEL_PARSER::read_Shape()
         else
         {
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_Shape %s NotImplemented" ), text );
-            Read_NotImplemented( m_file, '}' );
+            Read_NotImplemented( m_reader, '}' );
         }
     }
 
@@ -972,7 +949,7 @@ int VRML2_MODEL_PARSER::read_geometry()
     char tagName[BUFLINE_SIZE];
     tagName[0] = 0;
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -988,7 +965,7 @@ int VRML2_MODEL_PARSER::read_geometry()
 
         if( strcmp( text, "DEF" ) == 0 )
         {
-            if( !GetNextTag( m_file, tagName, sizeof(tagName) ) )
+            if( !GetNextTag( m_reader, tagName, sizeof(tagName) ) )
             {
                 debug_exit();
                 wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "DEF failed GetNextTag first" ) );
@@ -1014,7 +991,7 @@ int VRML2_MODEL_PARSER::read_geometry()
         else
         {
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_geometry: %s NotImplemented" ), text );
-            int ret = Read_NotImplemented( m_file, '}' );
+            int ret = Read_NotImplemented( m_reader, '}' );
             debug_exit();
             wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_geometry exit, after %s" ), text);
             return ret;
@@ -1035,7 +1012,7 @@ int VRML2_MODEL_PARSER::read_appearance()
     S3D_MATERIAL* material = NULL;
     char text[BUFLINE_SIZE];
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -1057,7 +1034,7 @@ int VRML2_MODEL_PARSER::read_appearance()
         }
         else if( strcmp( text, "DEF" ) == 0 )
         {
-            if( GetNextTag( m_file, text, sizeof(text) ) )
+            if( GetNextTag( m_reader, text, sizeof(text) ) )
             {
                 wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_appearance adding new material %s" ), text );
 
@@ -1068,7 +1045,7 @@ int VRML2_MODEL_PARSER::read_appearance()
                 m_Master->Insert( material );
                 m_model->m_Materials = material;
 
-                if( GetNextTag( m_file, text, sizeof(text) ) )
+                if( GetNextTag( m_reader, text, sizeof(text) ) )
                 {
                     if( strcmp( text, "Appearance" ) == 0 )
                     {
@@ -1084,7 +1061,7 @@ int VRML2_MODEL_PARSER::read_appearance()
         }
         else if( strcmp( text, "USE" ) == 0 )
         {
-            if( GetNextTag( m_file, text, sizeof(text) ) )
+            if( GetNextTag( m_reader, text, sizeof(text) ) )
             {
                 wxString mat_name;
                 mat_name = FROM_UTF8( text );
@@ -1133,7 +1110,7 @@ int VRML2_MODEL_PARSER::read_Appearance()
 
     char text[BUFLINE_SIZE];
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -1167,7 +1144,7 @@ int VRML2_MODEL_PARSER::read_material()
     S3D_MATERIAL* material = NULL;
     char text[BUFLINE_SIZE];
 
-    if( GetNextTag( m_file, text, sizeof(text) ) )
+    if( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( strcmp( text, "Material" ) == 0 )
         {
@@ -1187,7 +1164,7 @@ int VRML2_MODEL_PARSER::read_material()
         }
         else if( strcmp( text, "DEF" ) == 0 )
         {
-            if( GetNextTag( m_file, text, sizeof(text) ) )
+            if( GetNextTag( m_reader, text, sizeof(text) ) )
             {
                 wxString mat_name;
                 mat_name = FROM_UTF8( text );
@@ -1196,7 +1173,7 @@ int VRML2_MODEL_PARSER::read_material()
                 m_Master->Insert( material );
                 m_model->m_Materials = material;
 
-                if( GetNextTag( m_file, text, sizeof(text) ) )
+                if( GetNextTag( m_reader, text, sizeof(text) ) )
                 {
                     if( strcmp( text, "Material" ) == 0 )
                     {
@@ -1209,7 +1186,7 @@ int VRML2_MODEL_PARSER::read_material()
         }
         else if( strcmp( text, "USE" ) == 0 )
         {
-            if( GetNextTag( m_file, text, sizeof(text) ) )
+            if( GetNextTag( m_reader, text, sizeof(text) ) )
             {
                 wxString mat_name;
                 mat_name = FROM_UTF8( text );
@@ -1243,7 +1220,7 @@ int VRML2_MODEL_PARSER::read_Material()
     char text[BUFLINE_SIZE];
     glm::vec3 vertex;
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -1259,12 +1236,12 @@ int VRML2_MODEL_PARSER::read_Material()
 
         if( strcmp( text, "diffuseColor" ) == 0 )
         {
-            ParseVertex( m_file, vertex );
+            ParseVertex( m_reader, vertex );
             m_model->m_Materials->m_DiffuseColor.push_back( vertex );
         }
         else if( strcmp( text, "emissiveColor" ) == 0 )
         {
-            ParseVertex( m_file, vertex );
+            ParseVertex( m_reader, vertex );
 
             if( m_Master->m_use_modelfile_emissiveColor == true )
             {
@@ -1273,7 +1250,7 @@ int VRML2_MODEL_PARSER::read_Material()
         }
         else if( strcmp( text, "specularColor" ) == 0 )
         {
-            ParseVertex( m_file, vertex );
+            ParseVertex( m_reader, vertex );
 
             if( m_Master->m_use_modelfile_specularColor == true )
             {
@@ -1283,7 +1260,7 @@ int VRML2_MODEL_PARSER::read_Material()
         else if( strcmp( text, "ambientIntensity" ) == 0 )
         {
             float ambientIntensity;
-            ParseFloat( m_file, &ambientIntensity, 0.8 );
+            ParseFloat( m_reader, &ambientIntensity, 0.8 );
 
             if( m_Master->m_use_modelfile_ambientIntensity == true )
             {
@@ -1294,7 +1271,7 @@ int VRML2_MODEL_PARSER::read_Material()
         else if( strcmp( text, "transparency" ) == 0 )
         {
             float transparency;
-            ParseFloat( m_file, &transparency, 0.0 );
+            ParseFloat( m_reader, &transparency, 0.0 );
 
             if( m_Master->m_use_modelfile_transparency == true )
             {
@@ -1304,7 +1281,7 @@ int VRML2_MODEL_PARSER::read_Material()
         else if( strcmp( text, "shininess" ) == 0 )
         {
             float shininess;
-            ParseFloat( m_file, &shininess, 1.0 );
+            ParseFloat( m_reader, &shininess, 1.0 );
 
             // VRML value is normalized and openGL expects a value 0 - 128
             if( m_Master->m_use_modelfile_shininess == true )
@@ -1331,7 +1308,7 @@ int VRML2_MODEL_PARSER::read_IndexedFaceSet()
     m_normalPerVertex = false;
     colorPerVertex = false;
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -1347,7 +1324,7 @@ int VRML2_MODEL_PARSER::read_IndexedFaceSet()
 
         if( strcmp( text, "normalPerVertex" ) == 0 )
         {
-            if( GetNextTag( m_file, text, sizeof(text) ) )
+            if( GetNextTag( m_reader, text, sizeof(text) ) )
             {
                 if( strcmp( text, "TRUE" ) == 0 )
                 {
@@ -1357,7 +1334,7 @@ int VRML2_MODEL_PARSER::read_IndexedFaceSet()
         }
         else if( strcmp( text, "colorPerVertex" ) == 0 )
         {
-            GetNextTag( m_file, text, sizeof(text) );
+            GetNextTag( m_reader, text, sizeof(text) );
 
             if( strcmp( text, "TRUE" ) )
             {
@@ -1411,7 +1388,7 @@ int VRML2_MODEL_PARSER::read_IndexedLineSet()
 
     char text[BUFLINE_SIZE];
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
             continue;
@@ -1449,7 +1426,7 @@ int VRML2_MODEL_PARSER::read_colorIndex()
         int index;
         int first_index;
 
-        while( fscanf( m_file, "%d, ", &index ) )
+        while( m_reader->ReadInt( &index ) )
         {
             if( index == -1 )
             {
@@ -1466,7 +1443,7 @@ int VRML2_MODEL_PARSER::read_colorIndex()
     {
         int index;
 
-        while( fscanf( m_file, "%d,", &index ) )
+        while( m_reader->ReadInt( &index ) )
         {
             m_model->m_MaterialIndex.push_back( index );
         }
@@ -1483,27 +1460,7 @@ int VRML2_MODEL_PARSER::read_NormalIndex()
     wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_NormalIndex" ) );
     debug_enter();
 
-    m_model->m_NormalIndex.clear();
-
-    glm::ivec3 coord;
-
-    int dummy;    // should be -1
-
-    std::vector<int> coord_list;
-    coord_list.clear();
-
-    while( fscanf( m_file, "%d, ", &dummy ) == 1 )
-    {
-        if( dummy == -1 )
-        {
-            m_model->m_NormalIndex.push_back( coord_list );
-            coord_list.clear();
-        }
-        else
-        {
-            coord_list.push_back( dummy );
-        }
-    }
+    ParseFaceIndexList( m_reader, m_model->m_NormalIndex );
 
     //wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_NormalIndex m_NormalIndex.size: %u" ), (unsigned int)m_model->m_NormalIndex.size() );
     debug_exit();
@@ -1516,27 +1473,7 @@ int VRML2_MODEL_PARSER::read_coordIndex()
     wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_coordIndex" ) );
     debug_enter();
 
-    m_model->m_CoordIndex.clear();
-
-    glm::ivec3 coord;
-
-    int dummy;    // should be -1
-
-    std::vector<int> coord_list;
-    coord_list.clear();
-
-    while( fscanf( m_file, "%d, ", &dummy ) == 1 )
-    {
-        if( dummy == -1 )
-        {
-            m_model->m_CoordIndex.push_back( coord_list );
-            coord_list.clear();
-        }
-        else
-        {
-            coord_list.push_back( dummy );
-        }
-    }
+    ParseFaceIndexList( m_reader, m_model->m_CoordIndex );
 
     wxLogTrace( traceVrmlV2Parser, m_debugSpacer + wxT( "read_coordIndex m_CoordIndex.size: %lu" ), m_model->m_CoordIndex.size() );
     debug_exit();
@@ -1551,7 +1488,7 @@ int VRML2_MODEL_PARSER::read_Color()
 
     char text[BUFLINE_SIZE];
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -1567,7 +1504,7 @@ int VRML2_MODEL_PARSER::read_Color()
 
         if( strcmp( text, "color" ) == 0 )
         {
-            ParseVertexList( m_file, m_model->m_Materials->m_DiffuseColor );
+            ParseVertexList( m_reader, m_model->m_Materials->m_DiffuseColor );
         }
     }
 
@@ -1584,7 +1521,7 @@ int VRML2_MODEL_PARSER::read_Normal()
 
     char text[BUFLINE_SIZE];
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -1607,11 +1544,11 @@ int VRML2_MODEL_PARSER::read_Normal()
         {
             if( m_normalPerVertex == false )
             {
-                ParseVertexList( m_file, m_model->m_PerFaceNormalsNormalized );
+                ParseVertexList( m_reader, m_model->m_PerFaceNormalsNormalized );
             }
             else
             {
-                ParseVertexList( m_file, m_model->m_PerVertexNormalsNormalized );
+                ParseVertexList( m_reader, m_model->m_PerVertexNormalsNormalized );
             }
         }
     }
@@ -1628,7 +1565,7 @@ int VRML2_MODEL_PARSER::read_Coordinate()
 
     char text[BUFLINE_SIZE];
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
         {
@@ -1645,7 +1582,7 @@ int VRML2_MODEL_PARSER::read_Coordinate()
 
         if( strcmp( text, "point" ) == 0 )
         {
-            ParseVertexList( m_file, m_model->m_Point );
+            ParseVertexList( m_reader, m_model->m_Point );
         }
     }
 
@@ -1664,7 +1601,7 @@ int VRML2_MODEL_PARSER::read_CoordinateDef()
 
     char text[BUFLINE_SIZE];
 
-    while( GetNextTag( m_file, text, sizeof(text) ) )
+    while( GetNextTag( m_reader, text, sizeof(text) ) )
     {
         if( *text == ']' )
             continue;
@@ -1678,7 +1615,7 @@ int VRML2_MODEL_PARSER::read_CoordinateDef()
         }
 
         if( strcmp( text, "point" ) == 0 )
-            ParseVertexList( m_file, m_model->m_Point );
+            ParseVertexList( m_reader, m_model->m_Point );
     }
 
     debug_exit();
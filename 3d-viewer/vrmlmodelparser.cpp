@@ -79,15 +79,27 @@ bool VRML_MODEL_PARSER::Load( const wxString& aFilename )
 
     if( stricmp( line, "#VRML V2.0" ) == 0 )
     {
+        if( loadCache( aFilename ) )
+            return true;
+
         VRML2_MODEL_PARSER *vrml2_parser = new VRML2_MODEL_PARSER( this );
         vrml2_parser->Load( aFilename );
+
+        // The cache cannot tell if the included files were modified
+        if( !vrml2_parser->HasInline() )
+            saveCache( aFilename );
+
         delete vrml2_parser;
         return true;
     }
     else if( stricmp( line, "#VRML V1.0" ) == 0 )
     {
+        if( loadCache( aFilename ) )
+            return true;
+
         VRML1_MODEL_PARSER *vrml1_parser = new VRML1_MODEL_PARSER( this );
         vrml1_parser->Load( aFilename );
+        saveCache( aFilename );
         delete vrml1_parser;
         return true;
     }
@@ -69,6 +69,9 @@
 /// When defined, build the GITHUB_PLUGIN for pcbnew.
 #cmakedefine BUILD_GITHUB_PLUGIN
 
+/// When defined, the 3D view of boards can be rendered offscreen, with EGL.
+#cmakedefine KICAD_3D_OFFSCREEN
+
 /// When defined, use KIWAY and KIFACE DSOs
 #cmakedefine USE_KIWAY_DLLS
 
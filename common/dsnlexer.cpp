@@ -80,6 +80,7 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    mmapReader( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -96,6 +97,7 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    mmapReader( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -113,6 +115,7 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    mmapReader( NULL ),
     keywords( aKeywordTable ),
     keywordCount( aKeywordCount )
 {
@@ -130,6 +133,7 @@ DSNLEXER::DSNLEXER( const std::string& aSExpression, const wxString& aSource ) :
     next( NULL ),
     limit( NULL ),
     reader( NULL ),
+    mmapReader( NULL ),
     keywords( empty_keywords ),
     keywordCount( 0 )
 {
@@ -193,6 +197,7 @@ void DSNLEXER::PushReader( LINE_READER* aLineReader )
 {
     readerStack.push_back( aLineReader );
     reader = aLineReader;
+    mmapReader = dynamic_cast<MMAP_LINE_READER*>( reader );
     start  = (const char*) (*reader);
 
     // force a new readLine() as first thing.
@@ -213,6 +218,7 @@ LINE_READER* DSNLEXER::PopReader()
         if( readerStack.size() )
         {
             reader = readerStack.back();
+            mmapReader = dynamic_cast<MMAP_LINE_READER*>( reader );
             start  = reader->Line();
 
             // force a new readLine() as first thing.
@@ -222,6 +228,7 @@ LINE_READER* DSNLEXER::PopReader()
         else
         {
             reader = 0;
+            mmapReader = 0;
             start  = dummy;
             limit  = dummy;
             limit  = dummy;
@@ -659,7 +666,7 @@ L_read:
                     case 'v':   c = '\x0b';     break;
 
                     case 'x':   // 1 or 2 byte hex escape sequence
-                        for( i=0; i<2; ++i )
+                        for( i=0; i<2 && head+i<limit; ++i )
                         {
                             if( !isxdigit( head[i] ) )
                                 break;
@@ -675,7 +682,7 @@ L_read:
 
                     default:    // 1-3 byte octal escape sequence
                         --head;
-                        for( i=0; i<3; ++i )
+                        for( i=0; i<3 && head+i<limit; ++i )
                         {
                             if( head[i] < '0' || head[i] > '7' )
                                 break;
@@ -781,11 +788,11 @@ L_read:
     }           // specctraMode
 
     // non-quoted token, read it into curText.
-    curText.clear();
-
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.assign( cur, head );
 
     if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
     {
@@ -28,8 +28,6 @@
  */
 
 
-#define USE_WORKER_THREADS      1       // 1:yes, 0:no. use worker thread to load libraries
-
 /*
  * Functions to read footprint libraries and fill m_footprints by available footprints names
  * and their documentation (comments and keywords)
@@ -45,7 +43,16 @@
 #include <fp_lib_table.h>
 #include <fpid.h>
 #include <class_module.h>
-#include <boost/thread.hpp>
+#include <pcb_parser.h>
+#include <richio.h>
+#include <dsnlexer.h>
+#include <thread_pool.h>
+#include <boost/bind.hpp>
+
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <map>
+#include <set>
 
 
 /*
@@ -93,6 +100,305 @@ static wxString ToHTMLFragment( const IO_ERROR* aDerivative )
 */
 
 
+/// File name of the footprint index, in the KiCad configuration directory.
+static const wxChar footprintIndexFileName[] = wxT( "fp-info-index" );
+
+#define FOOTPRINT_INDEX_VERSION     1
+
+static KEYWORD empty_keywords[1] = {};
+
+
+/**
+ * Class FOOTPRINT_INFO_INDEX
+ * is the on-disk index of the FOOTPRINT_INFO fields of the footprints read so far.
+ * Footprints are keyed by library path and footprint name, and stamped with the
+ * modification time and size of the file they were read from: the .kicad_mod file for
+ * the KiCad libraries, or the library file for the single file libraries.
+ * It is shared by the worker threads of FOOTPRINT_LIST::ReadFootprintFiles().
+ */
+class FOOTPRINT_INFO_INDEX
+{
+public:
+    struct STAMP
+    {
+        long    mtime;
+        long    size;
+
+        bool operator==( const STAMP& aOther ) const
+        {
+            return mtime == aOther.mtime && size == aOther.size;
+        }
+    };
+
+    struct ENTRY
+    {
+        STAMP       stamp;
+        int         padCount;
+        wxString    doc;
+        wxString    keywords;
+        bool        used;           ///< found or added by the current read
+    };
+
+    typedef std::pair<wxString, wxString>           KEY;    ///< library path, footprint name
+    typedef std::map<KEY, ENTRY>                    ENTRIES;
+
+    FOOTPRINT_INFO_INDEX() :
+        m_modified( false )
+    {
+    }
+
+    /**
+     * Function GetStamp
+     * @return the stamp of the file @a aFileName.  The stamp of a missing file
+     *         does not match the stamp of any existing file.
+     */
+    static STAMP GetStamp( const wxString& aFileName )
+    {
+        wxStructStat    st;
+        STAMP           stamp;
+
+        if( wxStat( aFileName, &st ) != 0 )
+        {
+            stamp.mtime = -1;
+            stamp.size  = -1;
+        }
+        else
+        {
+            stamp.mtime = (long) st.st_mtime;
+            stamp.size  = (long) st.st_size;
+        }
+
+        return stamp;
+    }
+
+    /**
+     * Function Load
+     * reads the index file @a aFileName.  A missing or invalid index file gives
+     * an empty index.
+     */
+    void Load( const wxString& aFileName );
+
+    /**
+     * Function Save
+     * writes the index to @a aFileName if it changed, without the footprints
+     * which were not found any more in the libraries read since Load(), and
+     * without the libraries which are not in the library table any more.
+     * @param aTableLibs is the set of the paths of the libraries of the library table.
+     */
+    void Save( const wxString& aFileName, const std::set<wxString>& aTableLibs );
+
+    /**
+     * Function Find
+     * gets in @a aEntry the index entry of the footprint @a aFpName of the library
+     * @a aLibPath, if it was read from a file with the stamp @a aStamp.
+     * @return bool - true if the entry was found.
+     */
+    bool Find( const wxString& aLibPath, const wxString& aFpName, const STAMP& aStamp,
+               ENTRY* aEntry )
+    {
+        MUTLOCK lock( m_lock );
+
+        ENTRIES::iterator it = m_entries.find( KEY( aLibPath, aFpName ) );
+
+        if( it == m_entries.end() || !( it->second.stamp == aStamp ) )
+            return false;
+
+        it->second.used = true;
+        *aEntry = it->second;
+
+        return true;
+    }
+
+    /**
+     * Function FindLibrary
+     * gets in @a aEntries all the index entries of the single file library @a aLibPath,
+     * if they were all read from the library file with the stamp @a aStamp.
+     * @return bool - true if the library was found.
+     */
+    bool FindLibrary( const wxString& aLibPath, const STAMP& aStamp,
+                      std::vector< std::pair<wxString, ENTRY> >* aEntries )
+    {
+        MUTLOCK lock( m_lock );
+
+        ENTRIES::iterator begin = m_entries.lower_bound( KEY( aLibPath, wxEmptyString ) );
+        ENTRIES::iterator it;
+
+        for( it = begin;  it != m_entries.end() && it->first.first == aLibPath;  ++it )
+        {
+            if( !( it->second.stamp == aStamp ) )
+                return false;
+        }
+
+        if( it == begin )
+            return false;
+
+        for( it = begin;  it != m_entries.end() && it->first.first == aLibPath;  ++it )
+        {
+            it->second.used = true;
+            aEntries->push_back( std::make_pair( it->first.second, it->second ) );
+        }
+
+        return true;
+    }
+
+    /**
+     * Function Add
+     * puts in the index the footprint @a aFootprint of the library @a aLibPath,
+     * read from a file with the stamp @a aStamp.
+     */
+    void Add( const wxString& aLibPath, FOOTPRINT_INFO& aFootprint, const STAMP& aStamp )
+    {
+        ENTRY entry;
+
+        entry.stamp    = aStamp;
+        entry.padCount = aFootprint.GetPadCount();
+        entry.doc      = aFootprint.GetDoc();
+        entry.keywords = aFootprint.GetKeywords();
+        entry.used     = true;
+
+        MUTLOCK lock( m_lock );
+
+        m_entries[ KEY( aLibPath, aFootprint.GetFootprintName() ) ] = entry;
+        m_modified = true;
+    }
+
+    /**
+     * Function LibraryRead
+     * tells the index all the footprints of the library @a aLibPath were read:
+     * the entries of this library which were not used are obsolete.
+     */
+    void LibraryRead( const wxString& aLibPath )
+    {
+        MUTLOCK lock( m_lock );
+
+        m_readLibs.insert( aLibPath );
+    }
+
+private:
+    ENTRIES             m_entries;
+    std::set<wxString>  m_readLibs;
+    bool                m_modified;
+    MUTEX               m_lock;
+};
+
+
+void FOOTPRINT_INFO_INDEX::Load( const wxString& aFileName )
+{
+    if( !wxFileName::IsFileReadable( aFileName ) )
+        return;
+
+    try
+    {
+        FILE_LINE_READER    reader( aFileName );
+        DSNLEXER            lexer( empty_keywords, 0, &reader );
+
+        // (fp_info_index <version> (fp <lib> <name> <mtime> <size> <pads> <doc> <keywords>) ...)
+        if( lexer.NextTok() != DSN_LEFT || lexer.NextTok() != DSN_SYMBOL
+            || strcmp( lexer.CurText(), "fp_info_index" ) != 0 )
+        {
+            return;
+        }
+
+        lexer.NeedNUMBER( "version" );
+
+        if( atoi( lexer.CurText() ) != FOOTPRINT_INDEX_VERSION )
+            return;
+
+        while( lexer.NextTok() == DSN_LEFT )
+        {
+            KEY     key;
+            ENTRY   entry;
+
+            lexer.NeedSYMBOL();
+            lexer.NeedSYMBOLorNUMBER();
+            key.first = FROM_UTF8( lexer.CurText() );
+            lexer.NeedSYMBOLorNUMBER();
+            key.second = FROM_UTF8( lexer.CurText() );
+
+            lexer.NeedNUMBER( "mtime" );
+            entry.stamp.mtime = strtol( lexer.CurText(), NULL, 10 );
+            lexer.NeedNUMBER( "size" );
+            entry.stamp.size = strtol( lexer.CurText(), NULL, 10 );
+            lexer.NeedNUMBER( "pad count" );
+            entry.padCount = atoi( lexer.CurText() );
+
+            lexer.NeedSYMBOLorNUMBER();
+            entry.doc = FROM_UTF8( lexer.CurText() );
+            lexer.NeedSYMBOLorNUMBER();
+            entry.keywords = FROM_UTF8( lexer.CurText() );
+
+            lexer.NeedRIGHT();
+
+            entry.used = false;
+            m_entries[key] = entry;
+        }
+    }
+    catch( const IO_ERROR& )
+    {
+        // The index is only an optimization: start again with an empty one.
+        m_entries.clear();
+    }
+}
+
+
+void FOOTPRINT_INFO_INDEX::Save( const wxString& aFileName,
+                                 const std::set<wxString>& aTableLibs )
+{
+    // Forget the footprints removed from the libraries read this time, and the
+    // libraries removed from the table, so the index does not grow without bound.
+    for( ENTRIES::iterator it = m_entries.begin();  it != m_entries.end();  )
+    {
+        const wxString& libPath = it->first.first;
+
+        if( !aTableLibs.count( libPath )
+            || ( !it->second.used && m_readLibs.count( libPath ) ) )
+        {
+            m_entries.erase( it++ );
+            m_modified = true;
+        }
+        else
+            ++it;
+    }
+
+    if( !m_modified )
+        return;
+
+    // Write a temporary file first, so an other KiCad process never reads
+    // a partially written index.
+    wxString tempName = aFileName + wxT( ".tmp" );
+
+    try
+    {
+        {
+            FILE_OUTPUTFORMATTER out( tempName );
+
+            out.Print( 0, "(fp_info_index %d\n", FOOTPRINT_INDEX_VERSION );
+
+            for( ENTRIES::const_iterator it = m_entries.begin();  it != m_entries.end();  ++it )
+            {
+                const ENTRY& entry = it->second;
+
+                out.Print( 1, "(fp %s %s %ld %ld %d %s %s)\n",
+                           out.Quotew( it->first.first ).c_str(),
+                           out.Quotew( it->first.second ).c_str(),
+                           entry.stamp.mtime, entry.stamp.size, entry.padCount,
+                           out.Quotew( entry.doc ).c_str(),
+                           out.Quotew( entry.keywords ).c_str() );
+            }
+
+            out.Print( 0, ")\n" );
+        }
+
+        if( !wxRenameFile( tempName, aFileName, true ) )
+            wxRemoveFile( tempName );
+    }
+    catch( const IO_ERROR& )
+    {
+        wxRemoveFile( tempName );
+    }
+}
+
+
 void FOOTPRINT_INFO::load()
 {
     FP_LIB_TABLE*   fptable = m_owner->GetTable();
@@ -110,46 +416,34 @@ void FOOTPRINT_INFO::load()
 }
 
 
-#define JOBZ                6       // no. libraries per worker thread.  It takes about
-                                    // a second to load a GITHUB library, so assigning
-                                    // this no. libraries to each thread should give a little
-                                    // over this no. seconds total time if the original delay
-                                    // were caused by latencies alone.
-                                    // (If https://github.com does not mind.)
-
-#define NTOLERABLE_ERRORS   4       // max errors before aborting, although threads
+#define NTOLERABLE_ERRORS   4       // max errors before aborting, although jobs
                                     // in progress will still pile on for a bit.  e.g. if 9 threads
                                     // expect 9 greater than this.
 
-void FOOTPRINT_LIST::loader_job( const wxString* aNicknameList, int aJobZ )
+void FOOTPRINT_LIST::addCurrentError()
 {
-    //DBG(printf( "%s: first:'%s' count:%d\n", __func__, (char*) TO_UTF8( *aNicknameList ), aJobZ );)
-
-    for( int i=0; i<aJobZ; ++i )
+    try
     {
-        if( m_error_count >= NTOLERABLE_ERRORS )
-            break;
+        throw;
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        // m_errors.push_back is not thread safe, lock its MUTEX.
+        MUTLOCK lock( m_errors_lock );
 
-        const wxString& nickname = aNicknameList[i];
+        ++m_error_count;        // modify only under lock
+        m_errors.push_back( new IO_ERROR( ioe ) );  // some can be PARSE_ERRORs also
+    }
 
+    // Catch anything unexpected and map it into the expected.
+    // Likely even more important since the jobs run on GUI-less worker threads.
+    catch( const std::exception& se )
+    {
+        // This is a round about way to do this, but who knows what THROW_IO_ERROR()
+        // may be tricked out to do someday, keep it in the game.
         try
         {
-            wxArrayString fpnames = m_lib_table->FootprintEnumerate( nickname );
-
-            for( unsigned ni=0;  ni<fpnames.GetCount();  ++ni )
-            {
-                FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO( this, nickname, fpnames[ni] );
-
-                addItem( fpinfo );
-            }
-        }
-        catch( const PARSE_ERROR& pe )
-        {
-            // m_errors.push_back is not thread safe, lock its MUTEX.
-            MUTLOCK lock( m_errors_lock );
-
-            ++m_error_count;        // modify only under lock
-            m_errors.push_back( new IO_ERROR( pe ) );
+            THROW_IO_ERROR( se.what() );
         }
         catch( const IO_ERROR& ioe )
         {
@@ -158,27 +452,151 @@ void FOOTPRINT_LIST::loader_job( const wxString* aNicknameList, int aJobZ )
             ++m_error_count;
             m_errors.push_back( new IO_ERROR( ioe ) );
         }
+    }
+}
+
 
-        // Catch anything unexpected and map it into the expected.
-        // Likely even more important since this function runs on GUI-less
-        // worker threads.
-        catch( const std::exception& se )
+void FOOTPRINT_LIST::loader_job( const wxString& aNickname )
+{
+    if( m_error_count >= NTOLERABLE_ERRORS )
+        return;
+
+    try
+    {
+        loadLibrary( aNickname );
+    }
+    catch( ... )
+    {
+        addCurrentError();
+    }
+}
+
+
+void FOOTPRINT_LIST::footprint_job( const wxString& aNickname, const wxString& aLibPath,
+                                    const wxString& aFileName )
+{
+    if( m_error_count >= NTOLERABLE_ERRORS )
+        return;
+
+    try
+    {
+        wxString                    fpname = wxFileName( aFileName ).GetName();
+        FOOTPRINT_INFO_INDEX::STAMP stamp  = FOOTPRINT_INFO_INDEX::GetStamp( aFileName );
+        FOOTPRINT_INFO_INDEX::ENTRY entry;
+
+        if( m_index && m_index->Find( aLibPath, fpname, stamp, &entry ) )
+        {
+            addItem( new FOOTPRINT_INFO( this, aNickname, fpname, entry.doc,
+                                         entry.keywords, entry.padCount ) );
+            return;
+        }
+
+        // The file is parsed here, rather than through the library plugin, which
+        // loads the whole library and is not thread safe.
+        MMAP_LINE_READER    reader( aFileName );
+        PCB_PARSER          parser( &reader );
+
+        std::auto_ptr<BOARD_ITEM> item( parser.Parse() );
+
+        MODULE* module = dynamic_cast<MODULE*>( item.get() );
+
+        if( !module )
         {
-            // This is a round about way to do this, but who knows what THROW_IO_ERROR()
-            // may be tricked out to do someday, keep it in the game.
-            try
+            THROW_IO_ERROR( wxString::Format( _( "'%s' is not a footprint file" ),
+                                              GetChars( aFileName ) ) );
+        }
+
+        FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO( this, aNickname, fpname,
+                                                     module->GetDescription(),
+                                                     module->GetKeywords(),
+                                                     module->GetPadCount( DO_NOT_INCLUDE_NPTH ) );
+
+        addItem( fpinfo );
+
+        if( m_index )
+            m_index->Add( aLibPath, *fpinfo, stamp );
+    }
+    catch( ... )
+    {
+        addCurrentError();
+    }
+}
+
+
+void FOOTPRINT_LIST::loadLibrary( const wxString& aNickname )
+{
+    const FP_LIB_TABLE::ROW* row = m_lib_table->FindRow( aNickname );
+
+    wxString    libPath = row->GetFullURI( true );
+    bool        isKiCad = IO_MGR::EnumFromStr( row->GetType() ) == IO_MGR::KICAD;
+
+    typedef FOOTPRINT_INFO_INDEX::STAMP STAMP;
+
+    if( isKiCad && wxDirExists( libPath ) )
+    {
+        // One file per footprint: one job per footprint, which loads it only if
+        // its file changed since it was put in the index.
+        wxDir dir( libPath );
+
+        if( dir.IsOpened() )
+        {
+            wxString    fpFileName;
+            wxString    wildcard = wxT( "*." ) + KiCadFootprintFileExtension;
+
+            if( dir.GetFirst( &fpFileName, wildcard, wxDIR_FILES ) )
             {
-                THROW_IO_ERROR( se.what() );
+                do
+                {
+                    wxFileName fullPath( libPath, fpFileName );
+
+                    m_jobs->Add( boost::bind( &FOOTPRINT_LIST::footprint_job, this,
+                                              aNickname, libPath, fullPath.GetFullPath() ) );
+                } while( dir.GetNext( &fpFileName ) );
             }
-            catch( const IO_ERROR& ioe )
+
+            if( m_index )
+                m_index->LibraryRead( libPath );
+
+            return;
+        }
+    }
+
+    // Single file library: all its footprints are loaded if the file changed.
+    bool    indexed = m_index && wxFileExists( libPath );
+    STAMP   stamp   = FOOTPRINT_INFO_INDEX::GetStamp( libPath );
+
+    if( indexed )
+    {
+        std::vector< std::pair<wxString, FOOTPRINT_INFO_INDEX::ENTRY> > entries;
+
+        if( m_index->FindLibrary( libPath, stamp, &entries ) )
+        {
+            for( unsigned ii = 0;  ii < entries.size();  ++ii )
             {
-                MUTLOCK lock( m_errors_lock );
+                const FOOTPRINT_INFO_INDEX::ENTRY& entry = entries[ii].second;
 
-                ++m_error_count;
-                m_errors.push_back( new IO_ERROR( ioe ) );
+                addItem( new FOOTPRINT_INFO( this, aNickname, entries[ii].first, entry.doc,
+                                             entry.keywords, entry.padCount ) );
             }
+
+            return;
         }
     }
+
+    wxArrayString fpnames = m_lib_table->FootprintEnumerate( aNickname );
+
+    for( unsigned ni=0;  ni<fpnames.GetCount();  ++ni )
+    {
+        FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO( this, aNickname, fpnames[ni] );
+
+        addItem( fpinfo );
+
+        if( indexed )
+            m_index->Add( libPath, *fpinfo, stamp );
+    }
+
+    if( indexed )
+        m_index->LibraryRead( libPath );
 }
 
 
@@ -188,14 +606,30 @@ bool FOOTPRINT_LIST::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* a
 
     m_lib_table = aTable;
 
+    // The footprints which did not change since the last time are read from the index
+    FOOTPRINT_INFO_INDEX    index;
+    wxFileName              indexFileName( GetKicadConfigPath(), footprintIndexFileName );
+
+    index.Load( indexFileName.GetFullPath() );
+    m_index = &index;
+
     // Clear data before reading files
     m_error_count = 0;
     m_errors.clear();
     m_list.clear();
 
+    // The library jobs add the footprint jobs of their library to the same group,
+    // so the load time depends on the total footprint count, not on the biggest library.
+    JOB_GROUP jobs;
+
+    m_jobs = &jobs;
+
     if( aNickname )
-        // single footprint
-        loader_job( aNickname, 1 );
+    {
+        // single library
+        loader_job( *aNickname );
+        jobs.Wait();
+    }
     else
     {
         std::vector< wxString > nicknames;
@@ -203,67 +637,49 @@ bool FOOTPRINT_LIST::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* a
         // do all of them
         nicknames = aTable->GetLogicalLibs();
 
-#if USE_WORKER_THREADS
-
         // Even though the PLUGIN API implementation is the place for the
         // locale toggling, in order to keep LOCAL_IO::C_count at 1 or greater
-        // for the duration of all helper threads, we increment by one here via instantiation.
+        // for the duration of all the jobs, we increment by one here via instantiation.
         // Only done here because of the multi-threaded nature of this code.
         // Without this C_count skips in and out of "equal to zero" and causes
         // needless locale toggling among the threads, based on which of them
         // are in a PLUGIN::FootprintLoad() function.  And that is occasionally
-        // none of them.
+        // none of them.  The KiCad and legacy plugins read numbers without the C
+        // library and do not toggle the locale any more, but the other ones still do.
         LOCALE_IO   top_most_nesting;
 
-        // Something which will not invoke a thread copy constructor, one of many ways obviously:
-        typedef boost::ptr_vector< boost::thread >  MYTHREADS;
+        for( unsigned i=0; i<nicknames.size();  ++i )
+            jobs.Add( boost::bind( &FOOTPRINT_LIST::loader_job, this, nicknames[i] ) );
 
-        MYTHREADS threads;
+        // Everyone must finish.
+        jobs.Wait();
 
-        // Give each thread JOBZ nicknames to process.  The last portion of, or if the entire
-        // size() is small, I'll do myself.
-        for( unsigned i=0; i<nicknames.size();  )
-        {
-            if( m_error_count >= NTOLERABLE_ERRORS )
-            {
-                // abort the remaining nicknames.
-                retv = false;
-                break;
-            }
+        m_list.sort();
+    }
 
-            int jobz = JOBZ;
+    m_jobs = NULL;
 
-            if( i + jobz >= nicknames.size() )
-            {
-                jobz = nicknames.size() - i;
+    // The jobs skip the remaining libraries and footprints after too many errors.
+    if( m_error_count >= NTOLERABLE_ERRORS )
+        retv = false;
 
-                // Only a little bit to do, I'll do it myself, on current thread.
-                loader_job( &nicknames[i], jobz );
-            }
-            else
-            {
-                // Delegate the job to a worker thread created here.
-                threads.push_back( new boost::thread( &FOOTPRINT_LIST::loader_job,
-                        this, &nicknames[i], jobz ) );
-            }
+    m_index = NULL;
 
-            i += jobz;
-        }
+    // Keep the index entries of all the libraries of the table, even when
+    // only one of them was read.
+    std::vector< wxString > tableNicknames = aTable->GetLogicalLibs();
+    std::set< wxString >    tableLibs;
 
-        // Wait for all the worker threads to complete, it does not matter in what order
-        // we wait for them as long as a full sweep is made.  Think of the great race,
-        // everyone must finish.
-        for( unsigned i=0;  i<threads.size();  ++i )
-        {
-            threads[i].join();
-        }
-#else
-        loader_job( &nicknames[0], nicknames.size() );
-#endif
+    for( unsigned i=0; i<tableNicknames.size();  ++i )
+    {
+        const FP_LIB_TABLE::ROW* row = aTable->FindRow( tableNicknames[i] );
 
-        m_list.sort();
+        if( row )
+            tableLibs.insert( row->GetFullURI( true ) );
     }
 
+    index.Save( indexFileName.GetFullPath(), tableLibs );
+
     // The result of this function can be a blend of successes and failures, whose
     // mix is given by the Count()s of the two lists.  The return value indicates whether
     // an abort occurred, even true does not necessarily mean full success, although
@@ -52,6 +52,8 @@
 #include <menus_helpers.h>
 #include <confirm.h>
 #include <dialog_env_var_config.h>
+#include <thread_pool.h>
+#include <ki_mutex.h>
 
 
 #define KICAD_COMMON                     wxT( "kicad_common" )
@@ -273,6 +275,7 @@ PGM_BASE::PGM_BASE()
 
     m_wx_app = NULL;
     m_show_env_var_dialog = true;
+    m_thread_pool = NULL;
 
     setLanguageId( wxLANGUAGE_DEFAULT );
 
@@ -290,6 +293,11 @@ void PGM_BASE::destroy()
 {
     // unlike a normal destructor, this is designed to be called more than once safely:
 
+    // Join the workers now: the jobs are all finished, since their groups are waited
+    // for, but the workers must not outlive the program or the KIFACEs.
+    delete m_thread_pool;
+    m_thread_pool = 0;
+
     delete m_common_settings;
     m_common_settings = 0;
 
@@ -301,6 +309,19 @@ void PGM_BASE::destroy()
 }
 
 
+THREAD_POOL& PGM_BASE::GetThreadPool()
+{
+    static MUTEX    lock;
+
+    MUTLOCK locker( lock );
+
+    if( !m_thread_pool )
+        m_thread_pool = new THREAD_POOL();
+
+    return *m_thread_pool;
+}
+
+
 void PGM_BASE::SetEditorName( const wxString& aFileName )
 {
     m_editor_name = aFileName;
@@ -28,6 +28,16 @@
 
 #include <richio.h>
 
+#include <wx/filename.h>
+#include <wx/utils.h>
+
+#if !defined( __WINDOWS__ )
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -254,6 +264,316 @@ char* FILE_LINE_READER::ReadLine() throw( IO_ERROR )
 }
 
 
+/**
+ * Function readWholeFile
+ * reads the content of @a aFileName in @a aBuffer, in a single block.
+ * @return bool - false if the file could not be read.
+ */
+static bool readWholeFile( const wxString& aFileName, std::vector<char>& aBuffer )
+{
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+        return false;
+
+    bool ok = fseek( fp, 0, SEEK_END ) == 0;
+    long size = ok ? ftell( fp ) : -1;
+
+    ok = size >= 0 && fseek( fp, 0, SEEK_SET ) == 0;
+
+    if( ok )
+    {
+        aBuffer.resize( size );
+        ok = size == 0 || fread( &aBuffer[0], 1, size, fp ) == (size_t) size;
+    }
+
+    fclose( fp );
+
+    return ok;
+}
+
+
+MMAP_LINE_READER::MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber,
+            unsigned aMaxLineLength ) throw( IO_ERROR ) :
+    LINE_READER( aMaxLineLength ),
+    m_data( NULL ),
+    m_size( 0 ),
+    m_ndx( 0 ),
+    m_view( NULL ),
+    m_lineCopied( true ),
+    m_mapping( NULL )
+{
+    source  = aFileName;
+    lineNum = aStartingLineNumber;
+
+#if !defined( __WINDOWS__ )
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd < 0 )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename '%s' for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    struct stat st;
+
+    if( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0 )
+    {
+        void* addr = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+        if( addr != MAP_FAILED )
+        {
+#if defined( MADV_SEQUENTIAL )
+            madvise( addr, st.st_size, MADV_SEQUENTIAL );
+#endif
+            m_mapping = addr;
+            m_data    = (const char*) addr;
+            m_size    = st.st_size;
+        }
+    }
+
+    close( fd );
+
+    if( m_mapping )
+        return;
+#endif
+
+    // No mapping (or an empty or special file): read the file in a single block.
+    if( !readWholeFile( aFileName, m_buffer ) )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to read file '%s'" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_data = m_buffer.empty() ? NULL : &m_buffer[0];
+    m_size = m_buffer.size();
+}
+
+
+MMAP_LINE_READER::MMAP_LINE_READER( const MMAP_LINE_READER& aFile, size_t aBegin, size_t aEnd,
+            unsigned aStartingLineNumber ) :
+    LINE_READER( aFile.maxLineLength ),
+    m_data( aFile.m_data + aBegin ),
+    m_size( aEnd - aBegin ),
+    m_ndx( 0 ),
+    m_view( NULL ),
+    m_lineCopied( true ),
+    m_mapping( NULL )
+{
+    wxASSERT( aBegin <= aEnd && aEnd <= aFile.m_size );
+
+    source  = aFile.source;
+    lineNum = aStartingLineNumber;
+}
+
+
+MMAP_LINE_READER::~MMAP_LINE_READER()
+{
+#if !defined( __WINDOWS__ )
+    if( m_mapping )
+        munmap( m_mapping, m_size );
+#endif
+}
+
+
+const char* MMAP_LINE_READER::ReadLineView( unsigned* aLength ) throw( IO_ERROR )
+{
+    // lineNum is incremented even if there was no line read, like FILE_LINE_READER does.
+    ++lineNum;
+
+    m_lineCopied = false;
+
+    if( m_ndx >= m_size )
+    {
+        m_view  = NULL;
+        length  = 0;
+        *aLength = 0;
+        return NULL;
+    }
+
+    const char* begin = m_data + m_ndx;
+    const char* nl    = (const char*) memchr( begin, '\n', m_size - m_ndx );
+
+    length  = nl ? nl - begin + 1 : m_size - m_ndx;
+    m_ndx  += length;
+    m_view  = begin;
+
+    *aLength = length;
+
+    if( nl )
+        return begin;
+
+    // The last line has no '\n': it ends the mapping, and is copied so that it is
+    // followed by a nul, like any line returned by ReadLine().
+    if( length >= maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    return LineFromView();
+}
+
+
+char* MMAP_LINE_READER::LineFromView()
+{
+    if( !m_lineCopied )
+    {
+        unsigned len = length;
+
+        if( len + 1 > capacity )    // +1 for terminating nul
+            expandCapacity( len + 1 );
+
+        if( len + 1 > capacity )
+            len = capacity - 1;
+
+        if( len )
+            memcpy( line, m_view, len );
+
+        line[len] = 0;
+        m_lineCopied = true;
+    }
+
+    return line;
+}
+
+
+char* MMAP_LINE_READER::ReadLine() throw( IO_ERROR )
+{
+    unsigned len;
+
+    ReadLineView( &len );
+
+    if( len >= maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    LineFromView();
+
+    return length ? line : NULL;
+}
+
+
+/// Size of the magic number of a cache, see CACHE_WRITER::PutHeader().
+#define CACHE_MAGIC_SIZE    8
+
+
+wxString CacheFileName( const wxString& aFileName )
+{
+    wxFileName fn = aFileName;
+
+    fn.SetExt( fn.GetExt() + wxT( "-cache" ) );
+
+    return fn.GetFullPath();
+}
+
+
+/**
+ * Function hashFileData
+ * @return a 64 bits FNV-1a like hash of @a aData, computed by words of 8 bytes.
+ */
+static uint64_t hashFileData( const char* aData, size_t aSize )
+{
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t       hash  = 14695981039346656037ULL;
+    size_t         ii    = 0;
+
+    for( ; ii + sizeof( uint64_t ) <= aSize; ii += sizeof( uint64_t ) )
+    {
+        uint64_t word;
+
+        memcpy( &word, aData + ii, sizeof( word ) );
+        hash = ( hash ^ word ) * prime;
+    }
+
+    for( ; ii < aSize; ++ii )
+        hash = ( hash ^ (unsigned char) aData[ii] ) * prime;
+
+    return hash;
+}
+
+
+static int64_t modificationTime( const wxString& aFileName )
+{
+    return wxFileName( aFileName ).GetModificationTime().GetValue().GetValue();
+}
+
+
+void CACHE_WRITER::PutHeader( const char* aMagic, uint32_t aVersion,
+                              const MMAP_LINE_READER& aSource )
+{
+    Put( aMagic, CACHE_MAGIC_SIZE );
+    Put<uint32_t>( aVersion );
+    Put<uint64_t>( aSource.GetSize() );
+    Put<int64_t>( modificationTime( aSource.GetSource() ) );
+    Put<uint64_t>( hashFileData( aSource.GetData(), aSource.GetSize() ) );
+}
+
+
+bool CACHE_WRITER::Write( const wxString& aFileName ) const
+{
+    // Several processes may write the same cache at the same time
+    wxString tempName = aFileName + wxString::Format( wxT( ".%lu.tmp" ), wxGetProcessId() );
+
+    FILE* fp = wxFopen( tempName, wxT( "wb" ) );
+
+    if( !fp )
+        return false;
+
+    bool ok = fwrite( m_data.data(), 1, m_data.size(), fp ) == m_data.size();
+
+    ok = ( fclose( fp ) == 0 ) && ok;
+
+    if( !ok || !wxRenameFile( tempName, aFileName, true ) )
+    {
+        wxRemoveFile( tempName );
+        return false;
+    }
+
+    return true;
+}
+
+
+bool CACHE_READER::CheckHeader( const char* aMagic, uint32_t aVersion,
+                                const wxString& aSourceFileName ) throw( IO_ERROR )
+{
+    if( memcmp( Skip( CACHE_MAGIC_SIZE ), aMagic, CACHE_MAGIC_SIZE ) != 0
+        || Get<uint32_t>() != aVersion )
+    {
+        return false;
+    }
+
+    uint64_t sourceSize = Get<uint64_t>();
+    int64_t  sourceTime = Get<int64_t>();
+    uint64_t sourceHash = Get<uint64_t>();
+
+    // The modification time is the cheapest test, the hash needs to read the whole file
+    if( sourceTime != modificationTime( aSourceFileName ) )
+        return false;
+
+    MMAP_LINE_READER source( aSourceFileName );
+
+    return source.GetSize() == sourceSize
+        && hashFileData( source.GetData(), source.GetSize() ) == sourceHash;
+}
+
+
+const char* CACHE_READER::Skip( size_t aSize ) throw( IO_ERROR )
+{
+    if( m_size - m_pos < aSize )
+    {
+        wxString msg = wxString::Format(
+            _( "Truncated cache file '%s'" ), m_source.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    const char* ret = m_data + m_pos;
+
+    m_pos += aSize;
+
+    return ret;
+}
+
+
 STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ) :
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     lines( aString ),
@@ -31,6 +31,10 @@
 #include <richio.h>                        // StrPrintf
 #include <kicad_string.h>
 
+#include <cerrno>
+#include <sstream>
+#include <locale>
+
 
 /**
  * Illegal file name characters used to insure file names will be valid on all supported
@@ -197,7 +201,9 @@ char* GetLine( FILE* File, char* Line, int* LineNum, int SizeLine )
 
     } while( Line[0] == '#' || Line[0] == '\n' ||  Line[0] == '\r' || Line[0] == 0 );
 
-    strtok( Line, "\n\r" );
+    char* saveptr;
+
+    strtok_r( Line, "\n\r", &saveptr );
     return Line;
 }
 
@@ -479,3 +485,139 @@ bool ReplaceIllegalFileNameChars( std::string* aName )
 
     return changed;
 }
+
+
+/**
+ * Function strtodClassic
+ * is the slow path of Strtod_C(): converts the number between @a aText and
+ * @a aEnd using the classic "C" locale of the C++ library.
+ */
+static double strtodClassic( const char* aText, const char* aEnd )
+{
+    std::istringstream  in( std::string( aText, aEnd ) );
+    double              value = 0.0;
+
+    in.imbue( std::locale::classic() );
+    in >> value;
+
+    if( in.fail() )
+        errno = ERANGE;
+
+    return value;
+}
+
+
+double Strtod_C( const char* aText, char** aEndPtr )
+{
+    // The powers of ten which are exactly represented by a double.
+    static const double pow10[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    // The mantissa is exact as long as it is not above 2^53.
+    const int MAX_DIGITS = 15;
+
+    const char* cp = aText;
+
+    while( isspace( (unsigned char) *cp ) )
+        ++cp;
+
+    const char* start    = cp;
+    bool        negative = false;
+
+    if( *cp == '-' || *cp == '+' )
+        negative = *cp++ == '-';
+
+    double  mantissa = 0.0;
+    int     digits   = 0;      // significant digits in mantissa
+    int     exponent = 0;
+    bool    inexact  = false;
+    bool    anyDigit = false;
+
+    for( ; isdigit( (unsigned char) *cp ); ++cp )
+    {
+        anyDigit = true;
+
+        if( digits < MAX_DIGITS )
+        {
+            mantissa = mantissa * 10 + ( *cp - '0' );
+
+            if( mantissa != 0.0 )
+                ++digits;
+        }
+        else
+        {
+            ++exponent;
+            inexact = true;
+        }
+    }
+
+    if( *cp == '.' )
+    {
+        for( ++cp; isdigit( (unsigned char) *cp ); ++cp )
+        {
+            anyDigit = true;
+
+            if( digits < MAX_DIGITS )
+            {
+                mantissa = mantissa * 10 + ( *cp - '0' );
+
+                if( mantissa != 0.0 )
+                    ++digits;
+
+                --exponent;
+            }
+            else
+                inexact = true;
+        }
+    }
+
+    if( !anyDigit )
+    {
+        if( aEndPtr )
+            *aEndPtr = (char*) aText;
+
+        return 0.0;
+    }
+
+    if( *cp == 'e' || *cp == 'E' )
+    {
+        const char* ep = cp + 1;
+        bool        negativeExp = false;
+
+        if( *ep == '-' || *ep == '+' )
+            negativeExp = *ep++ == '-';
+
+        if( isdigit( (unsigned char) *ep ) )
+        {
+            int exp = 0;
+
+            for( ; isdigit( (unsigned char) *ep ); ++ep )
+            {
+                if( exp < 100000 )
+                    exp = exp * 10 + ( *ep - '0' );
+            }
+
+            exponent += negativeExp ? -exp : exp;
+            cp = ep;
+        }
+    }
+
+    if( aEndPtr )
+        *aEndPtr = (char*) cp;
+
+    double value;
+
+    // Both the mantissa and the power of ten are exact, so the result of a single
+    // IEEE multiplication or division is correctly rounded, like strtod() does.
+    if( !inexact && exponent >= -22 && exponent <= 22 )
+        value = exponent < 0 ? mantissa / pow10[-exponent] : mantissa * pow10[exponent];
+    else if( mantissa == 0.0 )
+        value = 0.0;
+    else
+        return strtodClassic( start, cp );
+
+    return negative ? -value : value;
+}
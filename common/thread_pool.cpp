@@ -0,0 +1,261 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file thread_pool.cpp
+ */
+
+#include <algorithm>
+#include <thread_pool.h>
+#include <pgm_base.h>
+#include <boost/bind.hpp>
+
+
+THREAD_POOL& THREAD_POOL::Get()
+{
+    // A function local static pool would be a different pool in each KIFACE, and
+    // would be joined during the static destruction, maybe after its DSO is unloaded.
+    return Pgm().GetThreadPool();
+}
+
+
+THREAD_POOL::THREAD_POOL( int aThreadCount ) :
+    m_queued( 0 ),
+    m_stop( false )
+{
+    if( aThreadCount <= 0 )
+        aThreadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+
+    // The last queue is for the jobs added by the threads which are not workers.
+    for( int ii = 0; ii <= aThreadCount; ++ii )
+        m_queues.push_back( new QUEUE );
+
+    for( int ii = 0; ii < aThreadCount; ++ii )
+        m_threads.create_thread( boost::bind( &THREAD_POOL::worker, this, ii ) );
+}
+
+
+THREAD_POOL::~THREAD_POOL()
+{
+    {
+        boost::mutex::scoped_lock lock( m_wakeLock );
+
+        m_stop = true;
+    }
+
+    m_wake.notify_all();
+    m_threads.join_all();
+}
+
+
+int THREAD_POOL::currentQueue() const
+{
+    int* queue = m_workerQueue.get();
+
+    return queue ? *queue : m_queues.size() - 1;
+}
+
+
+void THREAD_POOL::add( const JOB& aJob, JOB_GROUP* aGroup )
+{
+    ITEM item;
+
+    item.job   = aJob;
+    item.group = aGroup;
+
+    QUEUE& queue = m_queues[ currentQueue() ];
+
+    {
+        boost::mutex::scoped_lock lock( queue.lock );
+
+        queue.items.push_back( item );
+    }
+
+    {
+        boost::mutex::scoped_lock lock( m_wakeLock );
+
+        ++m_queued;
+    }
+
+    m_wake.notify_one();
+}
+
+
+bool THREAD_POOL::takeItem( QUEUE& aQueue, bool aNewest, JOB_GROUP* aGroup, ITEM& aItem )
+{
+    boost::mutex::scoped_lock lock( aQueue.lock );
+
+    std::deque<ITEM>& items = aQueue.items;
+
+    if( items.empty() )
+        return false;
+
+    if( !aGroup )
+    {
+        if( aNewest )
+        {
+            aItem = items.back();
+            items.pop_back();
+        }
+        else
+        {
+            aItem = items.front();
+            items.pop_front();
+        }
+
+        return true;
+    }
+
+    for( unsigned ii = 0; ii < items.size(); ++ii )
+    {
+        unsigned ndx = aNewest ? items.size() - 1 - ii : ii;
+
+        if( items[ndx].group == aGroup )
+        {
+            aItem = items[ndx];
+            items.erase( items.begin() + ndx );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool THREAD_POOL::runOne( int aQueue, JOB_GROUP* aGroup )
+{
+    ITEM item;
+    bool found = false;
+
+    // The newest job of the own queue first, since its data are likely
+    // still in the cache, then the oldest job of the other queues.
+    for( unsigned ii = 0; ii < m_queues.size() && !found; ++ii )
+    {
+        QUEUE& queue = m_queues[ ( aQueue + ii ) % m_queues.size() ];
+
+        found = takeItem( queue, ii == 0, aGroup, item );
+    }
+
+    if( !found )
+        return false;
+
+    {
+        boost::mutex::scoped_lock lock( m_wakeLock );
+
+        --m_queued;
+    }
+
+    item.group->jobTaken();
+
+    try
+    {
+        item.job();
+    }
+    catch( ... )
+    {
+        // Jobs must catch their own exceptions: at least do not let one stop
+        // a worker, and leave its group waiting for ever.
+    }
+
+    item.group->jobDone();
+
+    return true;
+}
+
+
+void THREAD_POOL::worker( int aQueue )
+{
+    m_workerQueue.reset( new int( aQueue ) );
+
+    while( true )
+    {
+        if( runOne( aQueue ) )
+            continue;
+
+        boost::mutex::scoped_lock lock( m_wakeLock );
+
+        while( !m_stop && m_queued == 0 )
+            m_wake.wait( lock );
+
+        if( m_stop )
+            return;
+    }
+}
+
+
+void JOB_GROUP::Add( const THREAD_POOL::JOB& aJob )
+{
+    {
+        boost::mutex::scoped_lock lock( m_lock );
+
+        ++m_pending;
+        ++m_queued;
+    }
+
+    m_pool.add( aJob, this );
+
+    // Wake up Wait(), to run the new job
+    m_done.notify_all();
+}
+
+
+void JOB_GROUP::jobTaken()
+{
+    boost::mutex::scoped_lock lock( m_lock );
+
+    --m_queued;
+}
+
+
+void JOB_GROUP::jobDone()
+{
+    boost::mutex::scoped_lock lock( m_lock );
+
+    if( --m_pending == 0 )
+        m_done.notify_all();
+}
+
+
+void JOB_GROUP::Wait()
+{
+    int queue = m_pool.currentQueue();
+
+    while( true )
+    {
+        {
+            boost::mutex::scoped_lock lock( m_lock );
+
+            // All the remaining jobs of the group are running: wait until one is done,
+            // or adds a job to the group.
+            while( m_pending && !m_queued )
+                m_done.wait( lock );
+
+            if( m_pending == 0 )
+                return;
+        }
+
+        // Help the workers with the jobs of this group, rather than sleeping while
+        // they are queued.  The jobs of the other groups are left to their waiters.
+        m_pool.runOne( queue, this );
+    }
+}
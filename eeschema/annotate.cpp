@@ -178,6 +178,10 @@ void SCH_EDIT_FRAME::AnnotateComponents( bool              aAnnotateSchematic,
 
     OnModify();
 
+    // The units of the components of all the sheets may have changed.
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+        screen->ConnectionsChanged();
+
     // Update on screen references, that can be modified by previous calculations:
     m_CurrentSheet->UpdateAllScreenReferences();
     SetSheetNumberAndCount();
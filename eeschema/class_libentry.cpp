@@ -767,6 +767,7 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 {
     int      unused;
     char*    p;
+    char*    saveptr;
     char*    componentName;
     char*    prefix = NULL;
     char*    line;
@@ -776,7 +777,7 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 
     line = aLineReader.Line();
 
-    p = strtok( line, " \t\r\n" );
+    p = strtok_r( line, " \t\r\n", &saveptr );
 
     if( strcmp( p, "DEF" ) != 0 )
     {
@@ -789,17 +790,17 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
     char drawnum = 0;
     char drawname = 0;
 
-    if( ( componentName = strtok( NULL, " \t\n" ) ) == NULL  // Part name:
-        || ( prefix = strtok( NULL, " \t\n" ) ) == NULL      // Prefix name:
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // NumOfPins:
+    if( ( componentName = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL     // Part name:
+        || ( prefix = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL         // Prefix name:
+        || ( p = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL              // NumOfPins:
         || sscanf( p, "%d", &unused ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // TextInside:
+        || ( p = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL              // TextInside:
         || sscanf( p, "%d", &m_pinNameOffset ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // DrawNums:
+        || ( p = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL              // DrawNums:
         || sscanf( p, "%c", &drawnum ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // DrawNums:
+        || ( p = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL              // DrawNums:
         || sscanf( p, "%c", &drawname ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // m_unitCount:
+        || ( p = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL              // m_unitCount:
         || sscanf( p, "%d", &m_unitCount ) != 1 )
     {
         aErrorMsg.Printf( wxT( "Wrong DEF format in line %d, skipped." ),
@@ -807,7 +808,7 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 
         while( (line = aLineReader.ReadLine()) != NULL )
         {
-            p = strtok( line, " \t\n" );
+            p = strtok_r( line, " \t\n", &saveptr );
 
             if( stricmp( p, "ENDDEF" ) == 0 )
                 break;
@@ -854,16 +855,16 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
     }
 
     // Copy optional infos
-    if( ( p = strtok( NULL, " \t\n" ) ) != NULL && *p == 'L' )
+    if( ( p = strtok_r( NULL, " \t\n", &saveptr ) ) != NULL && *p == 'L' )
         m_unitsLocked = true;
 
-    if( ( p = strtok( NULL, " \t\n" ) ) != NULL  && *p == 'P' )
+    if( ( p = strtok_r( NULL, " \t\n", &saveptr ) ) != NULL  && *p == 'P' )
         m_options = ENTRY_POWER;
 
     // Read next lines, until "ENDDEF" is found
     while( ( line = aLineReader.ReadLine() ) != NULL )
     {
-        p = strtok( line, " \t\r\n" );
+        p = strtok_r( line, " \t\r\n", &saveptr );
 
         // This is the error flag ( if an error occurs, result = false)
         result = true;
@@ -881,7 +882,7 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
             result = LoadDrawEntries( aLineReader, Msg );
         else if( strncmp( p, "ALIAS", 5 ) == 0 )
         {
-            p = strtok( NULL, "\r\n" );
+            p = strtok_r( NULL, "\r\n", &saveptr );
             result = LoadAliases( p, aErrorMsg );
         }
         else if( strncmp( p, "$FPLIST", 5 ) == 0 )
@@ -997,12 +998,13 @@ bool LIB_PART::LoadDrawEntries( LINE_READER& aLineReader, wxString& aErrorMsg )
 
 bool LIB_PART::LoadAliases( char* aLine, wxString& aErrorMsg )
 {
-    char* text = strtok( aLine, " \t\r\n" );
+    char* saveptr;
+    char* text = strtok_r( aLine, " \t\r\n", &saveptr );
 
     while( text )
     {
         m_aliases.push_back( new LIB_ALIAS( FROM_UTF8( text ), this ) );
-        text = strtok( NULL, " \t\r\n" );
+        text = strtok_r( NULL, " \t\r\n", &saveptr );
     }
 
     return true;
@@ -1048,6 +1050,7 @@ bool LIB_PART::LoadFootprints( LINE_READER& aLineReader, wxString& aErrorMsg )
 {
     char* line;
     char* p;
+    char* saveptr;
 
     while( true )
     {
@@ -1057,7 +1060,7 @@ bool LIB_PART::LoadFootprints( LINE_READER& aLineReader, wxString& aErrorMsg )
             return false;
         }
 
-        p = strtok( line, " \t\r\n" );
+        p = strtok_r( line, " \t\r\n", &saveptr );
 
         if( stricmp( p, "$ENDFPLIST" ) == 0 )
             break;
@@ -1264,10 +1267,11 @@ bool LIB_PART::SaveDateAndTime( OUTPUTFORMATTER& aFormatter )
 bool LIB_PART::LoadDateAndTime( char* aLine )
 {
     int   year, mon, day, hour, min, sec;
+    char* saveptr;
 
     year = mon = day = hour = min = sec = 0;
-    strtok( aLine, " \r\t\n" );
-    strtok( NULL, " \r\t\n" );
+    strtok_r( aLine, " \r\t\n", &saveptr );
+    strtok_r( NULL, " \r\t\n", &saveptr );
 
     if( sscanf( aLine, "%d/%d/%d %d:%d:%d", &year, &mon, &day, &hour, &min, &sec ) != 6 )
         return false;
@@ -42,8 +42,13 @@
 
 #include <general.h>
 #include <class_library.h>
+#include <ki_mutex.h>
+#include <thread_pool.h>
 
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/functional/hash.hpp>
 
 #include <wx/tokenzr.h>
 #include <wx/regex.h>
@@ -73,6 +78,45 @@ PART_LIB::PART_LIB( int aType, const wxString& aFileName ) :
 }
 
 
+PART_LIB::PART_LIB( const PART_LIB& aLibrary ) :
+    m_mod_hash( PART_LIBS::s_modify_generation )
+{
+    type = aLibrary.type;
+    isModified = false;
+    isCache = aLibrary.isCache;
+    timeStamp = aLibrary.timeStamp;
+    versionMajor = aLibrary.versionMajor;
+    versionMinor = aLibrary.versionMinor;
+    header = aLibrary.header;
+    fileName = aLibrary.fileName;
+
+    // Copy each part once, and map the names to the same aliases as in aLibrary,
+    // which may differ from the part alias lists if the library has duplicate names.
+    std::map<LIB_PART*, LIB_PART*> copies;
+
+    for( LIB_ALIAS_MAP::const_iterator it = aLibrary.m_amap.begin();
+         it != aLibrary.m_amap.end();  ++it )
+    {
+        LIB_PART*  part = it->second->GetPart();
+        LIB_PART*& copy = copies[part];
+
+        if( !copy )
+            copy = new LIB_PART( *part, this );
+
+        for( size_t i = 0; i < part->m_aliases.size(); i++ )
+        {
+            if( part->m_aliases[i] == it->second )
+            {
+                m_amap[ it->first ] = copy->m_aliases[i];
+                break;
+            }
+        }
+    }
+
+    ++m_mod_hash;
+}
+
+
 PART_LIB::~PART_LIB()
 {
     // When the library is destroyed, all of the alias objects on the heap should be deleted.
@@ -414,7 +458,6 @@ LIB_ALIAS* PART_LIB::GetPreviousEntry( const wxString& aName )
 
 bool PART_LIB::Load( wxString& aErrorMsg )
 {
-    FILE*          file;
     char*          line;
     wxString       msg;
 
@@ -424,15 +467,19 @@ bool PART_LIB::Load( wxString& aErrorMsg )
         return false;
     }
 
-    file = wxFopen( fileName.GetFullPath(), wxT( "rt" ) );
+    std::auto_ptr<MMAP_LINE_READER> fileReader;
 
-    if( file == NULL )
+    try
+    {
+        fileReader.reset( new MMAP_LINE_READER( fileName.GetFullPath() ) );
+    }
+    catch( const IO_ERROR& )
     {
         aErrorMsg = _( "The file could not be opened." );
         return false;
     }
 
-    FILE_LINE_READER reader( file, fileName.GetFullPath() );
+    MMAP_LINE_READER& reader = *fileReader;
 
     if( !reader.ReadLine() )
     {
@@ -579,13 +626,14 @@ void PART_LIB::LoadAliases( LIB_PART* aPart )
 bool PART_LIB::LoadHeader( LINE_READER& aLineReader )
 {
     char* line, * text, * data;
+    char* saveptr;
 
     while( aLineReader.ReadLine() )
     {
         line = (char*) aLineReader;
 
-        text = strtok( line, " \t\r\n" );
-        data = strtok( NULL, " \t\r\n" );
+        text = strtok_r( line, " \t\r\n", &saveptr );
+        data = strtok_r( NULL, " \t\r\n", &saveptr );
 
         if( stricmp( text, "TimeStamp" ) == 0 )
             timeStamp = atol( data );
@@ -602,6 +650,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
 {
     int        lineNumber = 0;
     char       line[8000], * name, * text;
+    char*      saveptr;
     LIB_ALIAS* entry;
     FILE*      file;
     wxString   msg;
@@ -644,7 +693,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
         }
 
         // Read one $CMP/$ENDCMP part entry from library:
-        name = strtok( line + 5, "\n\r" );
+        name = strtok_r( line + 5, "\n\r", &saveptr );
 
         wxString cmpname = FROM_UTF8( name );
 
@@ -655,7 +704,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
             if( strncmp( line, "$ENDCMP", 7 ) == 0 )
                 break;
 
-            text = strtok( line + 2, "\n\r" );
+            text = strtok_r( line + 2, "\n\r", &saveptr );
 
             if( entry )
             {
@@ -760,10 +809,151 @@ bool PART_LIB::SaveHeader( OUTPUTFORMATTER& aFormatter )
 
 PART_LIB* PART_LIB::LoadLibrary( const wxString& aFileName ) throw( IO_ERROR, boost::bad_pointer )
 {
-    std::auto_ptr<PART_LIB> lib( new PART_LIB( LIBRARY_TYPE_EESCHEMA, aFileName ) );
-
     wxBusyCursor ShowWait;
 
+    return loadCachedLibrary( aFileName );
+}
+
+
+/// Maximal total size of the library files kept parsed by PART_LIB::loadCachedLibrary().
+#define MAX_CACHED_LIBS_SIZE    ( 64 * 1024 * 1024 )
+
+
+/// A library parsed by PART_LIB::loadCachedLibrary(), and the stamp of its files.
+struct CACHED_PART_LIB
+{
+    size_t                      hash;       ///< hash of the library and doc files
+    long                        size;       ///< size of the library and doc files
+    unsigned                    lastUse;    ///< to evict the least recently used library
+    boost::shared_ptr<PART_LIB> lib;        ///< never modified, only copied
+};
+
+typedef std::map<wxString, CACHED_PART_LIB>     CACHED_PART_LIBS;
+
+/// The libraries parsed by all the projects and frames of the process, by full file name.
+static CACHED_PART_LIBS     s_cachedLibs;
+static long                 s_cachedLibsSize;   ///< total size of the cached libraries
+static unsigned             s_cachedLibsUse;    ///< count of uses, to set lastUse
+static MUTEX                s_cachedLibsLock;
+
+
+/**
+ * Function hashFile
+ * adds the content of the file @a aFileName to @a aHash, and its size to @a aSize.
+ * The content is used, rather than the modification time, which has a one
+ * second resolution: reading the file is much faster than parsing it.
+ * @return bool - false if the file cannot be read.
+ */
+static bool hashFile( const wxString& aFileName, size_t& aHash, long& aSize )
+{
+    FILE* file = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !file )
+        return false;
+
+    char    buffer[65536];
+    size_t  count;
+
+    while( ( count = fread( buffer, 1, sizeof( buffer ), file ) ) > 0 )
+    {
+        boost::hash_range( aHash, buffer, buffer + count );
+        aSize += count;
+    }
+
+    bool ok = !ferror( file );
+
+    fclose( file );
+
+    return ok;
+}
+
+
+PART_LIB* PART_LIB::loadCachedLibrary( const wxString& aFileName )
+    throw( IO_ERROR, boost::bad_pointer )
+{
+    wxFileName      fn( aFileName );
+
+    fn.MakeAbsolute();
+
+    wxString        fullName = fn.GetFullPath();
+
+    // The doc file is parsed with the library, so it is a part of the stamp, if any
+    size_t          hash = 0;
+    long            size = 0;
+    bool            stamped = hashFile( fullName, hash, size );
+
+    fn.SetExt( DOC_EXT );
+
+    if( stamped && fn.FileExists() )
+        stamped = hashFile( fn.GetFullPath(), hash, size );
+
+    boost::shared_ptr<PART_LIB> parsed;
+
+    if( stamped )
+    {
+        MUTLOCK lock( s_cachedLibsLock );
+
+        CACHED_PART_LIBS::iterator it = s_cachedLibs.find( fullName );
+
+        if( it != s_cachedLibs.end() && it->second.hash == hash && it->second.size == size )
+        {
+            parsed = it->second.lib;
+            it->second.lastUse = ++s_cachedLibsUse;
+        }
+    }
+
+    if( !parsed )
+    {
+        // Parse without the lock, so other libraries are parsed meanwhile.
+        parsed.reset( parseLibrary( aFileName ) );
+
+        if( stamped && size <= MAX_CACHED_LIBS_SIZE )
+        {
+            MUTLOCK lock( s_cachedLibsLock );
+
+            CACHED_PART_LIB& cached = s_cachedLibs[ fullName ];
+
+            if( cached.lib )
+                s_cachedLibsSize -= cached.size;
+
+            cached.hash    = hash;
+            cached.size    = size;
+            cached.lastUse = ++s_cachedLibsUse;
+            cached.lib     = parsed;
+
+            s_cachedLibsSize += size;
+
+            // Evict the least recently used libraries, to bound the memory used
+            // by the copies kept for the next loads.
+            while( s_cachedLibsSize > MAX_CACHED_LIBS_SIZE )
+            {
+                CACHED_PART_LIBS::iterator oldest = s_cachedLibs.begin();
+
+                for( CACHED_PART_LIBS::iterator it = s_cachedLibs.begin();
+                     it != s_cachedLibs.end(); ++it )
+                {
+                    if( it->second.lastUse < oldest->second.lastUse )
+                        oldest = it;
+                }
+
+                s_cachedLibsSize -= oldest->second.size;
+                s_cachedLibs.erase( oldest );
+            }
+        }
+    }
+
+    PART_LIB* lib = new PART_LIB( *parsed );
+
+    lib->fileName = aFileName;
+
+    return lib;
+}
+
+
+PART_LIB* PART_LIB::parseLibrary( const wxString& aFileName ) throw( IO_ERROR, boost::bad_pointer )
+{
+    std::auto_ptr<PART_LIB> lib( new PART_LIB( LIBRARY_TYPE_EESCHEMA, aFileName ) );
+
     wxString errorMsg;
 
     if( !lib->Load( errorMsg ) )
@@ -1053,11 +1243,31 @@ const wxString PART_LIBS::CacheName( const wxString& aFullProjectFilename )
 }
 
 
+void PART_LIBS::loadLibraryJob( const wxString& aFileName, PART_LIB** aLibrary,
+                                wxString* aErrorMsg )
+{
+    try
+    {
+        *aLibrary = PART_LIB::loadCachedLibrary( aFileName );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        *aErrorMsg = ioe.errorText;
+    }
+    catch( const std::exception& e )
+    {
+        *aErrorMsg = FROM_UTF8( e.what() );
+    }
+}
+
+
 void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::bad_pointer )
 {
     wxFileName      fn;
     wxString        filename;
     wxString        libs_not_found;
+    wxArrayString   filenames;
+    wxArrayString   names;
     SEARCH_STACK*   lib_search = aProject->SchSearchS();
 
 #if defined(DEBUG) && 1
@@ -1100,42 +1310,76 @@ void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::ba
             filename = fn.GetFullPath();
         }
 
-        try
-        {
-            AddLibrary( filename );
-        }
-        catch( const IO_ERROR& ioe )
-        {
-            wxString msg = wxString::Format( _(
-                    "Part library '%s' failed to load. Error:\n"
-                    "%s" ),
-                    GetChars( filename ),
-                    GetChars( ioe.errorText )
-                    );
+        // Don't load a library twice, see AddLibrary().
+        if( names.Index( fn.GetName(), true ) != wxNOT_FOUND )
+            continue;
 
-            THROW_IO_ERROR( msg );
-        }
+        names.Add( fn.GetName() );
+        filenames.Add( filename );
     }
 
-    // add the special cache library.
+    // add the special cache library, last.
     wxString cache_name = CacheName( aProject->GetProjectFullName() );
+    int      cache_index = wxNOT_FOUND;
+
     if( !!cache_name )
     {
-        try
-        {
-            if( PART_LIB* lib = AddLibrary( cache_name ) )
-                lib->SetCache();
-        }
-        catch( const IO_ERROR& ioe )
+        cache_index = names.Index( wxFileName( cache_name ).GetName(), true );
+
+        if( cache_index == wxNOT_FOUND )
+            cache_index = filenames.Add( cache_name );
+    }
+
+    wxBusyCursor ShowWait;
+
+    // Parse the libraries concurrently, then add them in the order of the project.
+    std::vector<PART_LIB*>  libs( filenames.GetCount(), (PART_LIB*) NULL );
+    std::vector<wxString>   errors( filenames.GetCount() );
+
+    {
+        JOB_GROUP   jobs;
+
+        for( unsigned i = 0; i < filenames.GetCount();  ++i )
+            jobs.Add( boost::bind( &PART_LIBS::loadLibraryJob, boost::cref( filenames[i] ),
+                                   &libs[i], &errors[i] ) );
+
+        jobs.Wait();
+    }
+
+    for( unsigned i = 0; i < libs.size();  ++i )
+    {
+        if( !libs[i] )
         {
-            wxString msg = wxString::Format( _(
-                    "Part library '%s' failed to load.\nError: %s" ),
-                    GetChars( cache_name ),
-                    GetChars( ioe.errorText )
-                    );
+            for( unsigned j = i + 1; j < libs.size();  ++j )
+                delete libs[j];
+
+            wxString msg;
+
+            if( filenames[i] == cache_name )
+            {
+                msg = wxString::Format( _(
+                        "Part library '%s' failed to load.\nError: %s" ),
+                        GetChars( cache_name ),
+                        GetChars( errors[i] )
+                        );
+            }
+            else
+            {
+                msg = wxString::Format( _(
+                        "Part library '%s' failed to load. Error:\n"
+                        "%s" ),
+                        GetChars( filenames[i] ),
+                        GetChars( errors[i] )
+                        );
+            }
 
             THROW_IO_ERROR( msg );
         }
+
+        if( (int) i == cache_index )
+            libs[i]->SetCache();
+
+        push_back( libs[i] );
     }
 
     // Print the libraries not found
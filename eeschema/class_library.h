@@ -240,6 +240,16 @@ public:
 
     int GetLibraryCount() { return size(); }
 
+private:
+    /**
+     * Function loadLibraryJob
+     * loads the library @a aFileName without user interface, from a worker thread.
+     *
+     * @param aLibrary - where to store the loaded library, or NULL on error.
+     * @param aErrorMsg - where to store the error message.
+     */
+    static void loadLibraryJob( const wxString& aFileName, PART_LIB** aLibrary,
+                                wxString* aErrorMsg );
 };
 
 
@@ -267,6 +277,13 @@ class PART_LIB
 
 public:
     PART_LIB( int aType, const wxString& aFileName );
+
+    /**
+     * Copy constructor
+     * copies all the parts and aliases of \a aLibrary.
+     */
+    PART_LIB( const PART_LIB& aLibrary );
+
     ~PART_LIB();
 
     /**
@@ -547,6 +564,21 @@ public:
      * @throw IO_ERROR if there's any problem loading the library.
      */
     static PART_LIB* LoadLibrary( const wxString& aFileName ) throw( IO_ERROR, boost::bad_pointer );
+
+private:
+    /**
+     * Function loadCachedLibrary
+     * is LoadLibrary() without user interface, so it may run on a worker thread.
+     * The libraries are parsed once for the whole process, and parsed again only
+     * when their files change: each caller gets a copy of the parsed library.
+     * The least recently used libraries are evicted when the total size of the
+     * parsed files reaches a limit.
+     */
+    static PART_LIB* loadCachedLibrary( const wxString& aFileName )
+        throw( IO_ERROR, boost::bad_pointer );
+
+    /// Parses the library file @a aFileName.
+    static PART_LIB* parseLibrary( const wxString& aFileName ) throw( IO_ERROR, boost::bad_pointer );
 };
 
 
@@ -32,8 +32,12 @@
 #define _CLASS_NETLIST_OBJECT_H_
 
 
+#include <map>
+#include <boost/unordered_map.hpp>
+
 #include <sch_sheet_path.h>
 #include <lib_pin.h>      // LIB_PIN::PinStringNum( m_PinNum )
+#include <disjoint_set.h>
 
 class NETLIST_OBJECT_LIST;
 class SCH_COMPONENT;
@@ -267,6 +271,27 @@ class NETLIST_OBJECT_LIST : public std::vector <NETLIST_OBJECT*>
     int m_lastBusNetCode;   // Used in intermediate calculation:
                             // last net code created for bus members
 
+    // Used in intermediate calculation: the net codes (and bus net codes)
+    // found connected together, merged by propageNetCode()
+    DISJOINT_SET m_netCodes;
+    DISJOINT_SET m_busNetCodes;
+
+    // Index of the items of the sheet being connected by BuildNetListInfo(),
+    // built by indexSheetItems(): items are stored by their index in list.
+    // The arrays are indexed by IS_WIRE (false) for the wire items,
+    // and IS_BUS (true) for the bus items
+    typedef std::pair<int, int>                                 POINT_KEY;
+    typedef boost::unordered_map< POINT_KEY, std::vector<int> > POINT_INDEX;
+    typedef boost::unordered_map< int, std::vector<int> >       LINE_INDEX;
+
+    POINT_INDEX      m_itemsByEnd[2];           // items by end point (m_Start and m_End)
+    LINE_INDEX       m_horizontalSegments[2];   // horizontal segments by Y coordinate
+    LINE_INDEX       m_verticalSegments[2];     // vertical segments by X coordinate
+    std::vector<int> m_otherSegments[2];        // oblique segments
+
+    // Items of label type, by lower case label name
+    std::map< wxString, std::vector<int> > m_labelsByName;
+
 public:
     /**
      * Constructor.
@@ -387,12 +412,39 @@ public:
 
 private:
     /*
-     * Propagate aNewNetCode to items having an internal netcode aOldNetCode
+     * Merge the groups of items having the net code aOldNetCode and aNewNetCode,
      * used to interconnect group of items already physically connected,
-     * when a new connection is found between aOldNetCode and aNewNetCode
+     * when a new connection is found between aOldNetCode and aNewNetCode.
+     * The item net codes are updated by resolveNetCodes()
      */
     void propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus );
 
+    /*
+     * Set the net codes (or bus net codes) of all items to the lowest
+     * net code of the group of net codes merged by propageNetCode()
+     */
+    void resolveNetCodes( bool aIsBus );
+
+    /*
+     * Connect the items of the list, which are the items of a single sheet,
+     * by their physical connections (wires, buses and junctions)
+     * The net codes are set from 1 to m_lastNetCode - 1, and the bus net codes
+     * from 1 to m_lastBusNetCode - 1.
+     */
+    void connectSheetItems();
+
+    /*
+     * Build the index of the items of the sheet of the item aIdxStart,
+     * i.e. from aIdxStart to the first item of an other sheet
+     * The list of objects is expected sorted by sheets.
+     */
+    void indexSheetItems( unsigned aIdxStart );
+
+    /*
+     * Build m_labelsByName
+     */
+    void indexLabels();
+
     /*
      * This function merges the net codes of groups of objects already connected
      * to labels (wires, bus, pins ... ) when 2 labels are equivalents
@@ -420,16 +472,19 @@ private:
      */
     void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel );
 
-    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start );
+    /*
+     * Search connections between the ends of aRef and the ends of the items
+     * of its sheet, in the index built by indexSheetItems()
+     */
+    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus );
 
     /*
      * Search connections betweena junction and segments
      * Propagate the junction net code to objects connected by this junction.
      * The junction must have a valid net code
-     * The list of objects is expected sorted by sheets.
-     * Search is done from index aIdxStart to the last element of list
+     * Search is done in the segments of the index built by indexSheetItems()
      */
-    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus, int aIdxStart );
+    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus );
 
     void connectBusLabels();
 
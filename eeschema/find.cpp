@@ -353,6 +353,8 @@ void SCH_EDIT_FRAME::OnFindReplace( wxFindDialogEvent& aEvent )
 
             if( m_foundItems.ReplaceItem( sheet ) )
             {
+                // The replaced item may be on an other sheet than the current one
+                sheet->LastScreen()->SetModify();
                 OnModify();
                 SaveUndoItemInUndoList( undoItem );
                 updateFindReplaceView( aEvent );
@@ -383,6 +385,8 @@ void SCH_EDIT_FRAME::OnFindReplace( wxFindDialogEvent& aEvent )
 
         if( m_foundItems.ReplaceItem( sheet ) )
         {
+            // The replaced item may be on an other sheet than the current one
+            sheet->LastScreen()->SetModify();
             OnModify();
             SaveUndoItemInUndoList( undoItem );
             updateFindReplaceView( aEvent );
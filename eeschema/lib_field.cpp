@@ -152,7 +152,7 @@ bool LIB_FIELD::Load( LINE_READER& aLineReader, wxString& errorMsg )
         return false;
     }
 
-    // Caller did a strtok(), which inserts a nul, so next few bytes are ugly:
+    // Caller did a strtok_r(), which inserts a nul, so next few bytes are ugly:
     // digit(s), a nul, some whitespace, then a double quote.
     while( line < limit && *line != '"' )
         line++;
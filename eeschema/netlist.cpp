@@ -41,9 +41,11 @@
 #include <sch_no_connect.h>
 #include <sch_text.h>
 #include <sch_sheet.h>
+#include <trigo.h>
 #include <algorithm>
 
 #include <boost/foreach.hpp>
+#include <boost/ptr_container/ptr_map.hpp>
 
 #define IS_WIRE false
 #define IS_BUS true
@@ -159,6 +161,33 @@ NETLIST_OBJECT_LIST * SCH_EDIT_FRAME::BuildNetListBase()
 }
 
 
+/*
+ * The netlist items of a sheet, connected by their physical connections inside the
+ * sheet only, with net codes starting at 1.  BuildNetListInfo() builds them again
+ * only when the screen of the sheet has changed (see SCH_SCREEN::ConnectionsChanged()).
+ */
+struct SHEET_NETLIST_ITEMS
+{
+    SCH_SHEET_PATH      m_SheetPath;
+    SCH_SCREEN*         m_Screen;
+    int                 m_ConnectionsStamp;
+    int                 m_Generation;       // last BuildNetListInfo() call using the items
+    NETLIST_OBJECT_LIST m_Items;
+
+    SHEET_NETLIST_ITEMS() :
+        m_Screen( NULL ),
+        m_ConnectionsStamp( 0 ),
+        m_Generation( 0 ),
+        m_Items( true )
+    {
+    }
+};
+
+// The netlist items of each sheet, by sheet path
+static boost::ptr_map< wxString, SHEET_NETLIST_ITEMS > s_sheetNetlistItems;
+static int s_netlistGeneration = 0;
+
+
 bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
 {
     s_NetObjectslist.SetOwner( true );
@@ -166,121 +195,81 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
 
     SCH_SHEET_PATH* sheet;
 
+    ++s_netlistGeneration;
+    m_lastNetCode = m_lastBusNetCode = 1;
+
     // Fill list with connected items from the flattened sheet list
     for( sheet = aSheets.GetFirst(); sheet != NULL;
          sheet = aSheets.GetNext() )
     {
-        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
-        {
-            item->GetNetListItem( *this, sheet );
-        }
-    }
+        SCH_SCREEN* screen = sheet->LastScreen();
 
-    if( size() == 0 )
-        return false;
+        // Components linked to parts of reloaded libraries are linked again here,
+        // which changes the connections stamp of the screen.
+        screen->CheckComponentsToPartsLinks();
 
-    // Sort objects by Sheet
-    SortListbySheet();
+        wxString path = sheet->Path();
 
-    sheet = &(GetItem( 0 )->m_SheetPath);
-    m_lastNetCode = m_lastBusNetCode = 1;
+        if( s_sheetNetlistItems.find( path ) == s_sheetNetlistItems.end() )
+            s_sheetNetlistItems.insert( path, new SHEET_NETLIST_ITEMS );
 
-    for( unsigned ii = 0, istart = 0; ii < size(); ii++ )
-    {
-        NETLIST_OBJECT* net_item = GetItem( ii );
+        SHEET_NETLIST_ITEMS& cached = s_sheetNetlistItems.at( path );
 
-        if( net_item->m_SheetPath != *sheet )   // Sheet change
+        if( cached.m_Screen != screen
+            || cached.m_ConnectionsStamp != screen->GetConnectionsStamp()
+            || cached.m_SheetPath != *sheet )
         {
-            sheet  = &(net_item->m_SheetPath);
-            istart = ii;
-        }
-
-        switch( net_item->m_Type )
-        {
-        case NET_ITEM_UNSPECIFIED:
-            wxMessageBox( wxT( "BuildNetListBase() error" ) );
-            break;
+            cached.m_Items.FreeList();
 
-        case NET_PIN:
-        case NET_PINLABEL:
-        case NET_SHEETLABEL:
-        case NET_NOCONNECT:
-            if( net_item->GetNet() != 0 )
-                break;
+            for( SCH_ITEM* item = screen->GetDrawItems(); item; item = item->Next() )
+                item->GetNetListItem( cached.m_Items, sheet );
 
-        case NET_SEGMENT:
-            // Test connections point to point type without bus.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+            cached.m_Items.connectSheetItems();
 
-            pointToPointConnect( net_item, IS_WIRE, istart );
-            break;
-
-        case NET_JUNCTION:
-            // Control of the junction outside BUS.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+            cached.m_SheetPath        = *sheet;
+            cached.m_Screen           = screen;
+            cached.m_ConnectionsStamp = screen->GetConnectionsStamp();
+        }
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+        cached.m_Generation = s_netlistGeneration;
 
-            // Control of the junction, on BUS.
-            if( net_item->m_BusNetCode == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+        // Copy the items, with net codes following the ones of the previous sheets
+        int netCodeOffset    = m_lastNetCode - 1;
+        int busNetCodeOffset = m_lastBusNetCode - 1;
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
-            break;
+        for( unsigned ii = 0; ii < cached.m_Items.size(); ii++ )
+        {
+            NETLIST_OBJECT* item = new NETLIST_OBJECT( *cached.m_Items.GetItem( ii ) );
 
-        case NET_LABEL:
-        case NET_HIERLABEL:
-        case NET_GLOBLABEL:
-            // Test connections type junction without bus.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+            if( item->GetNet() )
+                item->SetNet( item->GetNet() + netCodeOffset );
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
-            break;
+            if( item->m_BusNetCode )
+                item->m_BusNetCode += busNetCodeOffset;
 
-        case NET_SHEETBUSLABELMEMBER:
-            if( net_item->m_BusNetCode != 0 )
-                break;
+            push_back( item );
+        }
 
-        case NET_BUS:
-            // Control type connections point to point mode bus
-            if( net_item->m_BusNetCode == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+        m_lastNetCode    += cached.m_Items.m_lastNetCode - 1;
+        m_lastBusNetCode += cached.m_Items.m_lastBusNetCode - 1;
+    }
 
-            pointToPointConnect( net_item, IS_BUS, istart );
-            break;
+    // Forget the sheets removed from the hierarchy
+    for( boost::ptr_map< wxString, SHEET_NETLIST_ITEMS >::iterator it = s_sheetNetlistItems.begin();
+         it != s_sheetNetlistItems.end(); )
+    {
+        if( it->second->m_Generation != s_netlistGeneration )
+            s_sheetNetlistItems.erase( it++ );
+        else
+            ++it;
+    }
 
-        case NET_BUSLABELMEMBER:
-        case NET_HIERBUSLABELMEMBER:
-        case NET_GLOBBUSLABELMEMBER:
-            // Control connections similar has on BUS
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+    if( size() == 0 )
+        return false;
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
-            break;
-        }
-    }
+    // The labels create at most one net code each
+    m_netCodes.Reset( m_lastNetCode + size() );
+    m_busNetCodes.Reset( m_lastBusNetCode );
 
 #if defined(NETLIST_DEBUG) && defined(DEBUG)
     std::cout << "\n\nafter sheet local\n\n";
@@ -290,6 +279,8 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     // Updating the Bus Labels Netcode connected by Bus
     connectBusLabels();
 
+    indexLabels();
+
     // Group objects by label.
     for( unsigned ii = 0; ii < size(); ii++ )
     {
@@ -334,6 +325,10 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
             sheetLabelConnect( GetItem( ii ) );
     }
 
+    m_labelsByName.clear();
+
+    resolveNetCodes( IS_WIRE );
+
     // Sort objects by NetCode
     SortListbyNetcode();
 
@@ -366,6 +361,116 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     return true;
 }
 
+void NETLIST_OBJECT_LIST::connectSheetItems()
+{
+    m_lastNetCode = m_lastBusNetCode = 1;
+
+    // Each item creates at most one net code and one bus net code,
+    // and the first code is 1
+    m_netCodes.Reset( size() + 1 );
+    m_busNetCodes.Reset( size() + 1 );
+
+    indexSheetItems( 0 );
+
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* net_item = GetItem( ii );
+
+        switch( net_item->m_Type )
+        {
+        case NET_ITEM_UNSPECIFIED:
+            wxMessageBox( wxT( "BuildNetListBase() error" ) );
+            break;
+
+        case NET_PIN:
+        case NET_PINLABEL:
+        case NET_SHEETLABEL:
+        case NET_NOCONNECT:
+            if( net_item->GetNet() != 0 )
+                break;
+
+        case NET_SEGMENT:
+            // Test connections point to point type without bus.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            pointToPointConnect( net_item, IS_WIRE );
+            break;
+
+        case NET_JUNCTION:
+            // Control of the junction outside BUS.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_WIRE );
+
+            // Control of the junction, on BUS.
+            if( net_item->m_BusNetCode == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_BUS );
+            break;
+
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+            // Test connections type junction without bus.
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->SetNet( m_lastNetCode );
+                m_lastNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_WIRE );
+            break;
+
+        case NET_SHEETBUSLABELMEMBER:
+            if( net_item->m_BusNetCode != 0 )
+                break;
+
+        case NET_BUS:
+            // Control type connections point to point mode bus
+            if( net_item->m_BusNetCode == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            pointToPointConnect( net_item, IS_BUS );
+            break;
+
+        case NET_BUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            // Control connections similar has on BUS
+            if( net_item->GetNet() == 0 )
+            {
+                net_item->m_BusNetCode = m_lastBusNetCode;
+                m_lastBusNetCode++;
+            }
+
+            segmentToPointConnect( net_item, IS_BUS );
+            break;
+        }
+    }
+
+    // The index is no more needed
+    indexSheetItems( size() );
+
+    resolveNetCodes( IS_WIRE );
+    resolveNetCodes( IS_BUS );
+}
+
+
 // Helper function to give a priority to sort labels:
 // NET_PINLABEL and NET_GLOBLABEL are global labels
 // and the priority is hight
@@ -568,9 +673,17 @@ void NETLIST_OBJECT_LIST::sheetLabelConnect( NETLIST_OBJECT* SheetLabel )
     if( SheetLabel->GetNet() == 0 )
         return;
 
-    for( unsigned ii = 0; ii < size(); ii++ )
+    std::map< wxString, std::vector<int> >::const_iterator found =
+        m_labelsByName.find( SheetLabel->m_Label.Lower() );
+
+    if( found == m_labelsByName.end() )
+        return;
+
+    const std::vector<int>& labels = found->second;
+
+    for( unsigned ii = 0; ii < labels.size(); ii++ )
     {
-        NETLIST_OBJECT* ObjetNet = GetItem( ii );
+        NETLIST_OBJECT* ObjetNet = GetItem( labels[ii] );
 
         if( ObjetNet->m_SheetPath != SheetLabel->m_SheetPathInclude )
             continue;  //use SheetInclude, not the sheet!!
@@ -593,41 +706,63 @@ void NETLIST_OBJECT_LIST::sheetLabelConnect( NETLIST_OBJECT* SheetLabel )
 }
 
 
+static bool isBusLabelMember( const NETLIST_OBJECT* aItem )
+{
+    return aItem->m_Type == NET_SHEETBUSLABELMEMBER
+        || aItem->m_Type == NET_BUSLABELMEMBER
+        || aItem->m_Type == NET_HIERBUSLABELMEMBER;
+}
+
+
 void NETLIST_OBJECT_LIST::connectBusLabels()
 {
+    // Bus label members are connected when they have the same bus net code
+    // and the same member number: group them by bus net code and member number
+    typedef boost::unordered_map< std::pair<int, int>, std::vector<int> > MEMBERS;
+
+    MEMBERS members;
+
     for( unsigned ii = 0; ii < size(); ii++ )
     {
         NETLIST_OBJECT* Label = GetItem( ii );
 
-        if(  (Label->m_Type == NET_SHEETBUSLABELMEMBER)
-          || (Label->m_Type == NET_BUSLABELMEMBER)
-          || (Label->m_Type == NET_HIERBUSLABELMEMBER) )
+        if( isBusLabelMember( Label ) )
         {
-            if( Label->GetNet() == 0 )
-            {
-                Label->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+            std::pair<int, int> key( Label->m_BusNetCode, Label->m_Member );
 
-            for( unsigned jj = ii + 1; jj < size(); jj++ )
-            {
-                NETLIST_OBJECT* LabelInTst =  GetItem( jj );
-                if( (LabelInTst->m_Type == NET_SHEETBUSLABELMEMBER)
-                   || (LabelInTst->m_Type == NET_BUSLABELMEMBER)
-                   || (LabelInTst->m_Type == NET_HIERBUSLABELMEMBER) )
-                {
-                    if( LabelInTst->m_BusNetCode != Label->m_BusNetCode )
-                        continue;
+            members[key].push_back( ii );
+        }
+    }
+
+    // Give a net code to the first label of each group, by order in list,
+    // and connect the other labels of the group to it
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* Label = GetItem( ii );
 
-                    if( LabelInTst->m_Member != Label->m_Member )
-                        continue;
+        if( !isBusLabelMember( Label ) )
+            continue;
 
-                    if( LabelInTst->GetNet() == 0 )
-                        LabelInTst->SetNet( Label->GetNet() );
-                    else
-                        propageNetCode( LabelInTst->GetNet(), Label->GetNet(), IS_WIRE );
-                }
-            }
+        const std::vector<int>& group =
+            members[ std::pair<int, int>( Label->m_BusNetCode, Label->m_Member ) ];
+
+        if( group[0] != (int) ii )
+            continue;
+
+        if( Label->GetNet() == 0 )
+        {
+            Label->SetNet( m_lastNetCode );
+            m_lastNetCode++;
+        }
+
+        for( unsigned jj = 1; jj < group.size(); jj++ )
+        {
+            NETLIST_OBJECT* LabelInTst = GetItem( group[jj] );
+
+            if( LabelInTst->GetNet() == 0 )
+                LabelInTst->SetNet( Label->GetNet() );
+            else
+                propageNetCode( LabelInTst->GetNet(), Label->GetNet(), IS_WIRE );
         }
     }
 }
@@ -639,148 +774,212 @@ void NETLIST_OBJECT_LIST::propageNetCode( int aOldNetCode, int aNewNetCode, bool
         return;
 
     if( aIsBus == false )    // Propagate NetCode
+        m_netCodes.Union( aOldNetCode, aNewNetCode );
+    else                     // Propagate BusNetCode
+        m_busNetCodes.Union( aOldNetCode, aNewNetCode );
+}
+
+
+void NETLIST_OBJECT_LIST::resolveNetCodes( bool aIsBus )
+{
+    DISJOINT_SET& codes = aIsBus ? m_busNetCodes : m_netCodes;
+
+    // The lowest code of each group: codes are tested in increasing order,
+    // so the first code found in a group is the lowest one
+    std::vector<int> lowest( codes.GetSize(), -1 );
+
+    for( int code = 0; code < codes.GetSize(); code++ )
     {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
+        int& groupLowest = lowest[ codes.Find( code ) ];
 
-            if( object->GetNet() == aOldNetCode )
-                object->SetNet( aNewNetCode );
-        }
+        if( groupLowest < 0 )
+            groupLowest = code;
     }
-    else               // Propagate BusNetCode
+
+    for( unsigned ii = 0; ii < size(); ii++ )
     {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
+        NETLIST_OBJECT* item = GetItem( ii );
 
-            if( object->m_BusNetCode == aOldNetCode )
-                object->m_BusNetCode = aNewNetCode;
-        }
+        if( aIsBus == false )
+            item->SetNet( lowest[ codes.Find( item->GetNet() ) ] );
+        else
+            item->m_BusNetCode = lowest[ codes.Find( item->m_BusNetCode ) ];
     }
+
+    // Items have now their final code: start again with separate groups
+    codes.Reset( codes.GetSize() );
 }
 
 
-void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
-                                               int start )
+void NETLIST_OBJECT_LIST::indexSheetItems( unsigned aIdxStart )
 {
-    int netCode;
+    for( int kind = 0; kind < 2; kind++ )
+    {
+        m_itemsByEnd[kind].clear();
+        m_horizontalSegments[kind].clear();
+        m_verticalSegments[kind].clear();
+        m_otherSegments[kind].clear();
+    }
+
+    if( aIdxStart >= size() )
+        return;
+
+    const SCH_SHEET_PATH& sheet = GetItem( aIdxStart )->m_SheetPath;
 
-    if( aIsBus == false )    // Objects other than BUS and BUSLABELS
+    for( unsigned ii = aIdxStart; ii < size(); ii++ )
     {
-        netCode = aRef->GetNet();
+        NETLIST_OBJECT* item = GetItem( ii );
 
-        for( unsigned i = start; i < size(); i++ )
+        if( item->m_SheetPath != sheet )
+            break;
+
+        bool isWire = false;
+        bool isBus  = false;
+
+        switch( item->m_Type )
         {
-            NETLIST_OBJECT* item = GetItem( i );
+        case NET_SEGMENT:
+        case NET_PIN:
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+        case NET_SHEETLABEL:
+        case NET_PINLABEL:
+        case NET_NOCONNECT:
+            isWire = true;
+            break;
 
-            if( item->m_SheetPath != aRef->m_SheetPath )  //used to be > (why?)
-                continue;
+        case NET_BUS:
+        case NET_BUSLABELMEMBER:
+        case NET_SHEETBUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            isBus = true;
+            break;
 
-            switch( item->m_Type )
-            {
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_JUNCTION:
-            case NET_NOCONNECT:
-                if( aRef->m_Start == item->m_Start
-                    || aRef->m_Start == item->m_End
-                    || aRef->m_End   == item->m_Start
-                    || aRef->m_End   == item->m_End )
-                {
-                    if( item->GetNet() == 0 )
-                        item->SetNet( netCode );
-                    else
-                        propageNetCode( item->GetNet(), netCode, IS_WIRE );
-                }
-                break;
+        case NET_JUNCTION:
+            isWire = isBus = true;
+            break;
 
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_ITEM_UNSPECIFIED:
-                break;
-            }
+        case NET_ITEM_UNSPECIFIED:
+            break;
         }
-    }
-    else    // Object type BUS, BUSLABELS, and junctions.
-    {
-        netCode = aRef->m_BusNetCode;
 
-        for( unsigned i = start; i < size(); i++ )
+        for( int kind = 0; kind < 2; kind++ )
         {
-            NETLIST_OBJECT* item = GetItem( i );
-
-            if( item->m_SheetPath != aRef->m_SheetPath )
+            if( !( kind == IS_BUS ? isBus : isWire ) )
                 continue;
 
-            switch( item->m_Type )
-            {
-            case NET_ITEM_UNSPECIFIED:
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_NOCONNECT:
-                break;
+            m_itemsByEnd[kind][ POINT_KEY( item->m_Start.x, item->m_Start.y ) ].push_back( ii );
 
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_JUNCTION:
-                if(  aRef->m_Start == item->m_Start
-                  || aRef->m_Start == item->m_End
-                  || aRef->m_End   == item->m_Start
-                  || aRef->m_End   == item->m_End )
-                {
-                    if( item->m_BusNetCode == 0 )
-                        item->m_BusNetCode = netCode;
-                    else
-                        propageNetCode( item->m_BusNetCode, netCode, IS_BUS );
-                }
-                break;
-            }
+            if( item->m_End != item->m_Start )
+                m_itemsByEnd[kind][ POINT_KEY( item->m_End.x, item->m_End.y ) ].push_back( ii );
         }
+
+        if( item->m_Type == NET_SEGMENT || item->m_Type == NET_BUS )
+        {
+            int kind = item->m_Type == NET_BUS ? IS_BUS : IS_WIRE;
+
+            if( item->m_Start.y == item->m_End.y )
+                m_horizontalSegments[kind][ item->m_Start.y ].push_back( ii );
+            else if( item->m_Start.x == item->m_End.x )
+                m_verticalSegments[kind][ item->m_Start.x ].push_back( ii );
+            else
+                m_otherSegments[kind].push_back( ii );
+        }
+    }
+}
+
+
+void NETLIST_OBJECT_LIST::indexLabels()
+{
+    m_labelsByName.clear();
+
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* item = GetItem( ii );
+
+        if( item->IsLabelType() )
+            m_labelsByName[ item->m_Label.Lower() ].push_back( ii );
     }
 }
 
 
-void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction,
-                                                bool aIsBus, int aIdxStart )
+void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus )
 {
-    for( unsigned i = aIdxStart; i < size(); i++ )
+    const POINT_INDEX& index = m_itemsByEnd[aIsBus];
+
+    // Objects other than BUS and BUSLABELS use the net code,
+    // objects type BUS, BUSLABELS, and junctions use the bus net code.
+    int netCode = aIsBus == false ? aRef->GetNet() : aRef->m_BusNetCode;
+
+    for( int end = 0; end < 2; end++ )
     {
-        NETLIST_OBJECT* segment = GetItem( i );
+        const wxPoint& pos = end == 0 ? aRef->m_Start : aRef->m_End;
 
-        // if different sheets, obviously no physical connection between elements.
-        if( segment->m_SheetPath != aJonction->m_SheetPath )
+        if( end == 1 && pos == aRef->m_Start )
+            break;
+
+        POINT_INDEX::const_iterator found = index.find( POINT_KEY( pos.x, pos.y ) );
+
+        if( found == index.end() )
             continue;
 
-        if( aIsBus == IS_WIRE )
+        const std::vector<int>& items = found->second;
+
+        for( unsigned i = 0; i < items.size(); i++ )
         {
-            if( segment->m_Type != NET_SEGMENT )
-                continue;
+            NETLIST_OBJECT* item = GetItem( items[i] );
+
+            if( aIsBus == false )
+            {
+                if( item->GetNet() == 0 )
+                    item->SetNet( netCode );
+                else
+                    propageNetCode( item->GetNet(), netCode, IS_WIRE );
+            }
+            else
+            {
+                if( item->m_BusNetCode == 0 )
+                    item->m_BusNetCode = netCode;
+                else
+                    propageNetCode( item->m_BusNetCode, netCode, IS_BUS );
+            }
         }
-        else
+    }
+}
+
+
+void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus )
+{
+    const wxPoint& pos = aJonction->m_Start;
+
+    // Only the horizontal segments at the same Y, the vertical segments at the same X,
+    // and the oblique segments can contain the junction
+    const std::vector<int>* candidates[3] = { NULL, NULL, &m_otherSegments[aIsBus] };
+
+    LINE_INDEX::const_iterator found = m_horizontalSegments[aIsBus].find( pos.y );
+
+    if( found != m_horizontalSegments[aIsBus].end() )
+        candidates[0] = &found->second;
+
+    found = m_verticalSegments[aIsBus].find( pos.x );
+
+    if( found != m_verticalSegments[aIsBus].end() )
+        candidates[1] = &found->second;
+
+    for( int list = 0; list < 3; list++ )
+    {
+        if( !candidates[list] )
+            continue;
+
+        for( unsigned i = 0; i < candidates[list]->size(); i++ )
         {
-            if( segment->m_Type != NET_BUS )
+            NETLIST_OBJECT* segment = GetItem( (*candidates[list])[i] );
+
+            if( !IsPointOnSegment( segment->m_Start, segment->m_End, pos ) )
                 continue;
-        }
 
-        if( IsPointOnSegment( segment->m_Start, segment->m_End, aJonction->m_Start ) )
-        {
             // Propagation Netcode has all the objects of the same Netcode.
             if( aIsBus == IS_WIRE )
             {
@@ -806,9 +1005,18 @@ void NETLIST_OBJECT_LIST::labelConnect( NETLIST_OBJECT* aLabelRef )
     if( aLabelRef->GetNet() == 0 )
         return;
 
-    for( unsigned i = 0; i < size(); i++ )
+    // Only the labels having the same name can be connected
+    std::map< wxString, std::vector<int> >::const_iterator found =
+        m_labelsByName.find( aLabelRef->m_Label.Lower() );
+
+    if( found == m_labelsByName.end() )
+        return;
+
+    const std::vector<int>& labels = found->second;
+
+    for( unsigned i = 0; i < labels.size(); i++ )
     {
-        NETLIST_OBJECT* item = GetItem( i );
+        NETLIST_OBJECT* item = GetItem( labels[i] );
 
         if( item->GetNet() == aLabelRef->GetNet() )
             continue;
@@ -29,6 +29,7 @@
 #include <macros.h>
 
 #include <sch_sheet_path.h>
+#include <class_sch_screen.h>
 #include <transform.h>
 #include <sch_collectors.h>
 #include <sch_component.h>
@@ -467,8 +468,15 @@ bool SCH_FIND_COLLECTOR::ReplaceItem( SCH_SHEET_PATH* aSheetPath )
     bool replaced = item->Replace( m_findReplaceData, aSheetPath );
 
     if( replaced )
+    {
         m_forceSearch = true;
 
+        // The item may be on an other sheet than the current one: the netlist items
+        // kept for its screen must be built again, e.g. for a replaced label text.
+        if( aSheetPath && aSheetPath->LastScreen() )
+            aSheetPath->LastScreen()->ConnectionsChanged();
+    }
+
     return replaced;
 }
 
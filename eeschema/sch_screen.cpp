@@ -95,6 +95,7 @@ SCH_SCREEN::SCH_SCREEN( KIWAY* aKiway ) :
     m_paper( wxT( "A4" ) )
 {
     m_modification_sync = 0;
+    ConnectionsChanged();
 
     SetZoom( 32 );
 
@@ -149,12 +150,24 @@ void SCH_SCREEN::Clear()
 void SCH_SCREEN::FreeDrawList()
 {
     m_drawList.DeleteAll();
+    ConnectionsChanged();
 }
 
 
 void SCH_SCREEN::Remove( SCH_ITEM* aItem )
 {
     m_drawList.Remove( aItem );
+    ConnectionsChanged();
+}
+
+
+void SCH_SCREEN::ConnectionsChanged()
+{
+    // Not a counter per screen: a new screen allocated at the address of a deleted
+    // one must not have the stamp of the deleted one.
+    static int s_connectionsGeneration = 0;
+
+    m_connectionsStamp = ++s_connectionsGeneration;
 }
 
 
@@ -163,6 +176,7 @@ void SCH_SCREEN::DeleteItem( SCH_ITEM* aItem )
     wxCHECK_RET( aItem, wxT( "Cannot delete invalid item from screen." ) );
 
     SetModify();
+    ConnectionsChanged();
 
     if( aItem->Type() == SCH_SHEET_PIN_T )
     {
@@ -260,6 +274,8 @@ void SCH_SCREEN::ExtractWires( DLIST< SCH_ITEM >& aList, bool aCreateCopy )
             break;
         }
     }
+
+    ConnectionsChanged();
 }
 
 
@@ -286,6 +302,7 @@ void SCH_SCREEN::ReplaceWires( DLIST< SCH_ITEM >& aWireList )
     }
 
     m_drawList.Append( aWireList );
+    ConnectionsChanged();
 }
 
 
@@ -477,6 +494,9 @@ bool SCH_SCREEN::SchematicCleanUp( EDA_DRAW_PANEL* aCanvas, wxDC* aDC )
 
     TestDanglingEnds( aCanvas, aDC );
 
+    if( modified )
+        ConnectionsChanged();
+
     if( aCanvas && modified )
         aCanvas->Refresh();
 
@@ -562,6 +582,7 @@ void SCH_SCREEN::CheckComponentsToPartsLinks()
             SCH_COMPONENT::ResolveAll( c, libs );
 
             m_modification_sync = mod_hash;     // note the last mod_hash
+            ConnectionsChanged();               // the pins may have changed
 
             // guard against unneeded runs through this code path by printing trace
             DBG(printf("%s: resync-ing %s\n", __func__, TO_UTF8( GetFileName() ) );)
@@ -977,6 +998,9 @@ bool SCH_SCREEN::BreakSegment( const wxPoint& aPoint )
         brokenSegments = true;
     }
 
+    if( brokenSegments )
+        ConnectionsChanged();
+
     return brokenSegments;
 }
 
@@ -272,7 +272,15 @@ void SCH_SHEET_PATH::AnnotatePowerSymbols( PART_LIBS* aLibs, int* aReference )
             refstr = wxT( "#" ) + refstr;
 
         refstr << wxT( "0" ) << ref;
-        component->SetRef( this, refstr );
+
+        // The netlist items kept for the screen must be built again if a reference
+        // changes, but not at each netlist build
+        if( component->GetRef( this ) != refstr )
+        {
+            component->SetRef( this, refstr );
+            LastScreen()->ConnectionsChanged();
+        }
+
         ref++;
     }
 
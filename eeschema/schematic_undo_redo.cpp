@@ -147,6 +147,9 @@ void SCH_EDIT_FRAME::SaveCopyInUndoList( SCH_ITEM*      aItem,
 
     if( commandToUndo->GetCount() )
     {
+        // The saved items are about to be changed
+        GetScreen()->ConnectionsChanged();
+
         /* Save the copy in undo list */
         GetScreen()->PushCommandToUndoList( commandToUndo );
 
@@ -218,6 +221,9 @@ void SCH_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
 
     if( commandToUndo->GetCount() || aTypeCommand == UR_WIRE_IMAGE )
     {
+        // The saved items are about to be changed
+        GetScreen()->ConnectionsChanged();
+
         /* Save the copy in undo list */
         GetScreen()->PushCommandToUndoList( commandToUndo );
 
@@ -236,6 +242,8 @@ void SCH_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
     SCH_ITEM* item;
     SCH_ITEM* alt_item;
 
+    GetScreen()->ConnectionsChanged();
+
     // Exchange the current wires, buses, and junctions with the copy save by the last edit.
     if( aList->m_Status == UR_WIRE_IMAGE )
     {
@@ -718,6 +718,7 @@ void SCH_EDIT_FRAME::OnModify()
 {
     GetScreen()->SetModify();
     GetScreen()->SetSave();
+    GetScreen()->ConnectionsChanged();
 
     if( m_dlgFindReplace == NULL )
         m_foundItems.SetForceSearch();
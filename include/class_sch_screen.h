@@ -84,6 +84,9 @@ private:
     int     m_modification_sync;        ///< inequality with PART_LIBS::GetModificationHash()
                                         ///< will trigger ResolveAll().
 
+    int     m_connectionsStamp;         ///< unique among all the screens of the process,
+                                        ///< changed when the items connections may change.
+
     /**
      * Function addConnectedItemsToBlock
      * add items connected at \a aPosition to the block pick list.
@@ -140,6 +143,7 @@ public:
     {
         m_drawList.Append( aItem );
         --m_modification_sync;
+        ConnectionsChanged();
     }
 
     /**
@@ -152,8 +156,25 @@ public:
     {
         m_drawList.Append( aList );
         --m_modification_sync;
+        ConnectionsChanged();
     }
 
+    /**
+     * Function ConnectionsChanged
+     * tells the netlist builder that the connections of the items of the screen may
+     * have changed, so their netlist items must be built again.  This is done by the
+     * undo/redo functions and SCH_EDIT_FRAME::OnModify() for the edits of the
+     * current screen.
+     */
+    void ConnectionsChanged();
+
+    /**
+     * Function GetConnectionsStamp
+     * @return int - a value unique among all the screens of the process, which changes
+     *  each time ConnectionsChanged() is called.
+     */
+    int GetConnectionsStamp() const                         { return m_connectionsStamp; }
+
     /**
      * Function GetCurItem
      * returns the currently selected SCH_ITEM, overriding BASE_SCREEN::GetCurItem().
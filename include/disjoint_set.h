@@ -0,0 +1,123 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file disjoint_set.h
+ * @brief Union-find structure used to build clusters of connected items.
+ */
+
+#ifndef DISJOINT_SET_H_
+#define DISJOINT_SET_H_
+
+#include <vector>
+#include <algorithm>
+
+
+/**
+ * Class DISJOINT_SET
+ * partitions the integers 0 .. size-1 into disjoint sets (union-find with union
+ * by size and path compression), so that merging two clusters of items and finding
+ * the cluster of an item take an almost constant time, whatever the cluster sizes are.
+ */
+class DISJOINT_SET
+{
+public:
+    DISJOINT_SET( int aSize = 0 )
+    {
+        Reset( aSize );
+    }
+
+    /**
+     * Function Reset
+     * puts each element of 0 .. aSize-1 in its own set.
+     */
+    void Reset( int aSize )
+    {
+        m_parent.resize( aSize );
+        m_size.assign( aSize, 1 );
+
+        for( int ii = 0; ii < aSize; ++ii )
+            m_parent[ii] = ii;
+    }
+
+    int GetSize() const             { return m_parent.size(); }
+
+    /**
+     * Function Find
+     * @return the representative of the set containing aElement.
+     */
+    int Find( int aElement )
+    {
+        int root = aElement;
+
+        while( m_parent[root] != root )
+            root = m_parent[root];
+
+        // Path compression: attach all the elements of the path to the root
+        while( m_parent[aElement] != root )
+        {
+            int next = m_parent[aElement];
+            m_parent[aElement] = root;
+            aElement = next;
+        }
+
+        return root;
+    }
+
+    /**
+     * Function Union
+     * merges the sets containing aFirst and aSecond.
+     * @return the representative of the merged set.
+     */
+    int Union( int aFirst, int aSecond )
+    {
+        int first  = Find( aFirst );
+        int second = Find( aSecond );
+
+        if( first == second )
+            return first;
+
+        if( m_size[first] < m_size[second] )
+            std::swap( first, second );
+
+        m_parent[second] = first;
+        m_size[first] += m_size[second];
+
+        return first;
+    }
+
+    /**
+     * Function GetSetSize
+     * @return the number of elements of the set containing aElement.
+     */
+    int GetSetSize( int aElement )
+    {
+        return m_size[Find( aElement )];
+    }
+
+private:
+    std::vector<int>    m_parent;
+    std::vector<int>    m_size;     ///< element count, valid for the representatives only
+};
+
+#endif  // DISJOINT_SET_H_
@@ -90,6 +90,7 @@ protected:
 
     READER_STACK        readerStack;            ///< all the LINE_READERs by pointer.
     LINE_READER*        reader;                 ///< no ownership. ownership is via readerStack, maybe, if iOwnReaders
+    MMAP_LINE_READER*   mmapReader;             ///< reader, if it is a MMAP_LINE_READER, else NULL
 
     bool                specctraMode;           ///< if true, then:
                                                 ///< 1) stringDelimiter can be changed
@@ -116,6 +117,22 @@ protected:
 
     int readLine() throw( IO_ERROR )
     {
+        if( mmapReader )
+        {
+            // Lex directly in the mapped file, the line is not copied.
+            unsigned len;
+
+            start = mmapReader->ReadLineView( &len );
+
+            if( !start )
+                start = dummy;
+
+            next  = start;
+            limit = next + len;
+
+            return len;
+        }
+
         if( reader )
         {
             reader->ReadLine();
@@ -516,6 +533,9 @@ public:
      */
     const char* CurLine()
     {
+        if( mmapReader )
+            return mmapReader->LineFromView();
+
         return (const char*)(*reader);
     }
 
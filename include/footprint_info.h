@@ -42,6 +42,8 @@
 
 class FP_LIB_TABLE;
 class FOOTPRINT_LIST;
+class FOOTPRINT_INFO_INDEX;
+class JOB_GROUP;
 class wxTopLevelWindow;
 
 
@@ -75,6 +77,25 @@ public:
 #endif
     }
 
+    /**
+     * Constructor
+     * for a footprint whose doc, keywords and pad count are already known, for instance
+     * from the footprint index: the footprint is not loaded from its library.
+     */
+    FOOTPRINT_INFO( FOOTPRINT_LIST* aOwner, const wxString& aNickname,
+                    const wxString& aFootprintName, const wxString& aDoc,
+                    const wxString& aKeywords, int aPadCount ) :
+        m_owner( aOwner ),
+        m_loaded( true ),
+        m_nickname( aNickname ),
+        m_fpname( aFootprintName ),
+        m_num( 0 ),
+        m_pad_count( aPadCount ),
+        m_doc( aDoc ),
+        m_keywords( aKeywords )
+    {
+    }
+
     const wxString& GetDoc()
     {
         ensure_loaded();
@@ -154,6 +175,8 @@ inline bool operator<( const FOOTPRINT_INFO& item1, const FOOTPRINT_INFO& item2
 class FOOTPRINT_LIST
 {
     FP_LIB_TABLE*   m_lib_table;        ///< no ownership
+    FOOTPRINT_INFO_INDEX* m_index;      ///< no ownership, used during ReadFootprintFiles()
+    JOB_GROUP*      m_jobs;             ///< no ownership, used during ReadFootprintFiles()
     volatile int    m_error_count;      ///< thread safe to read.
 
     typedef boost::ptr_vector< FOOTPRINT_INFO >         FPILIST;
@@ -167,13 +190,31 @@ class FOOTPRINT_LIST
 
     /**
      * Function loader_job
-     * loads footprints from @a aNicknameList and calls AddItem() on to help fill
-     * m_list.
-     *
-     * @param aNicknameList is a wxString[] holding libraries to load all footprints from.
-     * @param aJobZ is the size of the job, i.e. the count of nicknames.
+     * loads the footprints of the library @a aNickname, to help fill m_list.
+     * It runs on the thread pool, and adds to m_jobs one job per footprint for the
+     * libraries which have one file per footprint.
+     */
+    void loader_job( const wxString& aNickname );
+
+    /**
+     * Function footprint_job
+     * adds to m_list the footprint of the file @a aFileName, in the library @a aNickname
+     * whose path is @a aLibPath.
+     */
+    void footprint_job( const wxString& aNickname, const wxString& aLibPath,
+                        const wxString& aFileName );
+
+    /// Records the exception being handled by a job, as an IO_ERROR.
+    void addCurrentError();
+
+    /**
+     * Function loadLibrary
+     * adds the footprints of the library @a aNickname to m_list.  The footprints
+     * which did not change since they were put in m_index are read from it, the
+     * other ones are loaded from the library, and put in m_index.  A KiCad library
+     * is loaded by one footprint_job() per footprint file.
      */
-    void loader_job( const wxString* aNicknameList, int aJobZ );
+    void loadLibrary( const wxString& aNickname );
 
     void addItem( FOOTPRINT_INFO* aItem )
     {
@@ -189,6 +230,8 @@ public:
 
     FOOTPRINT_LIST() :
         m_lib_table( 0 ),
+        m_index( 0 ),
+        m_jobs( 0 ),
         m_error_count( 0 )
     {
     }
@@ -230,6 +273,9 @@ public:
     /**
      * Function ReadFootprintFiles
      * reads all the footprints provided by the combination of aTable and aNickname.
+     * The footprints which did not change since the previous call, even in an other
+     * session, are read from an index in the KiCad configuration directory instead
+     * of their library.
      *
      * @param aTable defines all the libraries.
      * @param aNickname is the library to read from, or if NULL means read all
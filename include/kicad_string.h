@@ -164,6 +164,21 @@ wxString GetIllegalFileNameWxChars();
  */
 bool ReplaceIllegalFileNameChars( std::string* aName );
 
+/**
+ * Function Strtod_C
+ * is strtod() with the C locale, whatever the current locale is, so it can be used
+ * without LOCALE_IO, e.g. by several threads.  Decimal numbers with up to 15
+ * significant digits, i.e. all the numbers written by KiCad, are converted
+ * without any call to the C library and give the same (correctly rounded)
+ * result as strtod().
+ *
+ * @param aText is the number text, with optional leading white space.
+ * @param aEndPtr, if not NULL, is where to put the position after the number, or
+ *  @a aText if there is no number.
+ * @return double - the number, and errno is set to ERANGE on overflow.
+ */
+double Strtod_C( const char* aText, char** aEndPtr );
+
 #ifndef HAVE_STRTOKR
 // common/strtok_r.c optionally:
 extern "C" char* strtok_r( char* str, const char* delim, char** nextp );
@@ -42,6 +42,7 @@ class wxSingleInstanceChecker;
 class wxApp;
 class wxMenu;
 class wxWindow;
+class THREAD_POOL;
 
 
 // inter program module calling
@@ -255,6 +256,14 @@ public:
      */
     VTBL_ENTRY void ConfigurePaths( wxWindow* aParent = NULL );
 
+    /**
+     * Function GetThreadPool
+     * returns the pool of worker threads shared by all the KIFACEs of this process.
+     * It is created on first use, and stopped by destroy(), before the KIFACEs
+     * are unloaded.  Use THREAD_POOL::Get().
+     */
+    VTBL_ENTRY THREAD_POOL& GetThreadPool();
+
     /**
      * Function App
      * returns a bare naked wxApp, which may come from wxPython, SINGLE_TOP, or kicad.exe.
@@ -342,6 +351,9 @@ protected:
 
     wxApp*          m_wx_app;
 
+    /// The worker threads, see GetThreadPool().
+    THREAD_POOL*    m_thread_pool;
+
     // The PGM_* classes can have difficulties at termination if they
     // are not destroyed soon enough.  Relying on a static destructor can be
     // too late for contained objects like wxSingleInstanceChecker.
@@ -30,6 +30,8 @@
 
 
 #include <vector>
+#include <cstring>
+#include <stdint.h>
 #include <utf8.h>
 
 // I really did not want to be dependent on wxWidgets in richio
@@ -380,6 +382,249 @@ public:
 };
 
 
+/**
+ * Class MMAP_LINE_READER
+ * is a LINE_READER that maps a whole file in memory (or reads it in a single
+ * block where mapping is not available) instead of reading it byte per byte.
+ * Besides the usual nul terminated ReadLine(), it hands out the lines as views
+ * into the mapping, without any copy, see ReadLineView().
+ * <p>
+ * Limitation: the file must not be truncated by another process while it is
+ * mapped, otherwise reading the lost part of the mapping raises SIGBUS.  Files
+ * are read once and closed by the loaders, so this window is short.
+ * </p>
+ */
+class MMAP_LINE_READER : public LINE_READER
+{
+protected:
+    const char*         m_data;         ///< the file content, not nul terminated.
+    size_t              m_size;         ///< no. bytes in m_data.
+    size_t              m_ndx;          ///< offset of the next line in m_data.
+
+    const char*         m_view;         ///< the last line read by ReadLineView().
+    bool                m_lineCopied;   ///< true if @a line holds the last line read.
+
+    void*               m_mapping;      ///< the mapped area, NULL if none.
+    std::vector<char>   m_buffer;       ///< the file content, when it is not mapped.
+
+public:
+
+    /**
+     * Constructor MMAP_LINE_READER
+     * opens and maps @a aFileName and releases the file on destruction.
+     *
+     * @param aFileName is the name of the file to open and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error,
+     *  see FILE_LINE_READER.
+     * @param aMaxLineLength is the maximum length of a line returned by ReadLine().
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or read.
+     */
+    MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX ) throw( IO_ERROR );
+
+    /**
+     * Constructor MMAP_LINE_READER
+     * reads a part of a file already loaded by another MMAP_LINE_READER, e.g. to
+     * parse several parts of a file concurrently.
+     *
+     * @param aFile is the reader of the whole file, which must outlive this one.
+     *  Its source name is used for error reporting purposes.
+     * @param aBegin is the offset of the first byte of the part in the file.
+     * @param aEnd is the offset of the byte after the part.
+     * @param aStartingLineNumber is the number of the line before the part.
+     */
+    MMAP_LINE_READER( const MMAP_LINE_READER& aFile, size_t aBegin, size_t aEnd,
+            unsigned aStartingLineNumber );
+
+    ~MMAP_LINE_READER();
+
+    char* ReadLine() throw( IO_ERROR );   // see LINE_READER::ReadLine() description
+
+    /**
+     * Function GetData
+     * @return const char* - the content of the file (not nul terminated), or NULL
+     *  if the file is empty.
+     */
+    const char* GetData() const     { return m_data; }
+
+    /**
+     * Function GetSize
+     * @return size_t - the number of bytes of the file.
+     */
+    size_t GetSize() const          { return m_size; }
+
+    /**
+     * Function ReadLineView
+     * reads the next line like ReadLine() does, but returns it in place: the line is
+     * not copied, is not nul terminated and is valid as long as this reader exists.
+     * Line() is not updated, use LineFromView() to get a nul terminated copy.
+     *
+     * @param aLength is where to put the number of bytes of the line, including
+     *  the end of line char(s), and 0 at end of file.
+     * @return const char* - The beginning of the read line, or NULL if EOF.
+     * @throw IO_ERROR when the last line, which is copied, is too long.
+     */
+    const char* ReadLineView( unsigned* aLength ) throw( IO_ERROR );
+
+    /**
+     * Function LineFromView
+     * copies the last line returned by ReadLineView() to the line buffer, if not
+     * already done, e.g. to report an error.
+     * @return char* - the nul terminated line, truncated to the maximum line length.
+     */
+    char* LineFromView();
+
+    /**
+     * Function Rewind
+     * goes back to the beginning of the file and resets the line number back to zero.
+     */
+    void Rewind()
+    {
+        m_ndx   = 0;
+        lineNum = 0;
+    }
+};
+
+
+/**
+ * Function CacheFileName
+ * @return wxString - the name of the binary cache of @a aFileName, which is
+ *  @a aFileName with "-cache" appended to its extension.
+ */
+wxString CacheFileName( const wxString& aFileName );
+
+
+/**
+ * Class CACHE_WRITER
+ * builds the content of a binary cache file in memory, e.g. the cache of a big
+ * board or 3D model file, which is faster to read than the file itself.  The
+ * numbers are stored in the native byte order: the magic number of the header
+ * does not match on a machine with an other byte order, and the cache is not used.
+ * A cache starts with the header written by PutHeader() and checked by
+ * CACHE_READER::CheckHeader().
+ */
+class CACHE_WRITER
+{
+public:
+    template <class T> void Put( T aValue )
+    {
+        m_data.append( (const char*) &aValue, sizeof( aValue ) );
+    }
+
+    void Put( const char* aData, size_t aSize )
+    {
+        m_data.append( aData, aSize );
+    }
+
+    /// Puts the size of aList, then its items, see CACHE_READER::GetList().
+    template <class T> void PutList( const std::vector<T>& aList )
+    {
+        Put<uint32_t>( aList.size() );
+
+        if( !aList.empty() )
+            Put( (const char*) &aList[0], aList.size() * sizeof( T ) );
+    }
+
+    /**
+     * Function PutHeader
+     * puts the header of the cache: @a aMagic, @a aVersion, and the size,
+     * modification time and hash of the file the cache is made from.
+     * @param aMagic is the 8 bytes identifying the kind of cache.
+     * @param aVersion is the version of the cache format.
+     * @param aSource is the reader of the whole file the cache is made from.
+     */
+    void PutHeader( const char* aMagic, uint32_t aVersion, const MMAP_LINE_READER& aSource );
+
+    /**
+     * Function Write
+     * writes the cache to @a aFileName.  A temporary file is written first, so
+     * a partially written cache never replaces a valid one.
+     * @return bool - true if the cache was written.
+     */
+    bool Write( const wxString& aFileName ) const;
+
+    const std::string& GetData() const  { return m_data; }
+
+private:
+    std::string m_data;
+};
+
+
+/**
+ * Class CACHE_READER
+ * reads the numbers of a cache written by CACHE_WRITER, and throws an IO_ERROR
+ * when reading past its end.
+ */
+class CACHE_READER
+{
+public:
+    /**
+     * Constructor CACHE_READER
+     * @param aCache is the reader of the whole cache file, which must outlive this one.
+     */
+    CACHE_READER( const MMAP_LINE_READER& aCache ) :
+        m_data( aCache.GetData() ),
+        m_size( aCache.GetSize() ),
+        m_pos( 0 ),
+        m_source( aCache.GetSource() )
+    {
+    }
+
+    template <class T> T Get() throw( IO_ERROR )
+    {
+        T value;
+
+        memcpy( &value, Skip( sizeof( value ) ), sizeof( value ) );
+
+        return value;
+    }
+
+    /// Gets a list put by CACHE_WRITER::PutList().
+    template <class T> void GetList( std::vector<T>& aList ) throw( IO_ERROR )
+    {
+        uint32_t count = Get<uint32_t>();
+
+        // Check the size first, a corrupted count must not allocate gigabytes
+        const char* data = Skip( (size_t) count * sizeof( T ) );
+
+        aList.resize( count );
+
+        if( count )
+            memcpy( &aList[0], data, (size_t) count * sizeof( T ) );
+    }
+
+    /**
+     * Function CheckHeader
+     * reads the header written by CACHE_WRITER::PutHeader().
+     * @param aMagic is the 8 bytes identifying the kind of cache.
+     * @param aVersion is the version of the cache format.
+     * @param aSourceFileName is the name of the file the cache is made from.
+     * @return bool - true if the magic number and the version match, and
+     *  @a aSourceFileName has the size, modification time and hash of the header.
+     * @throw IO_ERROR if the cache is truncated or the file cannot be read.
+     */
+    bool CheckHeader( const char* aMagic, uint32_t aVersion, const wxString& aSourceFileName )
+        throw( IO_ERROR );
+
+    /**
+     * Function Skip
+     * skips the next @a aSize bytes.
+     * @return const char* - the skipped bytes.
+     */
+    const char* Skip( size_t aSize ) throw( IO_ERROR );
+
+    size_t GetPosition() const  { return m_pos; }
+
+private:
+    const char* m_data;
+    size_t      m_size;
+    size_t      m_pos;
+    wxString    m_source;   ///< the cache file name, for error reporting purposes
+};
+
+
 /**
  * Class STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
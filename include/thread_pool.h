@@ -0,0 +1,170 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file thread_pool.h
+ * @brief Shared pool of worker threads, used to load libraries concurrently.
+ */
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <deque>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread.hpp>
+
+
+class JOB_GROUP;
+
+
+/**
+ * Class THREAD_POOL
+ * runs jobs on a fixed number of worker threads, one per core.  Each worker has its
+ * own queue of jobs: the jobs added by a job running on a worker go to the queue of
+ * this worker, and an idle worker steals the oldest jobs of the other queues.  So
+ * a job may add many smaller jobs (e.g. one per footprint of a library) without
+ * keeping the other workers idle, and without contention on a single queue.
+ */
+class THREAD_POOL : public boost::noncopyable
+{
+public:
+    /// A job must catch its own exceptions.
+    typedef boost::function<void ()>    JOB;
+
+    /**
+     * Function Get
+     * @return THREAD_POOL& - the pool shared by all the loaders of all the KIFACEs,
+     *  owned by the program, see PGM_BASE::GetThreadPool().
+     */
+    static THREAD_POOL& Get();
+
+    /**
+     * Constructor
+     * @param aThreadCount is the number of worker threads, or 0 for one per core.
+     */
+    THREAD_POOL( int aThreadCount = 0 );
+
+    /// Waits for the running jobs to finish, and stops the workers.
+    ~THREAD_POOL();
+
+    int GetThreadCount() const              { return m_threads.size(); }
+
+private:
+    friend class JOB_GROUP;
+
+    struct ITEM
+    {
+        JOB         job;
+        JOB_GROUP*  group;
+    };
+
+    struct QUEUE
+    {
+        boost::mutex        lock;
+        std::deque<ITEM>    items;
+    };
+
+    /// Queues @a aJob of @a aGroup, on the queue of the current worker if any.
+    void add( const JOB& aJob, JOB_GROUP* aGroup );
+
+    /**
+     * Function runOne
+     * runs one queued job, taken from the queue @a aQueue or stolen from an other queue.
+     * @param aGroup is the group of the job to run, or NULL to run a job of any group.
+     * @return bool - false if there was no job to run.
+     */
+    bool runOne( int aQueue, JOB_GROUP* aGroup = NULL );
+
+    /// Removes a queued job of @a aGroup (of any group if NULL) from @a aQueue.
+    bool takeItem( QUEUE& aQueue, bool aNewest, JOB_GROUP* aGroup, ITEM& aItem );
+
+    void worker( int aQueue );
+
+    int currentQueue() const;
+
+    boost::ptr_vector<QUEUE>    m_queues;       ///< one per worker, then one for the other threads
+    boost::thread_group         m_threads;
+
+    /// Index of the queue of the current worker thread, not set for the other threads.
+    /// A member, not a static, since each KIFACE has its own copy of the statics.
+    boost::thread_specific_ptr<int>     m_workerQueue;
+
+    boost::mutex                m_wakeLock;
+    boost::condition_variable   m_wake;         ///< signaled when a job is queued
+    int                         m_queued;       ///< count of queued jobs, under m_wakeLock
+    bool                        m_stop;
+};
+
+
+/**
+ * Class JOB_GROUP
+ * is a set of jobs run by a THREAD_POOL, which can be waited for.  The jobs of a group
+ * may add more jobs to it.  A thread waiting for a group runs the queued jobs of this
+ * group meanwhile, so a job may wait for an other group without dead locking the pool.
+ */
+class JOB_GROUP : public boost::noncopyable
+{
+public:
+    JOB_GROUP( THREAD_POOL& aPool = THREAD_POOL::Get() ) :
+        m_pool( aPool ),
+        m_pending( 0 ),
+        m_queued( 0 )
+    {
+    }
+
+    ~JOB_GROUP()
+    {
+        Wait();
+    }
+
+    /**
+     * Function Add
+     * queues @a aJob in the pool.  If the pool has no worker threads, the job is
+     * run by Wait().
+     */
+    void Add( const THREAD_POOL::JOB& aJob );
+
+    /**
+     * Function Wait
+     * waits until all the jobs of the group, including the ones added by its jobs,
+     * are finished.  The queued jobs of the group are run by the calling thread, which
+     * sleeps only while all the remaining jobs are running.
+     */
+    void Wait();
+
+private:
+    friend class THREAD_POOL;
+
+    void jobTaken();
+    void jobDone();
+
+    THREAD_POOL&                m_pool;
+    boost::mutex                m_lock;
+    boost::condition_variable   m_done;         ///< signaled when a job is added or done
+    int                         m_pending;      ///< count of not finished jobs, under m_lock
+    int                         m_queued;       ///< count of not started jobs, under m_lock
+};
+
+#endif  // THREAD_POOL_H_
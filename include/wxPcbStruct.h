@@ -105,6 +105,7 @@ protected:
     PCB_LAYER_WIDGET* m_Layers;
 
     DRC* m_drc;                                 ///< the DRC controller, see drc.cpp
+    wxTimer* m_incrementalDrcTimer;             ///< runs the incremental DRC after changes
 
     PARAM_CFG_ARRAY   m_configSettings;         ///< List of Pcbnew configuration settings.
 
@@ -172,6 +173,13 @@ protected:
 
     virtual void unitsChangeRefresh();
 
+    /**
+     * Function onIncrementalDrcTimer
+     * runs the incremental DRC tests on the items modified since the last run.
+     * The timer is started by OnModify(), so a series of changes is tested only once.
+     */
+    void onIncrementalDrcTimer( wxTimerEvent& aEvent );
+
     /**
      * Function doAutoSave
      * performs auto save when the board has been modified and not saved within the
@@ -565,7 +573,7 @@ public:
      * must be called after a board change to set the modified flag.
      * <p>
      * Reloads the 3D view if required and calls the base PCB_BASE_FRAME::OnModify function
-     * to update auxiliary information.
+     * to update auxiliary information.  Schedules the incremental DRC if enabled.
      * </p>
      */
     virtual void OnModify();
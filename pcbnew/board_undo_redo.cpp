@@ -43,6 +43,7 @@
 #include <class_edge_mod.h>
 
 #include <ratsnest_data.h>
+#include <drc_stuff.h>
 
 #include <tools/selection_tool.h>
 #include <tool/tool_manager.h>
@@ -317,6 +318,9 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( BOARD_ITEM*    aItem,
             return;
     }
 
+    // The item is about to be modified: its area must be checked again
+    m_drc->MarkDirty( aItem );
+
     PICKED_ITEMS_LIST* commandToUndo = new PICKED_ITEMS_LIST();
 
     commandToUndo->m_TransformPoint = aTransformPoint;
@@ -410,6 +414,8 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
 
         wxASSERT( item );
 
+        m_drc->MarkDirty( item );
+
         switch( command )
         {
         case UR_CHANGED:
@@ -506,6 +512,9 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
 
         item->ClearFlags();
 
+        // Record the area of the item before the change, for the incremental DRC
+        m_drc->MarkDirty( item );
+
         // see if we must rebuild ratsnets and pointers lists
         switch( item->Type() )
         {
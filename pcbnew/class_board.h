@@ -57,6 +57,7 @@ class MSG_PANEL_ITEM;
 class NETLIST;
 class REPORTER;
 class RN_DATA;
+class wxProgressDialog;
 
 namespace KIGFX
 {
@@ -1038,6 +1039,26 @@ public:
     void RedrawFilledAreas( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDrawMode,
                             LAYER_ID aLayer );
 
+    /**
+     * Function FillAllZones
+     * rebuilds the filled areas of all zones, except keepout areas.
+     * Filling a zone reads the other board items, but modifies only this zone,
+     * so zones are filled concurrently when OpenMP is available.
+     * Zones whose outline, settings and neighbour items did not change since their last
+     * fill (see ZONE_CONTAINER::ComputeFillHash()) are not filled again.
+     * @param aProgressDialog = a progress dialog, updated with the count of filled
+     *  zones and used to abort the filling, or NULL.
+     * @param aStopOnError = true to stop filling the remaining zones when a zone
+     *  cannot be filled.
+     * @param aErrorLevel = if not NULL, receives the error level (0 = no error,
+     *  1 = at least one zone could not be filled).
+     * @param aRefilledCount = if not NULL, receives the number of zones actually
+     *  filled again, i.e. not up to date.  The board is modified only if it is not 0.
+     * @return the number of filled or up to date zones (less than the zone count if aborted).
+     */
+    int FillAllZones( wxProgressDialog* aProgressDialog = NULL, bool aStopOnError = false,
+                      int* aErrorLevel = NULL, int* aRefilledCount = NULL );
+
     /**
      * Function SetAreasNetCodesFromNetNames
      * Set the .m_NetCode member of all copper areas, according to the area Net Name
@@ -90,6 +90,49 @@ std::string BOARD_ITEM::FormatInternalUnits( int aValue )
 {
 #if 1
 
+    // Assume aValue is in nanometers, and that we want the result in millimeters:
+    // write the digits of aValue, and insert a decimal point 6 digits from the end,
+    // removing the trailing zeros.  This is exact, does not depend on the locale and
+    // gives the same text as the general purpose "%.10g" algorithm below.
+
+    char        buf[50];
+    char* const end = buf + sizeof( buf );
+    char*       cp  = end;
+
+    // unsigned, so that INT_MIN can be negated
+    unsigned    value = aValue < 0 ? 0u - (unsigned) aValue : (unsigned) aValue;
+    unsigned    whole = value / 1000000;
+    unsigned    frac  = value % 1000000;
+
+    if( frac )
+    {
+        int digits = 6;
+
+        for( ; frac % 10 == 0; --digits )
+            frac /= 10;
+
+        while( digits-- )
+        {
+            *--cp = '0' + frac % 10;
+            frac /= 10;
+        }
+
+        *--cp = '.';
+    }
+
+    do
+    {
+        *--cp = '0' + whole % 10;
+        whole /= 10;
+    } while( whole );
+
+    if( aValue < 0 )
+        *--cp = '-';
+
+    return std::string( cp, end );
+
+#else
+
     char    buf[50];
     int     len;
     double  mm = aValue / IU_PER_MM;
@@ -113,62 +156,43 @@ std::string BOARD_ITEM::FormatInternalUnits( int aValue )
 
     return std::string( buf, len );
 
-#else
-
-    // Assume aValue is in nanometers, and that we want the result in millimeters,
-    // and that int is 32 bits wide.  Then perform an alternative algorithm.
-    // Can be used to verify that the above algorithm is correctly generating text.
-    // Convert aValue into an integer string, then insert a decimal point manually.
-    // Results are the same as above general purpose algorithm.
+#endif
+}
 
-    wxASSERT( sizeof(int) == 4 );
 
-    if( aValue == 0 )
-        return std::string( 1, '0' );
-    else
+std::string BOARD_ITEM::FormatAngle( double aAngle )
+{
+    // Angles are most often a whole number of tenths of degree: write them
+    // like FormatInternalUnits() does, without the C library.  The range is
+    // checked first: converting an out of range (or NaN) value to int is undefined.
+    if( fabs( aAngle ) < 1e9 && aAngle == (int) aAngle )
     {
-        char    buf[50];
-        int     len = sprintf( buf, aValue > 0 ? "%06d" : "%07d", aValue );     // optionally pad w/leading zeros
-
-        std::string ret( buf, len );
-
-        std::string::iterator it = ret.end() - 1;           // last byte
-
-        // insert '.' at 6 positions from end, dividing by 10e6 (a million), nm => mm
-        std::string::iterator decpoint = ret.end() - 6;
-
-        // truncate trailing zeros, up to decimal point position
-        for(  ; *it=='0' && it >= decpoint;  --it )
-            ret.erase( it );    // does not invalidate iterators it or decpoint
+        char        buf[20];
+        char* const end = buf + sizeof( buf );
+        char*       cp  = end;
+        int         tenths = (int) aAngle;
+        unsigned    value  = tenths < 0 ? -tenths : tenths;
 
-        if( it >= decpoint )
+        if( value % 10 )
         {
-            ret.insert( decpoint, '.' );
-
-            // decpoint is invalidated here, after insert()
-
-#if 1       // want a leading zero when decimal point is in first position?
-            if( ret[0] == '.' )
-            {
-                // insert leading zero ahead of decimal point.
-                ret.insert( ret.begin(), '0' );
-            }
-            else if( ret[0]=='-' && ret[1]=='.' )
-            {
-                ret.insert( ret.begin() + 1, '0' );
-            }
-#endif
+            *--cp = '0' + value % 10;
+            *--cp = '.';
         }
 
-        return ret;
-    }
+        value /= 10;
 
-#endif
-}
+        do
+        {
+            *--cp = '0' + value % 10;
+            value /= 10;
+        } while( value );
 
+        if( tenths < 0 )
+            *--cp = '-';
+
+        return std::string( cp, end );
+    }
 
-std::string BOARD_ITEM::FormatAngle( double aAngle )
-{
     char temp[50];
 
     int len = snprintf( temp, sizeof(temp), "%.10g", aAngle / 10.0 );
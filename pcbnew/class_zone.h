@@ -48,6 +48,7 @@ class PCB_EDIT_FRAME;
 class BOARD;
 class ZONE_CONTAINER;
 class MSG_PANEL_ITEM;
+class ZONE_FILL_CONTEXT;
 
 
 /**
@@ -294,8 +295,11 @@ public:
      * When aOutlineBuffer is not null, his function calls
      * AddClearanceAreasPolygonsToPolysList() to add holes for pads and tracks
      * and other items not in net.
+     * @param aContext: the data shared by the fills of several zones, or NULL
+     * (see AddClearanceAreasPolygonsToPolysList())
      */
-    bool BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST* aOutlineBuffer = NULL );
+    bool BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST* aOutlineBuffer = NULL,
+                                        ZONE_FILL_CONTEXT* aContext = NULL );
 
     /**
      * Function CopyPolygonsFromKiPolygonListToFilledPolysList
@@ -330,8 +334,33 @@ public:
      * BuildFilledSolidAreasPolygons() call this function just after creating the
      *  filled copper area polygon (without clearance areas
      * @param aPcb: the current board
+     * @param aContext: if not NULL, the spatial index used to find the pads and tracks
+     * near the zone, and the cache of pad clearance polygons; otherwise all the board
+     * items are tested
      */
-    void AddClearanceAreasPolygonsToPolysList( BOARD* aPcb );
+    void AddClearanceAreasPolygonsToPolysList( BOARD* aPcb, ZONE_FILL_CONTEXT* aContext = NULL );
+
+    /**
+     * Function ComputeFillHash
+     * computes a hash of everything the filled areas depend on: the zone outline and
+     * settings, and the pads, tracks, drawings and zones which can change the filled
+     * areas of this zone.
+     * @param aPcb: the current board
+     * @param aContext: the spatial index used to find the items near the zone
+     * @return the hash, to compare to the one stored by the last fill (see GetFillHash()).
+     */
+    size_t ComputeFillHash( BOARD* aPcb, ZONE_FILL_CONTEXT& aContext ) const;
+
+    /**
+     * Function GetFillHash
+     * @return the hash of the data used by the last fill, stored by SetFillHash(),
+     * or 0 if it is unknown (the filled areas were read from the board file, or
+     * modified afterwards).  It is kept in memory and in the board cache only, and
+     * depends on the build, so it is not saved in the board file.
+     * When ComputeFillHash() returns the same value, the zone does not need to be refilled.
+     */
+    size_t GetFillHash() const { return m_fillHash; }
+    void SetFillHash( size_t aHash ) { m_fillHash = aHash; }
 
 
      /**
@@ -499,6 +528,7 @@ public:
     void ClearFilledPolysList()
     {
         m_FilledPolysList.RemoveAllContours();
+        m_fillHash = 0;
     }
 
    /**
@@ -552,6 +582,7 @@ public:
     void AddFilledPolygon( CPOLYGONS_LIST& aPolygon )
     {
         m_FilledPolysList.Append( aPolygon );
+        m_fillHash = 0;
     }
 
     void AddFillSegments( std::vector< SEGMENT >& aSegments )
@@ -618,6 +649,9 @@ private:
     /** True when a zone was filled, false after deleting the filled areas. */
     bool                  m_IsFilled;
 
+    /// The hash of the data used to compute the filled areas, or 0 if unknown.
+    size_t                m_fillHash;
+
     ///< Width of the gap in thermal reliefs.
     int                   m_ThermalReliefGap;
 
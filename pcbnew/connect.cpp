@@ -32,6 +32,8 @@
 #include <common.h>
 #include <macros.h>
 #include <wxBasePcbFrame.h>
+#include <convert_to_biu.h>
+#include <disjoint_set.h>
 
 #include <pcbnew.h>
 
@@ -45,11 +47,40 @@ extern void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb, int aNetcode );
 static void RebuildTrackChain( BOARD* pcb );
 
 
+// Size of the cells of the candidates spatial hash. Most searches are made
+// in areas smaller than a cell, so only a few cells are explored.
+static const int CANDIDATES_HASH_CELL_SIZE = Millimeter2iu( 1.0 );
+
+
 CONNECTIONS::CONNECTIONS( BOARD * aBrd )
 {
     m_brd = aBrd;
     m_firstTrack = NULL;
     m_lastTrack = NULL;
+    m_cellSize = CANDIDATES_HASH_CELL_SIZE;
+}
+
+
+/* Returns the index of the hash cell containing the coordinate aValue
+ * (rounded towards minus infinity, also for negative coordinates)
+ */
+static inline int cellIndex( int aValue, int aCellSize )
+{
+    return aValue >= 0 ? aValue / aCellSize : - ( ( -aValue - 1 ) / aCellSize ) - 1;
+}
+
+
+void CONNECTIONS::buildCandidatesHash()
+{
+    m_candidatesHash.clear();
+
+    for( unsigned ii = 0; ii < m_candidates.size(); ii++ )
+    {
+        const wxPoint& point = m_candidates[ii].GetPoint();
+        CELL_KEY key( cellIndex( point.x, m_cellSize ), cellIndex( point.y, m_cellSize ) );
+
+        m_candidatesHash[key].push_back( ii );
+    }
 }
 
 
@@ -146,79 +177,60 @@ void CONNECTIONS::CollectItemsNearTo( std::vector<CONNECTED_POINT*>& aList,
 {
     /* Search items in m_Candidates that position is <= aDistMax from aPosition
      * (Rectilinear distance)
-     * m_Candidates is sorted by X then Y values, so a fast binary search is used
-     * to locate the "best" entry point in list
-     * The best entry is a pad having its m_Pos.x == (or near) aPosition.x
-     * All candidates are near this candidate in list
-     * So from this entry point, a linear search is made to find all candidates
+     * Only the cells of the spatial hash covering the area
+     * aPosition +/- aDistMax are explored.
+     * Found items are added in m_candidates order (i.e. sorted by X then Y
+     * coordinates), so the result does not depend on the hash.
      */
-    int idxmax = m_candidates.size()-1;
+    int xmin = cellIndex( aPosition.x - aDistMax, m_cellSize );
+    int xmax = cellIndex( aPosition.x + aDistMax, m_cellSize );
+    int ymin = cellIndex( aPosition.y - aDistMax, m_cellSize );
+    int ymax = cellIndex( aPosition.y + aDistMax, m_cellSize );
 
-    int delta = m_candidates.size();
-
-    int idx = 0;        // Starting index is the beginning of list
-    while( delta )
-    {
-        // Calculate half size of remaining interval to test.
-        // Ensure the computed value is not truncated (too small)
-        if( (delta & 1) && ( delta > 1 ) )
-            delta++;
-        delta /= 2;
+    m_foundCandidates.clear();
 
-        CONNECTED_POINT& item = m_candidates[idx];
+    // For a very large area, it is faster to test all candidates
+    double cellCount = ( xmax - xmin + 1.0 ) * ( ymax - ymin + 1.0 );
 
-        int dist = item.GetPoint().x - aPosition.x;
-        if( abs(dist) <= aDistMax )
+    if( cellCount > m_candidatesHash.size() )
+    {
+        for( unsigned ii = 0; ii < m_candidates.size(); ii++ )
         {
-            break;   // A good entry point is found. The list can be scanned from this point.
-        }
+            wxPoint diff = m_candidates[ii].GetPoint() - aPosition;
 
-        else if( item.GetPoint().x < aPosition.x ) // We should search after this item
-        {
-            idx += delta;
-            if( idx > idxmax )
-                idx = idxmax;
+            if( abs( diff.x ) <= aDistMax && abs( diff.y ) <= aDistMax )
+                m_foundCandidates.push_back( ii );
         }
-        else    // We should search before this item
+    }
+    else
+    {
+        for( int cx = xmin; cx <= xmax; cx++ )
         {
-            idx -= delta;
-            if( idx < 0 )
-                idx = 0;
+            for( int cy = ymin; cy <= ymax; cy++ )
+            {
+                CANDIDATES_HASH::const_iterator cell =
+                        m_candidatesHash.find( CELL_KEY( cx, cy ) );
+
+                if( cell == m_candidatesHash.end() )
+                    continue;
+
+                const std::vector<int>& cellItems = cell->second;
+
+                for( unsigned ii = 0; ii < cellItems.size(); ii++ )
+                {
+                    wxPoint diff = m_candidates[cellItems[ii]].GetPoint() - aPosition;
+
+                    if( abs( diff.x ) <= aDistMax && abs( diff.y ) <= aDistMax )
+                        m_foundCandidates.push_back( cellItems[ii] );
+                }
+            }
         }
-    }
 
-    /* Now explore the candidate list from the "best" entry point found
-     * (candidate "near" aPosition.x)
-     * We explore the list until abs(candidate->m_Point.x - aPosition.x) > aDistMax
-     * because the list is sorted by X position (and for a given X pos, by Y pos)
-     * Currently a linear search is made because the number of candidates
-     * having the right X position is usually small
-     */
-    // search next candidates in list
-    wxPoint diff;
-    for( int ii = idx; ii <= idxmax; ii++ )
-    {
-        CONNECTED_POINT* item = &m_candidates[ii];
-        diff = item->GetPoint() - aPosition;
-        if( abs(diff.x) > aDistMax )
-            break;    // Exit: the distance is to long, we cannot find other candidates
-        if( abs(diff.y) > aDistMax )
-            continue;    // the y distance is to long, but we can find other candidates
-        // We have here a good candidate: add it
-        aList.push_back( item );
-    }
-    // search previous candidates in list
-    for(  int ii = idx-1; ii >=0; ii-- )
-    {
-        CONNECTED_POINT * item = &m_candidates[ii];
-        diff = item->GetPoint() - aPosition;
-        if( abs(diff.x) > aDistMax )
-            break;
-        if( abs(diff.y) > aDistMax )
-            continue;
-        // We have here a good candidate:add it
-        aList.push_back( item );
+        std::sort( m_foundCandidates.begin(), m_foundCandidates.end() );
     }
+
+    for( unsigned ii = 0; ii < m_foundCandidates.size(); ii++ )
+        aList.push_back( &m_candidates[m_foundCandidates[ii]] );
 }
 
 
@@ -232,6 +244,8 @@ void CONNECTIONS::BuildPadsCandidatesList()
         CONNECTED_POINT candidate( pad, pad->GetPosition() );
         m_candidates.push_back( candidate );
     }
+
+    buildCandidatesHash();
 }
 
 /* sort function used to sort .m_Connected by X the Y values
@@ -288,6 +302,8 @@ void CONNECTIONS::BuildTracksCandidatesList( TRACK* aBegin, TRACK* aEnd)
     // and for increasing Y coordinate when items have the same X coordinate
     // So candidates to the same location are consecutive in list.
     sort( m_candidates.begin(), m_candidates.end(), sortConnectedPointByXthenYCoordinates );
+
+    buildCandidatesHash();
 }
 
 
@@ -308,50 +324,13 @@ int CONNECTIONS::SearchConnectedTracks( const TRACK* aTrack )
     LSET layerMask = aTrack->GetLayerSet();
 
     // Search for connections to starting point:
-#define USE_EXTENDED_SEARCH
-
-#ifdef USE_EXTENDED_SEARCH
     int dist_max = aTrack->GetWidth() / 2;
     static std::vector<CONNECTED_POINT*> tracks_candidates;
-#endif
 
     wxPoint position = aTrack->GetStart();
 
     for( int kk = 0; kk < 2; kk++ )
     {
-#ifndef USE_EXTENDED_SEARCH
-        int idx = searchEntryPointInCandidatesList( position );
-
-        if( idx >= 0 )
-        {
-            // search after:
-            for( unsigned ii = idx; ii < m_candidates.size(); ii ++ )
-            {
-                if( m_candidates[ii].GetTrack() == aTrack )
-                    continue;
-
-                if( m_candidates[ii].GetPoint() != position )
-                    break;
-
-                if( ( m_candidates[ii].GetTrack()->GetLayerSet() & layerMask ).any() )
-                    m_connected.push_back( m_candidates[ii].GetTrack() );
-            }
-
-            // search before:
-            for( int ii = idx-1; ii >= 0; ii -- )
-            {
-                if( m_candidates[ii].GetTrack() == aTrack )
-                    continue;
-
-                if( m_candidates[ii].GetPoint() != position )
-                    break;
-
-                if( ( m_candidates[ii].GetTrack()->GetLayerSet() & layerMask ).any() )
-                    m_connected.push_back( m_candidates[ii].GetTrack() );
-            }
-        }
-#else
-
         tracks_candidates.clear();
 
         CollectItemsNearTo( tracks_candidates, position, dist_max );
@@ -377,7 +356,6 @@ int CONNECTIONS::SearchConnectedTracks( const TRACK* aTrack )
 
             m_connected.push_back( ctrack );
         }
-#endif
 
         // Search for connections to ending point:
         if( aTrack->Type() == PCB_VIA_T )
@@ -390,65 +368,6 @@ int CONNECTIONS::SearchConnectedTracks( const TRACK* aTrack )
 }
 
 
-int CONNECTIONS::searchEntryPointInCandidatesList( const wxPoint& aPoint )
-{
-    // Search the aPoint coordinates in m_Candidates
-    // m_Candidates is sorted by X then Y values, and a fast binary search is used
-    int idxmax = m_candidates.size()-1;
-
-    int delta = m_candidates.size();
-
-    int idx = 0;        // Starting index is the beginning of list
-
-    while( delta )
-    {
-        // Calculate half size of remaining interval to test.
-        // Ensure the computed value is not truncated (too small)
-        if( ( delta & 1 ) && ( delta > 1 ) )
-            delta++;
-
-        delta /= 2;
-
-        CONNECTED_POINT& candidate = m_candidates[idx];
-
-        if( candidate.GetPoint() == aPoint )   // candidate found
-        {
-            return idx;
-        }
-
-        // Not found: test the middle of the remaining sub list
-        if( candidate.GetPoint().x == aPoint.x )   // Must search considering Y coordinate
-        {
-            if(candidate.GetPoint().y < aPoint.y)  // Must search after this item
-            {
-                idx += delta;
-                if( idx > idxmax )
-                    idx = idxmax;
-            }
-            else // Must search before this item
-            {
-                idx -= delta;
-                if( idx < 0 )
-                    idx = 0;
-            }
-        }
-        else if( candidate.GetPoint().x < aPoint.x ) // Must search after this item
-        {
-            idx += delta;
-            if( idx > idxmax )
-                idx = idxmax;
-        }
-        else // Must search before this item
-        {
-            idx -= delta;
-            if( idx < 0 )
-                idx = 0;
-        }
-    }
-
-    return -1;
-}
-
 /* Used after a track change (delete a track ou add a track)
  * Connections to pads are recalculated
  * Note also aFirstTrack (and aLastTrack ) can be NULL
@@ -489,83 +408,6 @@ void CONNECTIONS::Build_CurrNet_SubNets_Connections( TRACK* aFirstTrack, TRACK*
 }
 
 
-/**
- * Change a subnet value to a new value, in m_sortedPads pad list
- * After that, 2 cluster (or subnets) are merged into only one.
- * Note: the resulting subnet value is the smallest between aOldSubNet et aNewSubNet
- */
-int CONNECTIONS::Merge_PadsSubNets( int aOldSubNet, int aNewSubNet )
-{
-    int    change_count = 0;
-
-    if( aOldSubNet == aNewSubNet )
-        return 0;
-
-    if( (aOldSubNet > 0) && (aOldSubNet < aNewSubNet) )
-        EXCHG( aOldSubNet, aNewSubNet );
-
-    // Examine connections between intersecting pads
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
-    {
-        D_PAD * curr_pad = m_sortedPads[ii];
-        if( curr_pad->GetSubNet() != aOldSubNet )
-            continue;
-
-        change_count++;
-        curr_pad->SetSubNet( aNewSubNet );
-    }
-
-    return change_count;
-}
-
-/*
- * Change a subnet value to a new value, for tracks and pads which are connected to.
- * The result is merging 2 clusters (or subnets) into only one cluster.
- * Note: the resulting sub net value is the smallest between aOldSubNet et aNewSubNet
- */
-int CONNECTIONS::Merge_SubNets( int aOldSubNet, int aNewSubNet )
-{
-    TRACK* curr_track;
-    int    change_count = 0;
-
-    if( aOldSubNet == aNewSubNet )
-        return 0;
-
-    if( (aOldSubNet > 0) && (aOldSubNet < aNewSubNet) )
-        EXCHG( aOldSubNet, aNewSubNet );
-
-    curr_track = (TRACK*)m_firstTrack;
-
-    for( ; curr_track != NULL; curr_track = curr_track->Next() )
-    {
-        if( curr_track->GetSubNet() != aOldSubNet )
-        {
-            if( curr_track == m_lastTrack )
-                break;
-
-            continue;
-        }
-
-        change_count++;
-        curr_track->SetSubNet( aNewSubNet );
-
-        for( unsigned ii = 0; ii < curr_track->m_PadsConnected.size(); ii++ )
-        {
-            D_PAD * pad = curr_track->m_PadsConnected[ii];
-            if( pad->GetSubNet() == aOldSubNet )
-            {
-                pad->SetSubNet( curr_track->GetSubNet() );
-            }
-        }
-
-        if( curr_track == m_lastTrack )
-            break;
-    }
-
-    return change_count;
-}
-
-
 /* Test a list of track segments, to create or propagate a sub netcode to pads and
  * segments connected together.
  * The track list must be sorted by nets, and all segments
@@ -580,147 +422,81 @@ int CONNECTIONS::Merge_SubNets( int aOldSubNet, int aNewSubNet )
  */
 void CONNECTIONS::Propagate_SubNets()
 {
-    int sub_netcode = 1;
+    // Give an index to each item: the tracks from m_firstTrack to m_lastTrack,
+    // then the pads.
+    std::vector<BOARD_CONNECTED_ITEM*> items;
+    boost::unordered_map<const BOARD_CONNECTED_ITEM*, int> itemIndex;
+
+    for( TRACK* track = (TRACK*) m_firstTrack; track != NULL; track = track->Next() )
+    {
+        itemIndex[track] = items.size();
+        items.push_back( track );
+
+        if( track == m_lastTrack )
+            break;
+    }
 
-    TRACK* curr_track = (TRACK*)m_firstTrack;
-    if( curr_track )
-        curr_track->SetSubNet( sub_netcode );
+    int trackCount = items.size();
 
-    // Examine connections between tracks and pads
-    for( ; curr_track != NULL; curr_track = curr_track->Next() )
+    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
     {
-        // First: handling connections to pads
-        for( unsigned ii = 0; ii < curr_track->m_PadsConnected.size(); ii++ )
+        itemIndex[m_sortedPads[ii]] = items.size();
+        items.push_back( m_sortedPads[ii] );
+    }
+
+    // Merge the clusters of connected items
+    DISJOINT_SET clusters( items.size() );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
+    {
+        BOARD_CONNECTED_ITEM* item = items[ii];
+
+        for( unsigned jj = 0; jj < item->m_PadsConnected.size(); jj++ )
         {
-            D_PAD * pad = curr_track->m_PadsConnected[ii];
+            boost::unordered_map<const BOARD_CONNECTED_ITEM*, int>::const_iterator it =
+                    itemIndex.find( item->m_PadsConnected[jj] );
 
-            if( curr_track->GetSubNet() )        // the track segment is already a cluster member
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // The pad is already a cluster member, so we can merge the 2 clusters
-                    Merge_SubNets( pad->GetSubNet(), curr_track->GetSubNet() );
-                }
-                else
-                {
-                    /* The pad is not yet attached to a cluster , so we can add this pad to
-                     * the cluster */
-                    pad->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-            else                              // the track segment is not attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // it is connected to a pad in a cluster, merge this track
-                    curr_track->SetSubNet( pad->GetSubNet() );
-                }
-                else
-                {
-                    /* it is connected to a pad not in a cluster, so we must create a new
-                     * cluster (only with the 2 items: the track and the pad) */
-                    sub_netcode++;
-                    curr_track->SetSubNet( sub_netcode );
-                    pad->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
+            if( it != itemIndex.end() )
+                clusters.Union( ii, it->second );
         }
 
-        // Test connections between segments
-        for( unsigned ii = 0; ii < curr_track->m_TracksConnected.size(); ii++ )
+        // Only tracks know their connected tracks
+        if( (int) ii >= trackCount )
+            continue;
+
+        for( unsigned jj = 0; jj < item->m_TracksConnected.size(); jj++ )
         {
-            BOARD_CONNECTED_ITEM* track = curr_track->m_TracksConnected[ii];
+            boost::unordered_map<const BOARD_CONNECTED_ITEM*, int>::const_iterator it =
+                    itemIndex.find( item->m_TracksConnected[jj] );
 
-            if( curr_track->GetSubNet() )   // The current track is already a cluster member
-            {
-                // The other track is already a cluster member, so we can merge the 2 clusters
-                if( track->GetSubNet() )
-                {
-                    Merge_SubNets( track->GetSubNet(), curr_track->GetSubNet() );
-                }
-                else
-                {
-                    // The other track is not yet attached to a cluster , so we can add this
-                    // other track to the cluster
-                    track->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
-            else        // the current track segment is not yet attached to a cluster
-            {
-                if( track->GetSubNet() )
-                {
-                    // The other track is already a cluster member, so we can add
-                    // the current segment to the cluster
-                    curr_track->SetSubNet( track->GetSubNet() );
-                }
-                else
-                {
-                    // it is connected to an other segment not in a cluster, so we must
-                    // create a new cluster (only with the 2 track segments)
-                    sub_netcode++;
-                    curr_track->SetSubNet( sub_netcode );
-                    track->SetSubNet( curr_track->GetSubNet() );
-                }
-            }
+            if( it != itemIndex.end() )
+                clusters.Union( ii, it->second );
         }
-
-        if( curr_track == m_lastTrack )
-            break;
     }
 
-    // Examine connections between intersecting pads, and propagate
-    // sub_netcodes to intersecting pads
-    for( unsigned ii = 0; ii < m_sortedPads.size(); ii++ )
+    // Give a sub netcode to each cluster. Items connected to nothing have a
+    // sub netcode = 0, except the first track which always starts the first cluster.
+    std::vector<int> subnetOfCluster( items.size(), 0 );
+    int sub_netcode = 0;
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
-        D_PAD* curr_pad = m_sortedPads[ii];
+        int cluster = clusters.Find( ii );
 
-        for( unsigned jj = 0; jj < curr_pad->m_PadsConnected.size(); jj++ )
+        if( clusters.GetSetSize( ii ) == 1 && !( ii == 0 && trackCount > 0 ) )
         {
-            D_PAD* pad = curr_pad->m_PadsConnected[jj];
-
-            if( curr_pad->GetSubNet() )   // the current pad is already attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // The pad is already a cluster member, so we can merge the 2 clusters
-                    // Store the initial subnets, which will be modified by Merge_PadsSubNets
-                    int subnet1 = pad->GetSubNet();
-                    int subnet2 = curr_pad->GetSubNet();
+            items[ii]->SetSubNet( 0 );
+            continue;
+        }
 
-                    // merge subnets of pads only, even those not connected by tracks
-                    Merge_PadsSubNets( subnet1, subnet2 );
+        if( subnetOfCluster[cluster] == 0 )
+            subnetOfCluster[cluster] = ++sub_netcode;
 
-                    // merge subnets of tracks (and pads, which are already merged)
-                    Merge_SubNets( subnet1, subnet2 );
-                }
-                else
-                {
-                    // The pad is not yet attached to a cluster,
-                    // so we can add this pad to the cluster
-                    pad->SetSubNet( curr_pad->GetSubNet() );
-                }
-            }
-            else   // the current pad is not attached to a cluster
-            {
-                if( pad->GetSubNet() > 0 )
-                {
-                    // the connected pad is in a cluster,
-                    // so we can add the current pad to the cluster
-                    curr_pad->SetSubNet( pad->GetSubNet() );
-                }
-                else
-                {
-                    // the connected pad is not in a cluster,
-                    // so we must create a new cluster, with the 2 pads.
-                    sub_netcode++;
-                    curr_pad->SetSubNet( sub_netcode );
-                    pad->SetSubNet( curr_pad->GetSubNet() );
-                }
-            }
-        }
+        items[ii]->SetSubNet( subnetOfCluster[cluster] );
     }
 }
 
+
 /*
  * Test all connections of the board,
  * and update subnet variable of pads and tracks
@@ -898,50 +674,49 @@ void PCB_BASE_FRAME::RecalculateAllTracksNetcode()
         connections.GetConnectedTracks( t );
     }
 
-    // Propagate net codes from a segment to other connected segments
-    bool new_pass_request = true;   // set to true if a track has its netcode changed from 0
-                                    // to a known netcode to re-evaluate netcodes
-                                    // of connected items
-    while( new_pass_request )
+    // Propagate net codes from segments to other connected segments:
+    // build the clusters of connected segments, and give to the segments having no
+    // netcode the netcode of the first segment of their cluster having one.
+    std::vector<TRACK*> tracks;
+    boost::unordered_map<const TRACK*, int> trackIndex;
+
+    for( TRACK* t = m_Pcb->m_Track;  t;  t = t->Next() )
     {
-        new_pass_request = false;
+        trackIndex[t] = tracks.size();
+        tracks.push_back( t );
+    }
 
-        for( TRACK* t = m_Pcb->m_Track;  t;  t = t->Next() )
-        {
-            int netcode = t->GetNetCode();
+    DISJOINT_SET clusters( tracks.size() );
 
-            if( netcode == 0 )
-            {
-                // try to find a connected item having a netcode
-                for( unsigned kk = 0; kk < t->m_TracksConnected.size(); kk++ )
-                {
-                    int altnetcode = t->m_TracksConnected[kk]->GetNetCode();
-                    if( altnetcode )
-                    {
-                        new_pass_request = true;
-                        netcode = altnetcode;
-                        t->SetNetCode(netcode);
-                        break;
-                    }
-                }
-            }
+    for( unsigned ii = 0; ii < tracks.size(); ii++ )
+    {
+        for( unsigned kk = 0; kk < tracks[ii]->m_TracksConnected.size(); kk++ )
+        {
+            // A connected item which is not in the track list has no cluster
+            boost::unordered_map<const TRACK*, int>::const_iterator connected =
+                trackIndex.find( tracks[ii]->m_TracksConnected[kk] );
 
-            if( netcode )    // this track has a netcode
-            {
-                // propagate this netcode to connected tracks having no netcode
-                for( unsigned kk = 0; kk < t->m_TracksConnected.size(); kk++ )
-                {
-                    int altnetcode = t->m_TracksConnected[kk]->GetNetCode();
-                    if( altnetcode == 0 )
-                    {
-                        t->m_TracksConnected[kk]->SetNetCode(netcode);
-                        new_pass_request = true;
-                    }
-                }
-            }
+            if( connected != trackIndex.end() )
+                clusters.Union( ii, connected->second );
         }
     }
 
+    std::vector<int> netcodeOfCluster( tracks.size(), 0 );
+
+    for( unsigned ii = 0; ii < tracks.size(); ii++ )
+    {
+        int cluster = clusters.Find( ii );
+
+        if( netcodeOfCluster[cluster] == 0 )
+            netcodeOfCluster[cluster] = tracks[ii]->GetNetCode();
+    }
+
+    for( unsigned ii = 0; ii < tracks.size(); ii++ )
+    {
+        if( tracks[ii]->GetNetCode() == 0 )
+            tracks[ii]->SetNetCode( netcodeOfCluster[clusters.Find( ii )] );
+    }
+
     // Sort the track list by net codes:
     RebuildTrackChain( m_Pcb );
 }
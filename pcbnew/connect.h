@@ -30,6 +30,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <boost/unordered_map.hpp>
+
 #include <class_track.h>
 #include <class_board.h>
 
@@ -100,6 +102,15 @@ private:
     const TRACK * m_lastTrack;                  // The last track used to build m_Candidates
     std::vector<D_PAD*> m_sortedPads;           // list of sorted pads by X (then Y) coordinate
 
+    // Spatial hash of m_candidates: indices in m_candidates of the candidates
+    // located in each cell of a grid of m_cellSize * m_cellSize squares
+    typedef std::pair<int, int>                                 CELL_KEY;
+    typedef boost::unordered_map< CELL_KEY, std::vector<int> > CANDIDATES_HASH;
+
+    CANDIDATES_HASH m_candidatesHash;
+    int             m_cellSize;
+    std::vector<int> m_foundCandidates;         // buffer used by CollectItemsNearTo()
+
 public:
     CONNECTIONS( BOARD * aBrd );
     ~CONNECTIONS() {};
@@ -198,8 +209,9 @@ public:
     /**
      * function CollectItemsNearTo
      * Used by SearchTracksConnectedToPads
-     * Fills aList with pads near to aPosition
-     * near means aPosition to pad position <= aDistMax
+     * Fills aList with pads near to aPosition, in m_candidates order
+     * near means aPosition to pad position <= aDistMax (rectilinear distance)
+     * Only the cells of the candidates spatial hash covering this area are explored.
      * @param aList = list to fill
      * @param aPosition = aPosition to use as reference
      * @param aDistMax = dist max from aPosition to a candidate to select it
@@ -215,49 +227,23 @@ public:
      * from m_firstTrack to m_lastTrack have the same net.
      * When 2 items are connected (a track to a pad, or a track to an other track),
      * they are grouped in a cluster.
-     * For pads, this is the .m_physical_connexion member which is a cluster identifier
-     * For tracks, this is the .m_Subnet member which is a cluster identifier
+     * For pads and tracks, this is the .m_Subnet member which is a cluster identifier
      * For a given net, if all tracks are created, there is only one cluster.
      * but if not all tracks are created, there are more than one cluster,
      * and some ratsnests will be left active.
+     * Clusters are built using a union-find structure, so large nets do not need
+     * to renumber their items each time two clusters are merged.
+     * Items not connected to any other item have a sub netcode = 0.
      */
     void Propagate_SubNets();
 
 private:
     /**
-     * function searchEntryPointInCandidatesList
-     * Search an item in m_Connected connected to aPoint
-     * note m_Connected containts usually more than one candidate
-     * and searchEntryPointInCandidatesList returns an index to one of these candidates
-     * Others are neightbor of the indexed item.
-     * @param aPoint is the reference coordinates
-     * @return the index of item found or -1 if no candidate
-     */
-    int searchEntryPointInCandidatesList( const wxPoint & aPoint);
-
-    /**
-     * Function Merge_SubNets
-     * Change a subnet old value to a new value, for tracks and pads which are connected to
-     * tracks from m_firstTrack to m_lastTrack and their connected pads.
-     * and modify the subnet parameter (change the old value to the new value).
-     * After that, 2 cluster (or subnets) are merged into only one.
-     * Note: the resulting sub net value is the smallest between aOldSubNet and aNewSubNet
-     * @return modification count
-     * @param aOldSubNet = subnet value to modify
-     * @param aNewSubNet = new subnet value for each item which have old_val as subnet value
-     */
-    int Merge_SubNets( int aOldSubNet, int aNewSubNet );
-
-    /**
-     * Function Merge_PadsSubNets
-     * Change a subnet value to a new value, in m_sortedPads pad list
-     * After that, 2 cluster (or subnets) are merged into only one.
-     * Note: the resulting subnet value is the smallest between aOldSubNet et aNewSubNet
-     * @return modification count
-     * @param aOldSubNet = subnet value to modify
-     * @param aNewSubNet = new subnet value for each item which have old_val as subnet value
+     * Function buildCandidatesHash
+     * fills m_candidatesHash from m_candidates.
+     * Must be called each time m_candidates is rebuilt.
      */
-    int Merge_PadsSubNets( int aOldSubNet, int aNewSubNet );
+    void buildCandidatesHash();
 };
 
 #endif      //  ifndef CONNECT_H
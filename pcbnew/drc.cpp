@@ -28,7 +28,13 @@
  * @file drc.cpp
  */
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 #include <fctsys.h>
+#include <map>
+#include <algorithm>
 #include <wxPcbStruct.h>
 #include <trigo.h>
 #include <base_units.h>
@@ -40,11 +46,13 @@
 #include <class_zone.h>
 #include <class_pcb_text.h>
 #include <class_draw_panel_gal.h>
+#include <ratsnest_data.h>
 #include <view/view.h>
 #include <geometry/seg.h>
 
 #include <pcbnew.h>
 #include <drc_stuff.h>
+#include <drc_spatial_index.h>
 
 #include <dialog_drc.h>
 #include <wx/progdlg.h>
@@ -94,9 +102,32 @@ void DRC::DestroyDialog( int aReason )
 
 
 DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
+{
+    init( aPcbWindow, aPcbWindow->GetBoard() );
+}
+
+
+DRC::DRC( BOARD* aBoard )
+{
+    init( NULL, aBoard );
+}
+
+
+DRC::DRC( const DRC* aParent )
+{
+    init( aParent->m_mainWindow, aParent->m_pcb );
+
+    m_doPad2PadTest     = aParent->m_doPad2PadTest;
+    m_doUnconnectedTest = aParent->m_doUnconnectedTest;
+    m_doZonesTest       = aParent->m_doZonesTest;
+    m_doKeepoutTest     = aParent->m_doKeepoutTest;
+}
+
+
+void DRC::init( PCB_EDIT_FRAME* aPcbWindow, BOARD* aBoard )
 {
     m_mainWindow = aPcbWindow;
-    m_pcb = aPcbWindow->GetBoard();
+    m_pcb = aBoard;
     m_ui  = 0;
 
     // establish initial values for everything:
@@ -108,6 +139,7 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     m_drcInProgress = false;
 
     m_doCreateRptFile = false;
+    m_doIncrementalTest = false;
 
     // m_rptFilename set to empty by its constructor
 
@@ -115,6 +147,7 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
 
     m_segmAngle  = 0;
     m_segmLength = 0;
+    m_segmClearance = 0;
 
     m_xcliplo = 0;
     m_ycliplo = 0;
@@ -275,6 +308,10 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 
     testTexts();
 
+    // From now on, the markers are kept up to date after each modification
+    // of the board by RunIncrementalTests().
+    SetIncrementalTest( true );
+
     // update the m_ui listboxes
     updatePointers();
 
@@ -299,7 +336,8 @@ void DRC::ListUnconnectedPads()
 void DRC::updatePointers()
 {
     // update my pointers, m_mainWindow is the only unchangeable one
-    m_pcb = m_mainWindow->GetBoard();
+    if( m_mainWindow )
+        m_pcb = m_mainWindow->GetBoard();
 
     if( m_ui )  // Use diag list boxes only in DRC dialog
     {
@@ -327,8 +365,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_CLEARANCE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -343,8 +380,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_TRACKWIDTH, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -358,8 +394,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_VIASIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -373,8 +408,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_VIADRILLSIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -388,8 +422,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_uVIASIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -403,8 +436,7 @@ bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
                     );
 
         m_currentMarker = fillMarker( DRCE_NETCLASS_uVIADRILLSIZE, msg, m_currentMarker );
-        m_pcb->Add( m_currentMarker );
-        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+        addMarkerToPcb( m_currentMarker );
         m_currentMarker = 0;
         ret = false;
     }
@@ -436,42 +468,156 @@ bool DRC::testNetClasses()
 }
 
 
+/*
+ * A group of pads having the same copper layers, stored as their positions in
+ * the pad list sorted by X coordinate.  Used by testPad2Pad() to skip the pads
+ * which cannot be in conflict with a reference pad.
+ */
+struct PAD_BUCKET
+{
+    LSET             m_layers;
+    std::vector<int> m_pads;
+};
+
+
+/**
+ * Function collectBucketPads
+ * appends to aResult the positions of the pads of aBucket located after
+ * aRefIndex in the sorted pad list, up to the X coordinate aXLimit.
+ */
+static void collectBucketPads( const PAD_BUCKET& aBucket, const std::vector<D_PAD*>& aSortedPads,
+                               int aRefIndex, int aXLimit, std::vector<int>& aResult )
+{
+    std::vector<int>::const_iterator it = std::upper_bound( aBucket.m_pads.begin(),
+                                                            aBucket.m_pads.end(), aRefIndex );
+
+    for( ; it != aBucket.m_pads.end(); ++it )
+    {
+        if( aSortedPads[*it]->GetPosition().x > aXLimit )
+            break;
+
+        aResult.push_back( *it );
+    }
+}
+
+
 void DRC::testPad2Pad()
 {
     std::vector<D_PAD*> sortedPads;
 
     m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
 
+    int count = sortedPads.size();
+
     // find the max size of the pads (used to stop the test)
+    // and gather the pads in buckets of pads having the same copper layers.
     int max_size = 0;
 
-    for( unsigned i = 0; i < sortedPads.size(); ++i )
+    std::map<unsigned long, int> bucketOfLayers;
+    std::vector<PAD_BUCKET>      buckets;
+    PAD_BUCKET                   drilledPads;
+
+    for( int i = 0; i < count; ++i )
     {
         D_PAD* pad = sortedPads[i];
 
         // GetBoundingRadius() is the radius of the minimum sized circle fully containing the pad
+        // (this call also initializes its cached value before the concurrent tests)
         int radius = pad->GetBoundingRadius();
         if( radius > max_size )
             max_size = radius;
+
+        LSET layers = pad->GetLayerSet() & LSET::AllCuMask();
+
+        std::map<unsigned long, int>::iterator bucket = bucketOfLayers.find( layers.to_ulong() );
+
+        if( bucket == bucketOfLayers.end() )
+        {
+            bucket = bucketOfLayers.insert( std::make_pair( layers.to_ulong(),
+                                                            (int) buckets.size() ) ).first;
+            buckets.push_back( PAD_BUCKET() );
+            buckets.back().m_layers = layers;
+        }
+
+        buckets[bucket->second].m_pads.push_back( i );
+
+        if( pad->GetDrillSize().x )
+            drilledPads.m_pads.push_back( i );
     }
 
-    // Test the pads
-    D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
+    // Test the pads.  Each pad is tested against the pads which follow it in the
+    // sorted list, up to a X limit, and which are either on one of its copper layers
+    // or have a hole (or any pad, if the pad itself has a hole): the other ones cannot
+    // be in conflict with it, and would be skipped by doPadToPadsDrc().
+    // Each pad has its own marker slot, so the markers are added in the same order
+    // whatever the thread which found them.
+    std::vector<MARKER_PCB*> markers( count, (MARKER_PCB*) NULL );
 
-    for( unsigned i = 0; i< sortedPads.size(); ++i )
-    {
-        D_PAD* pad = sortedPads[i];
+    int i;
 
-        int    x_limit = max_size + pad->GetClearance() +
-                         pad->GetBoundingRadius() + pad->GetPosition().x;
+#ifdef USE_OPENMP
+    #pragma omp parallel private(i)
+    {
+        DRC                 worker( this );
+        std::vector<int>    candidates;
+        std::vector<D_PAD*> neighbours;
 
-        if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+        #pragma omp for schedule(dynamic, 64)
+#else /* USE_OPENMP */
+    {
+        DRC                 worker( this );
+        std::vector<int>    candidates;
+        std::vector<D_PAD*> neighbours;
+#endif
+        for( i = 0; i < count; ++i )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            D_PAD* pad = sortedPads[i];
+
+            int    x_limit = max_size + pad->GetClearance() +
+                             pad->GetBoundingRadius() + pad->GetPosition().x;
+
+            LSET   layers = pad->GetLayerSet() & LSET::AllCuMask();
+            bool   drilled = pad->GetDrillSize().x != 0;
+
+            candidates.clear();
+
+            for( unsigned b = 0; b < buckets.size(); ++b )
+            {
+                if( drilled || ( buckets[b].m_layers & layers ).any() )
+                    collectBucketPads( buckets[b], sortedPads, i, x_limit, candidates );
+            }
+
+            if( !drilled )
+                collectBucketPads( drilledPads, sortedPads, i, x_limit, candidates );
+
+            if( candidates.empty() )
+                continue;
+
+            // Test the candidates in the sorted list order, to report the same
+            // error as a test of the whole list
+            std::sort( candidates.begin(), candidates.end() );
+            candidates.erase( std::unique( candidates.begin(), candidates.end() ),
+                              candidates.end() );
+
+            neighbours.clear();
+
+            for( unsigned jj = 0; jj < candidates.size(); ++jj )
+                neighbours.push_back( sortedPads[candidates[jj]] );
+
+            if( !worker.doPadToPadsDrc( pad, &neighbours[0], &neighbours[0] + neighbours.size(),
+                                        x_limit ) )
+            {
+                wxASSERT( worker.m_currentMarker );
+                markers[i] = worker.m_currentMarker;
+                worker.m_currentMarker = NULL;
+            }
         }
+    }  /* end of parallel section */
+
+    for( i = 0; i < count; ++i )
+    {
+        if( markers[i] )
+            addMarkerToPcb( markers[i] );
     }
 }
 
@@ -481,9 +627,16 @@ void DRC::testTracks( bool aShowProgressBar )
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
+
+    DRC_SPATIAL_INDEX index;
+
+    index.Build( m_pcb );
+
+    // The last track has already been tested against all the others
+    int count = index.GetTrackCount() - 1;
+
+    if( count <= 0 )
+        return;
 
     int deltamax = count/delta;
 
@@ -495,39 +648,75 @@ void DRC::testTracks( bool aShowProgressBar )
         progressDialog->Update( 0, wxEmptyString );
     }
 
-    int ii = 0;
-    count = 0;
+    // Each track gets its own marker slot, so the threads do not share anything
+    // and the markers are added to the board in track order, whatever the thread
+    // which found them.
+    std::vector<MARKER_PCB*> markers( count, (MARKER_PCB*) NULL );
 
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
+    int last = 0;
+
+    for( int first = 0; first < count; first = last )
     {
-        if ( ii++ > delta )
+        last = std::min( first + delta, count );
+
+        int ii;
+
+#ifdef USE_OPENMP
+        #pragma omp parallel private(ii)
         {
-            ii = 0;
-            count++;
+            DRC worker( this );
 
-            if( progressDialog )
+            #pragma omp for schedule(dynamic, 16)
+#else /* USE_OPENMP */
+        {
+            DRC worker( this );
+#endif
+            for( ii = first; ii < last; ++ii )
             {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
+                if( !worker.doTrackDrc( index.GetTrack( ii ), ii, index ) )
+                {
+                    wxASSERT( worker.m_currentMarker );
+                    markers[ii] = worker.m_currentMarker;
+                    worker.m_currentMarker = NULL;
+                }
             }
-        }
+        }  /* end of parallel section */
 
-        if( !doTrackDrc( segm, segm->Next(), true ) )
+        if( progressDialog )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            if( !progressDialog->Update( last / delta, wxEmptyString ) )
+                break;  // Aborted by user
         }
     }
 
+    for( int ii = 0; ii < last; ++ii )
+    {
+        if( markers[ii] )
+            addMarkerToPcb( markers[ii] );
+    }
+
     if( progressDialog )
         progressDialog->Destroy();
 }
 
 
+void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
+{
+    m_pcb->Add( aMarker );
+
+    if( m_mainWindow )
+        m_mainWindow->GetGalCanvas()->GetView()->Add( aMarker );
+}
+
+
 void DRC::testUnconnected()
 {
+    if( !m_mainWindow )
+    {
+        testRatsnestUnconnected();
+        return;
+    }
+
     if( (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
     {
         wxClientDC dc( m_mainWindow->GetCanvas() );
@@ -561,6 +750,41 @@ void DRC::testUnconnected()
 }
 
 
+void DRC::testRatsnestUnconnected()
+{
+    RN_DATA* ratsnest = m_pcb->GetRatsnest();
+
+    ratsnest->ProcessBoard();
+
+    wxString msg;
+
+    for( int net = 1; net < ratsnest->GetNetCount(); ++net )
+    {
+        const std::vector<RN_EDGE_MST_PTR>* edges = ratsnest->GetNet( net ).GetUnconnected();
+
+        if( !edges || edges->empty() )
+            continue;
+
+        NETINFO_ITEM* netinfo = m_pcb->FindNet( net );
+
+        msg.Printf( _( "Unconnected items net %s" ),
+                    netinfo ? GetChars( netinfo->GetNetname() ) : wxT( "?" ) );
+
+        BOOST_FOREACH( const RN_EDGE_MST_PTR& edge, *edges )
+        {
+            const RN_NODE_PTR& nodeA = edge->GetSourceNode();
+            const RN_NODE_PTR& nodeB = edge->GetTargetNode();
+
+            DRC_ITEM* uncItem = new DRC_ITEM( DRCE_UNCONNECTED_PADS, msg, msg,
+                                              wxPoint( nodeA->GetX(), nodeA->GetY() ),
+                                              wxPoint( nodeB->GetX(), nodeB->GetY() ) );
+
+            m_unconnected.push_back( uncItem );
+        }
+    }
+}
+
+
 void DRC::testZones()
 {
     // Test copper areas for valid netcodes
@@ -590,8 +814,7 @@ void DRC::testZones()
         {
             m_currentMarker = fillMarker( test_area,
                                           DRCE_SUSPICIOUS_NET_FOR_ZONE_OUTLINE, m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+            addMarkerToPcb( m_currentMarker );
             m_currentMarker = NULL;
         }
     }
@@ -626,8 +849,7 @@ void DRC::testKeepoutAreas()
                 {
                     m_currentMarker = fillMarker( segm, NULL,
                                                   DRCE_TRACK_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker );
                     m_currentMarker = 0;
                 }
             }
@@ -643,8 +865,7 @@ void DRC::testKeepoutAreas()
                 {
                     m_currentMarker = fillMarker( segm, NULL,
                                                   DRCE_VIA_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker );
                     m_currentMarker = 0;
                 }
             }
@@ -704,8 +925,7 @@ void DRC::testTexts()
                         m_currentMarker = fillMarker( track, text,
                                                       DRCE_TRACK_INSIDE_TEXT,
                                                       m_currentMarker );
-                        m_pcb->Add( m_currentMarker );
-                        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                        addMarkerToPcb( m_currentMarker );
                         m_currentMarker = NULL;
                         break;
                     }
@@ -723,8 +943,7 @@ void DRC::testTexts()
                     {
                         m_currentMarker = fillMarker( track, text,
                                                       DRCE_VIA_INSIDE_TEXT, m_currentMarker );
-                        m_pcb->Add( m_currentMarker );
-                        m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                        addMarkerToPcb( m_currentMarker );
                         m_currentMarker = NULL;
                         break;
                     }
@@ -774,8 +993,7 @@ void DRC::testTexts()
                 {
                     m_currentMarker = fillMarker( pad, text,
                                                   DRCE_PAD_INSIDE_TEXT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker );
                     m_currentMarker = NULL;
                     break;
                 }
@@ -834,7 +1052,8 @@ bool DRC::doTrackKeepoutDrc( TRACK* aRefSeg )
 
 bool DRC::doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit )
 {
-    const static LSET all_cu = LSET::AllCuMask();
+    // Not a static: this function is called concurrently by testPad2Pad()
+    const LSET all_cu = LSET::AllCuMask();
 
     LSET layerMask = aRefPad->GetLayerSet() & all_cu;
 
@@ -0,0 +1,324 @@
+/**
+ * @file drc_batch.cpp
+ * @brief Methods of class DRC used to run the tests without user interface,
+ * and to write a machine readable report of the results.
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <climits>
+
+#include <fctsys.h>
+#include <common.h>
+#include <richio.h>
+#include <macros.h>
+
+#include <class_board.h>
+#include <class_marker_pcb.h>
+#include <class_drc_item.h>
+
+#include <pcbnew.h>
+#include <drc_stuff.h>
+
+
+/**
+ * Function elapsedMicroSecs
+ * @return the microseconds elapsed since aStart, a GetRunningMicroSecs() value.
+ * The difference is computed as a signed 64 bit value, and corrected when the
+ * unsigned counter wrapped around between the two calls.
+ */
+static int64_t elapsedMicroSecs( unsigned aStart )
+{
+    int64_t elapsed = (int64_t) GetRunningMicroSecs() - (int64_t) aStart;
+
+    if( elapsed < 0 )
+        elapsed += (int64_t) UINT_MAX + 1;
+
+    return elapsed;
+}
+
+
+bool DRC::RunBatchTests()
+{
+    m_timings.clear();
+    m_failedTest.clear();
+
+    m_pcb->DeleteMARKERs();
+
+    for( unsigned ii = 0; ii < m_unconnected.size(); ++ii )
+        delete m_unconnected[ii];
+
+    m_unconnected.clear();
+
+    unsigned start = GetRunningMicroSecs();
+
+    bool netclassesOk = testNetClasses();
+    m_timings.push_back( DRC_TIMING( "netclasses", elapsedMicroSecs( start ) ) );
+
+    // See RunTests(): all the items of a net class failing the global
+    // rules would fail, so stop here.  WriteJsonReport() still writes the
+    // netclass markers, and this test as the one which failed.
+    if( !netclassesOk )
+    {
+        m_failedTest = m_timings.back().first;
+        return false;
+    }
+
+    if( m_doPad2PadTest )
+    {
+        start = GetRunningMicroSecs();
+        testPad2Pad();
+        m_timings.push_back( DRC_TIMING( "pad_clearances", elapsedMicroSecs( start ) ) );
+    }
+
+    start = GetRunningMicroSecs();
+    testTracks( false );
+    m_timings.push_back( DRC_TIMING( "track_clearances", elapsedMicroSecs( start ) ) );
+
+    // Refill all zones, like PCB_EDIT_FRAME::Fill_All_Zones() does,
+    // because filled areas stored in the file can be outdated.
+    start = GetRunningMicroSecs();
+    m_pcb->m_Zone.DeleteAll();
+    m_pcb->FillAllZones();
+
+    m_timings.push_back( DRC_TIMING( "zone_fill", elapsedMicroSecs( start ) ) );
+
+    start = GetRunningMicroSecs();
+    testZones();
+    m_timings.push_back( DRC_TIMING( "zones", elapsedMicroSecs( start ) ) );
+
+    if( m_doUnconnectedTest )
+    {
+        start = GetRunningMicroSecs();
+        testUnconnected();
+        m_timings.push_back( DRC_TIMING( "unconnected", elapsedMicroSecs( start ) ) );
+    }
+
+    if( m_doKeepoutTest )
+    {
+        start = GetRunningMicroSecs();
+        testKeepoutAreas();
+        m_timings.push_back( DRC_TIMING( "keepout_areas", elapsedMicroSecs( start ) ) );
+    }
+
+    start = GetRunningMicroSecs();
+    testTexts();
+    m_timings.push_back( DRC_TIMING( "texts", elapsedMicroSecs( start ) ) );
+
+    return m_pcb->GetMARKERCount() == 0 && m_unconnected.empty();
+}
+
+
+/**
+ * Function jsonString
+ * @return aText as a quoted and escaped UTF8 JSON string.
+ */
+static std::string jsonString( const wxString& aText )
+{
+    std::string utf8 = TO_UTF8( aText );
+    std::string ret  = "\"";
+
+    for( unsigned ii = 0; ii < utf8.size(); ++ii )
+    {
+        char c = utf8[ii];
+
+        switch( c )
+        {
+        case '"':   ret += "\\\"";  break;
+        case '\\':  ret += "\\\\";  break;
+        case '\n':  ret += "\\n";   break;
+        case '\r':  ret += "\\r";   break;
+        case '\t':  ret += "\\t";   break;
+
+        default:
+            if( (unsigned char) c < 0x20 )
+            {
+                char buf[8];
+                sprintf( buf, "\\u%04x", c );
+                ret += buf;
+            }
+            else
+                ret += c;
+        }
+    }
+
+    ret += '"';
+
+    return ret;
+}
+
+
+#define DRC_ERROR_NAME( code )  case code: return #code
+
+/**
+ * Function drcErrorName
+ * @return the untranslated name of the DRC error code aCode, i.e. the name of
+ * its DRCE_ define, for the tools reading the JSON report.
+ */
+static const char* drcErrorName( int aCode )
+{
+    switch( aCode )
+    {
+    DRC_ERROR_NAME( DRCE_UNCONNECTED_PADS );
+    DRC_ERROR_NAME( DRCE_TRACK_NEAR_THROUGH_HOLE );
+    DRC_ERROR_NAME( DRCE_TRACK_NEAR_PAD );
+    DRC_ERROR_NAME( DRCE_TRACK_NEAR_VIA );
+    DRC_ERROR_NAME( DRCE_VIA_NEAR_VIA );
+    DRC_ERROR_NAME( DRCE_VIA_NEAR_TRACK );
+    DRC_ERROR_NAME( DRCE_TRACK_ENDS1 );
+    DRC_ERROR_NAME( DRCE_TRACK_ENDS2 );
+    DRC_ERROR_NAME( DRCE_TRACK_ENDS3 );
+    DRC_ERROR_NAME( DRCE_TRACK_ENDS4 );
+    DRC_ERROR_NAME( DRCE_TRACK_SEGMENTS_TOO_CLOSE );
+    DRC_ERROR_NAME( DRCE_TRACKS_CROSSING );
+    DRC_ERROR_NAME( DRCE_ENDS_PROBLEM1 );
+    DRC_ERROR_NAME( DRCE_ENDS_PROBLEM2 );
+    DRC_ERROR_NAME( DRCE_ENDS_PROBLEM3 );
+    DRC_ERROR_NAME( DRCE_ENDS_PROBLEM4 );
+    DRC_ERROR_NAME( DRCE_ENDS_PROBLEM5 );
+    DRC_ERROR_NAME( DRCE_PAD_NEAR_PAD1 );
+    DRC_ERROR_NAME( DRCE_VIA_HOLE_BIGGER );
+    DRC_ERROR_NAME( DRCE_MICRO_VIA_INCORRECT_LAYER_PAIR );
+    DRC_ERROR_NAME( COPPERAREA_INSIDE_COPPERAREA );
+    DRC_ERROR_NAME( COPPERAREA_CLOSE_TO_COPPERAREA );
+    DRC_ERROR_NAME( DRCE_SUSPICIOUS_NET_FOR_ZONE_OUTLINE );
+    DRC_ERROR_NAME( DRCE_HOLE_NEAR_PAD );
+    DRC_ERROR_NAME( DRCE_HOLE_NEAR_TRACK );
+    DRC_ERROR_NAME( DRCE_TOO_SMALL_TRACK_WIDTH );
+    DRC_ERROR_NAME( DRCE_TOO_SMALL_VIA );
+    DRC_ERROR_NAME( DRCE_TOO_SMALL_MICROVIA );
+    DRC_ERROR_NAME( DRCE_NETCLASS_TRACKWIDTH );
+    DRC_ERROR_NAME( DRCE_NETCLASS_CLEARANCE );
+    DRC_ERROR_NAME( DRCE_NETCLASS_VIASIZE );
+    DRC_ERROR_NAME( DRCE_NETCLASS_VIADRILLSIZE );
+    DRC_ERROR_NAME( DRCE_NETCLASS_uVIASIZE );
+    DRC_ERROR_NAME( DRCE_NETCLASS_uVIADRILLSIZE );
+    DRC_ERROR_NAME( DRCE_VIA_INSIDE_KEEPOUT );
+    DRC_ERROR_NAME( DRCE_TRACK_INSIDE_KEEPOUT );
+    DRC_ERROR_NAME( DRCE_PAD_INSIDE_KEEPOUT );
+    DRC_ERROR_NAME( DRCE_VIA_INSIDE_TEXT );
+    DRC_ERROR_NAME( DRCE_TRACK_INSIDE_TEXT );
+    DRC_ERROR_NAME( DRCE_PAD_INSIDE_TEXT );
+
+    default:    return "DRCE_UNKNOWN";
+    }
+}
+
+#undef DRC_ERROR_NAME
+
+
+static void formatJsonItem( OUTPUTFORMATTER& aOut, int aNestLevel, const wxString& aText,
+                            const wxPoint& aPos, bool aDescriptions, bool aLast )
+    throw( IO_ERROR )
+{
+    aOut.Print( aNestLevel, "{ \"x_mm\": %.6f, \"y_mm\": %.6f",
+                aPos.x / IU_PER_MM, aPos.y / IU_PER_MM );
+
+    if( aDescriptions )
+        aOut.Print( 0, ", \"text\": %s", jsonString( aText ).c_str() );
+
+    aOut.Print( 0, " }%s\n", aLast ? "" : "," );
+}
+
+
+static void formatJsonDrcItem( OUTPUTFORMATTER& aOut, int aNestLevel, const DRC_ITEM& aItem,
+                               bool aDescriptions, bool aLast ) throw( IO_ERROR )
+{
+    aOut.Print( aNestLevel, "{\n" );
+    aOut.Print( aNestLevel+1, "\"code\": %d,\n", aItem.GetErrorCode() );
+    aOut.Print( aNestLevel+1, "\"name\": \"%s\",\n", drcErrorName( aItem.GetErrorCode() ) );
+
+    if( aDescriptions )
+    {
+        aOut.Print( aNestLevel+1, "\"description\": %s,\n",
+                    jsonString( aItem.GetErrorText() ).c_str() );
+    }
+
+    aOut.Print( aNestLevel+1, "\"items\": [\n" );
+
+    formatJsonItem( aOut, aNestLevel+2, aItem.GetTextA(), aItem.GetPointA(),
+                    aDescriptions, !aItem.HasSecondItem() );
+
+    if( aItem.HasSecondItem() )
+    {
+        formatJsonItem( aOut, aNestLevel+2, aItem.GetTextB(), aItem.GetPointB(),
+                        aDescriptions, true );
+    }
+
+    aOut.Print( aNestLevel+1, "]\n" );
+    aOut.Print( aNestLevel, "}%s\n", aLast ? "" : "," );
+}
+
+
+void DRC::WriteJsonReport( const wxString& aFullFileName, bool aDescriptions )
+    throw( IO_ERROR )
+{
+    LOCALE_IO   toggle;     // toggles on, then off, the C locale, for "%f" formatting
+
+    FILE_OUTPUTFORMATTER out( aFullFileName );
+
+    int markerCount = m_pcb->GetMARKERCount();
+
+    out.Print( 0, "{\n" );
+    out.Print( 1, "\"board\": %s,\n", jsonString( m_pcb->GetFileName() ).c_str() );
+    out.Print( 1, "\"passed\": %s,\n",
+               markerCount == 0 && m_unconnected.empty() && m_failedTest.empty() ?
+               "true" : "false" );
+
+    // The test which stopped RunBatchTests() early, the other tests were not run
+    if( !m_failedTest.empty() )
+        out.Print( 1, "\"failed_test\": \"%s\",\n", m_failedTest.c_str() );
+
+    out.Print( 1, "\"timings\": [\n" );
+
+    for( unsigned ii = 0; ii < m_timings.size(); ++ii )
+    {
+        out.Print( 2, "{ \"test\": \"%s\", \"usecs\": %lld }%s\n",
+                   m_timings[ii].first.c_str(), (long long) m_timings[ii].second,
+                   ii + 1 < m_timings.size() ? "," : "" );
+    }
+
+    out.Print( 1, "],\n" );
+
+    out.Print( 1, "\"violations\": [\n" );
+
+    for( int ii = 0; ii < markerCount; ++ii )
+    {
+        formatJsonDrcItem( out, 2, m_pcb->GetMARKER( ii )->GetReporter(),
+                           aDescriptions, ii + 1 == markerCount );
+    }
+
+    out.Print( 1, "],\n" );
+
+    out.Print( 1, "\"unconnected\": [\n" );
+
+    for( unsigned ii = 0; ii < m_unconnected.size(); ++ii )
+    {
+        formatJsonDrcItem( out, 2, *m_unconnected[ii], aDescriptions,
+                           ii + 1 == m_unconnected.size() );
+    }
+
+    out.Print( 1, "]\n" );
+    out.Print( 0, "}\n" );
+}
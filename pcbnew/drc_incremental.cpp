@@ -0,0 +1,320 @@
+/**
+ * @file drc_incremental.cpp
+ * @brief Methods of class DRC used to test again only the items around
+ * the last modifications of the board.
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <climits>
+#include <wxPcbStruct.h>
+#include <class_board_design_settings.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_pad.h>
+#include <class_marker_pcb.h>
+#include <class_draw_panel_gal.h>
+#include <view/view.h>
+
+#include <pcbnew.h>
+#include <drc_stuff.h>
+#include <drc_spatial_index.h>
+
+
+/**
+ * Function isClearanceError
+ * @return true if aErrorCode is reported by the track and pad clearance tests,
+ * i.e. by the tests run again by DRC::RunIncrementalTests().
+ */
+static bool isClearanceError( int aErrorCode )
+{
+    return ( aErrorCode >= DRCE_TRACK_NEAR_THROUGH_HOLE
+             && aErrorCode <= DRCE_MICRO_VIA_INCORRECT_LAYER_PAIR )
+        || ( aErrorCode >= DRCE_HOLE_NEAR_PAD && aErrorCode <= DRCE_TOO_SMALL_MICROVIA );
+}
+
+
+/**
+ * Function maxClearance
+ * @return the largest clearance used by the clearance tests of aPcb: the biggest
+ * net class clearance, or the larger local clearance of a pad or of its footprint.
+ */
+static int maxClearance( BOARD* aPcb )
+{
+    int clearance = aPcb->GetDesignSettings().GetBiggestClearanceValue();
+
+    for( unsigned ii = 0; ii < aPcb->GetPadCount(); ++ii )
+        clearance = std::max( clearance, aPcb->GetPad( ii )->GetClearance() );
+
+    return clearance;
+}
+
+
+static bool containsAny( const wxPoint& aPoint, const std::vector<EDA_RECT>& aAreas )
+{
+    for( unsigned ii = 0; ii < aAreas.size(); ++ii )
+    {
+        if( aAreas[ii].Contains( aPoint ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+static bool intersectsAny( const EDA_RECT& aBox, const std::vector<EDA_RECT>& aAreas )
+{
+    for( unsigned ii = 0; ii < aAreas.size(); ++ii )
+    {
+        if( aBox.Intersects( aAreas[ii] ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+void DRC::SetIncrementalTest( bool aEnable )
+{
+    m_doIncrementalTest = aEnable;
+
+    m_dirtyAreas.clear();
+    m_dirtyItems.clear();
+}
+
+
+void DRC::MarkDirty( const BOARD_ITEM* aItem )
+{
+    if( !m_doIncrementalTest || !aItem )
+        return;
+
+    switch( aItem->Type() )
+    {
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        m_dirtyAreas.push_back( DRC_SPATIAL_INDEX::TrackBox( (const TRACK*) aItem ) );
+        break;
+
+    case PCB_MODULE_T:
+        m_dirtyAreas.push_back( aItem->GetBoundingBox() );
+
+        // The markers reference the pads, not their footprint
+        for( D_PAD* pad = ( (const MODULE*) aItem )->Pads(); pad; pad = pad->Next() )
+            m_dirtyItems.insert( pad );
+
+        break;
+
+    default:
+        return;
+    }
+
+    m_dirtyItems.insert( aItem );
+}
+
+
+void DRC::addMarkerIfNew()
+{
+    for( int ii = 0; ii < m_pcb->GetMARKERCount(); ++ii )
+    {
+        MARKER_PCB* marker = m_pcb->GetMARKER( ii );
+
+        if( marker->GetPos() == m_currentMarker->GetPos()
+            && marker->GetReporter().GetErrorCode() ==
+               m_currentMarker->GetReporter().GetErrorCode() )
+        {
+            delete m_currentMarker;
+            m_currentMarker = NULL;
+            return;
+        }
+    }
+
+    addMarkerToPcb( m_currentMarker );
+    m_currentMarker = NULL;
+}
+
+
+void DRC::RunIncrementalTests()
+{
+    if( !m_doIncrementalTest || m_dirtyItems.empty() )
+        return;
+
+    // The changed region: the areas of the modified items before the modification,
+    // and the areas of the ones which are still on the board, after it.
+    std::vector<EDA_RECT> areas = m_dirtyAreas;
+
+    for( MODULE* module = m_pcb->m_Modules; module; module = module->Next() )
+    {
+        if( m_dirtyItems.count( module ) )
+            areas.push_back( module->GetBoundingBox() );
+    }
+
+    for( TRACK* track = m_pcb->m_Track; track; track = track->Next() )
+    {
+        if( m_dirtyItems.count( track ) )
+            areas.push_back( DRC_SPATIAL_INDEX::TrackBox( track ) );
+    }
+
+    std::set<const BOARD_ITEM*> dirtyItems;
+
+    dirtyItems.swap( m_dirtyItems );
+    m_dirtyAreas.clear();
+
+    // Items further than the biggest clearance from the changed region
+    // are not affected by the modification.  Pads can have a local clearance
+    // bigger than the net class ones.
+    int clearance = maxClearance( m_pcb );
+
+    for( unsigned ii = 0; ii < areas.size(); ++ii )
+        areas[ii].Inflate( clearance );
+
+    // The items to test again can be longer than the changed region, and must be
+    // tested against all their neighbours: extend each area to the items it
+    // intersects, plus the clearance, to get the area to index.
+    std::vector<EDA_RECT> indexAreas = areas;
+
+    for( TRACK* track = m_pcb->m_Track; track; track = track->Next() )
+    {
+        EDA_RECT box = DRC_SPATIAL_INDEX::TrackBox( track );
+
+        for( unsigned ii = 0; ii < areas.size(); ++ii )
+        {
+            if( box.Intersects( areas[ii] ) )
+                indexAreas[ii].Merge( box );
+        }
+    }
+
+    for( unsigned jj = 0; jj < m_pcb->GetPadCount(); ++jj )
+    {
+        EDA_RECT box = DRC_SPATIAL_INDEX::PadBox( m_pcb->GetPad( jj ) );
+
+        for( unsigned ii = 0; ii < areas.size(); ++ii )
+        {
+            if( box.Intersects( areas[ii] ) )
+                indexAreas[ii].Merge( box );
+        }
+    }
+
+    for( unsigned ii = 0; ii < indexAreas.size(); ++ii )
+        indexAreas[ii].Inflate( clearance );
+
+    DRC_SPATIAL_INDEX index;
+
+    index.Build( m_pcb, &indexAreas );
+
+    // Remove the clearance markers of the modified items, wherever they are now
+    // (the marker item is the tested item, see fillMarker()), and the ones whose
+    // items are in the changed region: they are found again if the error still exists.
+    for( int ii = m_pcb->GetMARKERCount() - 1; ii >= 0; --ii )
+    {
+        MARKER_PCB*     marker = m_pcb->GetMARKER( ii );
+        const DRC_ITEM& item   = marker->GetReporter();
+
+        if( !isClearanceError( item.GetErrorCode() ) )
+            continue;
+
+        bool stale = dirtyItems.count( marker->GetItem() )
+                     || containsAny( marker->GetPos(), areas )
+                     || containsAny( item.GetPointA(), areas )
+                     || ( item.HasSecondItem() && containsAny( item.GetPointB(), areas ) );
+
+        if( !stale )
+            continue;
+
+        if( m_mainWindow )
+            m_mainWindow->GetGalCanvas()->GetView()->Remove( marker );
+
+        m_pcb->Remove( marker );
+        delete marker;
+    }
+
+    // Flag the items to test again.  A pair of flagged items is tested only once,
+    // from the first item of the pair in list order, like the full tests do.
+    std::vector<bool> retestedPads( index.GetPadCount(), false );
+    std::vector<bool> retestedTracks( index.GetTrackCount(), false );
+
+    for( int ii = 0; ii < index.GetPadCount(); ++ii )
+        retestedPads[ii] = intersectsAny( DRC_SPATIAL_INDEX::PadBox( index.GetPad( ii ) ), areas );
+
+    for( int ii = 0; ii < index.GetTrackCount(); ++ii )
+    {
+        retestedTracks[ii] = intersectsAny( DRC_SPATIAL_INDEX::TrackBox( index.GetTrack( ii ) ),
+                                            areas );
+    }
+
+    std::vector<int>    candidates;
+    std::vector<D_PAD*> neighbours;
+
+    if( m_doPad2PadTest )
+    {
+        for( int ii = 0; ii < index.GetPadCount(); ++ii )
+        {
+            if( !retestedPads[ii] )
+                continue;
+
+            D_PAD*   pad  = index.GetPad( ii );
+            EDA_RECT area = DRC_SPATIAL_INDEX::PadBox( pad );
+
+            area.Inflate( index.GetMaxClearance() );
+            index.QueryPads( area, candidates );
+
+            neighbours.clear();
+
+            for( unsigned jj = 0; jj < candidates.size(); ++jj )
+            {
+                if( candidates[jj] < ii && retestedPads[candidates[jj]] )
+                    continue;
+
+                neighbours.push_back( index.GetPad( candidates[jj] ) );
+            }
+
+            if( neighbours.empty() )
+                continue;
+
+            // The neighbours are not sorted by X coordinate, so do not use the X limit
+            if( !doPadToPadsDrc( pad, &neighbours[0], &neighbours[0] + neighbours.size(),
+                                 INT_MAX ) )
+            {
+                wxASSERT( m_currentMarker );
+                addMarkerIfNew();
+            }
+        }
+    }
+
+    for( int ii = 0; ii < index.GetTrackCount(); ++ii )
+    {
+        if( !retestedTracks[ii] )
+            continue;
+
+        if( !doTrackDrc( index.GetTrack( ii ), ii, index, &retestedTracks ) )
+        {
+            wxASSERT( m_currentMarker );
+            addMarkerIfNew();
+        }
+    }
+
+    updatePointers();
+}
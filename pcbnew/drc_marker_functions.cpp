@@ -112,7 +112,6 @@ MARKER_PCB* DRC::fillMarker( const TRACK* aTrack, BOARD_ITEM* aItem, int aErrorC
             fillMe = new MARKER_PCB( aErrorCode, position,
                                      textA, aTrack->GetPosition(),
                                      textB, posB );
-            fillMe->SetItem( aItem );
         }
         else
         {
@@ -121,6 +120,10 @@ MARKER_PCB* DRC::fillMarker( const TRACK* aTrack, BOARD_ITEM* aItem, int aErrorC
         }
     }
 
+    // The tested track, also used by DRC::RunIncrementalTests() to find the
+    // markers of the modified items
+    fillMe->SetItem( aTrack );
+
     return fillMe;
 }
 
@@ -160,9 +163,10 @@ MARKER_PCB* DRC::fillMarker( D_PAD* aPad, BOARD_ITEM* aItem, int aErrorCode, MAR
     else
     {
         fillMe = new MARKER_PCB( aErrorCode, posA, textA, posA, textB, posB );
-        fillMe->SetItem( aPad );    // TODO it has to be checked
     }
 
+    fillMe->SetItem( aPad );
+
     return fillMe;
 }
 
@@ -0,0 +1,214 @@
+/**
+ * @file drc_spatial_index.cpp
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_pad.h>
+
+#include <drc_spatial_index.h>
+
+
+/**
+ * Class INDEX_COLLECTOR
+ * is the R-tree visitor used by the queries: it stores the index of each item found,
+ * skipping the ones not greater than a given index.
+ */
+class INDEX_COLLECTOR
+{
+public:
+    INDEX_COLLECTOR( std::vector<int>& aResult, int aMinIndex ) :
+        m_result( aResult ),
+        m_minIndex( aMinIndex )
+    {}
+
+    bool operator()( int aIndex )
+    {
+        if( aIndex > m_minIndex )
+            m_result.push_back( aIndex );
+
+        return true;
+    }
+
+private:
+    std::vector<int>&   m_result;
+    int                 m_minIndex;
+};
+
+
+static inline void insertBox( RTree<int, int, 2, float>& aTree, const EDA_RECT& aBox, int aIndex )
+{
+    const int mmin[2] = { aBox.GetX(), aBox.GetY() };
+    const int mmax[2] = { aBox.GetRight(), aBox.GetBottom() };
+
+    aTree.Insert( mmin, mmax, aIndex );
+}
+
+
+DRC_SPATIAL_INDEX::DRC_SPATIAL_INDEX() :
+    m_maxClearance( 0 )
+{
+    for( int layer = 0; layer < MAX_CU_LAYERS; ++layer )
+        m_trackTrees.push_back( new INDEX_RTREE );
+}
+
+
+void DRC_SPATIAL_INDEX::Clear()
+{
+    m_tracks.clear();
+    m_pads.clear();
+
+    for( unsigned ii = 0; ii < m_trackTrees.size(); ++ii )
+        m_trackTrees[ii].RemoveAll();
+
+    m_padTree.RemoveAll();
+    m_maxClearance = 0;
+}
+
+
+static bool intersectsAny( const EDA_RECT& aBox, const std::vector<EDA_RECT>* aAreas )
+{
+    if( !aAreas )
+        return true;
+
+    for( unsigned ii = 0; ii < aAreas->size(); ++ii )
+    {
+        if( aBox.Intersects( (*aAreas)[ii] ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+void DRC_SPATIAL_INDEX::Build( BOARD* aBoard, const std::vector<EDA_RECT>* aAreas )
+{
+    Clear();
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        int      index = m_tracks.size();
+        EDA_RECT box   = TrackBox( track );
+
+        if( !intersectsAny( box, aAreas ) )
+            continue;
+
+        m_tracks.push_back( track );
+        m_maxClearance = std::max( m_maxClearance, track->GetClearance() );
+
+        // A via is stored in the tree of each layer it goes through
+        for( LSEQ cu = ( track->GetLayerSet() & LSET::AllCuMask() ).CuStack();  cu;  ++cu )
+            insertBox( m_trackTrees[*cu], box, index );
+    }
+
+    for( unsigned ii = 0; ii < aBoard->GetPadCount(); ++ii )
+    {
+        D_PAD*   pad   = aBoard->GetPad( ii );
+        int      index = m_pads.size();
+
+        // PadBox() also initializes the cached bounding radius of the pad, so that
+        // concurrent tests do not have to.
+        EDA_RECT box   = PadBox( pad );
+
+        if( !intersectsAny( box, aAreas ) )
+            continue;
+
+        m_pads.push_back( pad );
+        m_maxClearance = std::max( m_maxClearance, pad->GetClearance() );
+
+        insertBox( m_padTree, box, index );
+    }
+}
+
+
+void DRC_SPATIAL_INDEX::QueryTracks( const EDA_RECT& aArea, LSET aLayers, int aMinIndex,
+                                     std::vector<int>& aResult )
+{
+    const int   mmin[2] = { aArea.GetX(), aArea.GetY() };
+    const int   mmax[2] = { aArea.GetRight(), aArea.GetBottom() };
+    LSET        cuLayers = aLayers & LSET::AllCuMask();
+
+    INDEX_COLLECTOR collector( aResult, aMinIndex );
+
+    aResult.clear();
+
+    for( LSEQ cu = cuLayers.CuStack();  cu;  ++cu )
+        m_trackTrees[*cu].Search( mmin, mmax, collector );
+
+    std::sort( aResult.begin(), aResult.end() );
+
+    // Vias are found once per layer
+    if( cuLayers.count() > 1 )
+        aResult.erase( std::unique( aResult.begin(), aResult.end() ), aResult.end() );
+}
+
+
+void DRC_SPATIAL_INDEX::QueryPads( const EDA_RECT& aArea, std::vector<int>& aResult )
+{
+    const int   mmin[2] = { aArea.GetX(), aArea.GetY() };
+    const int   mmax[2] = { aArea.GetRight(), aArea.GetBottom() };
+
+    INDEX_COLLECTOR collector( aResult, -1 );
+
+    aResult.clear();
+    m_padTree.Search( mmin, mmax, collector );
+    std::sort( aResult.begin(), aResult.end() );
+}
+
+
+EDA_RECT DRC_SPATIAL_INDEX::TrackBox( const TRACK* aTrack )
+{
+    EDA_RECT box( aTrack->GetStart(), wxSize( 0, 0 ) );
+
+    box.SetEnd( aTrack->GetEnd() );
+    box.Normalize();
+    box.Inflate( aTrack->GetWidth() / 2 + 1 );
+
+    return box;
+}
+
+
+EDA_RECT DRC_SPATIAL_INDEX::PadBox( const D_PAD* aPad )
+{
+    EDA_RECT box( aPad->ShapePos(), wxSize( 0, 0 ) );
+
+    box.Inflate( aPad->GetBoundingRadius() + 1 );
+
+    const wxSize& drill = aPad->GetDrillSize();
+
+    if( drill.x || drill.y )
+    {
+        EDA_RECT holeBox( aPad->GetPosition(), wxSize( 0, 0 ) );
+
+        holeBox.Inflate( std::max( drill.x, drill.y ) / 2 + 1 );
+        box.Merge( holeBox );
+    }
+
+    return box;
+}
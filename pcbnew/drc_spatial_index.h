@@ -0,0 +1,137 @@
+/**
+ * @file drc_spatial_index.h
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef _DRC_SPATIAL_INDEX_H
+#define _DRC_SPATIAL_INDEX_H
+
+#include <vector>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <class_eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+
+class BOARD;
+class TRACK;
+class D_PAD;
+
+
+/**
+ * Class DRC_SPATIAL_INDEX
+ * holds R-trees of the tracks (one tree per copper layer) and the pads of a BOARD,
+ * so the clearance tests only have to look at the neighbours of an item instead of
+ * walking the whole track and pad lists.
+ * Items are stored by their index in the board lists, and queries return indices
+ * sorted in list order, so a DRC run using this index reports the same first
+ * error for each item as a run walking BOARD::m_Track.
+ * The index does not own the items and must be rebuilt if the board changes.
+ * Once built, queries do not modify it and may run concurrently.
+ */
+class DRC_SPATIAL_INDEX
+{
+public:
+    DRC_SPATIAL_INDEX();
+
+    /**
+     * Function Build
+     * (re)builds the index from the tracks and the pads of aBoard.
+     * @param aBoard is the board to index.
+     * @param aAreas, if not NULL, restricts the index to the items whose bounding box
+     *               intersects one of these areas.  Indices are then positions in the
+     *               list of the indexed items, which keeps the board list order.
+     */
+    void Build( BOARD* aBoard, const std::vector<EDA_RECT>* aAreas = NULL );
+
+    /**
+     * Function Clear
+     * removes all items from the index.
+     */
+    void Clear();
+
+    int GetTrackCount() const               { return m_tracks.size(); }
+    TRACK* GetTrack( int aIndex ) const     { return m_tracks[aIndex]; }
+
+    int GetPadCount() const                 { return m_pads.size(); }
+    D_PAD* GetPad( int aIndex ) const       { return m_pads[aIndex]; }
+
+    /**
+     * Function GetMaxClearance
+     * @return the largest clearance of all the indexed items, i.e. the distance
+     * by which a reference area must be inflated so that queries return every item
+     * that might violate a clearance rule.
+     */
+    int GetMaxClearance() const             { return m_maxClearance; }
+
+    /**
+     * Function QueryTracks
+     * collects the tracks having at least one copper layer in aLayers and a
+     * bounding box intersecting aArea.
+     * @param aArea is the area to search in.
+     * @param aLayers is the layer set of the reference item.
+     * @param aMinIndex only tracks whose index is greater than aMinIndex are returned
+     *                  (use -1 to get all of them).
+     * @param aResult receives the track indices, sorted in board list order.
+     */
+    void QueryTracks( const EDA_RECT& aArea, LSET aLayers, int aMinIndex,
+                      std::vector<int>& aResult );
+
+    /**
+     * Function QueryPads
+     * collects the pads whose bounding box (including the hole) intersects aArea,
+     * whatever their layers are: a pad on other layers can still have a hole
+     * which must be tested.
+     * @param aArea is the area to search in.
+     * @param aResult receives the pad indices, sorted in board pad list order.
+     */
+    void QueryPads( const EDA_RECT& aArea, std::vector<int>& aResult );
+
+    /**
+     * Function TrackBox
+     * @return the normalized bounding box of a track segment or via, including its width.
+     */
+    static EDA_RECT TrackBox( const TRACK* aTrack );
+
+    /**
+     * Function PadBox
+     * @return the normalized bounding box of a pad shape and of its hole.
+     */
+    static EDA_RECT PadBox( const D_PAD* aPad );
+
+private:
+    typedef RTree<int, int, 2, float> INDEX_RTREE;
+
+    std::vector<TRACK*>             m_tracks;       ///< indexed tracks, in BOARD::m_Track order
+    std::vector<D_PAD*>             m_pads;         ///< indexed pads, in BOARD::GetPad() order
+
+    boost::ptr_vector<INDEX_RTREE>  m_trackTrees;   ///< one tree per copper layer
+    INDEX_RTREE                     m_padTree;
+
+    int                             m_maxClearance;
+};
+
+
+#endif  // _DRC_SPATIAL_INDEX_H
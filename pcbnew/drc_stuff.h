@@ -29,8 +29,13 @@
 #ifndef _DRC_STUFF_H
 #define _DRC_STUFF_H
 
+#include <stdint.h>
 #include <vector>
+#include <set>
+#include <string>
 #include <boost/shared_ptr.hpp>
+#include <richio.h>
+#include <class_eda_rect.h>
 
 #define OK_DRC  0
 #define BAD_DRC 1
@@ -91,6 +96,7 @@ class TRACK;
 class MARKER_PCB;
 class DRC_ITEM;
 class NETCLASS;
+class DRC_SPATIAL_INDEX;
 
 
 /**
@@ -139,6 +145,9 @@ public:
 
 typedef std::vector<DRC_ITEM*> DRC_LIST;
 
+/// Name of a DRC test and the time it took to run, in microseconds
+typedef std::pair<std::string, int64_t> DRC_TIMING;
+
 
 /**
  * Class DRC
@@ -162,6 +171,7 @@ private:
     bool     m_doZonesTest;
     bool     m_doKeepoutTest;
     bool     m_doCreateRptFile;
+    bool     m_doIncrementalTest;
 
     wxString m_rptFilename;
 
@@ -184,6 +194,7 @@ private:
      */
     double m_segmAngle;     // Ref segm orientation in 0,1 degre
     int m_segmLength;       // length of the reference segment
+    int m_segmClearance;    // netclass clearance of the reference segment, used for holes
 
     /* variables used in checkLine to test DRC segm to segm:
      * define the area relative to the ref segment that does not contains any other segment
@@ -199,6 +210,32 @@ private:
 
     DRC_LIST            m_unconnected;  ///< list of unconnected pads, as DRC_ITEMs
 
+    std::vector<DRC_TIMING> m_timings;  ///< time spent in each test by RunBatchTests()
+    std::string         m_failedTest;   ///< name of the test which stopped RunBatchTests() early
+
+    /* Dirty set used by RunIncrementalTests(): the areas the modified items
+     * occupied when they were recorded, and the items themselves, whose current
+     * area is used if they are still on the board.
+     */
+    std::vector<EDA_RECT>       m_dirtyAreas;
+    std::set<const BOARD_ITEM*> m_dirtyItems;
+
+
+    /**
+     * Constructor used to create a worker copy of aParent for the multi-threaded tests.
+     * The worker shares the board and the test settings of aParent, but has its
+     * own coordinates and current marker, so it can test items concurrently.
+     * It has no dialog and no list of unconnected items.
+     */
+    DRC( const DRC* aParent );
+
+    /**
+     * Function init
+     * sets the initial values of the members, shared by the constructors.
+     * @param aPcbWindow The frame of the DRC, or NULL for a DRC without user interface.
+     * @param aBoard The board to test.
+     */
+    void init( PCB_EDIT_FRAME* aPcbWindow, BOARD* aBoard );
 
     /**
      * Function updatePointers
@@ -208,6 +245,13 @@ private:
     void updatePointers();
 
 
+    /**
+     * Function addMarkerToPcb
+     * adds a DRC marker to the BOARD, and to the GAL view when there is a main window.
+     * @param aMarker The marker to add, owned by the BOARD after the call.
+     */
+    void addMarkerToPcb( MARKER_PCB* aMarker );
+
     /**
      * Function fillMarker
      * optionally creates a marker and fills it in with information,
@@ -270,16 +314,34 @@ private:
     /**
      * Function testTracks
      * performs the DRC on all tracks.
+     * Each track is only tested against its neighbours, found using a spatial
+     * index of the board built once per run, and tracks are tested concurrently
+     * when OpenMP is available.
      * because this test can take a while, a progress bar can be displayed
      * @param aShowProgressBar = true to show a progrsse bar
      * (Note: it is shown only if there are many tracks)
      */
     void testTracks( bool aShowProgressBar );
 
+    /**
+     * Function testPad2Pad
+     * performs the pad to pad and pad to hole clearance tests.
+     * Pads are grouped by copper layers, so that each pad is only tested against
+     * the pads sharing one of its layers or having a hole, and pads are tested
+     * concurrently when OpenMP is available.
+     */
     void testPad2Pad();
 
     void testUnconnected();
 
+    /**
+     * Function testRatsnestUnconnected
+     * gathers the unconnected items using the board connectivity data
+     * (BOARD::GetRatsnest()), which does not need a frame.  Used instead of the
+     * legacy ratsnest when there is no main window.
+     */
+    void testRatsnestUnconnected();
+
     void testZones();
 
     void testKeepoutAreas();
@@ -301,6 +363,14 @@ private:
      */
     bool doPadToPadsDrc( D_PAD* aRefPad, D_PAD** aStart, D_PAD** aEnd, int x_limit );
 
+    /**
+     * Function addMarkerIfNew
+     * adds m_currentMarker to the BOARD, unless a marker having the same position
+     * and error code is already there, in which case m_currentMarker is deleted.
+     * Used by the incremental tests, which can find again errors already reported.
+     */
+    void addMarkerIfNew();
+
     /**
      * Function DoTrackDrc
      * tests the current segment.
@@ -312,6 +382,58 @@ private:
      */
     bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
 
+    /**
+     * Function doTrackDrc
+     * tests the current segment against its neighbour pads, and the neighbour
+     * tracks located after it in the board track list, found using a spatial index.
+     * This gives the same results as doTrackDrc( aRefSeg, aRefSeg->Next(), true ).
+     * @param aRefSeg The segment to test
+     * @param aRefIndex The index of aRefSeg in aIndex
+     * @param aIndex The spatial index of the board items
+     * @param aRetested When not NULL, flags the tracks of aIndex which are tested as
+     *                  reference segments: aRefSeg is then also tested against the
+     *                  tracks located before it which are not flagged.
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackDrc( TRACK* aRefSeg, int aRefIndex, DRC_SPATIAL_INDEX& aIndex,
+                     const std::vector<bool>* aRetested = NULL );
+
+    /**
+     * Function doTrackShapeDrc
+     * tests the track width, or the via size, drill and layer pair, of the current
+     * segment, and initializes the reference segment variables (m_segmEnd,
+     * m_segmAngle, m_segmLength and m_segmClearance) used by the tests against other items.
+     * @param aRefSeg The segment to test
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackShapeDrc( TRACK* aRefSeg );
+
+    /**
+     * Function doTrackToPadDrc
+     * tests the clearance between the current segment and a pad, or its hole
+     * if the pad is not on the segment layers.
+     * doTrackShapeDrc() must have been called for aRefSeg.
+     * @param aRefSeg The segment to test
+     * @param aPad The pad to test against
+     * @param aDummyPad A pad used to build the shape of the hole of aPad
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackToPadDrc( TRACK* aRefSeg, D_PAD* aPad, D_PAD* aDummyPad );
+
+    /**
+     * Function doTrackToTrackDrc
+     * tests the clearance between the current segment and another track or via.
+     * doTrackShapeDrc() must have been called for aRefSeg.
+     * @param aRefSeg The segment to test
+     * @param aTrack The track to test against
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackToTrackDrc( TRACK* aRefSeg, TRACK* aTrack );
+
     /**
      * Function doTrackKeepoutDrc
      * tests the current segment or via.
@@ -392,6 +514,12 @@ private:
 public:
     DRC( PCB_EDIT_FRAME* aPcbWindow );
 
+    /**
+     * Constructor for a DRC without user interface, testing aBoard.
+     * Use RunBatchTests() to run the tests.
+     */
+    DRC( BOARD* aBoard );
+
     ~DRC();
 
     /**
@@ -483,6 +611,68 @@ public:
      */
     void RunTests( wxTextCtrl* aMessages = NULL );
 
+    /**
+     * Function RunBatchTests
+     * runs all the tests enabled by SetSettings(), without any user interface,
+     * and records the time spent in each of them.  The previous markers of the
+     * board are deleted, zones are refilled, and the new markers are added to the board.
+     * @return bool - true if no error and no unconnected item was found.
+     */
+    bool RunBatchTests();
+
+    /**
+     * Function SetIncrementalTest
+     * enables or disables the incremental tests.  When enabled, MarkDirty() records
+     * the items modified by the editor and RunIncrementalTests() tests them.
+     */
+    void SetIncrementalTest( bool aEnable );
+
+    bool IsIncrementalTestEnabled() const   { return m_doIncrementalTest; }
+
+    /**
+     * Function MarkDirty
+     * records an item which is about to be modified, added or deleted, so that the
+     * next RunIncrementalTests() call tests the items around its current area and
+     * around its area after the modification.
+     * Only tracks, vias and footprints are recorded: the other items are not
+     * used by the clearance tests.  Does nothing if the incremental tests are disabled.
+     */
+    void MarkDirty( const BOARD_ITEM* aItem );
+
+    /**
+     * Function RunIncrementalTests
+     * runs the track and pad clearance tests on the items whose bounding box
+     * intersects the area of the items recorded by MarkDirty(), inflated by the
+     * biggest clearance of the board, including the local clearances of pads and
+     * footprints.  Markers whose items are located in this area, or whose tested
+     * item is a recorded one, are replaced by the new ones, and the dirty set
+     * is cleared.
+     * The other tests (zones, unconnected items...) need a full run.
+     */
+    void RunIncrementalTests();
+
+    /**
+     * Function WriteJsonReport
+     * writes the markers of the board, the unconnected items and the timings of
+     * the last RunBatchTests() call to a JSON file, along with the test which
+     * stopped the tests early, if any.  Errors are identified by their code and
+     * untranslated name.
+     * @param aFullFileName The name of the report file.
+     * @param aDescriptions = true to also write the translated descriptions of
+     *  the errors and of their items.
+     * @throw IO_ERROR if the file cannot be written.
+     */
+    void WriteJsonReport( const wxString& aFullFileName, bool aDescriptions = false )
+        throw( IO_ERROR );
+
+    /**
+     * @return the time spent in each test by the last RunBatchTests() call.
+     */
+    const std::vector<DRC_TIMING>& GetTimings() const
+    {
+        return m_timings;
+    }
+
     /**
      * Function ListUnconnectedPad
      * gathers a list of all the unconnected pads and shows them in the
@@ -0,0 +1,306 @@
+/**
+ * @file kicad_board_cache.cpp
+ * @brief Binary cache of the big s-expression board files, used to load them faster.
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * The cache of <name>.kicad_pcb is <name>.kicad_pcb-cache.  It contains:
+ *  - a header, with the size, modification time and hash of the board file it was
+ *    made from, so a cache which does not match the board file is not used;
+ *  - the board without its tracks, vias and zone filled areas, in s-expression format;
+ *  - the tracks and vias, in binary form;
+ *  - the filled areas of each zone, in binary form, and the hash of the data used to
+ *    fill them (see ZONE_CONTAINER::ComputeFillHash()), so an unchanged zone is not
+ *    filled again after the board is loaded.
+ * Tracks and filled areas are most of a big board file, and are read from the cache
+ * without any parsing.  The cache is read and written with CACHE_READER and CACHE_WRITER.
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <build_version.h>
+#include <macros.h>
+#include <richio.h>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <kicad_plugin.h>
+#include <pcb_parser.h>
+
+#include <wx/filename.h>
+#include <stdint.h>
+#include <cstring>
+#include <memory>
+
+
+#define BOARD_CACHE_VERSION     3
+
+/// Smaller board files are fast enough to parse, and do not get a cache.
+static const size_t BOARD_CACHE_MIN_SIZE = 2 * 1024 * 1024;
+
+static const char boardCacheMagic[8] = { 'K', 'I', 'C', 'A', 'D', 'P', 'C', 'B' };
+
+/// Track types in the cache.
+enum CACHE_TRACK_T
+{
+    CACHE_SEGMENT,
+    CACHE_VIA
+};
+
+
+static LAYER_ID getCacheLayer( CACHE_READER& aReader ) throw( IO_ERROR )
+{
+    int32_t layer = aReader.Get<int32_t>();
+
+    if( layer < 0 || layer >= LAYER_ID_COUNT )
+        THROW_IO_ERROR( _( "invalid layer in board cache" ) );
+
+    return LAYER_ID( layer );
+}
+
+
+BOARD* PCB_IO::loadBoardCache( const wxString& aFileName )
+{
+    wxString cacheName = CacheFileName( aFileName );
+
+    if( !wxFileName::FileExists( cacheName ) )
+        return NULL;
+
+    try
+    {
+        MMAP_LINE_READER    cache( cacheName );
+        CACHE_READER        in( cache );
+
+        if( !in.CheckHeader( boardCacheMagic, BOARD_CACHE_VERSION, aFileName )
+            || in.Get<uint32_t>() != (uint32_t) SEXPR_BOARD_FILE_VERSION
+            || in.Get<uint32_t>() != (uint32_t) LAYER_ID_COUNT )
+        {
+            return NULL;
+        }
+
+        // The board, without tracks and zone filled areas
+        uint64_t textSize = in.Get<uint64_t>();
+        size_t   textPos  = in.GetPosition();
+
+        in.Skip( textSize );
+
+        MMAP_LINE_READER textReader( cache, textPos, textPos + textSize, 0 );
+
+        m_parser->SetLineReader( &textReader );
+        m_parser->SetBoard( NULL );
+
+        std::auto_ptr<BOARD> board( dyn_cast<BOARD*>( m_parser->Parse() ) );
+
+        if( !board.get() )
+            return NULL;
+
+        // The tracks and vias
+        uint32_t trackCount = in.Get<uint32_t>();
+
+        for( uint32_t ii = 0; ii < trackCount; ++ii )
+        {
+            uint8_t                 type = in.Get<uint8_t>();
+            std::auto_ptr<TRACK>    track;
+
+            if( type == CACHE_VIA )
+                track.reset( new VIA( board.get() ) );
+            else if( type == CACHE_SEGMENT )
+                track.reset( new TRACK( board.get() ) );
+            else
+                return NULL;
+
+            wxPoint start, end;
+
+            start.x = in.Get<int32_t>();
+            start.y = in.Get<int32_t>();
+            end.x   = in.Get<int32_t>();
+            end.y   = in.Get<int32_t>();
+
+            track->SetStart( start );
+            track->SetEnd( end );
+            track->SetWidth( in.Get<int32_t>() );
+            track->SetNetCode( m_parser->GetNetCode( in.Get<int32_t>() ) );
+
+            if( type == CACHE_VIA )
+            {
+                VIA*     via    = static_cast<VIA*>( track.get() );
+                LAYER_ID layer1 = getCacheLayer( in );
+                LAYER_ID layer2 = getCacheLayer( in );
+
+                via->SetLayerPair( layer1, layer2 );
+                via->SetViaType( VIATYPE_T( in.Get<int32_t>() ) );
+                via->SetDrill( in.Get<int32_t>() );
+            }
+            else
+            {
+                track->SetLayer( getCacheLayer( in ) );
+            }
+
+            track->SetTimeStamp( (time_t) in.Get<int64_t>() );
+            track->SetStatus( STATUS_FLAGS( in.Get<uint32_t>() ) );
+
+            board->Add( track.release(), ADD_APPEND );
+        }
+
+        // The zone filled areas, and the hash of their fill
+        if( in.Get<uint32_t>() != (uint32_t) board->GetAreaCount() )
+            return NULL;
+
+        for( int ii = 0; ii < board->GetAreaCount(); ++ii )
+        {
+            uint32_t        cornerCount = in.Get<uint32_t>();
+            CPOLYGONS_LIST  pts;
+
+            for( uint32_t jj = 0; jj < cornerCount; ++jj )
+            {
+                int x = in.Get<int32_t>();
+                int y = in.Get<int32_t>();
+
+                pts.Append( CPolyPt( x, y, in.Get<uint8_t>() != 0 ) );
+            }
+
+            if( pts.GetCornersCount() )
+                board->GetArea( ii )->AddFilledPolysList( pts );
+
+            board->GetArea( ii )->SetFillHash( (size_t) in.Get<uint64_t>() );
+        }
+
+        return board.release();
+    }
+    catch( const IO_ERROR& )
+    {
+        // The cache is unusable, the caller parses the board file.
+        return NULL;
+    }
+}
+
+
+/**
+ * Function removeBoardCache
+ * removes the cache of a board file which was saved without a new cache.  The old
+ * cache does not match the saved board file: it would never be used, but would still
+ * be read and hashed at each load.
+ */
+static void removeBoardCache( const wxString& aCacheName )
+{
+    if( wxFileName::FileExists( aCacheName ) )
+        wxRemoveFile( aCacheName );
+}
+
+
+void PCB_IO::saveBoardCache( const wxString& aFileName, BOARD* aBoard,
+                             const std::string& aBoardText )
+{
+    wxString cacheName = CacheFileName( aFileName );
+
+    try
+    {
+        MMAP_LINE_READER boardFile( aFileName );
+
+        if( boardFile.GetSize() < BOARD_CACHE_MIN_SIZE )
+        {
+            removeBoardCache( cacheName );
+            return;
+        }
+
+        CACHE_WRITER out;
+
+        out.PutHeader( boardCacheMagic, BOARD_CACHE_VERSION, boardFile );
+        out.Put<uint32_t>( SEXPR_BOARD_FILE_VERSION );
+        out.Put<uint32_t>( LAYER_ID_COUNT );
+
+        // The board, without tracks and zone filled areas, as written by Save()
+        out.Put<uint64_t>( aBoardText.size() );
+        out.Put( aBoardText.data(), aBoardText.size() );
+
+        // The tracks and vias, with the net codes of the file (m_mapping is
+        // still the one of Save())
+        out.Put<uint32_t>( aBoard->m_Track.GetCount() );
+
+        for( TRACK* track = aBoard->m_Track;  track;  track = track->Next() )
+        {
+            bool isVia = track->Type() == PCB_VIA_T;
+
+            out.Put<uint8_t>( isVia ? CACHE_VIA : CACHE_SEGMENT );
+            out.Put<int32_t>( track->GetStart().x );
+            out.Put<int32_t>( track->GetStart().y );
+            out.Put<int32_t>( track->GetEnd().x );
+            out.Put<int32_t>( track->GetEnd().y );
+            out.Put<int32_t>( track->GetWidth() );
+            out.Put<int32_t>( m_mapping->Translate( track->GetNetCode() ) );
+
+            if( isVia )
+            {
+                VIA*     via = static_cast<VIA*>( track );
+                LAYER_ID layer1, layer2;
+
+                via->LayerPair( &layer1, &layer2 );
+
+                out.Put<int32_t>( layer1 );
+                out.Put<int32_t>( layer2 );
+                out.Put<int32_t>( via->GetViaType() );
+                out.Put<int32_t>( via->GetDrill() );
+            }
+            else
+            {
+                out.Put<int32_t>( track->GetLayer() );
+            }
+
+            out.Put<int64_t>( track->GetTimeStamp() );
+            out.Put<uint32_t>( track->GetStatus() );
+        }
+
+        // The zone filled areas, and the hash of their fill
+        out.Put<uint32_t>( aBoard->GetAreaCount() );
+
+        for( int ii = 0; ii < aBoard->GetAreaCount(); ++ii )
+        {
+            const ZONE_CONTAINER* zone = aBoard->GetArea( ii );
+            const CPOLYGONS_LIST& fv   = zone->GetFilledPolysList();
+
+            out.Put<uint32_t>( fv.GetCornersCount() );
+
+            for( unsigned jj = 0; jj < fv.GetCornersCount(); ++jj )
+            {
+                out.Put<int32_t>( fv.GetX( jj ) );
+                out.Put<int32_t>( fv.GetY( jj ) );
+                out.Put<uint8_t>( fv.IsEndContour( jj ) );
+            }
+
+            out.Put<uint64_t>( zone->GetFillHash() );
+        }
+
+        if( out.Write( cacheName ) )
+            return;
+    }
+    catch( const IO_ERROR& )
+    {
+        // The cache is only an optimization, the board file itself is fine.
+    }
+
+    removeBoardCache( cacheName );
+}
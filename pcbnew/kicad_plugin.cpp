@@ -51,6 +51,14 @@
 #include <wx/wfstream.h>
 #include <boost/ptr_container/ptr_map.hpp>
 #include <memory.h>
+#include <set>
+
+#if defined( __linux__ )
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#include <stdint.h>
+#endif
 
 using namespace PCB_KEYS_T;
 
@@ -132,6 +140,191 @@ bool FP_CACHE_ITEM::IsModified() const
 }
 
 
+#define FP_CACHE_CHECK_INTERVAL     2000    ///< ms between two full checks of a library
+                                            ///< whose changes are not notified
+
+
+/**
+ * Function dirModificationTime
+ * @return the modification time of the directory @a aPath, or 0 if it does not exist.
+ */
+static time_t dirModificationTime( const wxString& aPath )
+{
+    wxStructStat st;
+
+    if( wxStat( aPath, &st ) != 0 )
+        return 0;
+
+    return st.st_mtime;
+}
+
+
+#if defined( __linux__ )
+/**
+ * Function isNotifiedFileSystem
+ * @return true if inotify reports all the changes of the files in @a aPath.  This is not
+ *         the case on network file systems, for the changes made by other machines.
+ */
+static bool isNotifiedFileSystem( const wxString& aPath )
+{
+    struct statfs fs;
+
+    if( statfs( aPath.fn_str(), &fs ) != 0 )
+        return false;
+
+    switch( (uint32_t) fs.f_type )
+    {
+    case 0x6969:        // NFS
+    case 0x517B:        // SMB
+    case 0xFF534D42:    // CIFS
+    case 0xFE534D42:    // SMB2
+    case 0x65735546:    // FUSE (sshfs ...)
+    case 0x5346414F:    // AFS
+    case 0x73757245:    // CODA
+        return false;
+
+    default:
+        return true;
+    }
+}
+#endif
+
+
+/**
+ * Class FP_CACHE_WATCHER
+ * tells which footprint files of a library changed, so #FP_CACHE does not test the
+ * modification time of every file of the library each time it is accessed.
+ *
+ * On Linux, the changes of the local libraries are notified by inotify.  Otherwise,
+ * all the files are checked when the directory modification time changed (a footprint
+ * was added, removed or renamed), and at most once every #FP_CACHE_CHECK_INTERVAL for
+ * the files modified in place.
+ */
+class FP_CACHE_WATCHER
+{
+    wxString    m_path;             ///< library path
+    time_t      m_dir_mod_time;     ///< library path modification time at the last full check
+    wxLongLong  m_last_check;       ///< time of the last full check, in ms
+    int         m_fd;               ///< inotify descriptor, or -1
+    int         m_wd;               ///< inotify watch, or -1
+
+public:
+    FP_CACHE_WATCHER( const wxString& aLibPath );
+    ~FP_CACHE_WATCHER();
+
+    /**
+     * Function GetChanges
+     * gets the names of the footprints whose file changed since the previous call.
+     *
+     * @param aChanged receives the names of the changed footprints, when they are known.
+     * @return true if they are not known, and all the footprint files must be checked.
+     */
+    bool GetChanges( std::set<wxString>* aChanged );
+};
+
+
+FP_CACHE_WATCHER::FP_CACHE_WATCHER( const wxString& aLibPath ) :
+    m_path( aLibPath ),
+    m_fd( -1 ),
+    m_wd( -1 )
+{
+    m_dir_mod_time = dirModificationTime( m_path );
+    m_last_check = wxGetLocalTimeMillis();
+
+#if defined( __linux__ )
+    if( isNotifiedFileSystem( m_path ) )
+    {
+        m_fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+
+        if( m_fd >= 0 )
+        {
+            m_wd = inotify_add_watch( m_fd, m_path.fn_str(),
+                                      IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE |
+                                      IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF );
+
+            if( m_wd < 0 )
+            {
+                close( m_fd );
+                m_fd = -1;
+            }
+        }
+    }
+#endif
+}
+
+
+FP_CACHE_WATCHER::~FP_CACHE_WATCHER()
+{
+#if defined( __linux__ )
+    if( m_fd >= 0 )
+        close( m_fd );
+#endif
+}
+
+
+bool FP_CACHE_WATCHER::GetChanges( std::set<wxString>* aChanged )
+{
+#if defined( __linux__ )
+    if( m_fd >= 0 )
+    {
+        char    buf[4096] __attribute__(( aligned( __alignof__( struct inotify_event ) ) ));
+        ssize_t len;
+        bool    full = false;
+
+        while( ( len = read( m_fd, buf, sizeof( buf ) ) ) > 0 )
+        {
+            for( char* ptr = buf; ptr < buf + len; )
+            {
+                const struct inotify_event* event = (const struct inotify_event*) ptr;
+
+                if( event->mask & IN_Q_OVERFLOW )
+                {
+                    full = true;
+                }
+                else if( event->mask & ( IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED ) )
+                {
+                    // The watch is gone with the directory: fall back to the full checks.
+                    full = true;
+                    close( m_fd );
+                    m_fd = m_wd = -1;
+                    break;
+                }
+                else if( event->len )
+                {
+                    wxFileName fn( wxString( event->name, wxConvFile ) );
+
+                    if( fn.GetExt() == KiCadFootprintFileExtension )
+                        aChanged->insert( fn.GetName() );
+                }
+
+                ptr += sizeof( struct inotify_event ) + event->len;
+            }
+
+            if( m_fd < 0 )
+                break;
+        }
+
+        if( !full )
+            return false;
+
+        m_dir_mod_time = dirModificationTime( m_path );
+        m_last_check = wxGetLocalTimeMillis();
+        return true;
+    }
+#endif
+
+    time_t      dirModTime = dirModificationTime( m_path );
+    wxLongLong  now = wxGetLocalTimeMillis();
+
+    if( dirModTime == m_dir_mod_time && now - m_last_check < FP_CACHE_CHECK_INTERVAL )
+        return false;
+
+    m_dir_mod_time = dirModTime;
+    m_last_check = now;
+    return true;
+}
+
+
 typedef boost::ptr_map< std::string, FP_CACHE_ITEM >  MODULE_MAP;
 typedef MODULE_MAP::iterator                          MODULE_ITER;
 typedef MODULE_MAP::const_iterator                    MODULE_CITER;
@@ -144,6 +337,11 @@ class FP_CACHE
     wxDateTime      m_mod_time;     /// Footprint library path modified time stamp.
     MODULE_MAP      m_modules;      /// Map of footprint file name per MODULE*.
 
+    std::auto_ptr<FP_CACHE_WATCHER> m_watcher;  /// Changes of the library files.
+
+    /// Loads or reloads the footprint file @a aFullPath.
+    void loadItem( const wxFileName& aFullPath );
+
 public:
     FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath );
 
@@ -166,18 +364,15 @@ public:
     wxDateTime GetLibModificationTime() const;
 
     /**
-     * Function IsModified
-     * check if the footprint cache has been modified relative to \a aLibPath
-     * and \a aFootprintName.
+     * Function Update
+     * reloads the footprint files which changed since they were cached, loads the
+     * new ones and forgets the deleted ones.  Only the files reported changed by the
+     * library watcher are tested, unless it cannot tell which ones changed.
      *
-     * @param aLibPath is a path to test the current cache library path against.
-     * @param aFootprintName is the footprint name in the cache to test.  If the footprint
-     *                       name is empty, the all the footprint files in the library are
-     *                       checked to see if they have been modified.
-     * @return true if the cache has been modified.
+     * @param aFootprintName is the name of a footprint about to be used, or empty.  It
+     *                       is tested, even if it is not reported changed.
      */
-    bool IsModified( const wxString& aLibPath,
-                     const wxString& aFootprintName = wxEmptyString ) const;
+    void Update( const wxString& aFootprintName = wxEmptyString );
 
     /**
      * Function IsPath
@@ -284,6 +479,9 @@ void FP_CACHE::Load()
         THROW_IO_ERROR( msg );
     }
 
+    // Watch the library before reading it, so no change is missed.
+    m_watcher.reset( new FP_CACHE_WATCHER( m_lib_path.GetPath() ) );
+
     wxString fpFileName;
     wxString wildcard = wxT( "*." ) + KiCadFootprintFileExtension;
 
@@ -292,18 +490,7 @@ void FP_CACHE::Load()
         do
         {
             // prepend the libpath into fullPath
-            wxFileName fullPath( m_lib_path.GetPath(), fpFileName );
-
-            FILE_LINE_READER    reader( fullPath.GetFullPath() );
-
-            m_owner->m_parser->SetLineReader( &reader );
-
-            std::string name = TO_UTF8( fullPath.GetName() );
-            MODULE*     footprint = (MODULE*) m_owner->m_parser->Parse();
-
-            // The footprint name is the file name without the extension.
-            footprint->SetFPID( FPID( fullPath.GetName() ) );
-            m_modules.insert( name, new FP_CACHE_ITEM( footprint, fullPath ) );
+            loadItem( wxFileName( m_lib_path.GetPath(), fpFileName ) );
 
         } while( dir.GetNext( &fpFileName ) );
 
@@ -315,6 +502,115 @@ void FP_CACHE::Load()
 }
 
 
+void FP_CACHE::loadItem( const wxFileName& aFullPath )
+{
+    MMAP_LINE_READER    reader( aFullPath.GetFullPath() );
+
+    m_owner->m_parser->SetLineReader( &reader );
+
+    std::string name = TO_UTF8( aFullPath.GetName() );
+
+    // The old version is not kept if the new one is not readable.
+    m_modules.erase( name );
+
+    MODULE*     footprint = (MODULE*) m_owner->m_parser->Parse();
+
+    // The footprint name is the file name without the extension.
+    footprint->SetFPID( FPID( aFullPath.GetName() ) );
+    m_modules.insert( name, new FP_CACHE_ITEM( footprint, aFullPath ) );
+}
+
+
+void FP_CACHE::Update( const wxString& aFootprintName )
+{
+    std::set<wxString>  changed;
+    bool                checkAll = true;
+
+    if( m_watcher.get() )
+        checkAll = m_watcher->GetChanges( &changed );
+    else    // e.g. a new library: watch it from now on.
+        m_watcher.reset( new FP_CACHE_WATCHER( m_lib_path.GetPath() ) );
+
+    if( checkAll )
+    {
+        wxLogTrace( traceFootprintLibrary, wxT( "Checking all the files of '%s'." ),
+                    GetChars( m_lib_path.GetPath() ) );
+
+        // The deleted files
+        for( MODULE_ITER it = m_modules.begin();  it != m_modules.end();  )
+        {
+            if( !it->second->GetFileName().FileExists() )
+                m_modules.erase( it++ );
+            else
+                ++it;
+        }
+
+        // The new and modified files are sorted out below.
+        wxDir dir( m_lib_path.GetPath() );
+
+        wxString fpFileName;
+        wxString wildcard = wxT( "*." ) + KiCadFootprintFileExtension;
+
+        if( dir.IsOpened() && dir.GetFirst( &fpFileName, wildcard, wxDIR_FILES ) )
+        {
+            do
+            {
+                changed.insert( wxFileName( fpFileName ).GetName() );
+            } while( dir.GetNext( &fpFileName ) );
+        }
+    }
+    else if( !aFootprintName.IsEmpty() )
+    {
+        changed.insert( aFootprintName );
+    }
+
+    // The changes are consumed from the watcher: a footprint which cannot be read must
+    // not stop the reload of the other ones.
+    wxString errorText;
+
+    for( std::set<wxString>::const_iterator name = changed.begin(); name != changed.end(); ++name )
+    {
+        wxFileName  fn( m_lib_path.GetPath(), *name, KiCadFootprintFileExtension );
+        MODULE_ITER it = m_modules.find( TO_UTF8( *name ) );
+
+        if( !fn.FileExists() )
+        {
+            if( it != m_modules.end() )
+                m_modules.erase( it );
+
+            continue;
+        }
+
+        if( it != m_modules.end() && !it->second->IsModified() )
+            continue;
+
+        wxLogTrace( traceFootprintLibrary, wxT( "Footprint cache file '%s' has been modified." ),
+                    GetChars( fn.GetFullPath() ) );
+
+        try
+        {
+            loadItem( fn );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            if( errorText.IsEmpty() )
+                errorText = ioe.errorText;
+        }
+    }
+
+    m_mod_time = GetLibModificationTime();
+
+    if( !errorText.IsEmpty() )
+    {
+        // The failed footprints are no longer reported as changed by the watcher:
+        // check all the files at the next update.
+        m_watcher.reset();
+
+        THROW_IO_ERROR( errorText );
+    }
+}
+
+
 void FP_CACHE::Remove( const wxString& aFootprintName )
 {
     std::string footprintName = TO_UTF8( aFootprintName );
@@ -348,52 +644,6 @@ bool FP_CACHE::IsPath( const wxString& aPath ) const
 }
 
 
-bool FP_CACHE::IsModified( const wxString& aLibPath, const wxString& aFootprintName ) const
-{
-    // The library is modified if the library path got deleted or changed.
-    if( !m_lib_path.DirExists() || !IsPath( aLibPath ) )
-        return true;
-
-    // If no footprint was specified, check every file modification time against the time
-    // it was loaded.
-    if( aFootprintName.IsEmpty() )
-    {
-        for( MODULE_CITER it = m_modules.begin();  it != m_modules.end();  ++it )
-        {
-            wxFileName fn = m_lib_path;
-
-            fn.SetName( it->second->GetFileName().GetName() );
-            fn.SetExt( KiCadFootprintFileExtension );
-
-            if( !fn.FileExists() )
-            {
-                wxLogTrace( traceFootprintLibrary,
-                            wxT( "Footprint cache file '%s' does not exist." ),
-                            fn.GetFullPath().GetData() );
-                return true;
-            }
-
-            if( it->second->IsModified() )
-            {
-                wxLogTrace( traceFootprintLibrary,
-                            wxT( "Footprint cache file '%s' has been modified." ),
-                            fn.GetFullPath().GetData() );
-                return true;
-            }
-        }
-    }
-    else
-    {
-        MODULE_CITER it = m_modules.find( TO_UTF8( aFootprintName ) );
-
-        if( it == m_modules.end() || it->second->IsModified() )
-            return true;
-    }
-
-    return false;
-}
-
-
 void PCB_IO::Save( const wxString& aFileName, BOARD* aBoard, const PROPERTIES* aProperties )
 {
     LOCALE_IO   toggle;     // toggles on, then off, the C locale.
@@ -405,16 +655,38 @@ void PCB_IO::Save( const wxString& aFileName, BOARD* aBoard, const PROPERTIES* a
     // Prepare net mapping that assures that net codes saved in a file are consecutive integers
     m_mapping->SetBoard( aBoard );
 
-    FILE_OUTPUTFORMATTER    formatter( aFileName );
+    std::string cacheText;
+
+    {
+        BOARD_CACHE_FORMATTER   formatter( aFileName );
 
-    m_out = &formatter;     // no ownership
+        m_out = &formatter;     // no ownership
+        m_cacheOut = &formatter;
 
-    m_out->Print( 0, "(kicad_pcb (version %d) (host pcbnew %s)\n", SEXPR_BOARD_FILE_VERSION,
-                  formatter.Quotew( GetBuildVersion() ).c_str() );
+        try
+        {
+            m_out->Print( 0, "(kicad_pcb (version %d) (host pcbnew %s)\n",
+                          SEXPR_BOARD_FILE_VERSION,
+                          formatter.Quotew( GetBuildVersion() ).c_str() );
 
-    Format( aBoard, 1 );
+            Format( aBoard, 1 );
 
-    m_out->Print( 0, ")\n" );
+            m_out->Print( 0, ")\n" );
+        }
+        catch( const IO_ERROR& )
+        {
+            m_out = &m_sf;
+            m_cacheOut = NULL;
+            throw;
+        }
+
+        m_cacheOut = NULL;
+        cacheText = formatter.GetCacheText();
+    }   // close the file before caching it
+
+    m_out = &m_sf;
+
+    saveBoardCache( aFileName, aBoard, cacheText );
 }
 
 
@@ -744,13 +1016,19 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
 
     // Do not save MARKER_PCBs, they can be regenerated easily.
 
-    // Save the tracks and vias.
+    // Save the tracks and vias.  They are stored in binary form in the board cache.
+    if( m_cacheOut )
+        m_cacheOut->Pause( true );
+
     for( TRACK* track = aBoard->m_Track;  track; track = track->Next() )
         Format( track, aNestLevel );
 
     if( aBoard->m_Track.GetCount() )
         m_out->Print( 0, "\n" );
 
+    if( m_cacheOut )
+        m_cacheOut->Pause( false );
+
     /// @todo Add warning here that the old segment filed zones are no longer supported and
     ///       will not be saved.
 
@@ -1622,6 +1900,10 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
     if( fv.GetCornersCount() )
     {
+        // The filled areas are stored in binary form in the board cache
+        if( m_cacheOut )
+            m_cacheOut->Pause( true );
+
         m_out->Print( aNestLevel+1, "(filled_polygon\n" );
         m_out->Print( aNestLevel+2, "(pts\n" );
 
@@ -1662,6 +1944,9 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         }
 
         m_out->Print( aNestLevel+1, ")\n" );
+
+        if( m_cacheOut )
+            m_cacheOut->Pause( false );
     }
 
     // Save the filling segments list
@@ -1688,6 +1973,7 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 PCB_IO::PCB_IO( int aControlFlags ) :
     m_cache( 0 ),
     m_ctl( aControlFlags ),
+    m_cacheOut( NULL ),
     m_parser( new PCB_PARSER() ),
     m_mapping( new NETINFO_MAPPING() )
 {
@@ -1706,17 +1992,30 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
-
     init( aProperties );
 
+    // A new board is read from its binary cache when it is up to date
+    if( !aAppendToMe )
+    {
+        BOARD* board = loadBoardCache( aFileName );
+
+        if( board )
+        {
+            board->SetFileName( aFileName );
+            return board;
+        }
+    }
+
+    MMAP_LINE_READER    reader( aFileName );
+
     m_parser->SetLineReader( &reader );
     m_parser->SetBoard( aAppendToMe );
 
     BOARD* board = dyn_cast<BOARD*>( m_parser->Parse() );
     wxASSERT( board );
 
-    // Give the filename to the board if it's new
+    // Give the filename to the board if it's new.  The cache is written only when the
+    // board is saved: writing it now would format the board again.
     if( !aAppendToMe )
         board->SetFileName( aFileName );
 
@@ -1735,20 +2034,25 @@ void PCB_IO::init( const PROPERTIES* aProperties )
 
 void PCB_IO::cacheLib( const wxString& aLibraryPath, const wxString& aFootprintName )
 {
-    if( !m_cache || m_cache->IsModified( aLibraryPath, aFootprintName ) )
+    // The library is reloaded if the library path got deleted or changed.
+    if( !m_cache || !m_cache->IsPath( aLibraryPath ) || !wxDirExists( aLibraryPath ) )
     {
         // a spectacular episode in memory management:
         delete m_cache;
         m_cache = new FP_CACHE( this, aLibraryPath );
         m_cache->Load();
     }
+    else
+    {
+        // Only the changed footprints are reloaded.
+        m_cache->Update( aFootprintName );
+    }
 }
 
 
 wxArrayString PCB_IO::FootprintEnumerate( const wxString&   aLibraryPath,
                                           const PROPERTIES* aProperties )
 {
-    LOCALE_IO     toggle;     // toggles on, then off, the C locale.
     wxArrayString ret;
     wxDir         dir( aLibraryPath );
 
@@ -1791,8 +2095,6 @@ wxArrayString PCB_IO::FootprintEnumerate( const wxString&   aLibraryPath,
 MODULE* PCB_IO::FootprintLoad( const wxString& aLibraryPath, const wxString& aFootprintName,
                                const PROPERTIES* aProperties )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     init( aProperties );
 
     cacheLib( aLibraryPath, aFootprintName );
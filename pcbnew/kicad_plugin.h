@@ -63,6 +63,41 @@ class NETINFO_MAPPING;
 #define CTL_FOR_BOARD               (CTL_OMIT_INITIAL_COMMENTS)
 
 
+/**
+ * Class BOARD_CACHE_FORMATTER
+ * writes a board file, and keeps a copy of its text without the parts written while
+ * paused, i.e. without the tracks and the zone filled areas, which are stored in
+ * binary form in the board cache.  So the board is formatted only once to save both.
+ */
+class BOARD_CACHE_FORMATTER : public FILE_OUTPUTFORMATTER
+{
+public:
+    BOARD_CACHE_FORMATTER( const wxString& aFileName ) throw( IO_ERROR ) :
+        FILE_OUTPUTFORMATTER( aFileName ),
+        m_paused( false )
+    {
+    }
+
+    void Pause( bool aPause )               { m_paused = aPause; }
+
+    /// @return the text written while not paused.
+    const std::string& GetCacheText() const { return m_cacheText; }
+
+protected:
+    void write( const char* aOutBuf, int aCount ) throw( IO_ERROR )
+    {
+        FILE_OUTPUTFORMATTER::write( aOutBuf, aCount );
+
+        if( !m_paused )
+            m_cacheText.append( aOutBuf, aCount );
+    }
+
+private:
+    std::string m_cacheText;
+    bool        m_paused;
+};
+
+
 class DIMENSION;
 class EDGE_MODULE;
 class DRAWSEGMENT;
@@ -172,6 +207,7 @@ protected:
     STRING_FORMATTER    m_sf;
     OUTPUTFORMATTER*    m_out;      ///< output any Format()s to this, no ownership
     int                 m_ctl;
+    BOARD_CACHE_FORMATTER* m_cacheOut;  ///< the board file being saved, or NULL
     PCB_PARSER*         m_parser;
     NETINFO_MAPPING*    m_mapping;  ///< mapping for net codes, so only not empty net codes
                                     ///< are stored with consecutive integers as net codes
@@ -181,6 +217,26 @@ protected:
 
     void init( const PROPERTIES* aProperties );
 
+    /**
+     * Function loadBoardCache
+     * loads the board file @a aFileName from its binary cache, written by saveBoardCache().
+     * @return BOARD* - the loaded board, or NULL if the cache does not exist, is not
+     *                  readable or does not match the current board file.
+     */
+    BOARD* loadBoardCache( const wxString& aFileName );
+
+    /**
+     * Function saveBoardCache
+     * writes the binary cache of @a aBoard, which was just saved to @a aFileName.
+     * The cache holds the board without its tracks, vias and zone filled areas in
+     * s-expression format, followed by these items in binary form.  Errors are
+     * ignored: the cache is only used to load big boards faster.
+     * @param aBoardText is the board file without its tracks, vias and zone filled
+     *  areas, see BOARD_CACHE_FORMATTER.
+     */
+    void saveBoardCache( const wxString& aFileName, BOARD* aBoard,
+                         const std::string& aBoardText );
+
 private:
     void format( BOARD* aBoard, int aNestLevel = 0 ) const
         throw( IO_ERROR );
@@ -1126,7 +1126,7 @@ void LEGACY_PLUGIN::loadSETUP()
 
         else if( TESTLINE( "Pad2PasteClearanceRatio" ) )
         {
-            double ratio = atof( line + SZ( "Pad2PasteClearanceRatio" ) );
+            double ratio = Strtod_C( line + SZ( "Pad2PasteClearanceRatio" ), NULL );
             bds.m_SolderPasteMarginRatio = ratio;
         }
 
@@ -1354,7 +1354,7 @@ void LEGACY_PLUGIN::loadMODULE( MODULE* aModule )
 
         else if( TESTLINE( ".SolderPasteRatio" ) )
         {
-            double tmp = atof( line + SZ( ".SolderPasteRatio" ) );
+            double tmp = Strtod_C( line + SZ( ".SolderPasteRatio" ), NULL );
             // Due to a bug in dialog editor in Modedit, fixed in BZR version 3565
             // this parameter can be broken.
             // It should be >= -50% (no solder paste) and <= 0% (full area of the pad)
@@ -1603,7 +1603,7 @@ void LEGACY_PLUGIN::loadPAD( MODULE* aModule )
 
         else if( TESTLINE( ".SolderPasteRatio" ) )
         {
-            double tmp = atof( line + SZ( ".SolderPasteRatio" ) );
+            double tmp = Strtod_C( line + SZ( ".SolderPasteRatio" ), NULL );
             pad->SetLocalSolderPasteMarginRatio( tmp );
         }
 
@@ -1937,26 +1937,29 @@ void LEGACY_PLUGIN::load3D( MODULE* aModule )
 
         else if( TESTLINE( "Sc" ) )     // Scale
         {
-            sscanf( line + SZ( "Sc" ), "%lf %lf %lf\n",
-                    &t3D->m_MatScale.x,
-                    &t3D->m_MatScale.y,
-                    &t3D->m_MatScale.z );
+            char* next;
+
+            t3D->m_MatScale.x = Strtod_C( line + SZ( "Sc" ), &next );
+            t3D->m_MatScale.y = Strtod_C( next, &next );
+            t3D->m_MatScale.z = Strtod_C( next, &next );
         }
 
         else if( TESTLINE( "Of" ) )     // Offset
         {
-            sscanf( line + SZ( "Of" ), "%lf %lf %lf\n",
-                    &t3D->m_MatPosition.x,
-                    &t3D->m_MatPosition.y,
-                    &t3D->m_MatPosition.z );
+            char* next;
+
+            t3D->m_MatPosition.x = Strtod_C( line + SZ( "Of" ), &next );
+            t3D->m_MatPosition.y = Strtod_C( next, &next );
+            t3D->m_MatPosition.z = Strtod_C( next, &next );
         }
 
         else if( TESTLINE( "Ro" ) )     // Rotation
         {
-            sscanf( line + SZ( "Ro" ), "%lf %lf %lf\n",
-                    &t3D->m_MatRotation.x,
-                    &t3D->m_MatRotation.y,
-                    &t3D->m_MatRotation.z );
+            char* next;
+
+            t3D->m_MatRotation.x = Strtod_C( line + SZ( "Ro" ), &next );
+            t3D->m_MatRotation.y = Strtod_C( next, &next );
+            t3D->m_MatRotation.z = Strtod_C( next, &next );
         }
 
         else if( TESTLINE( "$EndSHAPE3D" ) )
@@ -2989,7 +2992,7 @@ BIU LEGACY_PLUGIN::biuParse( const char* aValue, const char** nptrptr )
 
     errno = 0;
 
-    double fval = strtod( aValue, &nptr );
+    double fval = Strtod_C( aValue, &nptr );
 
     if( errno )
     {
@@ -3026,7 +3029,7 @@ double LEGACY_PLUGIN::degParse( const char* aValue, const char** nptrptr )
 
     errno = 0;
 
-    double fval = strtod( aValue, &nptr );
+    double fval = Strtod_C( aValue, &nptr );
 
     if( errno )
     {
@@ -4548,8 +4551,6 @@ void LEGACY_PLUGIN::cacheLib( const wxString& aLibraryPath )
 
 wxArrayString LEGACY_PLUGIN::FootprintEnumerate( const wxString& aLibraryPath, const PROPERTIES* aProperties )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     init( aProperties );
 
     cacheLib( aLibraryPath );
@@ -4570,8 +4571,6 @@ wxArrayString LEGACY_PLUGIN::FootprintEnumerate( const wxString& aLibraryPath, c
 MODULE* LEGACY_PLUGIN::FootprintLoad( const wxString& aLibraryPath,
         const wxString& aFootprintName, const PROPERTIES* aProperties )
 {
-    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
-
     init( aProperties );
 
     cacheLib( aLibraryPath );
@@ -28,8 +28,10 @@
  */
 
 #include <errno.h>
+#include <algorithm>
 #include <common.h>
 #include <confirm.h>
+#include <kicad_string.h>
 #include <macros.h>
 #include <convert_from_iu.h>
 #include <trigo.h>
@@ -54,6 +56,10 @@
 
 #include <boost/make_shared.hpp>
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 using namespace PCB_KEYS_T;
 
 
@@ -129,7 +135,7 @@ double PCB_PARSER::parseDouble() throw( IO_ERROR )
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    double fval = Strtod_C( CurText(), &tmp );
 
     if( errno )
     {
@@ -375,7 +381,6 @@ BOARD_ITEM* PCB_PARSER::Parse() throw( IO_ERROR, PARSE_ERROR )
 {
     T               token;
     BOARD_ITEM*     item;
-    LOCALE_IO       toggle;
 
     // MODULEs can be prefixed with an initial block of single line comments and these
     // are kept for Format() so they round trip in s-expression form.  BOARDs might
@@ -416,87 +421,406 @@ BOARD* PCB_PARSER::parseBOARD() throw( IO_ERROR, PARSE_ERROR )
 
     parseHeader();
 
+    if( mmapReader && parseBoardConcurrently() )
+        return m_board;
+
     for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
     {
         if( token != T_LEFT )
             Expecting( T_LEFT );
 
-        token = NextTok();
+        parseBoardSection( NextTok() );
+    }
 
-        switch( token )
+    return m_board;
+}
+
+
+void PCB_PARSER::parseBoardSection( T aToken ) throw( IO_ERROR, PARSE_ERROR )
+{
+    switch( aToken )
+    {
+    case T_general:
+        parseGeneralSection();
+        break;
+
+    case T_page:
+        parsePAGE_INFO();
+        break;
+
+    case T_title_block:
+        parseTITLE_BLOCK();
+        break;
+
+    case T_layers:
+        parseLayers();
+        break;
+
+    case T_setup:
+        parseSetup();
+        break;
+
+    case T_net:
+        parseNETINFO_ITEM();
+        break;
+
+    case T_net_class:
+        parseNETCLASS();
+        break;
+
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_line:
+    case T_gr_poly:
+        m_board->Add( parseDRAWSEGMENT(), ADD_APPEND );
+        break;
+
+    case T_gr_text:
+        m_board->Add( parseTEXTE_PCB(), ADD_APPEND );
+        break;
+
+    case T_dimension:
+        m_board->Add( parseDIMENSION(), ADD_APPEND );
+        break;
+
+    case T_module:
+        m_board->Add( parseMODULE(), ADD_APPEND );
+        break;
+
+    case T_segment:
+        m_board->Add( parseTRACK(), ADD_APPEND );
+        break;
+
+    case T_via:
+        m_board->Add( parseVIA(), ADD_APPEND );
+        break;
+
+    case T_zone:
+        m_board->Add( parseZONE_CONTAINER(), ADD_APPEND );
+        break;
+
+    case T_target:
+        m_board->Add( parsePCB_TARGET(), ADD_APPEND );
+        break;
+
+    default:
+        wxString err;
+        err.Printf( _( "unknown token \"%s\"" ), GetChars( FromUTF8() ) );
+        THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+    }
+}
+
+
+BOARD_ITEM* PCB_PARSER::parseBoardItem( T aToken, wxString* aZoneNetname )
+    throw( IO_ERROR, PARSE_ERROR )
+{
+    switch( aToken )
+    {
+    case T_module:
+        return parseMODULE();
+
+    case T_segment:
+        return parseTRACK();
+
+    case T_via:
+        return parseVIA();
+
+    case T_zone:
+        return parseZONE_CONTAINER( aZoneNetname );
+
+    default:
+        Expecting( "module, segment, via or zone" );
+        return NULL;
+    }
+}
+
+
+/**
+ * Struct TOP_LEVEL_ITEM
+ * locates the text of a top level item of a board file.
+ */
+struct TOP_LEVEL_ITEM
+{
+    const char* begin;          ///< the opening parenthesis
+    const char* end;            ///< after the closing parenthesis
+    unsigned    line;           ///< the line number of @a begin
+    bool        concurrent;     ///< true for the items parsed concurrently
+};
+
+
+static bool isSeparator( char cc )
+{
+    return isspace( (unsigned char) cc ) || cc == '(' || cc == ')';
+}
+
+
+/**
+ * Function isKeyword
+ * @return true if the token starting at @a aText is @a aKeyword.
+ */
+static bool isKeyword( const char* aText, const char* aEnd, const char* aKeyword )
+{
+    size_t len = strlen( aKeyword );
+
+    return aText + len < aEnd && !strncmp( aText, aKeyword, len ) && isSeparator( aText[len] );
+}
+
+
+/**
+ * Function scanBoardItems
+ * locates the top level items of a board between @a aBegin, which is after the
+ * board header, and the closing parenthesis of the board, without parsing them.
+ * Only the parentheses and the quoted strings are checked, as DSNLEXER reads them.
+ * @param aLine is the line number of @a aBegin.
+ * @return bool - false if the text does not have the expected structure.
+ */
+static bool scanBoardItems( const char* aBegin, const char* aEnd, unsigned aLine,
+                            std::vector<TOP_LEVEL_ITEM>& aItems )
+{
+    const char* cur = aBegin;
+
+    for( ;; )
+    {
+        while( cur < aEnd && isspace( (unsigned char) *cur ) )
         {
-        case T_general:
-            parseGeneralSection();
-            break;
+            if( *cur == '\n' )
+                ++aLine;
 
-        case T_page:
-            parsePAGE_INFO();
-            break;
+            ++cur;
+        }
 
-        case T_title_block:
-            parseTITLE_BLOCK();
-            break;
+        if( cur >= aEnd )
+            return false;   // the board is not terminated
 
-        case T_layers:
-            parseLayers();
-            break;
+        if( *cur == ')' )
+            return true;
 
-        case T_setup:
-            parseSetup();
-            break;
+        if( *cur != '(' )
+            return false;
 
-        case T_net:
-            parseNETINFO_ITEM();
-            break;
+        TOP_LEVEL_ITEM item;
 
-        case T_net_class:
-            parseNETCLASS();
-            break;
+        item.begin      = cur;
+        item.line       = aLine;
+        item.concurrent = isKeyword( cur + 1, aEnd, "module" )
+                          || isKeyword( cur + 1, aEnd, "segment" )
+                          || isKeyword( cur + 1, aEnd, "via" )
+                          || isKeyword( cur + 1, aEnd, "zone" );
 
-        case T_gr_arc:
-        case T_gr_circle:
-        case T_gr_curve:
-        case T_gr_line:
-        case T_gr_poly:
-            m_board->Add( parseDRAWSEGMENT(), ADD_APPEND );
-            break;
+        int depth = 0;
 
-        case T_gr_text:
-            m_board->Add( parseTEXTE_PCB(), ADD_APPEND );
-            break;
+        for( ; cur < aEnd; ++cur )
+        {
+            char cc = *cur;
 
-        case T_dimension:
-            m_board->Add( parseDIMENSION(), ADD_APPEND );
-            break;
+            if( cc == '\n' )
+                ++aLine;
+            else if( cc == '(' )
+                ++depth;
+            else if( cc == ')' )
+            {
+                if( --depth == 0 )
+                    break;
+            }
+            else if( cc == '"' && isSeparator( cur[-1] ) )
+            {
+                // A quoted string, which cannot span several lines.
+                for( ++cur; cur < aEnd && *cur != '"'; ++cur )
+                {
+                    if( *cur == '\n' )
+                        return false;
 
-        case T_module:
-            m_board->Add( parseMODULE(), ADD_APPEND );
-            break;
+                    if( *cur == '\\' && cur + 1 < aEnd && cur[1] != '\n' )
+                        ++cur;
+                }
 
-        case T_segment:
-            m_board->Add( parseTRACK(), ADD_APPEND );
-            break;
+                if( cur >= aEnd )
+                    return false;
+            }
+        }
 
-        case T_via:
-            m_board->Add( parseVIA(), ADD_APPEND );
-            break;
+        if( cur >= aEnd )
+            return false;
 
-        case T_zone:
-            m_board->Add( parseZONE_CONTAINER(), ADD_APPEND );
-            break;
+        item.end = ++cur;
+        aItems.push_back( item );
+    }
+}
 
-        case T_target:
-            m_board->Add( parsePCB_TARGET(), ADD_APPEND );
-            break;
 
-        default:
-            wxString err;
-            err.Printf( _( "unknown token \"%s\"" ), GetChars( FromUTF8() ) );
-            THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+bool PCB_PARSER::parseBoardConcurrently() throw( IO_ERROR, PARSE_ERROR )
+{
+    const MMAP_LINE_READER& file = *mmapReader;
+    const char* data = file.GetData();
+    const char* end  = data + file.GetSize();
+
+    // next is in the line buffer instead of the mapping if the header is
+    // on the last line of the file.
+    if( !data || next < data || next > end )
+        return false;
+
+    unsigned line = file.LineNumber() + std::count( start, next, '\n' );
+
+    std::vector<TOP_LEVEL_ITEM> items;
+
+    if( !scanBoardItems( next, end, line, items ) )
+        return false;
+
+    // Parse the sections first: they define the layers and the nets used by the items.
+    for( unsigned ii = 0; ii < items.size(); ++ii )
+    {
+        if( items[ii].concurrent )
+            continue;
+
+        MMAP_LINE_READER reader( file, items[ii].begin - data, items[ii].end - data,
+                                 items[ii].line - 1 );
+
+        PushReader( &reader );
+
+        try
+        {
+            NeedLEFT();
+            parseBoardSection( NextTok() );
+        }
+        catch( ... )
+        {
+            PopReader();
+            throw;
         }
+
+        PopReader();
     }
 
-    return m_board;
+    // Group the items in chunks of about the same size, to share them between threads.
+    const size_t CHUNK_SIZE = 64 * 1024;
+
+    std::vector<unsigned> chunks;       // index of the first item of each chunk
+    size_t chunkSize = CHUNK_SIZE;
+
+    for( unsigned ii = 0; ii < items.size(); ++ii )
+    {
+        if( !items[ii].concurrent )
+            continue;
+
+        if( chunkSize >= CHUNK_SIZE )
+        {
+            chunks.push_back( ii );
+            chunkSize = 0;
+        }
+
+        chunkSize += items[ii].end - items[ii].begin;
+    }
+
+    chunks.push_back( items.size() );
+
+    std::vector<BOARD_ITEM*>    parsed( items.size(), (BOARD_ITEM*) NULL );
+    std::vector<wxString>       zoneNetnames( items.size() );
+
+    std::auto_ptr<PARSE_ERROR>  parseError;
+    std::auto_ptr<IO_ERROR>     ioError;
+    volatile bool               failed = false;
+
+    int chunkCount = chunks.size() - 1;
+    int ii;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel private(ii)
+#endif /* USE_OPENMP */
+    {
+        PCB_PARSER parser;
+
+        parser.m_board        = m_board;
+        parser.m_layerIndices = m_layerIndices;
+        parser.m_layerMasks   = m_layerMasks;
+        parser.m_netCodes     = m_netCodes;
+
+#ifdef USE_OPENMP
+        #pragma omp for schedule(dynamic,1)
+#endif /* USE_OPENMP */
+        for( ii = 0; ii < chunkCount; ++ii )
+        {
+            if( failed )
+                continue;
+
+            try
+            {
+                for( unsigned jj = chunks[ii]; jj < chunks[ii + 1]; ++jj )
+                {
+                    if( !items[jj].concurrent )
+                        continue;
+
+                    MMAP_LINE_READER reader( file, items[jj].begin - data,
+                                             items[jj].end - data, items[jj].line - 1 );
+
+                    parser.PushReader( &reader );
+
+                    try
+                    {
+                        parser.NeedLEFT();
+                        parsed[jj] = parser.parseBoardItem( parser.NextTok(), &zoneNetnames[jj] );
+                    }
+                    catch( ... )
+                    {
+                        parser.PopReader();
+                        throw;
+                    }
+
+                    parser.PopReader();
+                }
+            }
+            catch( const PARSE_ERROR& error )
+            {
+#ifdef USE_OPENMP
+                #pragma omp critical (pcbParserError)
+#endif /* USE_OPENMP */
+                {
+                    if( !failed )
+                        parseError.reset( new PARSE_ERROR( error ) );
+
+                    failed = true;
+                }
+            }
+            catch( const IO_ERROR& error )
+            {
+#ifdef USE_OPENMP
+                #pragma omp critical (pcbParserError)
+#endif /* USE_OPENMP */
+                {
+                    if( !failed )
+                        ioError.reset( new IO_ERROR( error ) );
+
+                    failed = true;
+                }
+            }
+        }
+    } /* end of parallel section */
+
+    if( failed )
+    {
+        for( unsigned jj = 0; jj < parsed.size(); ++jj )
+            delete parsed[jj];
+
+        if( parseError.get() )
+            throw PARSE_ERROR( *parseError );
+
+        throw IO_ERROR( *ioError );
+    }
+
+    // Add the items in file order, so the board lists are the same as when
+    // parsing sequentially.
+    for( unsigned jj = 0; jj < items.size(); ++jj )
+    {
+        if( !parsed[jj] )
+            continue;
+
+        if( parsed[jj]->Type() == PCB_ZONE_AREA_T )
+            checkZoneNet( (ZONE_CONTAINER*) parsed[jj], zoneNetnames[jj] );
+
+        m_board->Add( parsed[jj], ADD_APPEND );
+    }
+
+    return true;
 }
 
 
@@ -2509,7 +2833,7 @@ VIA* PCB_PARSER::parseVIA() throw( IO_ERROR, PARSE_ERROR )
 }
 
 
-ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR )
+ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( wxString* aNetname ) throw( IO_ERROR, PARSE_ERROR )
 {
     wxCHECK_MSG( CurTok() == T_zone, NULL,
                  wxT( "Cannot parse " ) + GetTokenString( CurTok() ) +
@@ -2832,38 +3156,49 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR )
     if( !zone_has_net )
         zone->SetNetCode( NETINFO_LIST::UNCONNECTED );
 
+    if( aNetname )      // the caller checks the zone net itself
+        *aNetname = netnameFromfile;
+    else
+        checkZoneNet( zone.get(), netnameFromfile );
+
+    return zone.release();
+}
+
+
+void PCB_PARSER::checkZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetname )
+{
+    bool zone_has_net = aZone->IsOnCopperLayer() && !aZone->GetIsKeepout();
+
     // Ensure the zone net name is valid, and matches the net code, for copper zones
-    if( zone_has_net && ( zone->GetNet()->GetNetname() != netnameFromfile ) )
+    if( zone_has_net && ( aZone->GetNet()->GetNetname() != aNetname ) )
     {
         // Can happens which old boards, with nonexistent nets ...
         // or after being edited by hand
         // We try to fix the mismatch.
-        NETINFO_ITEM* net = m_board->FindNet( netnameFromfile );
+        NETINFO_ITEM* net = m_board->FindNet( aNetname );
 
         if( net )   // An existing net has the same net name. use it for the zone
-            zone->SetNetCode( net->GetNet() );
+            aZone->SetNetCode( net->GetNet() );
         else    // Not existing net: add a new net to keep trace of the zone netname
         {
             int newnetcode = m_board->GetNetCount();
-            net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
+            net = new NETINFO_ITEM( m_board, aNetname, newnetcode );
             m_board->AppendNet( net );
 
             // Store the new code mapping
             pushValueIntoMap( newnetcode, net->GetNet() );
             // and update the zone netcode
-            zone->SetNetCode( net->GetNet() );
+            aZone->SetNetCode( net->GetNet() );
 
             // Prompt the user
             wxString msg;
             msg.Printf( _( "There is a zone that belongs to a not existing net\n"
                            "\"%s\"\n"
                            "you should verify and edit it (run DRC test)." ),
-                           GetChars( netnameFromfile ) );
+                           GetChars( aNetname ) );
             DisplayError( NULL, msg );
         }
     }
-
-    return zone.release();
 }
 
 
@@ -123,10 +123,52 @@ class PCB_PARSER : public PCB_LEXER
     D_PAD*          parseD_PAD( MODULE* aParent = NULL ) throw( IO_ERROR, PARSE_ERROR );
     TRACK*          parseTRACK() throw( IO_ERROR, PARSE_ERROR );
     VIA*            parseVIA() throw( IO_ERROR, PARSE_ERROR );
-    ZONE_CONTAINER* parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR );
+
+    /**
+     * Function parseZONE_CONTAINER
+     * @param aNetname, if not NULL, is where to put the net name found in the file.  The
+     *  zone net is then not checked against it, see checkZoneNet().
+     */
+    ZONE_CONTAINER* parseZONE_CONTAINER( wxString* aNetname = NULL ) throw( IO_ERROR, PARSE_ERROR );
     PCB_TARGET*     parsePCB_TARGET() throw( IO_ERROR, PARSE_ERROR );
     BOARD*          parseBOARD() throw( IO_ERROR, PARSE_ERROR );
 
+    /**
+     * Function checkZoneNet
+     * fixes the net of a copper zone when its net code does not match the net
+     * name found in the file, creating the net if it does not exist.
+     */
+    void checkZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetname );
+
+    /**
+     * Function parseBoardSection
+     * parses a top level section or item of a board, after its keyword @a aToken,
+     * and adds it to the board.
+     */
+    void parseBoardSection( PCB_KEYS_T::T aToken ) throw( IO_ERROR, PARSE_ERROR );
+
+    /**
+     * Function parseBoardItem
+     * parses a module, track, via or zone of a board, after its keyword @a aToken.
+     * The board is not modified, so several parsers can do this concurrently.
+     * @param aZoneNetname is where to put the net name of a zone, see parseZONE_CONTAINER().
+     * @return BOARD_ITEM* - the item, not yet added to the board.
+     */
+    BOARD_ITEM* parseBoardItem( PCB_KEYS_T::T aToken, wxString* aZoneNetname )
+        throw( IO_ERROR, PARSE_ERROR );
+
+    /**
+     * Function parseBoardConcurrently
+     * parses the rest of a board read by a MMAP_LINE_READER in two passes: the top
+     * level items are located first, and then the modules, tracks, vias and zones
+     * are parsed concurrently by several parsers, and added to the board in file
+     * order.  The other items, which can change the parser state, are parsed by
+     * this parser before.
+     * @return bool - false if the board text could not be split in items, and must
+     *  be parsed sequentially.  Nothing has been parsed in this case.
+     */
+    bool parseBoardConcurrently() throw( IO_ERROR, PARSE_ERROR );
+
 
     /**
      * Function lookUpLayer
@@ -283,6 +325,13 @@ public:
     }
 
     BOARD_ITEM* Parse() throw( IO_ERROR, PARSE_ERROR );
+
+    /**
+     * Function GetNetCode
+     * @return the board net code of the net saved with the number @a aNetCode in the
+     *         last parsed board file.
+     */
+    int GetNetCode( int aNetCode )      { return getNetCode( aNetCode ); }
 };
 
 
@@ -28,6 +28,7 @@
 #include <layers_id_colors_and_visibility.h>
 #include <plot_common.h>
 #include <macros.h>
+#include <kicad_string.h>
 #include <convert_to_biu.h>
 
 
@@ -552,7 +553,7 @@ double PCB_PLOT_PARAMS_PARSER::parseDouble()
     if( token != T_NUMBER )
         Expecting( T_NUMBER );
 
-    double val = strtod( CurText(), NULL );
+    double val = Strtod_C( CurText(), NULL );
 
     return val;
 }
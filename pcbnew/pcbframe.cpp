@@ -300,6 +300,8 @@ BEGIN_EVENT_TABLE( PCB_EDIT_FRAME, PCB_BASE_FRAME )
                          PCB_EDIT_FRAME::OnUpdateMuWaveToolbar )
 
     EVT_COMMAND( wxID_ANY, LAYER_WIDGET::EVT_LAYER_COLOR_CHANGE, PCB_EDIT_FRAME::OnLayerColorChange )
+
+    EVT_TIMER( ID_INCREMENTAL_DRC_TIMER, PCB_EDIT_FRAME::onIncrementalDrcTimer )
 END_EVENT_TABLE()
 
 
@@ -321,6 +323,8 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
     m_RecordingMacros = -1;
     m_microWaveToolBar = NULL;
     m_useCmpFileForFpNames = true;
+    m_drc = NULL;                   // created after SetBoard()
+    m_incrementalDrcTimer = new wxTimer( this, ID_INCREMENTAL_DRC_TIMER );
 
     m_rotationAngle = 900;
 
@@ -463,6 +467,7 @@ PCB_EDIT_FRAME::~PCB_EDIT_FRAME()
     for( int i = 0; i < 10; i++ )
         m_Macros[i].m_Record.clear();
 
+    delete m_incrementalDrcTimer;
     delete m_drc;
 }
 
@@ -471,6 +476,13 @@ void PCB_EDIT_FRAME::SetBoard( BOARD* aBoard )
 {
     bool new_board = ( aBoard != m_Pcb );
 
+    // The markers of the incremental DRC belong to the previous board
+    if( new_board && m_drc )
+    {
+        m_incrementalDrcTimer->Stop();
+        m_drc->SetIncrementalTest( false );
+    }
+
     PCB_BASE_FRAME::SetBoard( aBoard );
 
     if( IsGalCanvasActive() )
@@ -930,11 +942,27 @@ void PCB_EDIT_FRAME::OnModify( )
 {
     PCB_BASE_FRAME::OnModify();
 
+    // Keep the DRC markers of the modified area up to date, once the current
+    // series of changes is done
+    if( m_drc->IsIncrementalTestEnabled() && !m_incrementalDrcTimer->IsRunning() )
+        m_incrementalDrcTimer->Start( 500, wxTIMER_ONE_SHOT );
+
     if( m_Draw3DFrame )
         m_Draw3DFrame->ReloadRequest();
 }
 
 
+void PCB_EDIT_FRAME::onIncrementalDrcTimer( wxTimerEvent& aEvent )
+{
+    m_drc->RunIncrementalTests();
+
+    if( IsGalCanvasActive() )
+        GetGalCanvas()->Refresh();
+    else
+        m_canvas->Refresh();
+}
+
+
 void PCB_EDIT_FRAME::SVG_Print( wxCommandEvent& event )
 {
     PCB_PLOT_PARAMS  tmp = GetPlotSettings();
@@ -391,6 +391,8 @@ enum pcbnew_ids
     ID_FOOTPRINT_WIZARD_SELECT_WIZARD,
     ID_FOOTPRINT_WIZARD_EXPORT_TO_BOARD,
 
+    ID_INCREMENTAL_DRC_TIMER,
+
     ID_PCBNEW_END_LIST
 };
 
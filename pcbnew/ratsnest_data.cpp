@@ -32,6 +32,7 @@
 #endif /* USE_OPENMP */
 
 #include <ratsnest_data.h>
+#include <disjoint_set.h>
 
 #include <class_board.h>
 #include <class_module.h>
@@ -165,10 +166,9 @@ static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
                 // Do a copy of edge, but make it RN_EDGE_MST. In contrary to RN_EDGE,
                 // RN_EDGE_MST saves both source and target node and does not require any other
                 // edges to exist for getting source/target nodes
-                RN_EDGE_MST_PTR newEdge = boost::make_shared<RN_EDGE_MST>( dt->GetSourceNode(),
-                                                                           dt->GetTargetNode(),
-                                                                           dt->GetWeight() );
-                mst->push_back( newEdge );
+                mst->push_back( boost::make_shared<RN_EDGE_MST>( dt->GetSourceNode(),
+                                                                 dt->GetTargetNode(),
+                                                                 dt->GetWeight() ) );
                 ++mstSize;
             }
             else
@@ -189,6 +189,41 @@ static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
 }
 
 
+///> Maximum number of changed nodes for which the ratsnest is updated locally,
+///> instead of being recomputed from scratch.
+static const unsigned int LOCAL_UPDATE_MAX_NODES = 64;
+
+///> Number of closest nodes a changed node is connected to, when updating locally.
+static const unsigned int LOCAL_UPDATE_NEIGHBOURS = 8;
+
+
+/**
+ * Function closestNodes()
+ * Finds the aCount nodes of aNodes closest to aNode (excluding aNode itself),
+ * in linear time.
+ */
+static void closestNodes( const RN_NODE_PTR& aNode, const std::vector<RN_NODE_PTR>& aNodes,
+                          unsigned int aCount, std::vector<RN_NODE_PTR>& aResult )
+{
+    std::vector<std::pair<uint64_t, unsigned int> > distances;
+    distances.reserve( aNodes.size() );
+
+    for( unsigned int i = 0; i < aNodes.size(); ++i )
+    {
+        if( aNodes[i] != aNode )
+            distances.push_back( std::make_pair( getDistance( aNode, aNodes[i] ), i ) );
+    }
+
+    aCount = std::min( aCount, (unsigned int) distances.size() );
+    std::nth_element( distances.begin(), distances.begin() + aCount, distances.end() );
+
+    aResult.clear();
+
+    for( unsigned int i = 0; i < aCount; ++i )
+        aResult.push_back( aNodes[distances[i].second] );
+}
+
+
 void RN_NET::validateEdge( RN_EDGE_MST_PTR& aEdge )
 {
     RN_NODE_PTR source = aEdge->GetSourceNode();
@@ -229,7 +264,7 @@ void RN_NET::validateEdge( RN_EDGE_MST_PTR& aEdge )
 
     // Replace an invalid edge with new, valid one
     if( !valid )
-        aEdge.reset( new RN_EDGE_MST( source, target ) );
+        aEdge = boost::make_shared<RN_EDGE_MST>( source, target );
 }
 
 
@@ -318,6 +353,15 @@ void RN_NET::clearNode( const RN_NODE_PTR& aNode )
     if( !m_rnEdges )
         return;
 
+    // Nodes linked to the removed node have to be connected again to the rest of the net
+    BOOST_FOREACH( const RN_EDGE_MST_PTR& edge, *m_rnEdges )
+    {
+        if( edge->GetSourceNode() == aNode )
+            m_changedNodes.push_back( edge->GetTargetNode() );
+        else if( edge->GetTargetNode() == aNode )
+            m_changedNodes.push_back( edge->GetSourceNode() );
+    }
+
     std::vector<RN_EDGE_MST_PTR>::iterator newEnd;
 
     // Remove all ratsnest edges for associated with the node
@@ -387,12 +431,127 @@ bool RN_POLY::HitTest( const RN_NODE_PTR& aNode ) const
 }
 
 
+bool RN_NET::updateLocal()
+{
+    const RN_LINKS::RN_NODE_SET& boardNodes = m_links.GetNodes();
+    const RN_LINKS::RN_EDGE_LIST& boardEdges = m_links.GetConnections();
+
+    if( m_fullUpdate || !m_rnEdges || boardNodes.size() <= 2
+            || m_changedNodes.size() > LOCAL_UPDATE_MAX_NODES )
+        return false;
+
+    // Nodes are identified by their index, stored in the tag during the computation
+    std::vector<RN_NODE_PTR> nodes( boardNodes.begin(), boardNodes.end() );
+
+    for( unsigned int i = 0; i < nodes.size(); ++i )
+        nodes[i]->SetTag( i );
+
+    // The existing connections are always part of the result
+    std::vector<RN_EDGE_PTR> edges( boardEdges.begin(), boardEdges.end() );
+
+    // The previous ratsnest edges may refer to nodes that were removed and added again
+    // at the same location, so use the current nodes (nodes are compared by coordinates)
+    BOOST_FOREACH( const RN_EDGE_MST_PTR& edge, *m_rnEdges )
+    {
+        RN_LINKS::RN_NODE_SET::const_iterator source = boardNodes.find( edge->GetSourceNode() );
+        RN_LINKS::RN_NODE_SET::const_iterator target = boardNodes.find( edge->GetTargetNode() );
+
+        if( source == boardNodes.end() || target == boardNodes.end() )
+            continue;
+
+        edges.push_back( boost::make_shared<RN_EDGE_MST>( *source, *target,
+                                                          getDistance( *source, *target ) ) );
+    }
+
+    // Changed nodes may be connected to their closest neighbours
+    std::vector<RN_NODE_PTR> closest;
+
+    BOOST_FOREACH( const RN_NODE_PTR& changed, m_changedNodes )
+    {
+        RN_LINKS::RN_NODE_SET::const_iterator node = boardNodes.find( changed );
+
+        if( node == boardNodes.end() )
+            continue;
+
+        closestNodes( *node, nodes, LOCAL_UPDATE_NEIGHBOURS, closest );
+
+        BOOST_FOREACH( const RN_NODE_PTR& neighbour, closest )
+        {
+            edges.push_back( boost::make_shared<RN_EDGE_MST>( *node, neighbour,
+                                                              getDistance( *node, neighbour ) ) );
+        }
+    }
+
+    // Kruskal algorithm, existing connections (weight == 0) come first
+    std::stable_sort( edges.begin(), edges.end(), sortWeight );
+
+    DISJOINT_SET forests( nodes.size() );
+    std::vector<int> tags;
+    unsigned int joined = 0;
+
+    std::vector<RN_EDGE_MST_PTR>* mst = new std::vector<RN_EDGE_MST_PTR>;
+
+    BOOST_FOREACH( const RN_EDGE_PTR& edge, edges )
+    {
+        // Once all connections are processed, nodes in the same forest are connected
+        // with copper, so they share the same tag
+        if( tags.empty() && edge->GetWeight() != 0 )
+        {
+            tags.resize( nodes.size() );
+
+            for( unsigned int i = 0; i < nodes.size(); ++i )
+                tags[i] = forests.Find( i );
+        }
+
+        int source = edge->GetSourceNode()->GetTag();
+        int target = edge->GetTargetNode()->GetTag();
+
+        if( forests.Find( source ) == forests.Find( target ) )
+            continue;
+
+        forests.Union( source, target );
+        ++joined;
+
+        if( edge->GetWeight() != 0 )
+        {
+            mst->push_back( boost::make_shared<RN_EDGE_MST>( edge->GetSourceNode(),
+                                                             edge->GetTargetNode(),
+                                                             edge->GetWeight() ) );
+        }
+
+        if( joined == nodes.size() - 1 )
+            break;
+    }
+
+    // The candidate edges did not link all the parts of the net
+    if( joined != nodes.size() - 1 )
+    {
+        delete mst;
+        return false;
+    }
+
+    if( tags.empty() )      // everything is connected with copper
+        tags.assign( nodes.size(), forests.Find( 0 ) );
+
+    for( unsigned int i = 0; i < nodes.size(); ++i )
+        nodes[i]->SetTag( tags[i] );
+
+    m_rnEdges.reset( mst );
+
+    return true;
+}
+
+
 void RN_NET::Update()
 {
     // Add edges resulting from nodes being connected by zones
     processZones();
 
-    compute();
+    if( !updateLocal() )
+        compute();
+
+    m_changedNodes.clear();
+    m_fullUpdate = false;
 
     BOOST_FOREACH( RN_EDGE_MST_PTR& edge, *m_rnEdges )
         validateEdge( edge );
@@ -404,6 +563,7 @@ void RN_NET::Update()
 void RN_NET::AddItem( const D_PAD* aPad )
 {
     m_pads[aPad] = m_links.AddNode( aPad->GetPosition().x, aPad->GetPosition().y );
+    m_changedNodes.push_back( m_pads[aPad] );
 
     m_dirty = true;
 }
@@ -412,6 +572,7 @@ void RN_NET::AddItem( const D_PAD* aPad )
 void RN_NET::AddItem( const VIA* aVia )
 {
     m_vias[aVia] = m_links.AddNode( aVia->GetPosition().x, aVia->GetPosition().y );
+    m_changedNodes.push_back( m_vias[aVia] );
 
     m_dirty = true;
 }
@@ -423,6 +584,8 @@ void RN_NET::AddItem( const TRACK* aTrack )
     RN_NODE_PTR end = m_links.AddNode( aTrack->GetEnd().x, aTrack->GetEnd().y );
 
     m_tracks[aTrack] = m_links.AddConnection( start, end );
+    m_changedNodes.push_back( start );
+    m_changedNodes.push_back( end );
 
     m_dirty = true;
 }
@@ -475,6 +638,8 @@ void RN_NET::AddItem( const ZONE_CONTAINER* aZone )
         }
     }
 
+    // Zones change the connections of many nodes at once
+    m_fullUpdate = true;
     m_dirty = true;
 }
 
@@ -487,6 +652,8 @@ void RN_NET::RemoveItem( const D_PAD* aPad )
 
         if( m_links.RemoveNode( node ) )
             clearNode( node );
+        else
+            m_changedNodes.push_back( node );
 
         m_pads.erase( aPad );
 
@@ -506,6 +673,8 @@ void RN_NET::RemoveItem( const VIA* aVia )
 
         if( m_links.RemoveNode( node ) )
             clearNode( node );
+        else
+            m_changedNodes.push_back( node );
 
         m_vias.erase( aVia );
 
@@ -532,9 +701,13 @@ void RN_NET::RemoveItem( const TRACK* aTrack )
         // if nodes are not used by other edges.
         if( m_links.RemoveNode( aBegin ) )
             clearNode( aBegin );
+        else
+            m_changedNodes.push_back( aBegin );     // the connection may have split a cluster
 
         if( m_links.RemoveNode( aEnd ) )
             clearNode( aEnd );
+        else
+            m_changedNodes.push_back( aEnd );
 
         m_tracks.erase( aTrack );
 
@@ -563,10 +736,11 @@ void RN_NET::RemoveItem( const ZONE_CONTAINER* aZone )
 
         // Remove all connections added by the zone
         std::deque<RN_EDGE_MST_PTR>& edges = m_zoneConnections.at( aZone );
-        BOOST_FOREACH( RN_EDGE_PTR edge, edges )
+        BOOST_FOREACH( const RN_EDGE_PTR& edge, edges )
             m_links.RemoveConnection( edge );
         edges.clear();
 
+        m_fullUpdate = true;
         m_dirty = true;
     }
     catch( ... )
@@ -841,7 +1015,7 @@ void RN_DATA::AddSimple( const BOARD_ITEM* aItem )
             return;
 
         // Add all nodes belonging to the item
-        BOOST_FOREACH( RN_NODE_PTR node, m_nets[net].GetNodes( item ) )
+        BOOST_FOREACH( const RN_NODE_PTR& node, m_nets[net].GetNodes( item ) )
             m_nets[net].AddSimpleNode( node );
     }
     else if( aItem->Type() == PCB_MODULE_T )
@@ -871,7 +1045,7 @@ void RN_DATA::AddBlocked( const BOARD_ITEM* aItem )
             return;
 
         // Block all nodes belonging to the item
-        BOOST_FOREACH( RN_NODE_PTR node, m_nets[net].GetNodes( item ) )
+        BOOST_FOREACH( const RN_NODE_PTR& node, m_nets[net].GetNodes( item ) )
             m_nets[net].AddBlockedNode( node );
     }
     else if( aItem->Type() == PCB_MODULE_T )
@@ -892,9 +1066,9 @@ void RN_DATA::AddSimple( const VECTOR2I& aPosition, int aNetCode )
 {
     assert( aNetCode > 0 );
 
-    RN_NODE_PTR newNode = boost::make_shared<RN_NODE>( aPosition.x, aPosition.y );
+    RN_NODE_PTR node = boost::make_shared<RN_NODE>( aPosition.x, aPosition.y );
 
-    m_nets[aNetCode].AddSimpleNode( newNode );
+    m_nets[aNetCode].AddSimpleNode( node );
 }
 
 
@@ -949,7 +1123,7 @@ void RN_NET::processZones()
 {
     BOOST_FOREACH( std::deque<RN_EDGE_MST_PTR>& edges, m_zoneConnections | boost::adaptors::map_values )
     {
-        BOOST_FOREACH( RN_EDGE_MST_PTR edge, edges )
+        BOOST_FOREACH( const RN_EDGE_MST_PTR& edge, edges )
             m_links.RemoveConnection( edge );
 
         edges.clear();
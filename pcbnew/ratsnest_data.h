@@ -267,7 +267,7 @@ class RN_NET
 {
 public:
     ///> Default constructor.
-    RN_NET() : m_dirty( true ), m_visible( true )
+    RN_NET() : m_dirty( true ), m_fullUpdate( true ), m_visible( true )
     {}
 
     /**
@@ -324,6 +324,9 @@ public:
     /**
      * Function Update()
      * Recomputes ratsnest for a net.
+     * When only a few nodes were changed since the previous update, the new ratsnest is
+     * computed from the previous one and the edges joining the changed nodes to their
+     * closest neighbours, without triangulating the whole net again.
      */
     void Update();
 
@@ -511,6 +514,15 @@ protected:
     ///> Recomputes ratsnset from scratch.
     void compute();
 
+    /**
+     * Function updateLocal()
+     * Recomputes ratsnest from the previous ratsnest edges, the existing connections and
+     * edges joining the nodes changed since the last update to their closest nodes.
+     * @return false if the changes are too large to be handled locally, or if the result does
+     * not span the whole net; compute() has to be used in that case.
+     */
+    bool updateLocal();
+
     ////> Stores information about connections for a given net.
     RN_LINKS m_links;
 
@@ -526,6 +538,13 @@ protected:
     ///> Flag indicating necessity of recalculation of ratsnest for a net.
     bool m_dirty;
 
+    ///> Flag indicating that the ratsnest has to be recomputed from scratch, instead of
+    ///> being updated using the list of changed nodes.
+    bool m_fullUpdate;
+
+    ///> Nodes added, or that lost a connection or a ratsnest edge, since the last update.
+    std::vector<RN_NODE_PTR> m_changedNodes;
+
     ///> Helper typedefs
     typedef boost::unordered_map<const D_PAD*, RN_NODE_PTR> PAD_NODE_MAP;
     typedef boost::unordered_map<const VIA*, RN_NODE_PTR> VIA_NODE_MAP;
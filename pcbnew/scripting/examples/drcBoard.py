@@ -0,0 +1,23 @@
+#!/usr/bin/env python
+#
+# Runs the DRC on a board without user interface, e.g. from a build farm:
+#   drcBoard.py board.kicad_pcb [report.json]
+# The exit code is 0 if the board passed the DRC, 1 otherwise.
+import sys
+from pcbnew import *
+
+filename = sys.argv[1]
+
+if len(sys.argv) > 2:
+    report = sys.argv[2]
+else:
+    report = ""
+
+pcb = LoadBoard(filename)
+
+passed = RunDRC(pcb, report)
+
+print "%s: %d DRC markers, %s" % (filename, pcb.GetMARKERCount(),
+                                  "passed" if passed else "FAILED")
+
+sys.exit(0 if passed else 1)
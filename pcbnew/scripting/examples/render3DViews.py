@@ -0,0 +1,26 @@
+#!/usr/bin/env python
+#
+# Renders the 3D views of a board without user interface nor display server,
+# e.g. from a build farm (KiCad must be built with KICAD_3D_OFFSCREEN):
+#   render3DViews.py board.kicad_pcb prefix [width height]
+# writes prefix-top.png, prefix-bottom.png and prefix-iso.png.
+import sys
+from pcbnew import *
+
+filename = sys.argv[1]
+prefix = sys.argv[2]
+
+if len(sys.argv) > 4:
+    width = int(sys.argv[3])
+    height = int(sys.argv[4])
+else:
+    width = 1024
+    height = 768
+
+pcb = LoadBoard(filename)
+
+if not Render3DViews(pcb, prefix, width, height):
+    print "%s: cannot render the 3D views" % filename
+    sys.exit(1)
+
+print "%s: 3D views written to %s-*.png" % (filename, prefix)
@@ -36,6 +36,10 @@
 #include <class_board.h>
 #include <kicad_string.h>
 #include <io_mgr.h>
+#include <drc_stuff.h>
+#if defined( KICAD_3D_OFFSCREEN )
+#include <3d_offscreen.h>
+#endif
 #include <macros.h>
 #include <stdlib.h>
 
@@ -107,3 +111,60 @@ bool SaveBoard( wxString& aFileName, BOARD* aBoard,
 #endif
     return true;
 }
+
+
+bool RunDRC( BOARD* aBoard, wxString& aReportFileName )
+{
+    DRC drc( aBoard );
+
+    bool ok = drc.RunBatchTests();
+
+    if( !aReportFileName.IsEmpty() )
+        drc.WriteJsonReport( aReportFileName );
+
+    return ok;
+}
+
+
+bool Render3DViews( BOARD* aBoard, wxString& aFileNamePrefix, int aWidth, int aHeight )
+{
+#if defined( KICAD_3D_OFFSCREEN )
+    EDA_3D_OFFSCREEN renderer( aBoard );
+
+    if( !renderer.Init( wxSize( aWidth, aHeight ) ) )
+        return false;
+
+    static const struct
+    {
+        EDA_3D_OFFSCREEN::VIEW3D    view;
+        const wxChar*               suffix;
+    } views[] =
+    {
+        { EDA_3D_OFFSCREEN::VIEW3D_TOP,     wxT( "-top.png" ) },
+        { EDA_3D_OFFSCREEN::VIEW3D_BOTTOM,  wxT( "-bottom.png" ) },
+        { EDA_3D_OFFSCREEN::VIEW3D_ISO,     wxT( "-iso.png" ) }
+    };
+
+    wxString    errorMessages;
+    bool        ok = true;
+
+    for( unsigned ii = 0; ii < DIM( views ); ii++ )
+    {
+        wxString fileName = aFileNamePrefix + views[ii].suffix;
+
+        if( !renderer.RenderView( views[ii].view, fileName, &errorMessages ) )
+        {
+            wxLogError( wxT( "Render3DViews: cannot write %s" ), GetChars( fileName ) );
+            ok = false;
+        }
+    }
+
+    if( !errorMessages.IsEmpty() )
+        wxLogMessage( errorMessages );
+
+    return ok;
+#else
+    wxLogError( wxT( "Render3DViews: KiCad was built without KICAD_3D_OFFSCREEN" ) );
+    return false;
+#endif
+}
@@ -43,5 +43,31 @@ BOARD*  LoadBoard( wxString& aFileName );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard, IO_MGR::PCB_FILE_T aFormat );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard );
 
+/**
+ * Function RunDRC
+ * runs all the DRC tests on aBoard without user interface, and adds the
+ * DRC markers to aBoard.
+ * @param aBoard is the board to test.
+ * @param aReportFileName is the name of the JSON report to write (with the
+ *  violations, unconnected items and time spent in each test), or empty for no report.
+ * @return true if no DRC error and no unconnected item was found.
+ */
+bool    RunDRC( BOARD* aBoard, wxString& aReportFileName );
+
+/**
+ * Function Render3DViews
+ * renders the 3D view of aBoard seen from the top, the bottom and the front left
+ * corner, without user interface nor display server, and saves them in
+ * <aFileNamePrefix>-top.png, <aFileNamePrefix>-bottom.png and <aFileNamePrefix>-iso.png.
+ * The 3D scene is built only once for the three views.
+ * Needs the option KICAD_3D_OFFSCREEN, always fails without it.
+ * @param aBoard is the board to render.
+ * @param aFileNamePrefix is the path and the beginning of the names of the png files.
+ * @param aWidth is the width of the images, in pixels.
+ * @param aHeight is the height of the images, in pixels.
+ * @return true if the three files are written.
+ */
+bool    Render3DViews( BOARD* aBoard, wxString& aFileNamePrefix, int aWidth, int aHeight );
+
 
 #endif
@@ -402,14 +402,16 @@ int PCB_EDITOR_CONTROL::ZoneFill( const TOOL_EVENT& aEvent )
 int PCB_EDITOR_CONTROL::ZoneFillAll( const TOOL_EVENT& aEvent )
 {
     BOARD* board = getModel<BOARD>();
+    int refilledCount = 0;
+
+    // Up to date zones are not filled again, and do not modify the board
+    board->FillAllZones( NULL, false, NULL, &refilledCount );
+
+    if( refilledCount )
+        m_frame->OnModify();
 
     for( int i = 0; i < board->GetAreaCount(); ++i )
-    {
-        ZONE_CONTAINER* zone = board->GetArea( i );
-        m_frame->Fill_Zone( zone );
-        zone->SetIsFilled( true );
-        zone->ViewUpdate();
-    }
+        board->GetArea( i )->ViewUpdate();
 
     setTransitions();
 
@@ -0,0 +1,121 @@
+/**
+ * @file zone_fill_context.cpp
+ * @brief Data shared by the fills of the zones of a board.
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_pad.h>
+
+#include <zone_fill_context.h>
+
+
+ZONE_FILL_CONTEXT::ZONE_FILL_CONTEXT( BOARD* aBoard ) :
+    m_maxThermalGap( 0 )
+{
+    m_index.Build( aBoard );
+
+    for( int ii = 0; ii < m_index.GetPadCount(); ++ii )
+        m_maxThermalGap = std::max( m_maxThermalGap, m_index.GetPad( ii )->GetThermalGap() );
+}
+
+
+void ZONE_FILL_CONTEXT::QueryPads( const EDA_RECT& aArea, std::vector<D_PAD*>& aResult )
+{
+    std::vector<int> candidates;
+
+    m_index.QueryPads( aArea, candidates );
+
+    aResult.clear();
+    aResult.reserve( candidates.size() );
+
+    for( unsigned ii = 0; ii < candidates.size(); ++ii )
+        aResult.push_back( m_index.GetPad( candidates[ii] ) );
+}
+
+
+void ZONE_FILL_CONTEXT::QueryTracks( const EDA_RECT& aArea, LAYER_ID aLayer,
+                                     std::vector<TRACK*>& aResult )
+{
+    std::vector<int> candidates;
+
+    m_index.QueryTracks( aArea, LSET( aLayer ), -1, candidates );
+
+    aResult.clear();
+    aResult.reserve( candidates.size() );
+
+    for( unsigned ii = 0; ii < candidates.size(); ++ii )
+        aResult.push_back( m_index.GetTrack( candidates[ii] ) );
+}
+
+
+void ZONE_FILL_CONTEXT::AddPadClearancePolygon( CPOLYGONS_LIST& aCornerBuffer, D_PAD* aPad,
+                                                int aClearance, int aCircleToSegmentsCount,
+                                                double aCorrectionFactor )
+{
+    PAD_POLYGON_KEY key;
+
+    key.m_pad = aPad;
+    key.m_clearance = aClearance;
+    key.m_segmentCount = aCircleToSegmentsCount;
+
+    bool found = false;
+
+    // Zones sharing this context can be filled by several threads
+#ifdef USE_OPENMP
+    #pragma omp critical (zoneFillPadPolygons)
+#endif
+    {
+        std::map<PAD_POLYGON_KEY, CPOLYGONS_LIST>::const_iterator it = m_padPolygons.find( key );
+
+        if( it != m_padPolygons.end() )
+        {
+            aCornerBuffer.Append( it->second );
+            found = true;
+        }
+    }
+
+    if( found )
+        return;
+
+    // Convert the pad outside of the critical section: two threads may convert the same pad,
+    // which only wastes a little time.
+    CPOLYGONS_LIST polygon;
+
+    aPad->TransformShapeWithClearanceToPolygon( polygon, aClearance,
+                                                aCircleToSegmentsCount, aCorrectionFactor );
+    aCornerBuffer.Append( polygon );
+
+#ifdef USE_OPENMP
+    #pragma omp critical (zoneFillPadPolygons)
+#endif
+    {
+        m_padPolygons.insert( std::make_pair( key, polygon ) );
+    }
+}
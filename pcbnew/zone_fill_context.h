@@ -0,0 +1,120 @@
+/**
+ * @file zone_fill_context.h
+ */
+
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef _ZONE_FILL_CONTEXT_H
+#define _ZONE_FILL_CONTEXT_H
+
+#include <vector>
+#include <map>
+
+#include <PolyLine.h>
+#include <drc_spatial_index.h>
+
+class BOARD;
+
+
+/**
+ * Class ZONE_FILL_CONTEXT
+ * holds the data shared by the fills of all the zones of a board:
+ * - a spatial index of the tracks and pads, so a zone fill only looks at the items
+ *   near the zone, instead of walking the whole board lists.
+ * - a cache of the pad clearance polygons, so a pad covered by several zones
+ *   (zones on several layers, or overlapping zones) is converted only once.
+ * The board items must not be modified while the context is used.
+ * Zones using the same context can be filled concurrently.
+ */
+class ZONE_FILL_CONTEXT
+{
+public:
+    ZONE_FILL_CONTEXT( BOARD* aBoard );
+
+    /**
+     * Function QueryPads
+     * collects the pads whose shape or hole may intersect aArea, on any layer.
+     * @param aArea is the area to search in.
+     * @param aResult receives the pads, in board pad list order.
+     */
+    void QueryPads( const EDA_RECT& aArea, std::vector<D_PAD*>& aResult );
+
+    /**
+     * Function QueryTracks
+     * collects the tracks and vias on aLayer which may intersect aArea.
+     * @param aArea is the area to search in.
+     * @param aLayer is the copper layer of the zone.
+     * @param aResult receives the tracks, in board track list order.
+     */
+    void QueryTracks( const EDA_RECT& aArea, LAYER_ID aLayer, std::vector<TRACK*>& aResult );
+
+    /**
+     * Function GetMaxClearance
+     * @return the largest clearance of the tracks and pads of the board.
+     */
+    int GetMaxClearance() const             { return m_index.GetMaxClearance(); }
+
+    /**
+     * Function GetMaxThermalGap
+     * @return the largest thermal relief gap defined by a pad or footprint of the board.
+     */
+    int GetMaxThermalGap() const            { return m_maxThermalGap; }
+
+    /**
+     * Function AddPadClearancePolygon
+     * appends to aCornerBuffer the polygon of the shape of aPad inflated by aClearance,
+     * i.e. the result of D_PAD::TransformShapeWithClearanceToPolygon(), computed only
+     * once for given parameters.
+     */
+    void AddPadClearancePolygon( CPOLYGONS_LIST& aCornerBuffer, D_PAD* aPad, int aClearance,
+                                 int aCircleToSegmentsCount, double aCorrectionFactor );
+
+private:
+    ///> Parameters of a pad clearance polygon
+    struct PAD_POLYGON_KEY
+    {
+        const D_PAD*    m_pad;
+        int             m_clearance;
+        int             m_segmentCount;     ///< the correction factor depends only on it
+
+        bool operator<( const PAD_POLYGON_KEY& aOther ) const
+        {
+            if( m_pad != aOther.m_pad )
+                return m_pad < aOther.m_pad;
+
+            if( m_clearance != aOther.m_clearance )
+                return m_clearance < aOther.m_clearance;
+
+            return m_segmentCount < aOther.m_segmentCount;
+        }
+    };
+
+    DRC_SPATIAL_INDEX                           m_index;
+    int                                         m_maxThermalGap;
+
+    std::map<PAD_POLYGON_KEY, CPOLYGONS_LIST>   m_padPolygons;
+};
+
+
+#endif  // _ZONE_FILL_CONTEXT_H
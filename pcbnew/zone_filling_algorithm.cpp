@@ -28,12 +28,25 @@
 
 
 #include <algorithm> // sort
+#include <boost/functional/hash.hpp>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
 
 #include <fctsys.h>
 #include <trigo.h>
 #include <wxPcbStruct.h>
-
+#include <wx/progdlg.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_track.h>
+#include <class_edge_mod.h>
+#include <class_drawsegment.h>
+#include <class_pcb_text.h>
 #include <class_zone.h>
+#include <zone_fill_context.h>
 
 #include <pcbnew.h>
 #include <zones.h>
@@ -54,7 +67,8 @@
  * to add holes for pads and tracks and other items not in net.
  */
 
-bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST* aOutlineBuffer )
+bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST* aOutlineBuffer,
+                                                    ZONE_FILL_CONTEXT* aContext )
 {
     /* convert outlines + holes to outlines without holes (adding extra segments if necessary)
      * m_Poly data is expected normalized, i.e. NormalizeAreaOutlines was used after building
@@ -65,53 +79,57 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, CPOLYGONS_LIST*
         return 0;
 
     // Make a smoothed polygon out of the user-drawn polygon if required
-    if( m_smoothedPoly )
-    {
-        delete m_smoothedPoly;
-        m_smoothedPoly = NULL;
-    }
+    CPolyLine* smoothedPoly;
 
     switch( m_cornerSmoothingType )
     {
     case ZONE_SETTINGS::SMOOTHING_CHAMFER:
-        m_smoothedPoly = m_Poly->Chamfer( m_cornerRadius );
+        smoothedPoly = m_Poly->Chamfer( m_cornerRadius );
         break;
 
     case ZONE_SETTINGS::SMOOTHING_FILLET:
-        m_smoothedPoly = m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
+        smoothedPoly = m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
         break;
 
     default:
-        m_smoothedPoly = new CPolyLine;
-        m_smoothedPoly->Copy( m_Poly );
+        smoothedPoly = new CPolyLine;
+        smoothedPoly->Copy( m_Poly );
         break;
     }
 
+    // When only the outline is wanted, the zone itself is left unchanged, because
+    // the outline of a zone can be used while this zone is filled by another thread
+    // (see BOARD::FillAllZones())
     if( aOutlineBuffer )
-        aOutlineBuffer->Append( m_smoothedPoly->m_CornersList );
+    {
+        aOutlineBuffer->Append( smoothedPoly->m_CornersList );
+        delete smoothedPoly;
+
+        return true;
+    }
+
+    delete m_smoothedPoly;
+    m_smoothedPoly = smoothedPoly;
 
     /* For copper layers, we now must add holes in the Polygon list.
      * holes are pads and tracks with their clearance area
      * for non copper layers just recalculate the m_FilledPolysList
      * with m_ZoneMinThickness taken in account
      */
+    m_FilledPolysList.RemoveAllContours();
+
+    if( IsOnCopperLayer() )
+        AddClearanceAreasPolygonsToPolysList( aPcb, aContext );
     else
     {
-        m_FilledPolysList.RemoveAllContours();
-
-        if( IsOnCopperLayer() )
-            AddClearanceAreasPolygonsToPolysList( aPcb );
-        else
-        {
-            int         margin = m_ZoneMinThickness / 2;
-            m_smoothedPoly->m_CornersList.InflateOutline(m_FilledPolysList, -margin, true );
-        }
+        int         margin = m_ZoneMinThickness / 2;
+        m_smoothedPoly->m_CornersList.InflateOutline(m_FilledPolysList, -margin, true );
+    }
 
-        if( m_FillMode )   // if fill mode uses segments, create them:
-            FillZoneAreasWithSegments();
+    if( m_FillMode )   // if fill mode uses segments, create them:
+        FillZoneAreasWithSegments();
 
-        m_IsFilled = true;
-    }
+    m_IsFilled = true;
 
     return true;
 }
@@ -254,3 +272,340 @@ int ZONE_CONTAINER::FillZoneAreasWithSegments()
 }
 
 
+static void hashPoint( size_t& aSeed, const wxPoint& aPoint )
+{
+    boost::hash_combine( aSeed, aPoint.x );
+    boost::hash_combine( aSeed, aPoint.y );
+}
+
+
+static void hashSize( size_t& aSeed, const wxSize& aSize )
+{
+    boost::hash_combine( aSeed, aSize.x );
+    boost::hash_combine( aSeed, aSize.y );
+}
+
+
+static void hashRect( size_t& aSeed, const EDA_RECT& aRect )
+{
+    hashPoint( aSeed, aRect.GetOrigin() );
+    hashPoint( aSeed, aRect.GetEnd() );
+}
+
+
+/**
+ * Function hashNetname
+ * hashes the net name of aItem rather than its net code, because the net codes
+ * are renumbered when the board is saved and loaded again.
+ */
+static void hashNetname( size_t& aSeed, const BOARD_CONNECTED_ITEM* aItem )
+{
+    const wxString& netname = aItem->GetNetname();
+
+    for( wxString::const_iterator it = netname.begin(); it != netname.end(); ++it )
+        boost::hash_combine( aSeed, (*it).GetValue() );
+}
+
+
+static void hashCorners( size_t& aSeed, const CPOLYGONS_LIST& aCorners )
+{
+    for( unsigned ic = 0; ic < aCorners.GetCornersCount(); ic++ )
+    {
+        hashPoint( aSeed, aCorners.GetPos( ic ) );
+        boost::hash_combine( aSeed, aCorners.IsEndContour( ic ) );
+    }
+}
+
+
+static void hashDrawSegment( size_t& aSeed, const DRAWSEGMENT* aSegment )
+{
+    boost::hash_combine( aSeed, (int) aSegment->GetShape() );
+    boost::hash_combine( aSeed, (int) aSegment->GetLayer() );
+    hashPoint( aSeed, aSegment->GetStart() );
+    hashPoint( aSeed, aSegment->GetEnd() );
+    boost::hash_combine( aSeed, aSegment->GetWidth() );
+    boost::hash_combine( aSeed, aSegment->GetAngle() );
+
+    for( unsigned ii = 0; ii < aSegment->GetPolyPoints().size(); ii++ )
+        hashPoint( aSeed, aSegment->GetPolyPoints()[ii] );
+
+    for( unsigned ii = 0; ii < aSegment->GetBezierPoints().size(); ii++ )
+        hashPoint( aSeed, aSegment->GetBezierPoints()[ii] );
+}
+
+
+size_t ZONE_CONTAINER::ComputeFillHash( BOARD* aPcb, ZONE_FILL_CONTEXT& aContext ) const
+{
+    size_t hash = 0;
+
+    // The zone itself
+    boost::hash_combine( hash, (int) GetLayer() );
+    hashNetname( hash, this );
+    boost::hash_combine( hash, GetClearance() );
+    boost::hash_combine( hash, m_cornerSmoothingType );
+    boost::hash_combine( hash, m_cornerRadius );
+    boost::hash_combine( hash, m_priority );
+    boost::hash_combine( hash, (int) m_PadConnection );
+    boost::hash_combine( hash, m_ZoneClearance );
+    boost::hash_combine( hash, m_ZoneMinThickness );
+    boost::hash_combine( hash, m_ArcToSegmentsCount );
+    boost::hash_combine( hash, m_ThermalReliefGap );
+    boost::hash_combine( hash, m_ThermalReliefCopperBridge );
+    boost::hash_combine( hash, m_FillMode );
+    hashCorners( hash, m_Poly->m_CornersList );
+
+    // Non copper zones depend only on their outline
+    if( !IsOnCopperLayer() )
+        return hash ? hash : 1;
+
+    // The area where items can change the filled areas: see
+    // AddClearanceAreasPolygonsToPolysList()
+    int      margin = m_ZoneMinThickness / 2;
+    int      zone_clearance = std::max( m_ZoneClearance, GetClearance() ) + margin;
+    EDA_RECT area = GetBoundingBox();
+
+    area.Inflate( std::max( aPcb->GetDesignSettings().GetBiggestClearanceValue(),
+                            zone_clearance ) );
+    area.Inflate( std::max( aContext.GetMaxClearance() + margin,
+                            std::max( m_ThermalReliefGap, aContext.GetMaxThermalGap() ) ) );
+
+    boost::hash_combine( hash, aPcb->GetDesignSettings().GetBiggestClearanceValue() );
+
+    std::vector<D_PAD*> pads;
+    aContext.QueryPads( area, pads );
+
+    for( unsigned ii = 0; ii < pads.size(); ii++ )
+    {
+        const D_PAD* pad = pads[ii];
+
+        hashPoint( hash, pad->GetPosition() );
+        hashPoint( hash, pad->GetOffset() );
+        hashSize( hash, pad->GetSize() );
+        hashSize( hash, pad->GetDelta() );
+        hashSize( hash, pad->GetDrillSize() );
+        boost::hash_combine( hash, (int) pad->GetShape() );
+        boost::hash_combine( hash, (int) pad->GetDrillShape() );
+        boost::hash_combine( hash, (int) pad->GetAttribute() );
+        boost::hash_combine( hash, pad->GetOrientation() );
+        boost::hash_combine( hash, pad->IsOnLayer( GetLayer() ) );
+        hashNetname( hash, pad );
+        boost::hash_combine( hash, pad->GetClearance() );
+        boost::hash_combine( hash, (int) pad->GetZoneConnection() );
+        boost::hash_combine( hash, pad->GetThermalGap() );
+        boost::hash_combine( hash, pad->GetThermalWidth() );
+    }
+
+    std::vector<TRACK*> tracks;
+    aContext.QueryTracks( area, GetLayer(), tracks );
+
+    for( unsigned ii = 0; ii < tracks.size(); ii++ )
+    {
+        const TRACK* track = tracks[ii];
+
+        boost::hash_combine( hash, (int) track->Type() );
+        hashPoint( hash, track->GetStart() );
+        hashPoint( hash, track->GetEnd() );
+        boost::hash_combine( hash, track->GetWidth() );
+        hashNetname( hash, track );
+        boost::hash_combine( hash, track->GetClearance() );
+    }
+
+    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    {
+        for( BOARD_ITEM* item = module->GraphicalItems();  item;  item = item->Next() )
+        {
+            if( item->Type() == PCB_MODULE_EDGE_T && item->GetBoundingBox().Intersects( area ) )
+                hashDrawSegment( hash, (EDGE_MODULE*) item );
+        }
+    }
+
+    // All the graphic items of the zone layer and the board edges are used
+    for( BOARD_ITEM* item = aPcb->m_Drawings; item; item = item->Next() )
+    {
+        if( item->GetLayer() != GetLayer() && item->GetLayer() != Edge_Cuts )
+            continue;
+
+        switch( item->Type() )
+        {
+        case PCB_LINE_T:
+            hashDrawSegment( hash, (DRAWSEGMENT*) item );
+            break;
+
+        case PCB_TEXT_T:
+        {
+            const TEXTE_PCB* text = (TEXTE_PCB*) item;
+
+            boost::hash_combine( hash, (int) text->GetLayer() );
+            boost::hash_combine( hash, text->GetText().IsEmpty() );
+            boost::hash_combine( hash, text->GetOrientation() );
+            hashPoint( hash, text->GetTextPosition() );
+            hashRect( hash, text->GetTextBox( -1 ) );
+        }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // The other zones of the layer, which can be removed from this zone
+    for( int ii = 0; ii < aPcb->GetAreaCount(); ii++ )
+    {
+        const ZONE_CONTAINER* zone = aPcb->GetArea( ii );
+
+        if( zone == this || zone->GetLayer() != GetLayer() )
+            continue;
+
+        if( !zone->GetBoundingBox().Intersects( area ) )
+            continue;
+
+        boost::hash_combine( hash, zone->m_priority );
+        boost::hash_combine( hash, zone->m_isKeepout );
+        boost::hash_combine( hash, zone->m_doNotAllowCopperPour );
+        hashNetname( hash, zone );
+        boost::hash_combine( hash, zone->GetClearance() );
+        boost::hash_combine( hash, zone->m_ZoneMinThickness );
+        boost::hash_combine( hash, zone->m_cornerSmoothingType );
+        boost::hash_combine( hash, zone->m_cornerRadius );
+        hashCorners( hash, zone->m_Poly->m_CornersList );
+    }
+
+    // 0 means an unknown hash
+    return hash ? hash : 1;
+}
+
+
+// Sort function used to fill the biggest zones first
+static bool sortByDecreasingArea( const ZONE_CONTAINER* aZone1, const ZONE_CONTAINER* aZone2 )
+{
+    return aZone1->GetBoundingBox().GetArea() > aZone2->GetBoundingBox().GetArea();
+}
+
+
+int BOARD::FillAllZones( wxProgressDialog* aProgressDialog, bool aStopOnError,
+                         int* aErrorLevel, int* aRefilledCount )
+{
+    std::vector<ZONE_CONTAINER*> zones;
+
+    for( int ii = 0; ii < GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = GetArea( ii );
+
+        // Cannot fill keepout zones:
+        if( !zone->GetIsKeepout() )
+            zones.push_back( zone );
+    }
+
+    // The big zones are usually the slowest to fill: start them first, so that the
+    // whole fill does not wait for a big zone started last by a single thread.
+    std::stable_sort( zones.begin(), zones.end(), sortByDecreasingArea );
+
+    // The spatial index of the board items and the pad polygons are shared by all the fills
+    ZONE_FILL_CONTEXT context( this );
+
+    // filledCount, refilledCount, errorLevel and aborted are shared by the threads:
+    // they are only accessed by atomic operations.
+    int zoneCount = zones.size();
+    int filledCount = 0;
+    int refilledCount = 0;
+    int errorLevel = 0;
+    int aborted = 0;
+    int ii;
+
+    // Each zone is a job: the threads take the next zone as soon as they are done
+    // with the previous one.  Insulated islands are removed by each job, because
+    // the thermal stubs removal needs the islands removed first.
+#ifdef USE_OPENMP
+    #pragma omp parallel private(ii)
+    {
+        #pragma omp for schedule(dynamic, 1)
+#else /* USE_OPENMP */
+    {
+#endif
+        for( ii = 0; ii < zoneCount; ii++ )
+        {
+            int stop;
+
+#ifdef USE_OPENMP
+            #pragma omp atomic read
+#endif
+            stop = aborted;
+
+            if( stop )
+                continue;
+
+            ZONE_CONTAINER* zone = zones[ii];
+
+            // Refill only if something used by the last fill was changed
+            size_t hash = zone->ComputeFillHash( this, context );
+
+            if( !zone->IsFilled() || hash != zone->GetFillHash() )
+            {
+                zone->ClearFilledPolysList();
+                zone->UnFill();
+
+#ifdef USE_OPENMP
+                #pragma omp atomic
+#endif
+                refilledCount++;
+
+                if( zone->BuildFilledSolidAreasPolygons( this, NULL, &context ) )
+                {
+                    zone->SetFillHash( hash );
+                }
+                else
+                {
+#ifdef USE_OPENMP
+                    #pragma omp atomic write
+#endif
+                    errorLevel = 1;
+
+                    if( aStopOnError )
+                    {
+#ifdef USE_OPENMP
+                        #pragma omp atomic write
+#endif
+                        aborted = 1;
+                    }
+                }
+            }
+
+            int count;
+
+#ifdef USE_OPENMP
+            #pragma omp atomic capture
+#endif
+            count = ++filledCount;
+
+#ifdef USE_OPENMP
+            // wx functions can be called only from the main thread
+            if( omp_get_thread_num() != 0 )
+                continue;
+#endif
+
+            if( aProgressDialog )
+            {
+                wxString msg;
+
+                msg.Printf( _( "Filling zone %d out of %d (net %s)..." ),
+                            count, zoneCount, GetChars( zone->GetNetname() ) );
+
+                if( !aProgressDialog->Update( count, msg ) )
+                {
+#ifdef USE_OPENMP
+                    #pragma omp atomic write
+#endif
+                    aborted = 1;    // Aborted by user
+                }
+            }
+        }
+    }   /* end of parallel section */
+
+    if( aErrorLevel )
+        *aErrorLevel = errorLevel;
+
+    if( aRefilledCount )
+        *aRefilledCount = refilledCount;
+
+    return filledCount;
+}
@@ -122,7 +122,6 @@ int PCB_EDIT_FRAME::Fill_Zone( ZONE_CONTAINER* aZone )
 
 int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
 {
-    int errorLevel = 0;
     int areaCount = GetBoard()->GetAreaCount();
     wxBusyCursor dummyCursor;
     wxString msg;
@@ -137,35 +136,26 @@ int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
                                      wxPD_AUTO_HIDE | wxPD_CAN_ABORT );
     // Display the actual message
     if( progressDialog )
-        progressDialog->Update( 0, _( "Starting zone fill..." ) );
+        progressDialog->Update( 0, _( "Filling zones..." ) );
 
     // Remove segment zones
-    GetBoard()->m_Zone.DeleteAll();
-
-    int ii;
+    bool modified = GetBoard()->m_Zone.GetCount() > 0;
 
-    for( ii = 0; ii < areaCount; ii++ )
-    {
-        ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
-        if( zoneContainer->GetIsKeepout() )
-            continue;
-
-        msg.Printf( FORMAT_STRING, ii + 1, areaCount, GetChars( zoneContainer->GetNetname() ) );
+    GetBoard()->m_Zone.DeleteAll();
 
-        if( progressDialog )
-        {
-            if( !progressDialog->Update( ii+1, msg ) )
-                break;  // Aborted by user
-        }
+    // Zones are filled concurrently, and the progress dialog shows the count of filled
+    // zones.  Like the previous serial fill, stop at the first error if not verbose.
+    // Up to date zones are not filled again, and do not modify the board.
+    int errorLevel = 0;
+    int refilledCount = 0;
 
-        errorLevel = Fill_Zone( zoneContainer );
+    GetBoard()->FillAllZones( progressDialog, !aVerbose, &errorLevel, &refilledCount );
 
-        if( errorLevel && !aVerbose )
-            break;
-    }
+    if( modified || refilledCount )
+        OnModify();
 
     if( progressDialog )
-        progressDialog->Update( ii+2, _( "Updating ratsnest..." ) );
+        progressDialog->Update( areaCount+1, _( "Updating ratsnest..." ) );
     TestConnections();
 
     // Recalculate the active ratsnest, i.e. the unconnected links
@@ -61,6 +61,7 @@
 
 #include <pcbnew.h>
 #include <zones.h>
+#include <zone_fill_context.h>
 #include <convert_basic_shapes_to_polygon.h>
 
 
@@ -84,16 +85,6 @@ extern void CreateThermalReliefPadPolygon( CPOLYGONS_LIST& aCornerBuffer,
 // Local Variables:
 static double s_thermalRot = 450;  // angle of stubs in thermal reliefs for round pads
 
-// how many segments are used to create a polygon from a circle:
-static int s_CircleToSegmentsCount = ARC_APPROX_SEGMENTS_COUNT_LOW_DEF;   /* default value. the real value will be changed to
-                                                                           * ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF
-                                                                           * if m_ArcToSegmentsCount == ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF
-                                                                           */
-double s_Correction;     /* mult coeff used to enlarge rounded and oval pads (and vias)
-                          * because the segment approximation for arcs and circles
-                          * create a smaller gap than a true circle
-                          */
-
 /**
  * Function AddClearanceAreasPolygonsToPolysList
  * Supports a min thickness area constraint.
@@ -123,25 +114,30 @@ double s_Correction;     /* mult coeff used to enlarge rounded and oval pads (an
  *     sub them to the filled areas.
  *     Remove new insulated copper islands
  */
-void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
+void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb,
+                                                           ZONE_FILL_CONTEXT* aContext )
 {
-    // Set the number of segments in arc approximations
+    // Zones can be filled concurrently (see BOARD::FillAllZones()), so this function
+    // uses no static or global buffer.
+
+    // Set the number of segments in arc approximations:
+    // how many segments are used to create a polygon from a circle
+    int segsInCircle;
+
     if( m_ArcToSegmentsCount == ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF  )
-        s_CircleToSegmentsCount = ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF;
+        segsInCircle = ARC_APPROX_SEGMENTS_COUNT_HIGHT_DEF;
     else
-        s_CircleToSegmentsCount = ARC_APPROX_SEGMENTS_COUNT_LOW_DEF;
+        segsInCircle = ARC_APPROX_SEGMENTS_COUNT_LOW_DEF;
 
     /* calculates the coeff to compensate radius reduction of holes clearance
      * due to the segment approx.
-     * For a circle the min radius is radius * cos( 2PI / s_CircleToSegmentsCount / 2)
-     * s_Correction is 1 /cos( PI/s_CircleToSegmentsCount  )
+     * For a circle the min radius is radius * cos( 2PI / segsInCircle / 2)
+     * correctionFactor is 1 /cos( PI/segsInCircle  )
      */
-    s_Correction = 1.0 / cos( M_PI / s_CircleToSegmentsCount );
+    double correctionFactor = 1.0 / cos( M_PI / segsInCircle );
 
     // this is a place to store holes (i.e. tracks, pads ... areas as polygons outlines)
-    // static to avoid unnecessary memory allocation when filling many zones.
-    static CPOLYGONS_LIST cornerBufferPolysToSubstract;
-    cornerBufferPolysToSubstract.RemoveAllContours();
+    CPOLYGONS_LIST cornerBufferPolysToSubstract;
 
     // This KI_POLYGON_SET is the area(s) to fill, with m_ZoneMinThickness/2
     KI_POLYGON_SET polyset_zone_solid_areas;
@@ -223,69 +219,94 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
     MODULE dummymodule( aPcb );    // Creates a dummy parent
     D_PAD dummypad( &dummymodule );
 
-    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    // The candidate pads: only the pads near the zone when a spatial index is available.
+    // Pads further than their clearance from the zone bounding box are skipped below.
+    std::vector<D_PAD*> pads;
+
+    if( aContext )
+    {
+        EDA_RECT area = zone_boundingbox;
+        area.Inflate( aContext->GetMaxClearance() + margin );
+        aContext->QueryPads( area, pads );
+    }
+    else
+    {
+        for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+        {
+            for( D_PAD* pad = module->Pads(); pad != NULL; pad = pad->Next() )
+                pads.push_back( pad );
+        }
+    }
+
+    for( unsigned ii = 0; ii < pads.size(); ii++ )
     {
-        D_PAD* nextpad;
+        D_PAD* pad = pads[ii];      // pad pointer can be modified by next code
 
-        for( D_PAD* pad = module->Pads(); pad != NULL; pad = nextpad )
+        if( !pad->IsOnLayer( GetLayer() ) )
         {
-            nextpad = pad->Next();  // pad pointer can be modified by next code, so
-                                    // calculate the next pad here
+            /* Test for pads that are on top or bottom only and have a hole.
+             * There are curious pads but they can be used for some components that are
+             * inside the board (in fact inside the hole. Some photo diodes and Leds are
+             * like this)
+             */
+            if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
+                continue;
 
-            if( !pad->IsOnLayer( GetLayer() ) )
-            {
-                /* Test for pads that are on top or bottom only and have a hole.
-                 * There are curious pads but they can be used for some components that are
-                 * inside the board (in fact inside the hole. Some photo diodes and Leds are
-                 * like this)
-                 */
-                if( pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
-                    continue;
-
-                // Use a dummy pad to calculate a hole shape that have the same dimension as
-                // the pad hole
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetOrientation( pad->GetOrientation() );
-                dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_OBLONG ?
-                                   PAD_OVAL : PAD_CIRCLE );
-                dummypad.SetPosition( pad->GetPosition() );
-
-                pad = &dummypad;
-            }
+            // Use a dummy pad to calculate a hole shape that have the same dimension as
+            // the pad hole
+            dummypad.SetSize( pad->GetDrillSize() );
+            dummypad.SetOrientation( pad->GetOrientation() );
+            dummypad.SetShape( pad->GetDrillShape() == PAD_DRILL_OBLONG ?
+                               PAD_OVAL : PAD_CIRCLE );
+            dummypad.SetPosition( pad->GetPosition() );
 
-            // Note: netcode <=0 means not connected item
-            if( ( pad->GetNetCode() != GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
-            {
-                item_clearance   = pad->GetClearance() + margin;
-                item_boundingbox = pad->GetBoundingBox();
-                item_boundingbox.Inflate( item_clearance );
+            pad = &dummypad;
+        }
+
+        // Note: netcode <=0 means not connected item
+        if( ( pad->GetNetCode() != GetNetCode() ) || ( pad->GetNetCode() <= 0 ) )
+        {
+            item_clearance   = pad->GetClearance() + margin;
+            item_boundingbox = pad->GetBoundingBox();
+            item_boundingbox.Inflate( item_clearance );
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
-                {
-                    int clearance = std::max( zone_clearance, item_clearance );
+            if( item_boundingbox.Intersects( zone_boundingbox ) )
+            {
+                int clearance = std::max( zone_clearance, item_clearance );
+
+                // The dummy pad changes for each hole, so it cannot be cached
+                if( aContext && pad != &dummypad )
+                    aContext->AddPadClearancePolygon( cornerBufferPolysToSubstract, pad,
+                                                      clearance, segsInCircle,
+                                                      correctionFactor );
+                else
                     pad->TransformShapeWithClearanceToPolygon( cornerBufferPolysToSubstract,
                                                                clearance,
-                                                               s_CircleToSegmentsCount,
-                                                               s_Correction );
-                }
-
-                continue;
+                                                               segsInCircle,
+                                                               correctionFactor );
             }
 
-            if( GetPadConnection( pad ) == PAD_NOT_IN_ZONE )
-            {
-                int gap = zone_clearance;
-                int thermalGap = GetThermalReliefGap( pad );
-                gap = std::max( gap, thermalGap );
-                item_boundingbox = pad->GetBoundingBox();
+            continue;
+        }
+
+        if( GetPadConnection( pad ) == PAD_NOT_IN_ZONE )
+        {
+            int gap = zone_clearance;
+            int thermalGap = GetThermalReliefGap( pad );
+            gap = std::max( gap, thermalGap );
+            item_boundingbox = pad->GetBoundingBox();
 
-                if( item_boundingbox.Intersects( zone_boundingbox ) )
-                {
+            if( item_boundingbox.Intersects( zone_boundingbox ) )
+            {
+                if( aContext )
+                    aContext->AddPadClearancePolygon( cornerBufferPolysToSubstract, pad,
+                                                      gap, segsInCircle,
+                                                      correctionFactor );
+                else
                     pad->TransformShapeWithClearanceToPolygon( cornerBufferPolysToSubstract,
                                                                gap,
-                                                               s_CircleToSegmentsCount,
-                                                               s_Correction );
-                }
+                                                               segsInCircle,
+                                                               correctionFactor );
             }
         }
     }
@@ -293,8 +314,22 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
     /* Add holes (i.e. tracks and vias areas as polygons outlines)
      * in cornerBufferPolysToSubstract
      */
-    for( TRACK* track = aPcb->m_Track;  track;  track = track->Next() )
+    std::vector<TRACK*> tracks;
+
+    if( aContext )
+    {
+        aContext->QueryTracks( zone_boundingbox, GetLayer(), tracks );
+    }
+    else
+    {
+        for( TRACK* track = aPcb->m_Track;  track;  track = track->Next() )
+            tracks.push_back( track );
+    }
+
+    for( unsigned ii = 0; ii < tracks.size(); ii++ )
     {
+        TRACK* track = tracks[ii];
+
         if( !track->IsOnLayer( GetLayer() ) )
             continue;
 
@@ -309,8 +344,8 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
             int clearance = std::max( zone_clearance, item_clearance );
             track->TransformShapeWithClearanceToPolygon( cornerBufferPolysToSubstract,
                                                          clearance,
-                                                         s_CircleToSegmentsCount,
-                                                         s_Correction );
+                                                         segsInCircle,
+                                                         correctionFactor );
         }
     }
 
@@ -334,7 +369,7 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
             {
                 ( (EDGE_MODULE*) item )->TransformShapeWithClearanceToPolygon(
                     cornerBufferPolysToSubstract, zone_clearance,
-                    s_CircleToSegmentsCount, s_Correction );
+                    segsInCircle, correctionFactor );
             }
         }
     }
@@ -350,7 +385,7 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
         case PCB_LINE_T:
             ( (DRAWSEGMENT*) item )->TransformShapeWithClearanceToPolygon(
                 cornerBufferPolysToSubstract,
-                zone_clearance, s_CircleToSegmentsCount, s_Correction );
+                zone_clearance, segsInCircle, correctionFactor );
             break;
 
         case PCB_TEXT_T:
@@ -404,37 +439,43 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
     }
 
    // Remove thermal symbols
-    for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
+    if( aContext )
     {
-        for( D_PAD* pad = module->Pads(); pad != NULL; pad = pad->Next() )
-        {
-            // Rejects non-standard pads with tht-only thermal reliefs
-            if( GetPadConnection( pad ) == THT_THERMAL
-             && pad->GetAttribute() != PAD_STANDARD )
-                continue;
+        EDA_RECT area = zone_boundingbox;
+        area.Inflate( std::max( m_ThermalReliefGap, aContext->GetMaxThermalGap() ) );
+        aContext->QueryPads( area, pads );
+    }
 
-            if( GetPadConnection( pad ) != THERMAL_PAD
-             && GetPadConnection( pad ) != THT_THERMAL )
-                continue;
+    for( unsigned ii = 0; ii < pads.size(); ii++ )
+    {
+        D_PAD* pad = pads[ii];
 
-            if( !pad->IsOnLayer( GetLayer() ) )
-                continue;
+        // Rejects non-standard pads with tht-only thermal reliefs
+        if( GetPadConnection( pad ) == THT_THERMAL
+         && pad->GetAttribute() != PAD_STANDARD )
+            continue;
 
-            if( pad->GetNetCode() != GetNetCode() )
-                continue;
-            item_boundingbox = pad->GetBoundingBox();
-            int thermalGap = GetThermalReliefGap( pad );
-            item_boundingbox.Inflate( thermalGap, thermalGap );
+        if( GetPadConnection( pad ) != THERMAL_PAD
+         && GetPadConnection( pad ) != THT_THERMAL )
+            continue;
 
-            if( item_boundingbox.Intersects( zone_boundingbox ) )
-            {
-                CreateThermalReliefPadPolygon( cornerBufferPolysToSubstract,
-                                               *pad, thermalGap,
-                                               GetThermalReliefCopperBridge( pad ),
-                                               m_ZoneMinThickness,
-                                               s_CircleToSegmentsCount,
-                                               s_Correction, s_thermalRot );
-            }
+        if( !pad->IsOnLayer( GetLayer() ) )
+            continue;
+
+        if( pad->GetNetCode() != GetNetCode() )
+            continue;
+        item_boundingbox = pad->GetBoundingBox();
+        int thermalGap = GetThermalReliefGap( pad );
+        item_boundingbox.Inflate( thermalGap, thermalGap );
+
+        if( item_boundingbox.Intersects( zone_boundingbox ) )
+        {
+            CreateThermalReliefPadPolygon( cornerBufferPolysToSubstract,
+                                           *pad, thermalGap,
+                                           GetThermalReliefCopperBridge( pad ),
+                                           m_ZoneMinThickness,
+                                           segsInCircle,
+                                           correctionFactor, s_thermalRot );
         }
     }
 
@@ -464,7 +505,7 @@ void ZONE_CONTAINER::AddClearanceAreasPolygonsToPolysList( BOARD* aPcb )
     // (this is a refinement for thermal relief shapes)
     if( GetNetCode() > 0 )
         BuildUnconnectedThermalStubsPolygonList( cornerBufferPolysToSubstract, aPcb, this,
-                                                 s_Correction, s_thermalRot );
+                                                 correctionFactor, s_thermalRot );
 
     // remove copper areas corresponding to not connected stubs
     if( cornerBufferPolysToSubstract.GetCornersCount() )
@@ -0,0 +1,36 @@
+#
+# Helpers shared by the QA test cases.  test.py runs from this directory,
+# so the test cases import this module with: from qa_utils import *
+#
+import os
+import shutil
+import tempfile
+import unittest
+
+
+def read_file(filename):
+    with open(filename) as file:
+        return file.read()
+
+
+class TempDirTestCase(unittest.TestCase):
+    """
+    A test case with a private temporary directory, created by setUp() and
+    removed with all its files after each test.  Test cases overriding setUp()
+    must call TempDirTestCase.setUp(self) first.
+    """
+
+    def setUp(self):
+        self.tempdir = tempfile.mkdtemp(prefix="kicad_qa_")
+        self.addCleanup(shutil.rmtree, self.tempdir, True)
+
+    def temp_path(self, name):
+        """Return the path of the file name in the temporary directory."""
+        return os.path.join(self.tempdir, name)
+
+    def assertSameContent(self, filename, *others):
+        """Check the files others have the same content as the file filename."""
+        content = read_file(filename)
+
+        for other in others:
+            self.assertEqual(read_file(other), content)
@@ -0,0 +1,32 @@
+import unittest
+import pcbnew
+
+from qa_utils import TempDirTestCase
+
+
+class TestPCBSaveLoad(TempDirTestCase):
+
+    def setUp(self):
+        TempDirTestCase.setUp(self)
+        self.pcb = pcbnew.LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.FILENAME1 = self.temp_path("save1.kicad_pcb")
+        self.FILENAME2 = self.temp_path("save2.kicad_pcb")
+
+    def test_pcb_round_trip(self):
+        # A saved and reloaded board must be saved again exactly the same way
+        self.assertTrue(pcbnew.SaveBoard(self.FILENAME1, self.pcb))
+
+        pcb2 = pcbnew.LoadBoard(self.FILENAME1)
+        self.assertNotEqual(pcb2, None)
+
+        self.assertEqual(len(list(pcb2.GetTracks())), len(list(self.pcb.GetTracks())))
+        self.assertEqual(len(list(pcb2.GetModules())), len(list(self.pcb.GetModules())))
+        self.assertEqual(pcb2.GetNetCount(), self.pcb.GetNetCount())
+
+        self.assertTrue(pcbnew.SaveBoard(self.FILENAME2, pcb2))
+
+        self.assertSameContent(self.FILENAME1, self.FILENAME2)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,59 @@
+import os
+import unittest
+import pcbnew
+
+from qa_utils import TempDirTestCase
+
+
+class TestPCBCache(TempDirTestCase):
+
+    def setUp(self):
+        TempDirTestCase.setUp(self)
+        self.FILENAME1 = self.temp_path("board.kicad_pcb")
+        self.FILENAME2 = self.temp_path("cached.kicad_pcb")
+        self.FILENAME3 = self.temp_path("parsed.kicad_pcb")
+
+        # Only the big boards get a binary cache: add enough tracks to the test board
+        self.pcb = pcbnew.LoadBoard("data/complex_hierarchy.kicad_pcb")
+        first = list(self.pcb.GetTracks())[0]
+
+        for ii in range(30000):
+            track = pcbnew.TRACK(self.pcb)
+            track.SetStart(pcbnew.wxPointMM(ii % 100, ii / 100))
+            track.SetEnd(pcbnew.wxPointMM(ii % 100 + 0.5, ii / 100))
+            track.SetWidth(pcbnew.FromMM(0.25))
+            track.SetLayer(first.GetLayer())
+            track.SetNetCode(first.GetNetCode())
+            self.pcb.Add(track)
+
+    def test_pcb_cached_load(self):
+        # Saving the board writes its cache
+        self.assertTrue(pcbnew.SaveBoard(self.FILENAME1, self.pcb))
+        self.assertTrue(os.path.exists(self.FILENAME1 + "-cache"))
+
+        # A board loaded from the cache must be the same as the board loaded from the text
+        cached = pcbnew.LoadBoard(self.FILENAME1)
+        self.assertTrue(pcbnew.SaveBoard(self.FILENAME2, cached))
+
+        os.remove(self.FILENAME1 + "-cache")
+
+        parsed = pcbnew.LoadBoard(self.FILENAME1)
+        self.assertTrue(pcbnew.SaveBoard(self.FILENAME3, parsed))
+
+        self.assertEqual(len(list(cached.GetTracks())), len(list(parsed.GetTracks())))
+        self.assertEqual(cached.GetNetCount(), parsed.GetNetCount())
+
+        self.assertSameContent(self.FILENAME1, self.FILENAME2, self.FILENAME3)
+
+    def test_pcb_stale_cache_removed(self):
+        self.assertTrue(pcbnew.SaveBoard(self.FILENAME1, self.pcb))
+        self.assertTrue(os.path.exists(self.FILENAME1 + "-cache"))
+
+        # A board too small for a cache removes the cache of its bigger version
+        small = pcbnew.LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.assertTrue(pcbnew.SaveBoard(self.FILENAME1, small))
+        self.assertFalse(os.path.exists(self.FILENAME1 + "-cache"))
+
+
+if __name__ == '__main__':
+    unittest.main()
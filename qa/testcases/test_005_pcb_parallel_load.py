@@ -0,0 +1,54 @@
+import io
+import unittest
+import pcbnew
+
+from qa_utils import TempDirTestCase
+
+
+class TestPCBParallelLoad(TempDirTestCase):
+
+    def setUp(self):
+        TempDirTestCase.setUp(self)
+
+        # LoadBoard() parses the items of a mapped board file concurrently,
+        # PCB_IO.Parse() parses a string serially.
+        self.pcb = pcbnew.LoadBoard("data/complex_hierarchy.kicad_pcb")
+
+        with io.open("data/complex_hierarchy.kicad_pcb", encoding="utf-8") as file:
+            self.serial = pcbnew.PCB_IO().Parse(file.read()).Cast()
+
+        self.FILENAME1 = self.temp_path("parallel.kicad_pcb")
+        self.FILENAME2 = self.temp_path("serial.kicad_pcb")
+
+    def test_pcb_item_order(self):
+        refs = [module.GetReference() for module in self.pcb.GetModules()]
+        serial_refs = [module.GetReference() for module in self.serial.GetModules()]
+        self.assertEqual(refs, serial_refs)
+
+        tracks = [(track.GetStart(), track.GetEnd(), track.GetNetCode())
+                  for track in self.pcb.GetTracks()]
+        serial_tracks = [(track.GetStart(), track.GetEnd(), track.GetNetCode())
+                         for track in self.serial.GetTracks()]
+        self.assertEqual(tracks, serial_tracks)
+
+    def test_pcb_net_codes(self):
+        self.assertEqual(self.pcb.GetNetCount(), self.serial.GetNetCount())
+
+        for module in self.pcb.GetModules():
+            serial_module = self.serial.FindModule(module.GetReference())
+
+            pads = [(pad.GetPadName(), pad.GetNetCode(), pad.GetNetname())
+                    for pad in module.Pads()]
+            serial_pads = [(pad.GetPadName(), pad.GetNetCode(), pad.GetNetname())
+                           for pad in serial_module.Pads()]
+            self.assertEqual(pads, serial_pads)
+
+    def test_pcb_same_output(self):
+        self.assertTrue(pcbnew.SaveBoard(self.FILENAME1, self.pcb))
+        self.assertTrue(pcbnew.SaveBoard(self.FILENAME2, self.serial))
+
+        self.assertSameContent(self.FILENAME1, self.FILENAME2)
+
+
+if __name__ == '__main__':
+    unittest.main()